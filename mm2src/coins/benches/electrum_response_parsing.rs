@@ -0,0 +1,95 @@
+//! Compares `ElectrumRpcMessage::from_slice` with the untagged enum the electrum responses were decoded with previously,
+//! on the largest responses the electrum client receives: 2016-header chunks and 10k-entry histories.
+//!
+//! Run with `cargo bench -p coins --bench electrum_response_parsing`.
+
+#![feature(test)]
+
+#[macro_use] extern crate serde_derive;
+extern crate test;
+
+use coins::utxo::rpc_clients::{ElectrumBlockHeadersRes, ElectrumRpcMessage, ElectrumTxHistoryItem};
+use common::jsonrpc_client::{JsonRpcBatchResponse, JsonRpcRequest, JsonRpcResponse, JsonRpcResponseEnum};
+use serde::de::DeserializeOwned;
+use serialization::{CoinVariant, CompactInteger, Reader};
+use test::{black_box, Bencher};
+
+const HEADERS_NUMBER: usize = 2016;
+const HISTORY_LEN: usize = 10_000;
+/// The bitcoin genesis block header.
+const HEADER_HEX: &str = "0100000000000000000000000000000000000000000000000000000000000000000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a29ab5f49ffff001d1dac2b7c";
+
+#[derive(Deserialize)]
+#[serde(untagged)]
+#[allow(dead_code)]
+enum UntaggedResponse {
+    SubscriptionNotification(JsonRpcRequest),
+    SingleResponse(JsonRpcResponse),
+    BatchResponses(JsonRpcBatchResponse),
+}
+
+fn headers_response() -> Vec<u8> {
+    format!(
+        r#"{{"jsonrpc":"2.0","id":1,"result":{{"count":{},"hex":"{}","max":{}}}}}"#,
+        HEADERS_NUMBER,
+        HEADER_HEX.repeat(HEADERS_NUMBER),
+        HEADERS_NUMBER
+    )
+    .into_bytes()
+}
+
+fn history_response() -> Vec<u8> {
+    let items: Vec<_> = (0..HISTORY_LEN)
+        .map(|i| format!(r#"{{"height":{},"tx_hash":"{:064x}"}}"#, 700_000 + i, i))
+        .collect();
+    format!(r#"{{"jsonrpc":"2.0","id":1,"result":[{}]}}"#, items.join(",")).into_bytes()
+}
+
+/// Decodes the response the way it was decoded before `ElectrumRpcMessage`.
+fn untagged_result<T: DeserializeOwned>(bytes: &[u8]) -> T {
+    match serde_json::from_slice(bytes).unwrap() {
+        UntaggedResponse::SingleResponse(single) => serde_json::from_value(single.result.clone()).unwrap(),
+        _ => panic!("Expected a single response"),
+    }
+}
+
+fn message_result<T: DeserializeOwned>(bytes: &[u8]) -> T {
+    match ElectrumRpcMessage::from_slice(bytes).unwrap() {
+        ElectrumRpcMessage::Response(JsonRpcResponseEnum::Single(single)) => T::deserialize(&single.result).unwrap(),
+        _ => panic!("Expected a single response"),
+    }
+}
+
+#[bench]
+fn bench_untagged_headers(b: &mut Bencher) {
+    let response = headers_response();
+    b.iter(|| {
+        let res: ElectrumBlockHeadersRes = untagged_result(&response);
+        let mut serialized = serialization::serialize(&CompactInteger::from(res.count)).take();
+        serialized.extend(res.hex.0.into_iter());
+        let mut reader = Reader::new_with_coin_variant(&serialized, CoinVariant::Standard);
+        let headers: Vec<chain::BlockHeader> = reader.read_list().unwrap();
+        black_box(headers)
+    });
+}
+
+#[bench]
+fn bench_message_headers(b: &mut Bencher) {
+    let response = headers_response();
+    b.iter(|| {
+        let res: ElectrumBlockHeadersRes = message_result(&response);
+        black_box(res.block_headers(CoinVariant::Standard).unwrap())
+    });
+}
+
+#[bench]
+fn bench_untagged_history(b: &mut Bencher) {
+    let response = history_response();
+    b.iter(|| black_box(untagged_result::<Vec<ElectrumTxHistoryItem>>(&response)));
+}
+
+#[bench]
+fn bench_message_history(b: &mut Bencher) {
+    let response = history_response();
+    b.iter(|| black_box(message_result::<Vec<ElectrumTxHistoryItem>>(&response)));
+}
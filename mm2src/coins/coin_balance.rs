@@ -6,6 +6,8 @@ use crate::{BalanceError, BalanceResult, CoinBalance, CoinBalanceMap, CoinWithDe
 use async_trait::async_trait;
 use common::log::{debug, info};
 use crypto::{Bip44Chain, RpcDerivationPath};
+use futures::future::try_join_all;
+use futures::stream::{self, StreamExt, TryStreamExt};
 use mm2_err_handle::prelude::*;
 use mm2_number::BigDecimal;
 #[cfg(test)] use mocktopus::macros::*;
@@ -13,6 +15,9 @@ use std::collections::{HashMap, HashSet};
 use std::ops::Range;
 use std::{fmt, iter};
 
+/// The maximum number of the addresses checked concurrently by the default [`HDAddressBalanceScanner::are_addresses_used`].
+const CONCURRENT_ADDRESS_CHECKS: usize = 10;
+
 pub type AddressIdRange = Range<u32>;
 pub(crate) type HDBalanceAddress<T> = <<T as HDWalletBalanceOps>::HDAddressScanner as HDAddressBalanceScanner>::Address;
 pub(crate) type HDWalletBalanceObject<T> = <T as HDWalletBalanceOps>::BalanceObject;
@@ -292,9 +297,9 @@ pub trait HDWalletBalanceOps: HDWalletCoinOps {
     ) -> BalanceResult<Vec<HDAccountBalance<Self::BalanceObject>>> {
         let accounts = hd_wallet.get_accounts().await;
 
-        let mut result = Vec::with_capacity(accounts.len());
-        for (_account_id, hd_account) in accounts {
-            let addresses = self.all_known_addresses_balances(&hd_account).await?;
+        // The balances of the accounts are requested concurrently, but returned in the order of the account ids.
+        let account_balances = accounts.values().map(|hd_account| async move {
+            let addresses = self.all_known_addresses_balances(hd_account).await?;
 
             let total_balance = addresses
                 .iter()
@@ -303,17 +308,14 @@ pub trait HDWalletBalanceOps: HDWalletCoinOps {
                     total
                 });
 
-            let account_balance = HDAccountBalance {
+            Ok(HDAccountBalance {
                 account_index: hd_account.account_id(),
                 derivation_path: RpcDerivationPath(hd_account.account_derivation_path()),
                 total_balance,
                 addresses,
-            };
-
-            result.push(account_balance);
-        }
-
-        Ok(result)
+            })
+        });
+        try_join_all(account_balances).await
     }
 
     /// Requests balances of every known addresses of the given `hd_account`.
@@ -402,6 +404,21 @@ pub trait HDAddressBalanceScanner {
 
     /// Checks if the given `address` has been used before.
     async fn is_address_used(&self, address: &Self::Address) -> BalanceResult<bool>;
+
+    /// Checks which of the given `addresses` have been used before.
+    /// The results are guaranteed to be in the same order in which the addresses were requested.
+    ///
+    /// By default, the addresses are checked by [`HDAddressBalanceScanner::is_address_used`],
+    /// at most [`CONCURRENT_ADDRESS_CHECKS`] at a time.
+    async fn are_addresses_used(&self, addresses: &[Self::Address]) -> BalanceResult<Vec<bool>>
+    where
+        Self: Sync,
+    {
+        stream::iter(addresses.iter().map(|address| self.is_address_used(address)))
+            .buffered(CONCURRENT_ADDRESS_CHECKS)
+            .try_collect()
+            .await
+    }
 }
 
 pub enum AddressBalanceStatus<Balance> {
@@ -538,7 +555,7 @@ pub mod common_impl {
             coin.ticker()
         );
         let scan_new_addresses = matches!(params.scan_policy, EnableCoinScanPolicy::Scan);
-        for (account_id, hd_account) in accounts.iter_mut() {
+        let account_balances = accounts.iter_mut().map(|(account_id, hd_account)| {
             let min_addresses_number = if *account_id == path_to_address.account_id {
                 // The account for the enabled address is already indexed.
                 // But in case the address index is larger than the number of derived addresses,
@@ -547,7 +564,7 @@ pub mod common_impl {
             } else {
                 params.min_addresses_number
             };
-            let account_balance = enable_hd_account(
+            enable_hd_account(
                 coin,
                 hd_wallet,
                 hd_account,
@@ -556,9 +573,9 @@ pub mod common_impl {
                 scan_new_addresses,
                 min_addresses_number,
             )
-            .await?;
-            result.accounts.push(account_balance);
-        }
+        });
+        // The accounts are enabled concurrently, but their balances are returned in the order of the account ids.
+        result.accounts.extend(try_join_all(account_balances).await?);
         drop(accounts);
 
         if coin.is_trezor() {
@@ -35,6 +35,7 @@ use crate::nft::nft_errors::ParseContractTypeError;
 use crate::nft::nft_structs::{ContractType, ConvertChain, NftInfo, TransactionNftDetails, WithdrawErc1155,
                               WithdrawErc721};
 use crate::nft::WithdrawNftResult;
+use crate::rpc_cache::{ttl_from_block_interval, SingleFlightCache};
 use crate::rpc_command::account_balance::{AccountBalanceParams, AccountBalanceRpcOps, HDAccountBalanceResponse};
 use crate::rpc_command::get_new_address::{GetNewAddressParams, GetNewAddressResponse, GetNewAddressRpcError,
                                           GetNewAddressRpcOps};
@@ -76,11 +77,12 @@ pub use ethcore_transaction::{SignedTransaction as SignedEthTx, TxType};
 use ethereum_types::{Address, H160, H256, U256};
 use ethkey::{public_to_address, sign, verify_address, KeyPair, Public, Signature};
 use futures::compat::Future01CompatExt;
-use futures::future::{join, join_all, select_ok, try_join_all, Either, FutureExt, TryFutureExt};
+use futures::future::{join, join_all, select_ok, Either, FutureExt, TryFutureExt};
 use futures01::Future;
 use http::Uri;
 use kdf_walletconnect::{WalletConnectCtx, WalletConnectOps};
 use mm2_core::mm_ctx::{MmArc, MmWeak};
+use mm2_metrics::MetricsWeak;
 use mm2_number::bigdecimal_custom::CheckedDivision;
 use mm2_number::{BigDecimal, BigUint, MmNumber};
 use rand::seq::SliceRandom;
@@ -181,6 +183,8 @@ const NFT_SWAP_CONTRACT_ABI: &str = include_str!("eth/nft_swap_contract_abi.json
 const NFT_MAKER_SWAP_V2_ABI: &str = include_str!("eth/nft_maker_swap_v2_abi.json");
 const MAKER_SWAP_V2_ABI: &str = include_str!("eth/maker_swap_v2_abi.json");
 const TAKER_SWAP_V2_ABI: &str = include_str!("eth/taker_swap_v2_abi.json");
+/// The `aggregate3` method of https://github.com/mds1/multicall
+const MULTICALL3_ABI: &str = include_str!("eth/multicall3_abi.json");
 
 /// Payment states from etomic swap smart contract: https://github.com/artemii235/etomic-swap/blob/master/contracts/EtomicSwap.sol#L5
 pub enum PaymentState {
@@ -210,6 +214,12 @@ pub(crate) enum TakerPaymentStateV2 {
 /// It can change 12.5% max each block according to https://www.blocknative.com/blog/eip-1559-fees
 const BASE_BLOCK_FEE_DIFF_PCT: u64 = 13;
 const DEFAULT_LOGS_BLOCK_RANGE: u64 = 1000;
+/// The block interval of the chains that don't have `avg_blocktime` in the config.
+const DEFAULT_AVG_BLOCKTIME: u64 = 12;
+/// The RPC nodes don't notify about new blocks, so the cached chain values are bounded by the TTL only.
+const RPC_CACHE_GENERATION: u64 = 0;
+/// The maximum number of `eth_call`s sent within a single JSON-RPC batch, the RPC nodes limit the batch size.
+const ETH_CALL_BATCH_SIZE: usize = 100;
 
 const DEFAULT_REQUIRED_CONFIRMATIONS: u8 = 1;
 
@@ -519,6 +529,7 @@ lazy_static! {
     pub static ref ERC1155_CONTRACT: Contract = Contract::load(ERC1155_ABI.as_bytes()).unwrap();
     pub static ref NFT_SWAP_CONTRACT: Contract = Contract::load(NFT_SWAP_CONTRACT_ABI.as_bytes()).unwrap();
     pub static ref NFT_MAKER_SWAP_V2: Contract = Contract::load(NFT_MAKER_SWAP_V2_ABI.as_bytes()).unwrap();
+    static ref MULTICALL3_CONTRACT: Contract = Contract::load(MULTICALL3_ABI.as_bytes()).unwrap();
 }
 
 pub type EthDerivationMethod = DerivationMethod<Address, EthHDWallet>;
@@ -876,6 +887,8 @@ pub struct EthCoinImpl {
     trezor_coin: Option<String>,
     /// the block range used for eth_getLogs
     logs_block_range: u64,
+    /// The address of the Multicall3 contract used to aggregate the `eth_call`s of many tokens into one.
+    multicall_address: Option<Address>,
     /// A mapping of Ethereum addresses to their respective nonce locks.
     /// This is used to ensure that only one transaction is sent at a time per address.
     /// Each address is associated with an `AsyncMutex` which is locked when a transaction is being created and sent,
@@ -894,6 +907,28 @@ pub struct EthCoinImpl {
     /// This spawner is used to spawn coin's related futures that should be aborted on coin deactivation
     /// and on [`MmArc::stop`].
     pub abortable_system: AbortableQueue,
+    /// The chain values requested by every swap and order.
+    /// Shared by the platform coin and its tokens as they request the same values from the same nodes.
+    rpc_cache: Arc<EthRpcCache>,
+}
+
+/// See [`crate::rpc_cache`].
+pub struct EthRpcCache {
+    block_number: SingleFlightCache<u64>,
+    gas_price: SingleFlightCache<U256>,
+    /// The fee estimated with the gas api provider if it's configured.
+    eip1559_fee: SingleFlightCache<FeePerGasEstimated>,
+}
+
+impl EthRpcCache {
+    pub fn new(ticker: &str, avg_blocktime: Option<u64>, metrics: MetricsWeak) -> EthRpcCache {
+        let ttl = ttl_from_block_interval(avg_blocktime.unwrap_or(DEFAULT_AVG_BLOCKTIME));
+        EthRpcCache {
+            block_number: SingleFlightCache::new("block_number", ticker.to_owned(), ttl, metrics.clone()),
+            gas_price: SingleFlightCache::new("gas_price", ticker.to_owned(), ttl, metrics.clone()),
+            eip1559_fee: SingleFlightCache::new("eip1559_fee", ticker.to_owned(), ttl, metrics),
+        }
+    }
 }
 
 #[derive(Clone, Debug)]
@@ -2637,9 +2672,12 @@ impl MarketCoinOps for EthCoin {
         let coin = self.clone();
 
         let fut = async move {
-            coin.block_number()
+            coin.rpc_cache
+                .block_number
+                .get_or_fetch(RPC_CACHE_GENERATION, || async {
+                    coin.block_number().await.map(|res| res.as_u64())
+                })
                 .await
-                .map(|res| res.as_u64())
                 .map_err(|e| ERRL!("{}", e))
         };
 
@@ -4625,24 +4663,118 @@ impl EthCoin {
         &self,
         address: Address,
     ) -> Result<CoinBalanceMap, MmError<BalanceError>> {
-        let coin = || self;
-
-        let tokens = self.get_erc_tokens_infos();
-        let mut requests = Vec::with_capacity(tokens.len());
+        let tokens: Vec<_> = self.get_erc_tokens_infos().into_iter().collect();
+        if tokens.is_empty() {
+            return Ok(CoinBalanceMap::new());
+        }
 
-        for (token_ticker, info) in tokens {
-            let fut = async move {
-                let balance_as_u256 = coin()
-                    .get_token_balance_for_address(address, info.token_address)
-                    .await?;
+        let function = ERC20_CONTRACT.function("balanceOf")?;
+        let data: Bytes = function.encode_input(&[Token::Address(address)])?.into();
+        let calls = tokens
+            .iter()
+            .map(|(_, info)| (info.token_address, data.clone()))
+            .collect();
+        let results = self.aggregate_calls(address, calls).await?;
+
+        tokens
+            .into_iter()
+            .zip(results)
+            .map(|((token_ticker, info), res)| {
+                let decoded = function.decode_output(&res.0)?;
+                let balance_as_u256 = match decoded[0] {
+                    Token::Uint(number) => number,
+                    _ => {
+                        let error = format!("Expected U256 as balanceOf result but got {:?}", decoded);
+                        return MmError::err(BalanceError::InvalidResponse(error));
+                    },
+                };
                 let balance_as_big_decimal = u256_to_big_decimal(balance_as_u256, info.decimals)?;
-                let balance = CoinBalance::new(balance_as_big_decimal);
-                Ok((token_ticker, balance))
-            };
-            requests.push(fut);
-        }
+                Ok((token_ticker, CoinBalance::new(balance_as_big_decimal)))
+            })
+            .collect()
+    }
 
-        try_join_all(requests).await.map(|res| res.into_iter().collect())
+    /// Makes the `(contract, data)` constant calls with a single round trip: with the Multicall3 `aggregate3` call
+    /// if the coin config has the `multicall_address`, or with JSON-RPC batches of at most `ETH_CALL_BATCH_SIZE`
+    /// `eth_call`s otherwise. The results are in the order of the `calls`, any failed call fails the whole request.
+    async fn aggregate_calls(&self, from: Address, calls: Vec<(Address, Bytes)>) -> Web3RpcResult<Vec<Bytes>> {
+        let multicall_address = match self.multicall_address {
+            Some(multicall_address) => multicall_address,
+            None => {
+                let mut results = Vec::with_capacity(calls.len());
+                for chunk in calls.chunks(ETH_CALL_BATCH_SIZE) {
+                    let requests = chunk
+                        .iter()
+                        .map(|(to, data)| {
+                            let request = CallRequest {
+                                from: Some(from),
+                                to: Some(*to),
+                                data: Some(data.clone()),
+                                ..CallRequest::default()
+                            };
+                            (request, Some(BlockId::Number(BlockNumber::Latest)))
+                        })
+                        .collect();
+                    let chunk_results = self.call_batch(requests).await?;
+                    if chunk_results.len() != chunk.len() {
+                        let error = format!(
+                            "Expected {} eth_call results but got {}",
+                            chunk.len(),
+                            chunk_results.len()
+                        );
+                        return MmError::err(Web3RpcError::InvalidResponse(error));
+                    }
+                    for ((to, _), res) in chunk.iter().zip(chunk_results) {
+                        // The batch transport errors are returned above, these are the errors of the single calls.
+                        let res = res.map_to_mm(|err| {
+                            Web3RpcError::InvalidResponse(format!("eth_call to {:#02x} failed: {}", to, err))
+                        })?;
+                        results.push(res);
+                    }
+                }
+                return Ok(results);
+            },
+        };
+
+        let function = MULTICALL3_CONTRACT.function("aggregate3")?;
+        let calls_len = calls.len();
+        let calls = calls
+            .into_iter()
+            .map(|(to, data)| Token::Tuple(vec![Token::Address(to), Token::Bool(true), Token::Bytes(data.0)]))
+            .collect();
+        let data = function.encode_input(&[Token::Array(calls)])?;
+        let res = self
+            .call_request(from, multicall_address, None, Some(data.into()), BlockNumber::Latest)
+            .await?;
+
+        let results = match function.decode_output(&res.0)?.pop() {
+            Some(Token::Array(results)) if results.len() == calls_len => results,
+            decoded => {
+                let error = format!("Expected {} aggregate3 results but got {:?}", calls_len, decoded);
+                return MmError::err(Web3RpcError::InvalidResponse(error));
+            },
+        };
+        results
+            .into_iter()
+            .map(|result| match result {
+                Token::Tuple(mut fields) => match (fields.pop(), fields.pop()) {
+                    (Some(Token::Bytes(data)), Some(Token::Bool(true))) => Ok(data.into()),
+                    (Some(Token::Bytes(data)), Some(Token::Bool(false))) => {
+                        MmError::err(Web3RpcError::InvalidResponse(format!(
+                            "aggregate3 call failed, return data: {}",
+                            hex::encode(data)
+                        )))
+                    },
+                    _ => MmError::err(Web3RpcError::InvalidResponse(
+                        "Expected (bool, bytes) as aggregate3 result".to_owned(),
+                    )),
+                },
+                _ => MmError::err(Web3RpcError::InvalidResponse(format!(
+                    "Expected tuple as aggregate3 result but got {:?}",
+                    result
+                ))),
+            })
+            .collect()
     }
 
     pub async fn get_tokens_balance_list(&self) -> Result<CoinBalanceMap, MmError<BalanceError>> {
@@ -5398,6 +5530,13 @@ impl EthCoin {
 
     /// Get gas price
     pub async fn get_gas_price(&self) -> Web3RpcResult<U256> {
+        self.rpc_cache
+            .gas_price
+            .get_or_fetch(RPC_CACHE_GENERATION, || self.request_gas_price())
+            .await
+    }
+
+    async fn request_gas_price(&self) -> Web3RpcResult<U256> {
         let coin = self.clone();
         let eth_gas_price_fut = async {
             match coin.gas_price().await {
@@ -5435,6 +5574,16 @@ impl EthCoin {
 
     /// Get gas base fee and suggest priority tip fees for the next block (see EIP-1559)
     pub async fn get_eip1559_gas_fee(&self, use_simple: bool) -> Web3RpcResult<FeePerGasEstimated> {
+        if use_simple {
+            return self.request_eip1559_gas_fee(true).await;
+        }
+        self.rpc_cache
+            .eip1559_fee
+            .get_or_fetch(RPC_CACHE_GENERATION, || self.request_eip1559_gas_fee(false))
+            .await
+    }
+
+    async fn request_eip1559_gas_fee(&self, use_simple: bool) -> Web3RpcResult<FeePerGasEstimated> {
         let coin = self.clone();
         let history_estimator_fut = FeePerGasSimpleEstimator::estimate_fee_by_history(&coin);
         let ctx =
@@ -6551,7 +6700,7 @@ pub async fn eth_coin_from_conf_and_request(
                     komodo_proxy: false,
                 };
 
-                Web3Transport::new_http_with_event_handlers(node, event_handlers.clone())
+                Web3Transport::new_http_with_event_handlers(node, event_handlers.clone(), ctx.metrics.weak())
             },
             _ => {
                 return ERR!(
@@ -6654,6 +6803,7 @@ pub async fn eth_coin_from_conf_and_request(
     let max_eth_tx_type = get_max_eth_tx_type_conf(ctx, conf, &coin_type).await?;
     let gas_limit: EthGasLimit = extract_gas_limit_from_conf(conf)?;
     let gas_limit_v2: EthGasLimitV2 = extract_gas_limit_from_conf(conf)?;
+    let multicall_address = extract_multicall_address_from_conf(conf)?;
 
     let coin = EthCoinImpl {
         priv_key_policy: key_pair,
@@ -6676,12 +6826,18 @@ pub async fn eth_coin_from_conf_and_request(
         required_confirmations,
         trezor_coin,
         logs_block_range: conf["logs_block_range"].as_u64().unwrap_or(DEFAULT_LOGS_BLOCK_RANGE),
+        multicall_address,
         address_nonce_locks,
         erc20_tokens_infos: Default::default(),
         nfts_infos: Default::default(),
         gas_limit,
         gas_limit_v2,
         abortable_system,
+        rpc_cache: Arc::new(EthRpcCache::new(
+            ticker,
+            conf["avg_blocktime"].as_u64(),
+            ctx.metrics.weak(),
+        )),
     };
 
     Ok(EthCoin(Arc::new(coin)))
@@ -7313,6 +7469,13 @@ fn extract_gas_limit_from_conf<T: ExtractGasLimit>(coin_conf: &Json) -> Result<T
     }
 }
 
+/// Parses the optional `multicall_address` of the coin config.
+/// An invalid address fails the activation instead of silently falling back to the JSON-RPC batches.
+fn extract_multicall_address_from_conf(coin_conf: &Json) -> Result<Option<Address>, String> {
+    json::from_value(coin_conf["multicall_address"].clone())
+        .map_err(|e| format!("invalid multicall_address config {}", e))
+}
+
 impl Eip1559Ops for EthCoin {
     fn get_swap_transaction_fee_policy(&self) -> SwapTxFeePolicy { self.swap_txfee_policy.lock().unwrap().clone() }
 
@@ -7514,12 +7677,14 @@ impl EthCoin {
             ctx: self.ctx.clone(),
             trezor_coin: self.trezor_coin.clone(),
             logs_block_range: self.logs_block_range,
+            multicall_address: self.multicall_address,
             address_nonce_locks: Arc::clone(&self.address_nonce_locks),
             erc20_tokens_infos: Arc::clone(&self.erc20_tokens_infos),
             nfts_infos: Arc::clone(&self.nfts_infos),
             gas_limit: EthGasLimit::default(),
             gas_limit_v2: EthGasLimitV2::default(),
             abortable_system: self.abortable_system.create_subsystem().unwrap(),
+            rpc_cache: Arc::clone(&self.rpc_cache),
         };
         EthCoin(Arc::new(coin))
     }
@@ -10,7 +10,7 @@ use serde_json::Value;
 use web3::types::{Address, Block, BlockId, BlockNumber, Bytes, CallRequest, FeeHistory, Filter, Log, Proof, SyncState,
                   Trace, TraceFilter, Transaction, TransactionId, TransactionReceipt, TransactionRequest, Work, H256,
                   H520, H64, U256, U64};
-use web3::{helpers, Transport};
+use web3::{helpers, BatchTransport, Transport};
 
 pub(crate) const ETH_RPC_REQUEST_TIMEOUT: Duration = Duration::from_secs(10);
 
@@ -56,6 +56,55 @@ impl EthCoin {
 
         Err(error)
     }
+
+    /// Sends the `requests` within a single JSON-RPC batch, rotating through the transports as [`EthCoin::try_rpc_send`].
+    /// The results are in the order of the `requests`.
+    async fn try_rpc_send_batch(
+        &self,
+        requests: &[(&str, Vec<jsonrpc_core::Value>)],
+    ) -> Result<Vec<Result<Value, web3::Error>>, web3::Error> {
+        let mut clients = self.web3_instances.lock().await;
+
+        let mut error = web3::Error::Unreachable;
+        for (i, client) in clients.clone().into_iter().enumerate() {
+            let transport = client.web3.transport();
+            if let Web3Transport::Websocket(socket) = transport {
+                socket.maybe_spawn_connection_loop(self.clone());
+            }
+            let batch: Vec<_> = requests
+                .iter()
+                .map(|(method, params)| transport.prepare(method, params.clone()))
+                .collect();
+
+            match transport.send_batch(batch).timeout(ETH_RPC_REQUEST_TIMEOUT).await {
+                Ok(Ok(r)) => {
+                    // Bring the live client to the front of rpc_clients
+                    clients.rotate_left(i);
+                    return Ok(r);
+                },
+                Ok(Err(err)) => {
+                    debug!("Batch of {} requests failed. Error: {err}", requests.len());
+                    error = err;
+
+                    if let Web3Transport::Websocket(socket_transport) = transport {
+                        socket_transport.stop_connection_loop().await;
+                    };
+                },
+                Err(timeout_error) => {
+                    debug!(
+                        "Timeout exceed for batch of {} requests. Error: {timeout_error}",
+                        requests.len()
+                    );
+
+                    if let Web3Transport::Websocket(socket_transport) = transport {
+                        socket_transport.stop_connection_loop().await;
+                    };
+                },
+            };
+        }
+
+        Err(error)
+    }
 }
 
 #[allow(dead_code)]
@@ -84,6 +133,29 @@ impl EthCoin {
             .and_then(|t| serde_json::from_value(t).map_err(Into::into))
     }
 
+    /// Calls the constant methods of contracts within a single JSON-RPC batch.
+    /// The results are in the order of the `requests`.
+    pub(crate) async fn call_batch(
+        &self,
+        requests: Vec<(CallRequest, Option<BlockId>)>,
+    ) -> Result<Vec<Result<Bytes, web3::Error>>, web3::Error> {
+        let requests: Vec<_> = requests
+            .into_iter()
+            .map(|(req, block)| {
+                let req = helpers::serialize(&req);
+                let block = helpers::serialize(&block.unwrap_or_else(|| BlockNumber::Latest.into()));
+                ("eth_call", vec![req, block])
+            })
+            .collect();
+
+        Ok(self
+            .try_rpc_send_batch(&requests)
+            .await?
+            .into_iter()
+            .map(|res| res.and_then(|t| serde_json::from_value(t).map_err(Into::into)))
+            .collect())
+    }
+
     /// Get coinbase address
     pub(crate) async fn coinbase(&self) -> Result<Address, web3::Error> {
         self.try_rpc_send("eth_coinbase", vec![])
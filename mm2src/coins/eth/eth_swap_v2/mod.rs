@@ -85,6 +85,9 @@ impl EthCoin {
         &self,
         params: SpendTxSearchParams<'_>,
     ) -> MmResult<H256, FindPaymentSpendError> {
+        // Only the blocks mined since the previous iteration are scanned. The previous tip is scanned again
+        // as the node might not have indexed all of its logs yet.
+        let mut from_block = params.from_block;
         loop {
             let now = now_sec();
             if now > params.wait_until {
@@ -103,7 +106,7 @@ impl EthCoin {
                 },
             };
 
-            let mut next_from_block = params.from_block;
+            let mut next_from_block = from_block;
             while next_from_block <= current_block {
                 let to_block = std::cmp::min(next_from_block + self.logs_block_range - 1, current_block);
 
@@ -141,6 +144,7 @@ impl EthCoin {
 
                 next_from_block += self.logs_block_range;
             }
+            from_block = from_block.max(current_block);
 
             Timer::sleep(params.check_every).await;
         }
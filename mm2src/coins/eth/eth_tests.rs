@@ -1167,3 +1167,43 @@ fn test_h256_to_str() {
     let b: BytesJson = h.0.to_vec().into();
     println!("H256=0x{:02x}", b);
 }
+
+#[test]
+fn test_de_rpc_batch_response() {
+    use crate::eth::web3_transport::http_transport::de_rpc_batch_response;
+
+    // The responses come in a different order than the requests, and the request with id 3 is missing.
+    let response = br#"[
+        {"jsonrpc":"2.0","id":2,"error":{"code":-32000,"message":"execution reverted"}},
+        {"jsonrpc":"2.0","id":1,"result":"0x01"}
+    ]"#;
+    let results = de_rpc_batch_response(&response[..], &[1, 2, 3], "http://node").unwrap();
+    assert_eq!(results.len(), 3);
+    assert_eq!(results[0].as_ref().unwrap(), &Json::String("0x01".to_owned()));
+    assert!(matches!(results[1], Err(web3::Error::Rpc(_))));
+    assert!(matches!(results[2], Err(web3::Error::InvalidResponse(_))));
+
+    // A server that doesn't support batches replies with a single error.
+    let response = br#"{"jsonrpc":"2.0","id":null,"error":{"code":-32600,"message":"Invalid request"}}"#;
+    assert!(de_rpc_batch_response(&response[..], &[1], "http://node").is_err());
+}
+
+#[test]
+fn test_multicall3_aggregate3_abi() {
+    let function = MULTICALL3_CONTRACT.function("aggregate3").unwrap();
+    // https://github.com/mds1/multicall/blob/main/src/Multicall3.sol
+    assert_eq!(function.short_signature(), [0x82, 0xad, 0x56, 0xcb]);
+}
+
+#[test]
+fn test_multicall_address_conf() {
+    let address = "0xcA11bde05977b3631167028862bE2a173976CA11";
+    assert_eq!(
+        extract_multicall_address_from_conf(&json!({ "multicall_address": address })),
+        Ok(Some(Address::from_str(address).unwrap()))
+    );
+    assert_eq!(extract_multicall_address_from_conf(&json!({})), Ok(None));
+    // a typo in the config must not silently disable the multicall batching
+    extract_multicall_address_from_conf(&json!({ "multicall_address": "0xcA11bde05977b3631167028862bE2a173976CA1" }))
+        .unwrap_err();
+}
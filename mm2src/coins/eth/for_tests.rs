@@ -53,6 +53,7 @@ pub(crate) fn eth_coin_from_keypair(
     let gas_limit: EthGasLimit = extract_gas_limit_from_conf(&coin_conf).expect("expected valid gas_limit config");
     let gas_limit_v2: EthGasLimitV2 = extract_gas_limit_from_conf(&coin_conf).expect("expected valid gas_limit config");
 
+    let rpc_cache = Arc::new(EthRpcCache::new(&ticker, None, ctx.metrics.weak()));
     let eth_coin = EthCoin(Arc::new(EthCoinImpl {
         coin_type,
         chain_spec: ChainSpec::Evm { chain_id },
@@ -72,6 +73,7 @@ pub(crate) fn eth_coin_from_keypair(
         swap_txfee_policy: Mutex::new(SwapTxFeePolicy::Internal),
         trezor_coin: None,
         logs_block_range: DEFAULT_LOGS_BLOCK_RANGE,
+        multicall_address: None,
         address_nonce_locks: Arc::new(AsyncMutex::new(new_nonce_lock())),
         max_eth_tx_type: None,
         erc20_tokens_infos: Default::default(),
@@ -79,6 +81,7 @@ pub(crate) fn eth_coin_from_keypair(
         gas_limit,
         gas_limit_v2,
         abortable_system: AbortableQueue::default(),
+        rpc_cache,
     }));
     (ctx, eth_coin)
 }
@@ -487,12 +487,14 @@ impl EthCoin {
             required_confirmations,
             trezor_coin: self.trezor_coin.clone(),
             logs_block_range: self.logs_block_range,
+            multicall_address: self.multicall_address,
             address_nonce_locks: self.address_nonce_locks.clone(),
             erc20_tokens_infos: Default::default(),
             nfts_infos: Default::default(),
             gas_limit,
             gas_limit_v2,
             abortable_system,
+            rpc_cache: self.rpc_cache.clone(),
         };
 
         Ok(EthCoin(Arc::new(token)))
@@ -574,12 +576,14 @@ impl EthCoin {
             ctx: self.ctx.clone(),
             trezor_coin: self.trezor_coin.clone(),
             logs_block_range: self.logs_block_range,
+            multicall_address: self.multicall_address,
             address_nonce_locks: self.address_nonce_locks.clone(),
             erc20_tokens_infos: Default::default(),
             nfts_infos: Arc::new(AsyncMutex::new(nft_infos)),
             gas_limit,
             gas_limit_v2,
             abortable_system,
+            rpc_cache: self.rpc_cache.clone(),
         };
         Ok(EthCoin(Arc::new(global_nft)))
     }
@@ -693,6 +697,7 @@ pub async fn eth_coin_from_conf_and_request_v2(
         .map_to_mm(|e| EthActivationV2Error::InternalError(format!("invalid gas_limit config {}", e)))?;
     let gas_limit_v2: EthGasLimitV2 = extract_gas_limit_from_conf(conf)
         .map_to_mm(|e| EthActivationV2Error::InternalError(format!("invalid gas_limit config {}", e)))?;
+    let multicall_address = extract_multicall_address_from_conf(conf).map_to_mm(EthActivationV2Error::InternalError)?;
 
     let coin = EthCoinImpl {
         priv_key_policy,
@@ -714,12 +719,18 @@ pub async fn eth_coin_from_conf_and_request_v2(
         required_confirmations,
         trezor_coin,
         logs_block_range: conf["logs_block_range"].as_u64().unwrap_or(DEFAULT_LOGS_BLOCK_RANGE),
+        multicall_address,
         address_nonce_locks,
         erc20_tokens_infos: Default::default(),
         nfts_infos: Default::default(),
         gas_limit,
         gas_limit_v2,
         abortable_system,
+        rpc_cache: Arc::new(EthRpcCache::new(
+            ticker,
+            conf["avg_blocktime"].as_u64(),
+            ctx.metrics.weak(),
+        )),
     };
 
     Ok(EthCoin(Arc::new(coin)))
@@ -945,7 +956,7 @@ fn create_http_transport(
     };
 
     let komodo_proxy = node.komodo_proxy;
-    let mut http_transport = HttpTransport::with_event_handlers(node, event_handlers.to_owned());
+    let mut http_transport = HttpTransport::with_event_handlers(node, event_handlers.to_owned(), ctx.metrics.weak());
 
     if komodo_proxy {
         http_transport.proxy_sign_keypair = Some(P2PContext::fetch_from_mm_arc(ctx).keypair().clone());
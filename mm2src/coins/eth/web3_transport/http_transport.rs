@@ -1,17 +1,22 @@
-use crate::eth::{web3_transport::Web3SendOut, RpcTransportEventHandler, RpcTransportEventHandlerShared, Web3RpcError};
+use crate::eth::web3_transport::{Web3BatchSendOut, Web3SendOut};
+use crate::eth::{RpcTransportEventHandler, RpcTransportEventHandlerShared, Web3RpcError};
 use common::APPLICATION_JSON;
 use common::X_AUTH_PAYLOAD;
 use http::header::CONTENT_TYPE;
-use jsonrpc_core::{Call, Response};
+use jsonrpc_core::{Call, Id, Output, Response};
+use mm2_metrics::MetricsWeak;
 use mm2_p2p::Keypair;
 use proxy_signature::RawMessage;
+use serde::Serialize;
 use serde_json::Value as Json;
+use std::collections::HashMap;
+use std::fmt;
 use std::ops::Deref;
 use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 use std::sync::Arc;
 use web3::error::{Error, TransportError};
 use web3::helpers::{build_request, to_result_from_output, to_string};
-use web3::{RequestId, Transport};
+use web3::{BatchTransport, RequestId, Transport};
 
 /// Deserialize bytes RPC response into `Result`.
 /// Implementation copied from Web3 HTTP transport
@@ -34,6 +39,51 @@ where
     }
 }
 
+/// Deserialize bytes RPC batch response into the results of the batched requests with the given `ids`,
+/// in the order of the `ids`.
+pub(crate) fn de_rpc_batch_response<T>(
+    response: T,
+    ids: &[RequestId],
+    rpc_url: &str,
+) -> Result<Vec<Result<Json, Error>>, Error>
+where
+    T: Deref<Target = [u8]> + std::fmt::Debug,
+{
+    let response = serde_json::from_slice(&response).map_err(|e| {
+        Error::InvalidResponse(format!(
+            "url: {}, Error deserializing response: {}, raw response: {}",
+            rpc_url,
+            e,
+            String::from_utf8_lossy(&response)
+        ))
+    })?;
+
+    let outputs = match response {
+        Response::Batch(outputs) => outputs,
+        // The servers that don't support batches reply with a single error.
+        Response::Single(output) => {
+            to_result_from_output(output)?;
+            return Err(Error::InvalidResponse("Expected batch, got single.".into()));
+        },
+    };
+
+    // The batch responses may come in any order.
+    let mut outputs: HashMap<Id, Output> = outputs
+        .into_iter()
+        .map(|output| (output.id().clone(), output))
+        .collect();
+    Ok(ids
+        .iter()
+        .map(|id| match outputs.remove(&Id::Num(*id as u64)) {
+            Some(output) => to_result_from_output(output),
+            None => Err(Error::InvalidResponse(format!(
+                "No response to the request with id {}",
+                id
+            ))),
+        })
+        .collect())
+}
+
 #[derive(Clone, Debug)]
 pub struct HttpTransport {
     id: Arc<AtomicUsize>,
@@ -41,6 +91,9 @@ pub struct HttpTransport {
     node: HttpTransportNode,
     event_handlers: Vec<RpcTransportEventHandlerShared>,
     pub(crate) proxy_sign_keypair: Option<Keypair>,
+    /// The connection pool metrics are recorded to. The browser manages the connections itself on WASM.
+    #[cfg_attr(target_arch = "wasm32", allow(dead_code))]
+    metrics: MetricsWeak,
 }
 
 #[derive(Clone, Debug)]
@@ -59,17 +112,23 @@ impl HttpTransport {
             event_handlers: Default::default(),
             proxy_sign_keypair: None,
             last_request_failed: Arc::new(AtomicBool::new(false)),
+            metrics: MetricsWeak::new(),
         }
     }
 
     #[inline]
-    pub fn with_event_handlers(node: HttpTransportNode, event_handlers: Vec<RpcTransportEventHandlerShared>) -> Self {
+    pub fn with_event_handlers(
+        node: HttpTransportNode,
+        event_handlers: Vec<RpcTransportEventHandlerShared>,
+        metrics: MetricsWeak,
+    ) -> Self {
         HttpTransport {
             id: Arc::new(AtomicUsize::new(0)),
             node,
             event_handlers,
             proxy_sign_keypair: None,
             last_request_failed: Arc::new(AtomicBool::new(false)),
+            metrics,
         }
     }
 }
@@ -91,18 +150,85 @@ impl Transport for HttpTransport {
     fn send(&self, _id: RequestId, request: Call) -> Self::Out { Box::pin(send_request(request, self.clone())) }
 }
 
-#[cfg(not(target_arch = "wasm32"))]
+impl BatchTransport for HttpTransport {
+    type Batch = Web3BatchSendOut;
+
+    /// Sends the `requests` within a single HTTP request.
+    fn send_batch<T>(&self, requests: T) -> Self::Batch
+    where
+        T: IntoIterator<Item = (RequestId, Call)>,
+    {
+        let (ids, calls) = requests.into_iter().unzip();
+        Box::pin(send_batch_request(ids, calls, self.clone()))
+    }
+}
+
+/// Describes the request in the errors.
+enum RequestInfo<'a> {
+    Single(&'a Call),
+    Batch(&'a [Call]),
+}
+
+impl fmt::Display for RequestInfo<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            RequestInfo::Single(call) => {
+                let (method, id) = match call {
+                    Call::MethodCall(m) => (m.method.clone(), m.id.clone()),
+                    Call::Notification(n) => (n.method.clone(), jsonrpc_core::Id::Null),
+                    Call::Invalid { id } => ("Invalid call".to_string(), id.clone()),
+                };
+                write!(f, "method: '{}', id: {:?}", method, id)
+            },
+            RequestInfo::Batch(calls) => write!(f, "batch of {} calls", calls.len()),
+        }
+    }
+}
+
 async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, Error> {
+    let info = RequestInfo::Single(&request);
+    let response = post_request(&request, &info, &transport).await?;
+    de_rpc_response(response, &transport.node.uri.to_string()).map_err(|err| {
+        request_failed_error(
+            &info,
+            Web3RpcError::InvalidResponse(format!("Server: '{}', error: {}", transport.node.uri, err)),
+        )
+    })
+}
+
+async fn send_batch_request(
+    ids: Vec<RequestId>,
+    calls: Vec<Call>,
+    transport: HttpTransport,
+) -> Result<Vec<Result<Json, Error>>, Error> {
+    let info = RequestInfo::Batch(&calls);
+    // An array of calls is serialized as a JSON-RPC batch.
+    let response = post_request(&calls, &info, &transport).await?;
+    de_rpc_batch_response(response, &ids, &transport.node.uri.to_string()).map_err(|err| {
+        request_failed_error(
+            &info,
+            Web3RpcError::InvalidResponse(format!("Server: '{}', error: {}", transport.node.uri, err)),
+        )
+    })
+}
+
+/// Posts the serialized `request` and returns the response body.
+#[cfg(not(target_arch = "wasm32"))]
+async fn post_request<R: Serialize>(
+    request: &R,
+    info: &RequestInfo<'_>,
+    transport: &HttpTransport,
+) -> Result<Vec<u8>, Error> {
     use common::executor::Timer;
     use common::log::warn;
     use futures::future::{select, Either};
     use gstuff::binprint;
     use http::header::HeaderValue;
-    use mm2_net::transport::slurp_req;
+    use mm2_net::native_http::slurp_req_pooled;
 
     const REQUEST_TIMEOUT_S: f64 = 20.;
 
-    let serialized_request = to_string(&request);
+    let serialized_request = to_string(request);
     let request_bytes = serialized_request.as_bytes();
 
     transport.event_handlers.on_outgoing_request(request_bytes);
@@ -120,39 +246,34 @@ async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, E
             request_bytes.len(),
             common::PROXY_REQUEST_EXPIRATION_SEC,
         )
-        .map_err(|e| request_failed_error(&request, Web3RpcError::Internal(e.to_string())))?;
+        .map_err(|e| request_failed_error(info, Web3RpcError::Internal(e.to_string())))?;
 
         let proxy_sign_serialized = serde_json::to_string(&proxy_sign)
-            .map_err(|e| request_failed_error(&request, Web3RpcError::Internal(e.to_string())))?;
+            .map_err(|e| request_failed_error(info, Web3RpcError::Internal(e.to_string())))?;
 
         req.headers_mut()
             .insert(X_AUTH_PAYLOAD, proxy_sign_serialized.parse().unwrap());
     }
 
     let timeout = Timer::sleep(REQUEST_TIMEOUT_S);
-    let req = Box::pin(slurp_req(req));
+    let req = Box::pin(slurp_req_pooled(req, &transport.metrics));
     let rc = select(req, timeout).await;
     let res = match rc {
         Either::Left((r, _t)) => r,
         Either::Right((_t, _r)) => {
-            let (method, id) = match &request {
-                Call::MethodCall(m) => (m.method.clone(), m.id.clone()),
-                Call::Notification(n) => (n.method.clone(), jsonrpc_core::Id::Null),
-                Call::Invalid { id } => ("Invalid call".to_string(), id.clone()),
-            };
             let error = format!(
-                "Error requesting '{}': {}s timeout expired, method: '{}', id: {:?}",
-                transport.node.uri, REQUEST_TIMEOUT_S, method, id
+                "Error requesting '{}': {}s timeout expired, {}",
+                transport.node.uri, REQUEST_TIMEOUT_S, info
             );
             warn!("{}", error);
-            return Err(request_failed_error(&request, Web3RpcError::Transport(error)));
+            return Err(request_failed_error(info, Web3RpcError::Transport(error)));
         },
     };
 
     let (status, _headers, body) = match res {
         Ok(r) => r,
         Err(err) => {
-            return Err(request_failed_error(&request, Web3RpcError::Transport(err.to_string())));
+            return Err(request_failed_error(info, Web3RpcError::Transport(err.to_string())));
         },
     };
 
@@ -160,7 +281,7 @@ async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, E
 
     if !status.is_success() {
         return Err(request_failed_error(
-            &request,
+            info,
             Web3RpcError::Transport(format!(
                 "Server: '{}', response !200: {}, {}",
                 transport.node.uri,
@@ -170,22 +291,17 @@ async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, E
         ));
     }
 
-    let res = match de_rpc_response(body, &transport.node.uri.to_string()) {
-        Ok(r) => r,
-        Err(err) => {
-            return Err(request_failed_error(
-                &request,
-                Web3RpcError::InvalidResponse(format!("Server: '{}', error: {}", transport.node.uri, err)),
-            ));
-        },
-    };
-
-    Ok(res)
+    Ok(body)
 }
 
+/// Posts the serialized `request` and returns the response body.
 #[cfg(target_arch = "wasm32")]
-async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, Error> {
-    let serialized_request = to_string(&request);
+async fn post_request<R: Serialize>(
+    request: &R,
+    info: &RequestInfo<'_>,
+    transport: &HttpTransport,
+) -> Result<Vec<u8>, Error> {
+    let serialized_request = to_string(request);
     let request_bytes = serialized_request.as_bytes();
 
     let proxy_sign_header = if let Some(proxy_sign_keypair) = &transport.proxy_sign_keypair {
@@ -195,10 +311,10 @@ async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, E
             request_bytes.len(),
             common::PROXY_REQUEST_EXPIRATION_SEC,
         )
-        .map_err(|e| request_failed_error(&request, Web3RpcError::Internal(e.to_string())))?;
+        .map_err(|e| request_failed_error(info, Web3RpcError::Internal(e.to_string())))?;
 
         let proxy_sign_serialized = serde_json::to_string(&proxy_sign)
-            .map_err(|e| request_failed_error(&request, Web3RpcError::Internal(e.to_string())))?;
+            .map_err(|e| request_failed_error(info, Web3RpcError::Internal(e.to_string())))?;
 
         Some(proxy_sign_serialized)
     } else {
@@ -213,13 +329,13 @@ async fn send_request(request: Call, transport: HttpTransport) -> Result<Json, E
     )
     .await
     {
-        Ok(response_json) => Ok(response_json),
+        Ok(response) => Ok(response.into_bytes()),
         Err(Error::Transport(e)) => Err(request_failed_error(
-            &request,
+            info,
             Web3RpcError::Transport(format!("Server: '{}', error: {}", transport.node.uri, e)),
         )),
         Err(e) => Err(request_failed_error(
-            &request,
+            info,
             Web3RpcError::InvalidResponse(format!("Server: '{}', error: {}", transport.node.uri, e)),
         )),
     }
@@ -231,7 +347,7 @@ async fn send_request_once(
     uri: &http::Uri,
     event_handlers: &Vec<RpcTransportEventHandlerShared>,
     proxy_sign_header: Option<String>,
-) -> Result<Json, Error> {
+) -> Result<String, Error> {
     use http::header::ACCEPT;
     use mm2_net::wasm::http::FetchRequest;
 
@@ -263,19 +379,13 @@ async fn send_request_once(
     // account for incoming traffic
     event_handlers.on_incoming_response(response_str.as_bytes());
 
-    let response: Response = serde_json::from_str(&response_str).map_err(|e| {
-        Error::InvalidResponse(format!(
-            "Error deserializing response: {}, raw response: {:?}",
-            e, response_str
-        ))
-    })?;
-    match response {
-        Response::Single(output) => to_result_from_output(output),
-        Response::Batch(_) => Err(Error::InvalidResponse("Expected single, got batch.".to_owned())),
-    }
+    Ok(response_str)
 }
 
-fn request_failed_error(request: &Call, error: Web3RpcError) -> Error {
-    let error = format!("request {:?} failed: {}", request, error);
+fn request_failed_error(request: &RequestInfo<'_>, error: Web3RpcError) -> Error {
+    let error = match request {
+        RequestInfo::Single(call) => format!("request {:?} failed: {}", call, error),
+        RequestInfo::Batch(calls) => format!("batch request {:?} failed: {}", calls, error),
+    };
     Error::Transport(TransportError::Message(error))
 }
@@ -1,11 +1,12 @@
 use ethereum_types::U256;
-use futures::future::BoxFuture;
+use futures::future::{join_all, BoxFuture};
 use jsonrpc_core::Call;
 #[cfg(target_arch = "wasm32")] use mm2_metamask::MetamaskResult;
+use mm2_metrics::MetricsWeak;
 use serde_json::Value as Json;
 use serde_json::Value;
 use std::sync::atomic::Ordering;
-use web3::{Error, RequestId, Transport};
+use web3::{BatchTransport, Error, RequestId, Transport};
 
 use crate::RpcTransportEventHandlerShared;
 
@@ -14,6 +15,7 @@ pub(crate) mod http_transport;
 pub(crate) mod websocket_transport;
 
 pub(crate) type Web3SendOut = BoxFuture<'static, Result<Json, Error>>;
+pub(crate) type Web3BatchSendOut = BoxFuture<'static, Result<Vec<Result<Json, Error>>, Error>>;
 
 /// The transport layer for interacting with a Web3 provider.
 #[derive(Clone, Debug)]
@@ -28,8 +30,9 @@ impl Web3Transport {
     pub fn new_http_with_event_handlers(
         node: http_transport::HttpTransportNode,
         event_handlers: Vec<RpcTransportEventHandlerShared>,
+        metrics: MetricsWeak,
     ) -> Web3Transport {
-        http_transport::HttpTransport::with_event_handlers(node, event_handlers).into()
+        http_transport::HttpTransport::with_event_handlers(node, event_handlers, metrics).into()
     }
 
     #[cfg(target_arch = "wasm32")]
@@ -96,6 +99,33 @@ impl Transport for Web3Transport {
     }
 }
 
+impl BatchTransport for Web3Transport {
+    type Batch = Web3BatchSendOut;
+
+    /// Sends the `requests` as a single JSON-RPC batch over HTTP.
+    /// The websocket transport multiplexes the requests over one connection anyway and MetaMask has no batch API,
+    /// so the requests are sent concurrently one by one there.
+    fn send_batch<T>(&self, requests: T) -> Self::Batch
+    where
+        T: IntoIterator<Item = (RequestId, Call)>,
+    {
+        let selfi = self.clone();
+        let requests: Vec<_> = requests.into_iter().collect();
+        let fut = async move {
+            let result = match &selfi {
+                Web3Transport::Http(http) => http.send_batch(requests).await,
+                _ => Ok(join_all(requests.into_iter().map(|(id, request)| selfi.send(id, request))).await),
+            };
+
+            selfi.set_last_request_failed(result.is_err());
+
+            result
+        };
+
+        Box::pin(fut)
+    }
+}
+
 impl From<http_transport::HttpTransport> for Web3Transport {
     fn from(http: http_transport::HttpTransport) -> Self { Web3Transport::Http(http) }
 }
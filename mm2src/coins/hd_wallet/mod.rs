@@ -64,6 +64,8 @@ pub(crate) type HDCoinHDAccount<T> = HDWalletHDAccount<<T as HDWalletCoinOps>::H
 type HDWalletHDAccount<T> = <T as HDWalletOps>::HDAccount;
 
 pub(crate) const DEFAULT_GAP_LIMIT: u32 = 20;
+/// The maximum number of the addresses derived and checked at once on scanning for new addresses.
+pub(crate) const MAX_SCAN_WINDOW_LEN: u32 = 100;
 const DEFAULT_ACCOUNT_LIMIT: u32 = ChildNumber::HARDENED_FLAG;
 const DEFAULT_ADDRESS_LIMIT: u32 = ChildNumber::HARDENED_FLAG;
 const DEFAULT_RECEIVER_CHAIN: Bip44Chain = Bip44Chain::External;
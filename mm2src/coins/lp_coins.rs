@@ -55,6 +55,7 @@ use derive_more::Display;
 use enum_derives::{EnumFromStringify, EnumFromTrait};
 use ethereum_types::{H256, H264, H520, U256};
 use futures::compat::Future01CompatExt;
+use futures::future::try_join_all;
 use futures::lock::{Mutex as AsyncMutex, MutexGuard as AsyncMutexGuard};
 use futures::{FutureExt, TryFutureExt};
 use futures01::Future;
@@ -208,9 +209,10 @@ macro_rules! ok_or_continue_after_sleep {
 }
 
 pub mod coin_balance;
-use coin_balance::{AddressBalanceStatus, HDAddressBalance, HDWalletBalanceOps};
+use coin_balance::{HDAddressBalance, HDAddressBalanceScanner, HDWalletBalanceOps};
 
 pub mod lp_price;
+pub mod rpc_cache;
 pub mod watcher_common;
 
 pub mod coin_errors;
@@ -227,7 +229,8 @@ use eth::{eth_coin_from_conf_and_request, get_eth_address, EthCoin, EthGasDetail
 pub mod hd_wallet;
 use hd_wallet::{AccountUpdatingError, AddressDerivingError, HDAccountOps, HDAddressId, HDAddressOps,
                 HDAddressSelector, HDCoinAddress, HDCoinHDAccount, HDExtractPubkeyError, HDPathAccountToAddressId,
-                HDWalletAddress, HDWalletCoinOps, HDWalletOps, HDWithdrawError, HDXPubExtractor, WithdrawSenderAddress};
+                HDWalletAddress, HDWalletCoinOps, HDWalletOps, HDWithdrawError, HDXPubExtractor,
+                WithdrawSenderAddress, MAX_SCAN_WINDOW_LEN};
 
 #[cfg(not(target_arch = "wasm32"))] pub mod lightning;
 #[cfg_attr(target_arch = "wasm32", allow(dead_code, unused_imports))]
@@ -4687,6 +4690,9 @@ pub trait RpcTransportEventHandler {
     fn on_connected(&self, address: &str) -> Result<(), String>;
 
     fn on_disconnected(&self, address: &str) -> Result<(), String>;
+
+    /// Called when a response to the RPC `method` is received after `elapsed` since the request was sent.
+    fn on_request_finished(&self, _method: &str, _elapsed: Duration) {}
 }
 
 pub type SharableRpcTransportEventHandler = dyn RpcTransportEventHandler + Send + Sync;
@@ -4706,6 +4712,10 @@ impl RpcTransportEventHandler for RpcTransportEventHandlerShared {
     fn on_connected(&self, address: &str) -> Result<(), String> { self.as_ref().on_connected(address) }
 
     fn on_disconnected(&self, address: &str) -> Result<(), String> { self.as_ref().on_disconnected(address) }
+
+    fn on_request_finished(&self, method: &str, elapsed: Duration) {
+        self.as_ref().on_request_finished(method, elapsed)
+    }
 }
 
 impl RpcTransportEventHandler for Box<SharableRpcTransportEventHandler> {
@@ -4718,6 +4728,10 @@ impl RpcTransportEventHandler for Box<SharableRpcTransportEventHandler> {
     fn on_connected(&self, address: &str) -> Result<(), String> { self.as_ref().on_connected(address) }
 
     fn on_disconnected(&self, address: &str) -> Result<(), String> { self.as_ref().on_disconnected(address) }
+
+    fn on_request_finished(&self, method: &str, elapsed: Duration) {
+        self.as_ref().on_request_finished(method, elapsed)
+    }
 }
 
 impl<T: RpcTransportEventHandler> RpcTransportEventHandler for Vec<T> {
@@ -4738,6 +4752,12 @@ impl<T: RpcTransportEventHandler> RpcTransportEventHandler for Vec<T> {
         }
     }
 
+    fn on_request_finished(&self, method: &str, elapsed: Duration) {
+        for handler in self {
+            handler.on_request_finished(method, elapsed)
+        }
+    }
+
     fn on_connected(&self, address: &str) -> Result<(), String> {
         let mut errors = vec![];
         for handler in self {
@@ -4823,6 +4843,11 @@ impl RpcTransportEventHandler for CoinTransportMetrics {
     fn on_connected(&self, _address: &str) -> Result<(), String> { Ok(()) }
 
     fn on_disconnected(&self, _address: &str) -> Result<(), String> { Ok(()) }
+
+    fn on_request_finished(&self, method: &str, elapsed: Duration) {
+        mm_timing!(self.metrics, "rpc_client.request.duration", elapsed,
+            "coin" => self.ticker.to_owned(), "client" => self.client.to_owned(), "method" => method.to_owned());
+    }
 }
 
 #[async_trait]
@@ -5926,10 +5951,38 @@ pub async fn scan_for_new_addresses_impl<T>(
     chain: Bip44Chain,
     gap_limit: u32,
 ) -> BalanceResult<Vec<HDAddressBalance<HDWalletBalanceObject<T>>>>
+where
+    T: HDWalletBalanceOps + Sync,
+{
+    let (balances, known_addresses_number) =
+        scan_chain_for_new_addresses(coin, hd_account, address_scanner, chain, gap_limit).await?;
+    coin.set_known_addresses_number(hd_wallet, hd_account, chain, known_addresses_number)
+        .await?;
+    Ok(balances)
+}
+
+/// Checks the new addresses of the `chain` as [`scan_for_new_addresses_impl`] does, but doesn't update
+/// the number of known addresses of the `hd_account`, so that the chains of an account can be scanned concurrently.
+///
+/// The addresses are checked by windows of the addresses that would be checked anyway before finding
+/// `gap_limit` consecutive empty addresses, so the same addresses are checked as if they were checked one by one.
+/// Every window is derived at once, checked by [`HDAddressBalanceScanner::are_addresses_used`],
+/// and the balances of its used addresses are requested concurrently.
+///
+/// Returns the balances of the new addresses and the new number of known addresses.
+pub async fn scan_chain_for_new_addresses<T>(
+    coin: &T,
+    hd_account: &HDCoinHDAccount<T>,
+    address_scanner: &T::HDAddressScanner,
+    chain: Bip44Chain,
+    gap_limit: u32,
+) -> BalanceResult<(Vec<HDAddressBalance<HDWalletBalanceObject<T>>>, u32)>
 where
     T: HDWalletBalanceOps + Sync,
 {
     let mut balances = Vec::with_capacity(gap_limit as usize);
+    // The empty addresses checked since the last non-empty one.
+    let mut unused_addresses = Vec::new();
 
     // Get the first unknown address id.
     let mut checking_address_id = hd_account
@@ -5937,59 +5990,77 @@ where
         // A UTXO coin should support both [`Bip44Chain::External`] and [`Bip44Chain::Internal`].
         .mm_err(|e| BalanceError::Internal(e.to_string()))?;
 
-    let mut unused_addresses_counter = 0;
     let max_addresses_number = hd_account.address_limit();
-    while checking_address_id < max_addresses_number && unused_addresses_counter <= gap_limit {
-        let hd_address = coin.derive_address(hd_account, chain, checking_address_id).await?;
-        let checking_address = hd_address.address();
-        let checking_address_der_path = hd_address.derivation_path();
+    while checking_address_id < max_addresses_number && unused_addresses.len() as u32 <= gap_limit {
+        let window_len = scan_window_len(
+            gap_limit,
+            unused_addresses.len() as u32,
+            checking_address_id,
+            max_addresses_number,
+        );
+        let window_ids =
+            (checking_address_id..checking_address_id + window_len).map(|address_id| HDAddressId { chain, address_id });
+        let window = coin.derive_addresses(hd_account, window_ids).await?;
+
+        let window_addresses: Vec<_> = window.iter().map(|hd_address| hd_address.address()).collect();
+        let used = address_scanner.are_addresses_used(&window_addresses).await?;
+        let used_balances = window_addresses
+            .iter()
+            .zip(used.iter())
+            .filter(|(_, is_used)| **is_used)
+            .map(|(address, _)| coin.known_address_balance(address));
+        let mut used_balances = try_join_all(used_balances).await?.into_iter();
+
+        for (hd_address, is_used) in window.into_iter().zip(used) {
+            if !is_used {
+                unused_addresses.push(hd_address);
+                continue;
+            }
 
-        match coin.is_address_used(&checking_address, address_scanner).await? {
             // We found a non-empty address, so we have to fill up the balance list
-            // with zeros starting from `last_non_empty_address_id = checking_address_id - unused_addresses_counter`.
-            AddressBalanceStatus::Used(non_empty_balance) => {
-                let last_non_empty_address_id = checking_address_id - unused_addresses_counter;
-
-                // First, derive all empty addresses and put it into `balances` with default balance.
-                let address_ids = (last_non_empty_address_id..checking_address_id)
-                    .map(|address_id| HDAddressId { chain, address_id });
-                let empty_addresses =
-                    coin.derive_addresses(hd_account, address_ids)
-                        .await?
-                        .into_iter()
-                        .map(|empty_address| HDAddressBalance {
-                            address: empty_address.address().display_address(),
-                            derivation_path: RpcDerivationPath(empty_address.derivation_path().clone()),
-                            chain,
-                            balance: HDWalletBalanceObject::<T>::new(),
-                        });
-                balances.extend(empty_addresses);
-
-                // Then push this non-empty address.
-                balances.push(HDAddressBalance {
-                    address: checking_address.display_address(),
-                    derivation_path: RpcDerivationPath(checking_address_der_path.clone()),
-                    chain,
-                    balance: non_empty_balance,
-                });
-                // Reset the counter of unused addresses to zero since we found a non-empty address.
-                unused_addresses_counter = 0;
-            },
-            AddressBalanceStatus::NotUsed => unused_addresses_counter += 1,
+            // with the empty addresses checked since the last non-empty one.
+            let empty_addresses = unused_addresses.drain(..).map(|empty_address| HDAddressBalance {
+                address: empty_address.address().display_address(),
+                derivation_path: RpcDerivationPath(empty_address.derivation_path().clone()),
+                chain,
+                balance: HDWalletBalanceObject::<T>::new(),
+            });
+            balances.extend(empty_addresses);
+
+            // Then push this non-empty address.
+            let non_empty_balance = used_balances
+                .next()
+                .or_mm_err(|| BalanceError::Internal("There must be a balance for every used address".to_owned()))?;
+            balances.push(HDAddressBalance {
+                address: hd_address.address().display_address(),
+                derivation_path: RpcDerivationPath(hd_address.derivation_path().clone()),
+                chain,
+                balance: non_empty_balance,
+            });
         }
 
-        checking_address_id += 1;
+        checking_address_id += window_len;
     }
 
-    coin.set_known_addresses_number(
-        hd_wallet,
-        hd_account,
-        chain,
-        checking_address_id - unused_addresses_counter,
-    )
-    .await?;
+    Ok((balances, checking_address_id - unused_addresses.len() as u32))
+}
 
-    Ok(balances)
+/// Returns the number of the addresses to check next on scanning for new addresses,
+/// given the number of the empty addresses checked since the last non-empty one.
+/// These addresses would be checked anyway before finding `gap_limit` consecutive empty addresses,
+/// but at most [`MAX_SCAN_WINDOW_LEN`] of them are taken at once.
+///
+/// Expects `unused_addresses_number <= gap_limit` and `checking_address_id < max_addresses_number`.
+fn scan_window_len(
+    gap_limit: u32,
+    unused_addresses_number: u32,
+    checking_address_id: u32,
+    max_addresses_number: u32,
+) -> u32 {
+    (gap_limit - unused_addresses_number)
+        .saturating_add(1)
+        .min(MAX_SCAN_WINDOW_LEN)
+        .min(max_addresses_number - checking_address_id)
 }
 
 #[cfg(test)]
@@ -5999,6 +6070,30 @@ mod tests {
     use mm2_test_helpers::for_tests::RICK;
     use mocktopus::mocking::{MockResult, Mockable};
 
+    #[test]
+    fn test_scan_window_len() {
+        const LIMIT: u32 = 1000;
+        const MAX_LEN: u32 = MAX_SCAN_WINDOW_LEN;
+
+        // A full window holds the addresses up to the `gap_limit + 1`th consecutive empty one.
+        assert_eq!(scan_window_len(20, 0, 0, LIMIT), 21);
+        assert_eq!(scan_window_len(20, 15, 40, LIMIT), 6);
+        assert_eq!(scan_window_len(20, 20, 40, LIMIT), 1);
+        assert_eq!(scan_window_len(0, 0, 0, LIMIT), 1);
+
+        // The windows are capped by `MAX_SCAN_WINDOW_LEN` if `gap_limit` is larger.
+        let gap_limit = MAX_LEN + 50;
+        assert_eq!(scan_window_len(gap_limit, 0, 0, LIMIT), MAX_LEN);
+        assert_eq!(scan_window_len(gap_limit, MAX_LEN, MAX_LEN, LIMIT), 51);
+        assert_eq!(scan_window_len(gap_limit, 49, 200, LIMIT), MAX_LEN);
+        assert_eq!(scan_window_len(gap_limit, MAX_LEN - 10, 300, LIMIT), 61);
+        assert_eq!(scan_window_len(u32::MAX, 0, 0, LIMIT), MAX_LEN);
+
+        // The windows don't exceed the address limit.
+        assert_eq!(scan_window_len(20, 0, LIMIT - 5, LIMIT), 5);
+        assert_eq!(scan_window_len(gap_limit, 0, LIMIT - 1, LIMIT), 1);
+    }
+
     #[test]
     fn test_lp_coinfind() {
         let ctx = mm2_core::mm_ctx::MmCtxBuilder::default().into_mm_arc();
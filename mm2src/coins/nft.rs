@@ -89,12 +89,15 @@ pub type WithdrawNftResult = Result<TransactionNftDetails, MmError<WithdrawError
 pub async fn get_nft_list(ctx: MmArc, req: NftListReq) -> MmResult<NftList, GetNftInfoError> {
     let nft_ctx = NftCtx::from_ctx(&ctx).map_to_mm(GetNftInfoError::Internal)?;
 
-    let storage = nft_ctx.lock_db().await?;
-    for chain in req.chains.iter() {
-        if !NftListStorageOps::is_initialized(&storage, chain).await? {
-            NftListStorageOps::init(&storage, chain).await?;
+    {
+        let storage = nft_ctx.lock_db().await?;
+        for chain in req.chains.iter() {
+            if !NftListStorageOps::is_initialized(&storage, chain).await? {
+                NftListStorageOps::init(&storage, chain).await?;
+            }
         }
     }
+    let storage = nft_ctx.read_db().await?;
     let mut nft_list = storage
         .get_nft_list(req.chains, req.max, req.limit, req.page_number, req.filters)
         .await?;
@@ -114,10 +117,13 @@ pub async fn get_nft_list(ctx: MmArc, req: NftListReq) -> MmResult<NftList, GetN
 pub async fn get_nft_metadata(ctx: MmArc, req: NftMetadataReq) -> MmResult<Nft, GetNftInfoError> {
     let nft_ctx = NftCtx::from_ctx(&ctx).map_to_mm(GetNftInfoError::Internal)?;
 
-    let storage = nft_ctx.lock_db().await?;
-    if !NftListStorageOps::is_initialized(&storage, &req.chain).await? {
-        NftListStorageOps::init(&storage, &req.chain).await?;
+    {
+        let storage = nft_ctx.lock_db().await?;
+        if !NftListStorageOps::is_initialized(&storage, &req.chain).await? {
+            NftListStorageOps::init(&storage, &req.chain).await?;
+        }
     }
+    let storage = nft_ctx.read_db().await?;
     let mut nft = storage
         .get_nft(&req.chain, format!("{:#02x}", req.token_address), req.token_id.clone())
         .await?
@@ -154,15 +160,18 @@ pub async fn get_nft_metadata(ctx: MmArc, req: NftMetadataReq) -> MmResult<Nft,
 pub async fn get_nft_transfers(ctx: MmArc, req: NftTransfersReq) -> MmResult<NftsTransferHistoryList, GetNftInfoError> {
     let nft_ctx = NftCtx::from_ctx(&ctx).map_to_mm(GetNftInfoError::Internal)?;
 
-    let storage = nft_ctx.lock_db().await?;
-    for chain in req.chains.iter() {
-        if !NftTransferHistoryStorageOps::is_initialized(&storage, chain).await? {
-            NftTransferHistoryStorageOps::init(&storage, chain).await?;
-        } else {
-            #[cfg(not(target_arch = "wasm32"))]
-            NftMigrationOps::migrate_tx_history_if_needed(&storage, chain).await?;
+    {
+        let storage = nft_ctx.lock_db().await?;
+        for chain in req.chains.iter() {
+            if !NftTransferHistoryStorageOps::is_initialized(&storage, chain).await? {
+                NftTransferHistoryStorageOps::init(&storage, chain).await?;
+            } else {
+                #[cfg(not(target_arch = "wasm32"))]
+                NftMigrationOps::migrate_tx_history_if_needed(&storage, chain).await?;
+            }
         }
     }
+    let storage = nft_ctx.read_db().await?;
     let mut transfer_history_list = storage
         .get_transfer_history(req.chains.clone(), req.max, req.limit, req.page_number, req.filters)
         .await?;
@@ -725,6 +725,9 @@ pub(crate) struct NftCtx {
     pub(crate) nft_cache_db: SharedDb<NftCacheIDB>,
     #[cfg(not(target_arch = "wasm32"))]
     pub(crate) nft_cache_db: Arc<AsyncMutex<AsyncConnection>>,
+    /// The handle to `nft_cache_db` the read-only operations are done with, see [`NftCtx::read_db`].
+    #[cfg(not(target_arch = "wasm32"))]
+    nft_cache_reader: AsyncConnection,
 }
 
 impl NftCtx {
@@ -738,8 +741,13 @@ impl NftCtx {
                 .async_sqlite_connection
                 .get()
                 .ok_or("async_sqlite_connection is not initialized".to_owned())?;
+            let async_sqlite_reader = ctx
+                .async_sqlite_reader
+                .get()
+                .ok_or("async_sqlite_reader is not initialized".to_owned())?;
             Ok(NftCtx {
                 nft_cache_db: async_sqlite_connection.clone(),
+                nft_cache_reader: async_sqlite_reader.clone(),
             })
         })
     }
@@ -771,6 +779,23 @@ impl NftCtx {
             .mm_err(WasmNftCacheError::from)
             .mm_err(LockDBError::from)
     }
+
+    /// Returns the database for the read-only NFT operations, which don't need to wait for the locked ones.
+    /// The tables are expected to be initialized with [`NftCtx::lock_db`] beforehand.
+    #[cfg(not(target_arch = "wasm32"))]
+    pub(crate) async fn read_db(
+        &self,
+    ) -> MmResult<impl NftListStorageOps + NftTransferHistoryStorageOps + '_, LockDBError> {
+        Ok(&self.nft_cache_reader)
+    }
+
+    /// IndexedDB transactions are isolated already, so the reads lock the database the same way.
+    #[cfg(target_arch = "wasm32")]
+    pub(crate) async fn read_db(
+        &self,
+    ) -> MmResult<impl NftListStorageOps + NftTransferHistoryStorageOps + '_, LockDBError> {
+        self.lock_db().await
+    }
 }
 
 #[derive(Debug, Serialize)]
@@ -222,6 +222,26 @@ cross_test!(test_nft_list, {
     assert_eq!(nft_list.total, 4);
 });
 
+#[cfg(not(target_arch = "wasm32"))]
+#[tokio::test(flavor = "multi_thread")]
+async fn test_read_nfts_while_db_locked() {
+    let chain = Chain::Bsc;
+    let nft_ctx = get_nft_ctx(&chain).await;
+    let storage = nft_ctx.lock_db().await.unwrap();
+    NftListStorageOps::init(&storage, &chain).await.unwrap();
+    let nft_list = nft_list();
+    storage.add_nfts_to_list(chain, nft_list, 28056726).await.unwrap();
+
+    // The database stays locked, e.g. by a long `update_nft`, but the reads don't wait for it.
+    let reader = nft_ctx.read_db().await.unwrap();
+    let nft_list = reader.get_nft_list(vec![chain], true, 1, None, None).await.unwrap();
+    assert_eq!(nft_list.total, 4);
+    let token_id = BigUint::from_str(TOKEN_ID).unwrap();
+    let nft = reader.get_nft(&chain, TOKEN_ADD.to_string(), token_id).await.unwrap();
+    assert!(nft.is_some());
+    drop(storage);
+}
+
 cross_test!(test_remove_nft, {
     let chain = Chain::Bsc;
     let nft_ctx = get_nft_ctx(&chain).await;
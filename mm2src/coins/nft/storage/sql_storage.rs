@@ -12,7 +12,6 @@ use db_common::sqlite::rusqlite::{Connection, Error as SqlError, Result as SqlRe
 use db_common::sqlite::sql_builder::SqlBuilder;
 use db_common::sqlite::{query_single_row, string_from_row, SafeTableName, CHECK_TABLE_EXISTS_SQL};
 use ethereum_types::Address;
-use futures::lock::MutexGuard as AsyncMutexGuard;
 use mm2_err_handle::prelude::*;
 use mm2_number::{BigDecimal, BigUint};
 use serde_json::Value as Json;
@@ -20,6 +19,7 @@ use serde_json::{self as json};
 use std::collections::HashSet;
 use std::convert::TryInto;
 use std::num::NonZeroUsize;
+use std::ops::Deref;
 use std::str::FromStr;
 
 const CURRENT_SCHEMA_VERSION_TX_HISTORY: i32 = 2;
@@ -600,8 +600,13 @@ fn is_table_empty(conn: &Connection, safe_table_name: SafeTableName) -> Result<b
         .map(|count| count == 0)
 }
 
+/// Implemented for the locked connection and for the reader handle of [`crate::nft::nft_structs::NftCtx`] alike,
+/// the writes are to be done with the locked one.
 #[async_trait]
-impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
+impl<Conn> NftListStorageOps for Conn
+where
+    Conn: Deref<Target = AsyncConnection> + Send + Sync,
+{
     type Error = AsyncConnError;
 
     async fn init(&self, chain: &Chain) -> MmResult<(), Self::Error> {
@@ -617,7 +622,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
 
     async fn is_initialized(&self, chain: &Chain) -> MmResult<bool, Self::Error> {
         let table_name = chain.nft_list_table_name()?;
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let nft_list_initialized =
                 query_single_row(conn, CHECK_TABLE_EXISTS_SQL, [table_name.inner()], string_from_row)?;
             let scanned_nft_blocks_initialized = query_single_row(
@@ -640,7 +645,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         page_number: Option<NonZeroUsize>,
         filters: Option<NftListFilters>,
     ) -> MmResult<NftList, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let sql_builder = get_nft_list_builder_preimage(chains, filters)?;
             let total_count_builder_sql = sql_builder
                 .clone()
@@ -732,7 +737,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         token_id: BigUint,
     ) -> MmResult<Option<Nft>, Self::Error> {
         let table_name = chain.nft_list_table_name()?;
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let sql = format!(
                 "SELECT * FROM {} WHERE token_address=?1 AND token_id=?2",
                 table_name.inner()
@@ -785,7 +790,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
             table_name.inner()
         );
         let params = [token_address, token_id.to_string()];
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let amount = query_single_row(conn, &sql, params, nft_amount_from_row)?;
             Ok(amount)
         })
@@ -832,7 +837,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     async fn get_last_block_number(&self, chain: &Chain) -> MmResult<Option<u64>, Self::Error> {
         let table_name = chain.nft_list_table_name()?;
         let sql = select_last_block_number_sql(table_name);
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let block_number = query_single_row(conn, &sql, [], block_number_from_row)?;
             Ok(block_number)
         })
@@ -845,7 +850,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     async fn get_last_scanned_block(&self, chain: &Chain) -> MmResult<Option<u64>, Self::Error> {
         let sql = select_last_scanned_block_sql()?;
         let params = [chain.to_ticker()];
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let block_number = query_single_row(conn, &sql, params, block_number_from_row)?;
             Ok(block_number)
         })
@@ -903,7 +908,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     }
 
     async fn get_nfts_by_token_address(&self, chain: Chain, token_address: String) -> MmResult<Vec<Nft>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_name = chain.nft_list_table_name()?;
             let mut stmt = get_nfts_by_token_address_statement(conn, table_name)?;
             let nfts = stmt
@@ -939,7 +944,7 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
 
     async fn get_animation_external_domains(&self, chain: &Chain) -> MmResult<HashSet<String>, Self::Error> {
         let safe_table_name = chain.nft_list_table_name()?;
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_name = safe_table_name.inner();
             let sql_query = format!(
                 "SELECT DISTINCT animation_domain FROM {} UNION SELECT DISTINCT external_domain FROM {}",
@@ -1018,7 +1023,10 @@ impl NftListStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
 }
 
 #[async_trait]
-impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
+impl<Conn> NftTransferHistoryStorageOps for Conn
+where
+    Conn: Deref<Target = AsyncConnection> + Send + Sync,
+{
     type Error = AsyncConnError;
 
     async fn init(&self, chain: &Chain) -> MmResult<(), Self::Error> {
@@ -1040,7 +1048,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
 
     async fn is_initialized(&self, chain: &Chain) -> MmResult<bool, Self::Error> {
         let table = chain.transfer_history_table_name()?;
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_exists = query_single_row(conn, CHECK_TABLE_EXISTS_SQL, [table.inner()], string_from_row)?;
             Ok(table_exists.is_some())
         })
@@ -1056,7 +1064,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         page_number: Option<NonZeroUsize>,
         filters: Option<NftTransferHistoryFilters>,
     ) -> MmResult<NftsTransferHistoryList, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let sql_builder = get_nft_transfer_builder_preimage(chains, filters)?;
             let total_count_builder_sql = sql_builder
                 .clone()
@@ -1138,7 +1146,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     async fn get_last_block_number(&self, chain: &Chain) -> MmResult<Option<u64>, Self::Error> {
         let table_name = chain.transfer_history_table_name()?;
         let sql = select_last_block_number_sql(table_name);
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let block_number = query_single_row(conn, &sql, [], block_number_from_row)?;
             Ok(block_number)
         })
@@ -1153,7 +1161,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         chain: Chain,
         from_block: u64,
     ) -> MmResult<Vec<NftTransferHistory>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let mut stmt = get_transfers_from_block_statement(conn, &chain)?;
             let transfers = stmt
                 .query_map([from_block], transfer_history_from_row)?
@@ -1170,7 +1178,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         token_address: String,
         token_id: BigUint,
     ) -> MmResult<Vec<NftTransferHistory>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let mut stmt = get_transfers_by_token_addr_id_statement(conn, chain)?;
             let transfers = stmt
                 .query_map([token_address, token_id.to_string()], transfer_history_from_row)?
@@ -1193,7 +1201,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
             "SELECT * FROM {} WHERE transaction_hash=?1 AND log_index = ?2 AND token_id = ?3",
             table_name.inner()
         );
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let transfer = query_single_row(
                 conn,
                 &sql,
@@ -1243,7 +1251,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     }
 
     async fn get_transfers_with_empty_meta(&self, chain: Chain) -> MmResult<Vec<NftTokenAddrId>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let sql_builder = get_transfers_with_empty_meta_builder(conn, &chain)?;
             let token_addr_id_pair = sql_builder.query(token_address_id_from_row)?;
             Ok(token_addr_id_pair)
@@ -1257,7 +1265,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
         chain: Chain,
         token_address: String,
     ) -> MmResult<Vec<NftTransferHistory>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_name = chain.transfer_history_table_name()?;
             let mut stmt = get_nfts_by_token_address_statement(conn, table_name)?;
             let transfers = stmt
@@ -1292,7 +1300,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
     }
 
     async fn get_token_addresses(&self, chain: Chain) -> MmResult<HashSet<Address>, Self::Error> {
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_name = chain.transfer_history_table_name()?;
             let mut stmt = get_token_addresses_statement(conn, table_name)?;
             let addresses = stmt
@@ -1306,7 +1314,7 @@ impl NftTransferHistoryStorageOps for AsyncMutexGuard<'_, AsyncConnection> {
 
     async fn get_domains(&self, chain: &Chain) -> MmResult<HashSet<String>, Self::Error> {
         let safe_table_name = chain.transfer_history_table_name()?;
-        self.call(move |conn| {
+        self.call_read(move |conn| {
             let table_name = safe_table_name.inner();
             let sql_query = format!(
                 "SELECT DISTINCT token_domain FROM {} UNION SELECT DISTINCT image_domain FROM {}",
@@ -1445,7 +1453,10 @@ fn has_primary_key_duplication(conn: &Connection, safe_table_name: &SafeTableNam
 }
 
 #[async_trait]
-impl NftMigrationOps for AsyncMutexGuard<'_, AsyncConnection> {
+impl<Conn> NftMigrationOps for Conn
+where
+    Conn: Deref<Target = AsyncConnection> + Send + Sync,
+{
     type Error = AsyncConnError;
 
     async fn migrate_tx_history_if_needed(&self, chain: &Chain) -> MmResult<(), Self::Error> {
@@ -260,7 +260,7 @@ impl<'a> UtxoCoinBuilderCommonOps for Qrc20CoinBuilder<'a> {
     #[inline]
     #[cfg(not(target_arch = "wasm32"))]
     fn tx_cache(&self) -> UtxoVerboseCacheShared {
-        crate::utxo::tx_cache::fs_tx_cache::FsVerboseCache::new(self.platform.clone(), self.tx_cache_path())
+        crate::utxo::tx_cache::sqlite_tx_cache::SqliteVerboseCache::new(self.platform.clone(), self.tx_cache_path())
             .into_shared()
     }
 }
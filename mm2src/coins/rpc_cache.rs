@@ -0,0 +1,165 @@
+//! Time-bounded single-flight caches of the chain values that every swap and order validation requests.
+//!
+//! The block count, fee rates and gas prices are requested independently by the concurrent swaps and orders of a coin,
+//! while they only change with new blocks. A [`SingleFlightCache`] keeps the value for a TTL following the block
+//! interval, and lets the concurrent callers wanting the value share one request instead of sending their own ones.
+//! The value is also invalidated once the RPC client is notified about a new block, see [`SingleFlightCache::get_or_fetch`].
+
+use compatible_time::Instant;
+use futures::channel::oneshot;
+use mm2_metrics::MetricsWeak;
+use std::future::Future;
+use std::sync::Mutex;
+use std::time::Duration;
+
+/// The TTL is this part of the average block interval, so the cached values are rarely older than a block.
+const BLOCK_INTERVAL_TTL_DIVISOR: u64 = 10;
+const MIN_TTL: Duration = Duration::from_secs(1);
+const MAX_TTL: Duration = Duration::from_secs(60);
+
+/// Returns the TTL of the cached values of a coin mining a block every `avg_blocktime` seconds.
+pub fn ttl_from_block_interval(avg_blocktime: u64) -> Duration {
+    Duration::from_secs(avg_blocktime / BLOCK_INTERVAL_TTL_DIVISOR).clamp(MIN_TTL, MAX_TTL)
+}
+
+struct CacheState<V> {
+    /// The cached value, the chain generation it was requested at and when it was received.
+    value: Option<(V, u64, Instant)>,
+    in_flight: bool,
+    /// The callers waiting for the request in flight. They get `None` if the request fails.
+    waiters: Vec<oneshot::Sender<Option<V>>>,
+}
+
+pub struct SingleFlightCache<V> {
+    /// The name of the value used as the metrics label.
+    name: &'static str,
+    ticker: String,
+    ttl: Duration,
+    metrics: MetricsWeak,
+    state: Mutex<CacheState<V>>,
+}
+
+impl<V: Clone> SingleFlightCache<V> {
+    pub fn new(name: &'static str, ticker: String, ttl: Duration, metrics: MetricsWeak) -> SingleFlightCache<V> {
+        SingleFlightCache {
+            name,
+            ticker,
+            ttl,
+            metrics,
+            state: Mutex::new(CacheState {
+                value: None,
+                in_flight: false,
+                waiters: Vec::new(),
+            }),
+        }
+    }
+
+    /// Returns the cached value if it's younger than the TTL and was requested at the current chain `generation`,
+    /// i.e. no new block has been seen since then. Otherwise, requests it with `fetch`, or waits for the request
+    /// another caller has in flight.
+    ///
+    /// The errors aren't shared: if the request in flight fails, its waiters request the value themselves.
+    /// Pass the same `generation` all the time if the RPC client isn't notified about new blocks.
+    ///
+    /// The cache hits and misses are counted in the `rpc_cache.hit` and `rpc_cache.miss` metrics.
+    pub async fn get_or_fetch<F, Fut, E>(&self, generation: u64, fetch: F) -> Result<V, E>
+    where
+        F: FnOnce() -> Fut,
+        Fut: Future<Output = Result<V, E>>,
+    {
+        loop {
+            let waiter = {
+                let mut state = self.state.lock().unwrap();
+                if let Some((value, value_generation, received_at)) = &state.value {
+                    if *value_generation == generation && received_at.elapsed() < self.ttl {
+                        let value = value.clone();
+                        drop(state);
+                        self.count("rpc_cache.hit");
+                        return Ok(value);
+                    }
+                }
+                if !state.in_flight {
+                    state.in_flight = true;
+                    break;
+                }
+                let (tx, rx) = oneshot::channel();
+                state.waiters.push(tx);
+                rx
+            };
+            if let Ok(Some(value)) = waiter.await {
+                self.count("rpc_cache.hit");
+                return Ok(value);
+            }
+        }
+
+        self.count("rpc_cache.miss");
+        let mut in_flight = InFlightRequest {
+            cache: self,
+            generation,
+            value: None,
+        };
+        let value = fetch().await?;
+        in_flight.value = Some(value.clone());
+        Ok(value)
+    }
+
+    fn count(&self, metric: &'static str) {
+        mm_counter!(self.metrics, metric, 1, "coin" => self.ticker.clone(), "value" => self.name);
+    }
+}
+
+/// Completes the request in flight once it's dropped, so the waiters aren't left hanging if the request is cancelled.
+struct InFlightRequest<'a, V: Clone> {
+    cache: &'a SingleFlightCache<V>,
+    generation: u64,
+    value: Option<V>,
+}
+
+impl<'a, V: Clone> Drop for InFlightRequest<'a, V> {
+    fn drop(&mut self) {
+        let mut state = self.cache.state.lock().unwrap();
+        state.in_flight = false;
+        for waiter in state.waiters.drain(..) {
+            waiter.send(self.value.clone()).ok();
+        }
+        if let Some(value) = self.value.take() {
+            state.value = Some((value, self.generation, Instant::now()));
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::block_on;
+    use futures::future::join_all;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[test]
+    fn test_single_flight_cache() {
+        let cache = SingleFlightCache::new("value", "COIN".to_owned(), MAX_TTL, MetricsWeak::new());
+        let requests = &AtomicUsize::new(0);
+        let fetch = move || async move { Ok::<_, ()>(requests.fetch_add(1, Ordering::Relaxed) + 1) };
+
+        let values = block_on(join_all((0..10).map(|_| cache.get_or_fetch(0, fetch))));
+        assert!(values.iter().all(|value| *value == Ok(1)));
+        assert_eq!(requests.load(Ordering::Relaxed), 1);
+
+        // a new block
+        assert_eq!(block_on(cache.get_or_fetch(1, fetch)), Ok(2));
+        assert_eq!(block_on(cache.get_or_fetch(1, fetch)), Ok(2));
+
+        // the errors aren't cached
+        let cache = SingleFlightCache::<usize>::new("value", "COIN".to_owned(), MAX_TTL, MetricsWeak::new());
+        assert_eq!(block_on(cache.get_or_fetch(0, || async { Err("error") })), Err("error"));
+        assert_eq!(block_on(cache.get_or_fetch(0, || async { Ok::<_, &str>(1) })), Ok(1));
+    }
+
+    #[test]
+    fn test_ttl_from_block_interval() {
+        assert_eq!(ttl_from_block_interval(600), Duration::from_secs(60));
+        assert_eq!(ttl_from_block_interval(60), Duration::from_secs(6));
+        assert_eq!(ttl_from_block_interval(5), MIN_TTL);
+        assert_eq!(ttl_from_block_interval(6000), MAX_TTL);
+    }
+}
@@ -6,6 +6,7 @@ use cosmrs::tendermint::evidence::Evidence;
 use cosmrs::tendermint::Genesis;
 use cosmrs::tendermint::Hash;
 use http::Uri;
+use mm2_metrics::MetricsWeak;
 use mm2_p2p::Keypair;
 use serde::{de::DeserializeOwned, Serialize};
 use std::fmt;
@@ -293,18 +294,14 @@ pub struct HttpClient {
 
 impl HttpClient {
     /// Construct a new Tendermint RPC HTTP/S client connecting to the given
-    /// URL.
-    pub fn new<U>(url: U, proxy_sign_keypair: Option<Keypair>) -> Result<Self, Error>
+    /// URL. The pool metrics of the node are recorded to the `metrics`.
+    pub fn new<U>(url: U, proxy_sign_keypair: Option<Keypair>, metrics: MetricsWeak) -> Result<Self, Error>
     where
         U: TryInto<HttpClientUrl, Error = Error>,
     {
         let url = url.try_into()?;
         Ok(Self {
-            inner: if url.0.is_secure() {
-                sealed::HttpClient::new_https(url.try_into()?, proxy_sign_keypair)
-            } else {
-                sealed::HttpClient::new_http(url.try_into()?, proxy_sign_keypair)
-            },
+            inner: sealed::HttpClient::new(url.try_into()?, proxy_sign_keypair, metrics),
         })
     }
 
@@ -377,73 +374,63 @@ mod sealed {
     use common::log::debug;
     use common::X_AUTH_PAYLOAD;
     use http::HeaderValue;
-    use hyper::body::Buf;
-    use hyper::client::connect::Connect;
-    use hyper::client::HttpConnector;
     use hyper::{header, Uri};
-    use hyper_rustls::{HttpsConnector, HttpsConnectorBuilder};
+    use mm2_metrics::MetricsWeak;
+    use mm2_net::native_http::slurp_req_pooled;
     use mm2_p2p::Keypair;
     use proxy_signature::RawMessage;
-    use std::io::Read;
+    use std::fmt;
     use tendermint_rpc::{Error, Response, SimpleRequest};
 
-    fn https_connector() -> HttpsConnector<HttpConnector> {
-        HttpsConnectorBuilder::new()
-            .with_webpki_roots()
-            .https_or_http()
-            .enable_http1()
-            .enable_http2()
-            .build()
-    }
-
-    /// A wrapper for a `hyper`-based client, generic over the connector type.
-    #[derive(Debug, Clone)]
-    pub struct HyperClient<C> {
+    /// A client sending the requests over HTTP or HTTPS through the shared connection pool,
+    /// so the connections to the node are kept alive and multiplexed over HTTP/2 if the node supports it.
+    #[derive(Clone)]
+    pub struct HttpClient {
         uri: Uri,
-        inner: hyper::Client<C>,
         proxy_sign_keypair: Option<Keypair>,
+        metrics: MetricsWeak,
+    }
+
+    impl fmt::Debug for HttpClient {
+        fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+            f.debug_struct("HttpClient")
+                .field("uri", &self.uri)
+                .field("proxy_sign_keypair", &self.proxy_sign_keypair)
+                .finish()
+        }
     }
 
-    impl<C> HyperClient<C> {
-        pub fn new(uri: Uri, inner: hyper::Client<C>, proxy_sign_keypair: Option<Keypair>) -> Self {
-            Self {
+    impl HttpClient {
+        pub fn new(uri: Uri, proxy_sign_keypair: Option<Keypair>, metrics: MetricsWeak) -> Self {
+            HttpClient {
                 uri,
-                inner,
                 proxy_sign_keypair,
+                metrics,
             }
         }
-    }
 
-    impl<C> HyperClient<C>
-    where
-        C: Connect + Clone + Send + Sync + 'static,
-    {
         pub async fn perform<R>(&self, request: R) -> Result<R::Response, Error>
         where
             R: SimpleRequest,
         {
             let request = self.build_request(request)?;
-            let response = self
-                .inner
-                .request(request)
+            let (_status, _headers, body) = slurp_req_pooled(request, &self.metrics)
                 .await
                 .map_err(|e| Error::client_internal(e.to_string()))?;
-            let response_body = response_to_string(response).await?;
+            let response_body = String::from_utf8(body).map_err(|e| Error::client_internal(e.to_string()))?;
             debug!("Incoming response: {}", response_body);
             R::Response::from_string(&response_body)
         }
-    }
 
-    impl<C> HyperClient<C> {
         /// Build a request using the given Tendermint RPC request.
-        pub fn build_request<R: SimpleRequest>(&self, request: R) -> Result<hyper::Request<hyper::Body>, Error> {
+        pub fn build_request<R: SimpleRequest>(&self, request: R) -> Result<http::Request<Vec<u8>>, Error> {
             let body_bytes = request.into_json().into_bytes();
             let body_size = body_bytes.len();
 
-            let mut request = hyper::Request::builder()
+            let mut request = http::Request::builder()
                 .method("POST")
                 .uri(&self.uri)
-                .body(hyper::Body::from(body_bytes))
+                .body(body_bytes)
                 .map_err(|e| Error::client_internal(e.to_string()))?;
 
             {
@@ -476,66 +463,9 @@ mod sealed {
 
             Ok(request)
         }
-    }
-
-    /// We offer several variations of `hyper`-based client.
-    ///
-    /// Here we erase the type signature of the underlying `hyper`-based
-    /// client, allowing the higher-level HTTP client to operate via HTTP or
-    /// HTTPS, and with or without a proxy.
-    #[derive(Debug, Clone)]
-    pub enum HttpClient {
-        Http(HyperClient<HttpConnector>),
-        Https(HyperClient<HttpsConnector<HttpConnector>>),
-    }
 
-    impl HttpClient {
-        pub fn new_http(uri: Uri, proxy_sign_keypair: Option<Keypair>) -> Self {
-            Self::Http(HyperClient::new(uri, hyper::Client::new(), proxy_sign_keypair))
-        }
-
-        pub fn new_https(uri: Uri, proxy_sign_keypair: Option<Keypair>) -> Self {
-            Self::Https(HyperClient::new(
-                uri,
-                hyper::Client::builder().build(https_connector()),
-                proxy_sign_keypair,
-            ))
-        }
-
-        pub async fn perform<R>(&self, request: R) -> Result<R::Response, Error>
-        where
-            R: SimpleRequest,
-        {
-            match self {
-                HttpClient::Http(c) => c.perform(request).await,
-                HttpClient::Https(c) => c.perform(request).await,
-            }
-        }
-
-        pub fn uri(&self) -> Uri {
-            match self {
-                HttpClient::Http(client) => client.uri.clone(),
-                HttpClient::Https(client) => client.uri.clone(),
-            }
-        }
-
-        pub fn proxy_sign_keypair(&self) -> &Option<Keypair> {
-            match self {
-                HttpClient::Http(client) => &client.proxy_sign_keypair,
-                HttpClient::Https(client) => &client.proxy_sign_keypair,
-            }
-        }
-    }
-
-    async fn response_to_string(response: hyper::Response<hyper::Body>) -> Result<String, Error> {
-        let mut response_body = String::new();
-        hyper::body::aggregate(response.into_body())
-            .await
-            .map_err(|e| Error::client_internal(e.to_string()))?
-            .reader()
-            .read_to_string(&mut response_body)
-            .map_err(Error::io)?;
+        pub fn uri(&self) -> Uri { self.uri.clone() }
 
-        Ok(response_body)
+        pub fn proxy_sign_keypair(&self) -> &Option<Keypair> { &self.proxy_sign_keypair }
     }
 }
@@ -4,6 +4,7 @@ use derive_more::Display;
 use http::header::{ACCEPT, CONTENT_TYPE};
 use http::uri::InvalidUri;
 use http::{StatusCode, Uri};
+use mm2_metrics::MetricsWeak;
 use mm2_net::transport::SlurpError;
 use mm2_net::wasm::http::FetchRequest;
 use mm2_p2p::Keypair;
@@ -55,7 +56,12 @@ impl From<TendermintRpcError> for PerformError {
 }
 
 impl HttpClient {
-    pub(crate) fn new(url: &str, proxy_sign_keypair: Option<Keypair>) -> Result<Self, HttpClientInitError> {
+    /// The browser manages the connections itself, so the connection pool `metrics` are not recorded.
+    pub(crate) fn new(
+        url: &str,
+        proxy_sign_keypair: Option<Keypair>,
+        _metrics: MetricsWeak,
+    ) -> Result<Self, HttpClientInitError> {
         Uri::from_str(url)?;
         Ok(HttpClient {
             uri: url.to_owned(),
@@ -138,7 +144,7 @@ mod tests {
 
     #[wasm_bindgen_test]
     async fn test_get_abci_info() {
-        let client = HttpClient::new("http://34.80.202.172:26657", None).unwrap();
+        let client = HttpClient::new("http://34.80.202.172:26657", None, MetricsWeak::new()).unwrap();
         client.abci_info().await.unwrap();
     }
 }
@@ -3163,7 +3163,7 @@ fn clients_from_urls(ctx: &MmArc, nodes: Vec<RpcNode>) -> MmResult<Vec<HttpClien
     // keep all invalid urls in one vector to show all of them in error
     for node in nodes.iter() {
         let proxy_sign_keypair = if node.komodo_proxy { p2p_keypair.clone() } else { None };
-        match HttpClient::new(node.url.as_str(), proxy_sign_keypair) {
+        match HttpClient::new(node.url.as_str(), proxy_sign_keypair, ctx.metrics.weak()) {
             Ok(client) => clients.push(client),
             Err(e) => errors.push(format!("Url {} is invalid, got error {}", node.url, e)),
         }
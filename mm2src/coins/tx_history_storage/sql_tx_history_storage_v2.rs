@@ -7,13 +7,14 @@ use common::{async_blocking, PagingOptionsEnum};
 use db_common::sql_build::*;
 use db_common::sqlite::rusqlite::types::Type;
 use db_common::sqlite::rusqlite::{Connection, Error as SqlError, Row};
-use db_common::sqlite::{query_single_row, string_from_row, validate_table_name, CHECK_TABLE_EXISTS_SQL};
+use db_common::sqlite::{query_single_row, string_from_row, validate_table_name, SqliteReadPoolShared,
+                        CHECK_TABLE_EXISTS_SQL};
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
 use rpc::v1::types::Bytes as BytesJson;
 use serde_json::{self as json};
 use std::convert::TryInto;
-use std::sync::{Arc, Mutex};
+use std::sync::{Arc, Mutex, MutexGuard};
 
 fn tx_history_table(wallet_id: &WalletId) -> String { wallet_id.to_sql_table_name() + "_tx_history" }
 
@@ -372,7 +373,11 @@ impl WalletId {
 }
 
 #[derive(Clone)]
-pub struct SqliteTxHistoryStorage(Arc<Mutex<Connection>>);
+pub struct SqliteTxHistoryStorage {
+    conn: Arc<Mutex<Connection>>,
+    /// Serves the reads so they don't wait for the history writes. Not available for the in-memory databases.
+    read_pool: Option<SqliteReadPoolShared>,
+}
 
 impl SqliteTxHistoryStorage {
     pub fn new(ctx: &MmArc) -> Result<Self, MmError<CreateTxHistoryStorageError>> {
@@ -382,7 +387,17 @@ impl SqliteTxHistoryStorage {
                 .ok_or(MmError::new(CreateTxHistoryStorageError::Internal(
                     "sqlite_connection is not initialized".to_owned(),
                 )))?;
-        Ok(SqliteTxHistoryStorage(sqlite_connection.clone()))
+        Ok(SqliteTxHistoryStorage {
+            conn: sqlite_connection.clone(),
+            read_pool: ctx.sqlite_read_pool.get().cloned(),
+        })
+    }
+
+    fn read_conn(&self) -> MutexGuard<Connection> {
+        match self.read_pool {
+            Some(ref read_pool) => read_pool.conn(),
+            None => self.conn.lock().unwrap(),
+        }
     }
 }
 
@@ -401,7 +416,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let sql_addr_index = create_internal_id_index_sql(wallet_id, tx_address_table)?;
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.conn.lock().unwrap();
 
             conn.execute(&sql_history, []).map(|_| ())?;
             conn.execute(&sql_addr, []).map(|_| ())?;
@@ -423,7 +438,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
 
         let selfi = self.clone();
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
             let history_initialized =
                 query_single_row(&conn, CHECK_TABLE_EXISTS_SQL, [tx_history_table], string_from_row)?;
             let cache_initialized = query_single_row(&conn, CHECK_TABLE_EXISTS_SQL, [tx_cache_table], string_from_row)?;
@@ -444,8 +459,11 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
         let wallet_id = wallet_id.clone();
         async_blocking(move || {
-            let mut conn = selfi.0.lock().unwrap();
+            let mut conn = selfi.conn.lock().unwrap();
             let sql_transaction = conn.transaction()?;
+            let mut insert_tx_in_cache = sql_transaction.prepare_cached(&insert_tx_in_cache_sql(&wallet_id)?)?;
+            let mut insert_tx_in_history = sql_transaction.prepare_cached(&insert_tx_in_history_sql(&wallet_id)?)?;
+            let mut insert_tx_address = sql_transaction.prepare_cached(&insert_tx_address_sql(&wallet_id)?)?;
 
             for tx in transactions {
                 let Some(tx_hash) = tx.tx.tx_hash() else { continue };
@@ -461,7 +479,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
 
                 let tx_cache_params = [tx_hash, &tx_hex];
 
-                sql_transaction.execute(&insert_tx_in_cache_sql(&wallet_id)?, tx_cache_params)?;
+                insert_tx_in_cache.execute(tx_cache_params)?;
 
                 let params = [
                     tx_hash,
@@ -471,14 +489,15 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
                     &token_id,
                     &tx_json,
                 ];
-                sql_transaction.execute(&insert_tx_in_history_sql(&wallet_id)?, params)?;
+                insert_tx_in_history.execute(params)?;
 
                 let addresses: FilteringAddresses = tx.from.into_iter().chain(tx.to.into_iter()).collect();
                 for address in addresses {
                     let params = [internal_id.clone(), address];
-                    sql_transaction.execute(&insert_tx_address_sql(&wallet_id)?, params)?;
+                    insert_tx_address.execute(params)?;
                 }
             }
+            drop((insert_tx_in_cache, insert_tx_in_history, insert_tx_address));
             sql_transaction.commit()?;
             Ok(())
         })
@@ -497,7 +516,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let mut conn = selfi.0.lock().unwrap();
+            let mut conn = selfi.conn.lock().unwrap();
             let sql_transaction = conn.transaction()?;
 
             sql_transaction.execute(&remove_tx_addr_sql, params.clone())?;
@@ -525,7 +544,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
             query_single_row(&conn, &sql, params, tx_details_from_row).map_to_mm(SqlError::from)
         })
         .await
@@ -536,7 +555,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
             query_single_row(&conn, &sql, [], block_height_from_row).map_to_mm(SqlError::from)
         })
         .await
@@ -551,7 +570,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
             let sql_query = history_contains_unconfirmed_txes_preimage(&conn, &wallet_id, for_addresses)?;
 
             let count_unconfirmed: u32 = sql_query
@@ -571,7 +590,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
 
             let sql_query = get_unconfirmed_txes_builder_preimage(&conn, &wallet_id, for_addresses)?;
             let result = sql_query.query(tx_details_from_row)?;
@@ -601,8 +620,11 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
 
         let selfi = self.clone();
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
-            conn.execute(&sql, params).map(|_| ()).map_err(MmError::new)
+            let conn = selfi.conn.lock().unwrap();
+            conn.prepare_cached(&sql)?
+                .execute(params)
+                .map(|_| ())
+                .map_err(MmError::new)
         })
         .await
     }
@@ -613,8 +635,8 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
 
         let selfi = self.clone();
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
-            let count: u32 = conn.query_row(&sql, params, |row| row.get(0))?;
+            let conn = selfi.read_conn();
+            let count: u32 = conn.prepare_cached(&sql)?.query_row(params, |row| row.get(0))?;
             Ok(count > 0)
         })
         .await
@@ -629,7 +651,7 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let wallet_id = wallet_id.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            let conn = selfi.read_conn();
 
             let sql_query = count_unique_tx_hashes_preimage(&conn, &wallet_id, for_addresses)?;
             let count: u32 = sql_query
@@ -650,8 +672,8 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let params = [tx_hash.to_owned(), format!("{:02x}", tx_hex)];
         let selfi = self.clone();
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
-            conn.execute(&sql, params)?;
+            let conn = selfi.conn.lock().unwrap();
+            conn.prepare_cached(&sql)?.execute(params)?;
             Ok(())
         })
         .await
@@ -666,8 +688,8 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let params = [tx_hash.to_owned()];
         let selfi = self.clone();
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
-            let maybe_tx_hex: Result<String, _> = conn.query_row(&sql, params, |row| row.get(0));
+            let conn = selfi.read_conn();
+            let maybe_tx_hex: Result<String, _> = conn.prepare_cached(&sql)?.query_row(params, |row| row.get(0));
             if let Err(SqlError::QueryReturnedNoRows) = maybe_tx_hex {
                 return Ok(None);
             }
@@ -700,7 +722,9 @@ impl TxHistoryStorage for SqliteTxHistoryStorage {
         let selfi = self.clone();
 
         async_blocking(move || {
-            let conn = selfi.0.lock().unwrap();
+            // Count and list the transactions within one snapshot.
+            let mut conn = selfi.read_conn();
+            let conn = conn.transaction()?;
             let token_id = filters.token_id_or_exclude();
             let mut sql_builder = get_history_builder_preimage(&conn, &wallet_id, token_id, filters.for_addresses)?;
 
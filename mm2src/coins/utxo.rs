@@ -70,7 +70,7 @@ pub use keys::{Address, AddressBuilder, AddressFormat as UtxoAddressFormat, Addr
 use lightning_invoice::Currency as LightningCurrency;
 use mm2_core::mm_ctx::{MmArc, MmWeak};
 use mm2_err_handle::prelude::*;
-use mm2_metrics::MetricsArc;
+use mm2_metrics::{MetricsArc, MetricsWeak};
 use mm2_number::BigDecimal;
 use mm2_rpc::data::legacy::UtxoMergeParams;
 #[cfg(test)] use mocktopus::macros::*;
@@ -112,6 +112,7 @@ use super::{big_decimal_from_sat_unsigned, BalanceError, BalanceFut, BalanceResu
 use crate::coin_balance::{EnableCoinScanPolicy, EnabledCoinBalanceParams, HDAddressBalanceScanner};
 use crate::hd_wallet::{AddrToString, HDAccountOps, HDAddressOps, HDPathAccountToAddressId, HDWalletCoinOps,
                        HDWalletOps};
+use crate::rpc_cache::{ttl_from_block_interval, SingleFlightCache};
 use crate::utxo::tx_cache::UtxoVerboseCacheShared;
 use crate::{ParseCoinAssocTypes, ToBytes};
 
@@ -643,6 +644,30 @@ pub struct UtxoCoinFields {
     /// This abortable system is used to spawn coin's related futures that should be aborted on coin deactivation
     /// and on [`MmArc::stop`].
     pub abortable_system: AbortableQueue,
+    /// The chain values requested by every swap and order of the coin.
+    pub rpc_cache: Arc<UtxoRpcCache>,
+}
+
+/// The block interval of the coins that don't have `avg_blocktime` in the config.
+const DEFAULT_AVG_BLOCKTIME: u64 = 60;
+
+/// See [`crate::rpc_cache`].
+pub struct UtxoRpcCache {
+    pub block_count: SingleFlightCache<u64>,
+    /// The dynamic fee rate in satoshis per kbyte.
+    pub fee_rate: SingleFlightCache<u64>,
+    pub median_time_past: SingleFlightCache<u32>,
+}
+
+impl UtxoRpcCache {
+    pub fn new(ticker: &str, avg_blocktime: Option<u64>, metrics: MetricsWeak) -> UtxoRpcCache {
+        let ttl = ttl_from_block_interval(avg_blocktime.unwrap_or(DEFAULT_AVG_BLOCKTIME));
+        UtxoRpcCache {
+            block_count: SingleFlightCache::new("block_count", ticker.to_owned(), ttl, metrics.clone()),
+            fee_rate: SingleFlightCache::new("fee_rate", ticker.to_owned(), ttl, metrics.clone()),
+            median_time_past: SingleFlightCache::new("median_time_past", ticker.to_owned(), ttl, metrics),
+        }
+    }
 }
 
 #[derive(Debug, Display)]
@@ -914,6 +939,35 @@ impl HDAddressBalanceScanner for UtxoAddressScanner {
         };
         Ok(is_used)
     }
+
+    /// Requests the histories of all the `addresses` in a single batch if the coin is initialized with an Electrum client.
+    async fn are_addresses_used(&self, addresses: &[Self::Address]) -> BalanceResult<Vec<bool>> {
+        match self {
+            UtxoAddressScanner::Native { .. } => {
+                let mut used = Vec::with_capacity(addresses.len());
+                for address in addresses {
+                    used.push(self.is_address_used(address).await?);
+                }
+                Ok(used)
+            },
+            UtxoAddressScanner::Electrum(electrum_client) => {
+                let script_hashes = addresses
+                    .iter()
+                    .map(|address| {
+                        let script = output_script(address)?;
+                        Ok(hex::encode(electrum_script_hash(&script)))
+                    })
+                    .collect::<BalanceResult<Vec<_>>>()?;
+
+                let electrum_histories = electrum_client
+                    .scripthash_get_history_batch(script_hashes)
+                    .compat()
+                    .await?;
+
+                Ok(electrum_histories.iter().map(|history| !history.is_empty()).collect())
+            },
+        }
+    }
 }
 
 impl UtxoAddressScanner {
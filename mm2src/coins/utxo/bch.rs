@@ -1526,6 +1526,10 @@ impl UtxoTxHistoryOps for BchCoin {
         self.get_block_timestamp(height).await
     }
 
+    async fn get_block_timestamps(&self, heights: Vec<u64>) -> MmResult<HashMap<u64, u64>, GetBlockHeaderError> {
+        self.as_ref().rpc_client.get_block_timestamps(heights).await
+    }
+
     async fn my_addresses_balances(&self) -> BalanceResult<HashMap<String, BigDecimal>> {
         let my_address = self
             .my_address()
@@ -94,6 +94,39 @@ impl Deref for UtxoRpcClientEnum {
     }
 }
 
+/// The chain updates a swap waits for, see [`UtxoRpcClientEnum::watch_chain_updates`].
+pub enum ChainUpdates {
+    Polling,
+    Electrum(ElectrumChainUpdates),
+}
+
+impl ChainUpdates {
+    /// Registers a waiter for the next chain update.
+    /// It's to be called before checking the chain state, so that an update during the check isn't missed.
+    pub fn next_update(&self) -> ChainUpdate<'_> {
+        match self {
+            ChainUpdates::Polling => ChainUpdate::Polling,
+            ChainUpdates::Electrum(updates) => ChainUpdate::Electrum(updates.next_update()),
+        }
+    }
+}
+
+/// The next chain update registered with [`ChainUpdates::next_update`].
+pub enum ChainUpdate<'a> {
+    Polling,
+    Electrum(ElectrumChainUpdate<'a>),
+}
+
+impl ChainUpdate<'_> {
+    /// See [`ElectrumChainUpdate::wait`], polling is done every `check_every` seconds.
+    pub async fn wait(self, check_every: f64, wait_until: u64) {
+        match self {
+            ChainUpdate::Polling => Timer::sleep(check_every).await,
+            ChainUpdate::Electrum(update) => update.wait(check_every, wait_until).await,
+        }
+    }
+}
+
 impl UtxoRpcClientEnum {
     pub fn wait_for_confirmations(
         &self,
@@ -107,7 +140,10 @@ impl UtxoRpcClientEnum {
         let selfi = self.clone();
         let mut tx_not_found_retries = TX_NOT_FOUND_RETRIES;
         let fut = async move {
+            let chain_updates = selfi.watch_chain_updates(None).await;
             loop {
+                // The number of confirmations can only change with a new block.
+                let chain_update = chain_updates.next_update();
                 if now_sec() > wait_until {
                     return ERR!(
                         "Waited too long until {} for transaction {:?} to be confirmed {} times",
@@ -126,12 +162,13 @@ impl UtxoRpcClientEnum {
                         };
                         if tx_confirmations >= confirmations {
                             return Ok(());
-                        } else {
-                            info!(
-                                "Waiting for tx {:?} confirmations, now {}, required {}, requires_notarization {}",
-                                tx_hash, tx_confirmations, confirmations, requires_notarization
-                            )
                         }
+                        info!(
+                            "Waiting for tx {:?} confirmations, now {}, required {}, requires_notarization {}",
+                            tx_hash, tx_confirmations, confirmations, requires_notarization
+                        );
+                        chain_update.wait(check_every as f64, wait_until).await;
+                        continue;
                     },
                     Err(e) => {
                         if e.get_inner().is_tx_not_found_error() {
@@ -179,6 +216,24 @@ impl UtxoRpcClientEnum {
         Box::new(fut.boxed().compat())
     }
 
+    /// Starts watching the chain updates that can change the state of the transactions or of the `script` outputs.
+    /// See [`ElectrumClient::watch_chain_updates`], the native client can't be notified so it polls every `check_every` seconds.
+    pub async fn watch_chain_updates(&self, script: Option<&[u8]>) -> ChainUpdates {
+        match self {
+            UtxoRpcClientEnum::Native(_) => ChainUpdates::Polling,
+            UtxoRpcClientEnum::Electrum(electrum) => ChainUpdates::Electrum(electrum.watch_chain_updates(script).await),
+        }
+    }
+
+    /// Returns the chain generation of the cached values that change with new blocks, see [`crate::rpc_cache`].
+    /// The native client isn't notified about new blocks, so the values are bounded by the TTL only.
+    pub fn new_blocks_seen(&self) -> u64 {
+        match self {
+            UtxoRpcClientEnum::Native(_) => 0,
+            UtxoRpcClientEnum::Electrum(electrum) => electrum.new_blocks_seen(),
+        }
+    }
+
     #[inline]
     pub fn is_native(&self) -> bool {
         match self {
@@ -384,6 +439,15 @@ pub trait UtxoRpcClientOps: fmt::Debug + Send + Sync + 'static {
     /// Returns block time in seconds since epoch (Jan 1 1970 GMT).
     async fn get_block_timestamp(&self, height: u64) -> Result<u64, MmError<GetBlockHeaderError>>;
 
+    /// Returns block times of the given `heights` in seconds since epoch (Jan 1 1970 GMT).
+    async fn get_block_timestamps(&self, heights: Vec<u64>) -> Result<HashMap<u64, u64>, MmError<GetBlockHeaderError>> {
+        let mut timestamps = HashMap::with_capacity(heights.len());
+        for height in heights {
+            timestamps.insert(height, self.get_block_timestamp(height).await?);
+        }
+        Ok(timestamps)
+    }
+
     /// Returns verbose transaction by the given `txid` if it's on-chain or None if it's not.
     async fn get_tx_if_onchain(&self, tx_hash: &H256Json) -> Result<Option<UtxoTx>, MmError<GetTxError>> {
         match self
@@ -0,0 +1,331 @@
+//! Wakes the swaps waiting for transaction confirmations and output spends when the server notifies about chain updates.
+//!
+//! A confirmation can only change with a new block, and an output can only be spent by a transaction that changes
+//! the status of the output script hash. So instead of polling the server every `check_every` seconds, the waiters
+//! sleep until a `blockchain.headers.subscribe` or `blockchain.scripthash.subscribe` notification comes.
+//! All the waiters are woken by a new block at once, so their requests can be coalesced into batches.
+//!
+//! A waiter is registered with [`ElectrumChainUpdates::next_update`] before the swap checks the chain state,
+//! so a notification that comes during the check isn't missed. The watched script hashes are the swap scripts,
+//! they stay subscribed while any swap watches them and their notifications aren't passed to the balance streamer.
+
+use super::client::ElectrumClient;
+use super::constants::MAX_CHAIN_UPDATE_WAIT;
+use common::executor::{SpawnFuture, Timer};
+use common::now_sec;
+use futures::channel::oneshot;
+use futures::compat::Future01CompatExt;
+use futures::future::{select, FutureExt};
+use std::collections::HashMap;
+use std::sync::Mutex;
+
+#[derive(Debug, Default)]
+struct WatchedScriptHash {
+    /// The address of the server the script hash is subscribed with, if it's subscribed.
+    server_address: Option<String>,
+    /// The number of the [`ElectrumChainUpdates`] watching the script hash.
+    watchers: usize,
+}
+
+#[derive(Debug, Default)]
+struct ChainWatchState {
+    /// The address of the server the headers are subscribed with.
+    headers_server: Option<String>,
+    best_height: u64,
+    /// The number of new blocks notified about, see [`ElectrumChainWatch::new_blocks`].
+    new_blocks: u64,
+    /// The script hashes watched by the swaps.
+    script_hashes: HashMap<String, WatchedScriptHash>,
+    /// The waiters and the script hashes they are interested in besides the new blocks.
+    waiters: Vec<(Option<String>, oneshot::Sender<()>)>,
+}
+
+#[derive(Debug, Default)]
+pub struct ElectrumChainWatch {
+    state: Mutex<ChainWatchState>,
+}
+
+impl ElectrumChainWatch {
+    /// Returns the address of the server the notifications about new blocks come from.
+    pub fn headers_server(&self) -> Option<String> { self.state.lock().unwrap().headers_server.clone() }
+
+    /// Returns the number of new blocks notified about so far.
+    /// The caches of the values changing with new blocks use it as the chain generation.
+    pub fn new_blocks(&self) -> u64 { self.state.lock().unwrap().new_blocks }
+
+    pub fn on_headers_subscribed(&self, server_address: String, height: u64) {
+        let mut state = self.state.lock().unwrap();
+        state.headers_server = Some(server_address);
+        state.best_height = height;
+    }
+
+    pub fn is_script_hash_subscribed(&self, script_hash: &str) -> bool {
+        self.state
+            .lock()
+            .unwrap()
+            .script_hashes
+            .get(script_hash)
+            .map_or(false, |watched| watched.server_address.is_some())
+    }
+
+    pub fn on_script_hash_subscribed(&self, script_hash: &str, server_address: String) {
+        // The watchers could be gone while subscribing, the subscription is left to expire with the connection then.
+        if let Some(watched) = self.state.lock().unwrap().script_hashes.get_mut(script_hash) {
+            watched.server_address = Some(server_address);
+        }
+    }
+
+    /// Starts watching the `script_hash` by one more swap.
+    pub fn watch_script_hash(&self, script_hash: String) {
+        self.state
+            .lock()
+            .unwrap()
+            .script_hashes
+            .entry(script_hash)
+            .or_default()
+            .watchers += 1;
+    }
+
+    /// Stops watching the `script_hash` by a swap. Returns the address of the server to unsubscribe from
+    /// if no other swap watches the script hash anymore.
+    pub fn unwatch_script_hash(&self, script_hash: &str) -> Option<String> {
+        let mut state = self.state.lock().unwrap();
+        let watched = state.script_hashes.get_mut(script_hash)?;
+        watched.watchers = watched.watchers.saturating_sub(1);
+        if watched.watchers > 0 {
+            return None;
+        }
+        state.script_hashes.remove(script_hash)?.server_address
+    }
+
+    /// Returns a receiver that fires on a new block or, if the `script_hash` is given, on a change of its status.
+    pub fn wait_for_update(&self, script_hash: Option<String>) -> oneshot::Receiver<()> {
+        let (tx, rx) = oneshot::channel();
+        let mut state = self.state.lock().unwrap();
+        // Forget the waiters that have timed out.
+        state.waiters.retain(|(_, tx)| !tx.is_canceled());
+        state.waiters.push((script_hash, tx));
+        rx
+    }
+
+    /// Handles the `blockchain.headers.subscribe` notification.
+    pub fn on_new_block(&self, height: u64) {
+        let mut state = self.state.lock().unwrap();
+        // Every connection subscribed to the headers notifies about the same block.
+        if height == state.best_height {
+            return;
+        }
+        state.best_height = height;
+        state.new_blocks += 1;
+        for (_, tx) in state.waiters.drain(..) {
+            tx.send(()).ok();
+        }
+    }
+
+    /// Handles the `blockchain.scripthash.subscribe` notification.
+    /// Returns `true` if the script hash is watched by the swaps.
+    pub fn on_script_hash_status(&self, script_hash: &str) -> bool {
+        let mut state = self.state.lock().unwrap();
+        let (woken, waiting): (Vec<_>, Vec<_>) = state
+            .waiters
+            .drain(..)
+            .partition(|(waiter_hash, _)| waiter_hash.as_deref() == Some(script_hash));
+        state.waiters = waiting;
+        for (_, tx) in woken {
+            tx.send(()).ok();
+        }
+        state.script_hashes.contains_key(script_hash)
+    }
+
+    /// Forgets the subscriptions made with the disconnected server, and wakes all the waiters up
+    /// as the server won't notify them anymore.
+    pub fn on_disconnected(&self, server_address: &str) {
+        let mut state = self.state.lock().unwrap();
+        if state.headers_server.as_deref() == Some(server_address) {
+            state.headers_server = None;
+        }
+        for watched in state.script_hashes.values_mut() {
+            if watched.server_address.as_deref() == Some(server_address) {
+                watched.server_address = None;
+            }
+        }
+        for (_, tx) in state.waiters.drain(..) {
+            tx.send(()).ok();
+        }
+    }
+}
+
+/// Whether the client is subscribed to the chain updates a swap waits for,
+/// see [`ElectrumClient::subscribe_for_chain_updates`].
+pub(super) enum ChainSubscription {
+    /// The client can't be notified about the new blocks.
+    Unavailable,
+    /// The subscription has just been made, so it couldn't notify about the updates before it.
+    New,
+    Existing,
+}
+
+/// The chain updates a swap waits for, see [`ElectrumClient::watch_chain_updates`].
+/// The watched script hash is unsubscribed from when the last swap watching it drops its updates.
+pub struct ElectrumChainUpdates {
+    client: ElectrumClient,
+    script_hash: Option<String>,
+}
+
+impl ElectrumChainUpdates {
+    pub(super) fn new(client: ElectrumClient, script_hash: Option<String>) -> Self {
+        if let Some(script_hash) = &script_hash {
+            client.chain_watch.watch_script_hash(script_hash.clone());
+        }
+        ElectrumChainUpdates { client, script_hash }
+    }
+
+    /// Registers a waiter for the next chain update.
+    /// It's to be called before checking the chain state, so that an update during the check isn't missed.
+    pub fn next_update(&self) -> ElectrumChainUpdate<'_> {
+        ElectrumChainUpdate {
+            updates: self,
+            notified: self.client.chain_watch.wait_for_update(self.script_hash.clone()),
+        }
+    }
+}
+
+impl Drop for ElectrumChainUpdates {
+    fn drop(&mut self) {
+        let script_hash = match self.script_hash.take() {
+            Some(script_hash) => script_hash,
+            None => return,
+        };
+        let server_address = match self.client.chain_watch.unwatch_script_hash(&script_hash) {
+            Some(server_address) => server_address,
+            None => return,
+        };
+        // The unspent cache relies on the same subscription.
+        if let Some(unspent_cache) = &self.client.unspent_cache {
+            if unspent_cache.is_subscribed(&script_hash) {
+                return;
+            }
+        }
+
+        let client = self.client.clone();
+        self.client.weak_spawner().spawn(async move {
+            // The servers below protocol 1.4.2 don't support unsubscribing,
+            // the subscription is dropped along with the connection then.
+            client
+                .blockchain_scripthash_unsubscribe_using(&server_address, script_hash)
+                .compat()
+                .await
+                .ok();
+        });
+    }
+}
+
+/// The next chain update registered with [`ElectrumChainUpdates::next_update`].
+pub struct ElectrumChainUpdate<'a> {
+    updates: &'a ElectrumChainUpdates,
+    notified: oneshot::Receiver<()>,
+}
+
+impl ElectrumChainUpdate<'_> {
+    /// Waits until the server notifies about a new block or, if a script is watched, about a change of its status.
+    /// Falls back to sleeping `check_every` seconds if the client can't subscribe to the notifications.
+    ///
+    /// Doesn't wait past `wait_until` for more than `check_every` seconds,
+    /// so that the caller polling until `wait_until` doesn't time out late.
+    pub async fn wait(self, check_every: f64, wait_until: u64) {
+        let client = &self.updates.client;
+        match client
+            .subscribe_for_chain_updates(self.updates.script_hash.as_deref())
+            .await
+        {
+            ChainSubscription::Unavailable => Timer::sleep(check_every).await,
+            // E.g. after a reconnection, the caller is to check the chain state again.
+            ChainSubscription::New => (),
+            ChainSubscription::Existing => {
+                let until_timeout = wait_until.saturating_sub(now_sec()) as f64;
+                let timeout = Timer::sleep(until_timeout.min(MAX_CHAIN_UPDATE_WAIT).max(check_every));
+                select(self.notified, timeout.boxed()).await;
+            },
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_electrum_chain_watch() {
+        let watch = ElectrumChainWatch::default();
+        watch.on_headers_subscribed("server".to_owned(), 100);
+        watch.watch_script_hash("hash".to_owned());
+        assert!(!watch.is_script_hash_subscribed("hash"));
+        watch.on_script_hash_subscribed("hash", "server".to_owned());
+        assert_eq!(watch.headers_server().as_deref(), Some("server"));
+        assert!(watch.is_script_hash_subscribed("hash"));
+
+        let mut block_waiter = watch.wait_for_update(None);
+        let mut hash_waiter = watch.wait_for_update(Some("hash".to_owned()));
+        let mut other_hash_waiter = watch.wait_for_update(Some("other".to_owned()));
+
+        // already known block
+        watch.on_new_block(100);
+        assert_eq!(block_waiter.try_recv(), Ok(None));
+        assert_eq!(watch.new_blocks(), 0);
+
+        assert!(watch.on_script_hash_status("hash"));
+        assert_eq!(hash_waiter.try_recv(), Ok(Some(())));
+        assert_eq!(block_waiter.try_recv(), Ok(None));
+        assert_eq!(other_hash_waiter.try_recv(), Ok(None));
+
+        watch.on_new_block(101);
+        assert_eq!(block_waiter.try_recv(), Ok(Some(())));
+        assert_eq!(watch.new_blocks(), 1);
+        assert_eq!(other_hash_waiter.try_recv(), Ok(Some(())));
+
+        let mut waiter = watch.wait_for_update(None);
+        watch.on_disconnected("server");
+        assert_eq!(waiter.try_recv(), Ok(Some(())));
+        assert_eq!(watch.headers_server(), None);
+        assert!(!watch.is_script_hash_subscribed("hash"));
+    }
+
+    #[test]
+    fn test_electrum_chain_watch_notification_during_check() {
+        let watch = ElectrumChainWatch::default();
+        watch.on_headers_subscribed("server".to_owned(), 100);
+
+        // The waiter is registered before the caller checks the chain state,
+        // so the block notified in between wakes it up instead of being lost.
+        let mut waiter = watch.wait_for_update(None);
+        watch.on_new_block(101);
+        assert_eq!(waiter.try_recv(), Ok(Some(())));
+    }
+
+    #[test]
+    fn test_electrum_chain_watch_script_hash_watchers() {
+        let watch = ElectrumChainWatch::default();
+        // Not watched by the swaps, e.g. a wallet address of the balance streamer.
+        assert!(!watch.on_script_hash_status("address"));
+
+        watch.watch_script_hash("hash".to_owned());
+        watch.watch_script_hash("hash".to_owned());
+        watch.on_script_hash_subscribed("hash", "server".to_owned());
+        assert!(watch.on_script_hash_status("hash"));
+
+        // The script hash stays subscribed while the other swap watches it.
+        assert_eq!(watch.unwatch_script_hash("hash"), None);
+        assert!(watch.is_script_hash_subscribed("hash"));
+        assert_eq!(watch.unwatch_script_hash("hash").as_deref(), Some("server"));
+        assert!(!watch.is_script_hash_subscribed("hash"));
+        assert!(!watch.on_script_hash_status("hash"));
+        assert_eq!(watch.unwatch_script_hash("hash"), None);
+
+        // Nothing to unsubscribe from after a disconnection.
+        watch.watch_script_hash("hash".to_owned());
+        watch.on_script_hash_subscribed("hash", "server".to_owned());
+        watch.on_disconnected("server");
+        assert!(watch.on_script_hash_status("hash"));
+        assert_eq!(watch.unwatch_script_hash("hash"), None);
+    }
+}
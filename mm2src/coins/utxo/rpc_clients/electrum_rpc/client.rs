@@ -1,12 +1,15 @@
 use super::super::{BlockHashOrHeight, EstimateFeeMethod, EstimateFeeMode, SpentOutputInfo, UnspentInfo, UnspentMap,
                    UtxoJsonRpcClientInfo, UtxoRpcClientOps, UtxoRpcError, UtxoRpcFut};
+use super::chain_watch::{ChainSubscription, ElectrumChainUpdates, ElectrumChainWatch};
 use super::connection::{ElectrumConnection, ElectrumConnectionErr, ElectrumConnectionSettings};
 use super::connection_manager::ConnectionManager;
 use super::constants::{BLOCKCHAIN_HEADERS_SUB_ID, BLOCKCHAIN_SCRIPTHASH_SUB_ID, ELECTRUM_REQUEST_TIMEOUT,
-                       NO_FORCE_CONNECT_METHODS, SEND_TO_ALL_METHODS};
+                       MAX_HEADERS_RANGE_READ, NO_FORCE_CONNECT_METHODS, SEND_TO_ALL_METHODS};
 use super::electrum_script_hash;
 use super::event_handlers::ElectrumConnectionManagerNotifier;
+use super::request_coalescer::ElectrumRequestCoalescer;
 use super::rpc_responses::*;
+use super::unspent_cache::ElectrumUnspentCache;
 
 use crate::utxo::rpc_clients::ConcurrentRequestMap;
 use crate::utxo::utxo_block_header_storage::BlockHeaderStorage;
@@ -16,19 +19,20 @@ use crate::RpcTransportEventHandler;
 use crate::SharableRpcTransportEventHandler;
 use chain::{BlockHeader, Transaction as UtxoTx, TxHashAlgo};
 use common::executor::abortable_queue::{AbortableQueue, WeakSpawner};
+use common::executor::{SpawnFuture, Timer};
 use common::jsonrpc_client::{JsonRpcBatchClient, JsonRpcClient, JsonRpcError, JsonRpcErrorType, JsonRpcId,
                              JsonRpcMultiClient, JsonRpcRemoteAddr, JsonRpcRequest, JsonRpcRequestEnum,
                              JsonRpcResponseEnum, JsonRpcResponseFut, RpcRes};
 use common::log::warn;
 use common::{median, OrdRange};
+use compatible_time::Instant;
 use keys::hash::H256;
 use keys::Address;
 use mm2_err_handle::prelude::*;
 use mm2_number::BigDecimal;
 #[cfg(test)] use mocktopus::macros::*;
 use rpc::v1::types::{Bytes as BytesJson, Transaction as RpcTransaction, H256 as H256Json};
-use serialization::{deserialize, serialize, serialize_with_flags, CoinVariant, CompactInteger, Reader,
-                    SERIALIZE_TRANSACTION_WITNESS};
+use serialization::{deserialize, serialize, serialize_with_flags, CoinVariant, SERIALIZE_TRANSACTION_WITNESS};
 use spv_validation::helpers_validation::SPVError;
 use spv_validation::storage::BlockHeaderStorageOps;
 
@@ -42,11 +46,13 @@ use std::num::NonZeroU64;
 use std::ops::Deref;
 use std::sync::atomic::{AtomicU64, Ordering as AtomicOrdering};
 use std::sync::Arc;
+use std::time::Duration;
 
 use crate::utxo::utxo_balance_events::UtxoBalanceEventStreamer;
 use async_trait::async_trait;
+use futures::channel::oneshot;
 use futures::compat::Future01CompatExt;
-use futures::future::{join_all, FutureExt, TryFutureExt};
+use futures::future::{join_all, select, FutureExt, TryFutureExt};
 use futures::stream::FuturesUnordered;
 use futures::StreamExt;
 use futures01::Future;
@@ -69,6 +75,13 @@ pub struct ElectrumClientSettings {
     pub min_connected: usize,
     /// Maximum number of connections to keep alive at any time.
     pub max_connected: usize,
+    /// If set, the single requests of some methods issued within this window are coalesced into JSON-RPC batches.
+    pub batch_window: Option<Duration>,
+    /// Whether to send a duplicate of a request to the next fastest server
+    /// if the fastest one hasn't responded within its p95 latency.
+    pub hedge_requests: bool,
+    /// Whether to keep the unspents of the subscribed script hashes in memory until the server notifies about a change.
+    pub cache_unspents: bool,
 }
 
 #[derive(Debug)]
@@ -81,6 +94,14 @@ pub struct ElectrumClientImpl {
     protocol_version: OrdRange<f32>,
     get_balance_concurrent_map: ConcurrentRequestMap<String, ElectrumBalance>,
     list_unspent_concurrent_map: ConcurrentRequestMap<String, Vec<ElectrumUnspent>>,
+    /// Coalesces the concurrent single requests into batches if [`ElectrumClientSettings::batch_window`] is set.
+    pub(super) request_coalescer: Option<ElectrumRequestCoalescer>,
+    /// See [`ElectrumClientSettings::hedge_requests`].
+    hedge_requests: bool,
+    /// Set if [`ElectrumClientSettings::cache_unspents`] is enabled.
+    pub(super) unspent_cache: Option<ElectrumUnspentCache>,
+    /// Wakes the swaps waiting for confirmations and spends on the server notifications.
+    pub(super) chain_watch: ElectrumChainWatch,
     block_headers_storage: BlockHeaderStorage,
     /// Event handlers that are triggered on (dis)connection & transport events. They are wrapped
     /// in an `Arc` since they are shared outside `ElectrumClientImpl`. They are handed to each active
@@ -124,6 +145,10 @@ impl ElectrumClientImpl {
             protocol_version: OrdRange::new(1.2, 1.4).unwrap(),
             get_balance_concurrent_map: ConcurrentRequestMap::new(),
             list_unspent_concurrent_map: ConcurrentRequestMap::new(),
+            request_coalescer: client_settings.batch_window.map(ElectrumRequestCoalescer::new),
+            hedge_requests: client_settings.hedge_requests,
+            unspent_cache: client_settings.cache_unspents.then(ElectrumUnspentCache::default),
+            chain_watch: ElectrumChainWatch::default(),
             block_headers_storage,
             abortable_system,
             streaming_manager,
@@ -193,6 +218,13 @@ impl ElectrumClientImpl {
     ///
     /// The streamer will figure out which address this scripthash belongs to and will broadcast an notification to clients.
     pub fn notify_triggered_hash(&self, script_hash: String) -> Result<(), String> {
+        if let Some(unspent_cache) = &self.unspent_cache {
+            unspent_cache.invalidate(&script_hash);
+        }
+        // The swap scripts watched by the chain watch aren't the addresses the balance streamer is interested in.
+        if self.chain_watch.on_script_hash_status(&script_hash) {
+            return Ok(());
+        }
         match self.streaming_manager.send(
             &UtxoBalanceEventStreamer::derive_streamer_id(&self.coin_ticker),
             ScripthashNotification::Triggered(script_hash),
@@ -203,6 +235,12 @@ impl ElectrumClientImpl {
         }
     }
 
+    /// Handles the `blockchain.headers.subscribe` notification.
+    pub fn notify_new_block(&self, height: u64) { self.chain_watch.on_new_block(height); }
+
+    /// Returns the number of the new blocks the servers have notified about so far.
+    pub fn new_blocks_seen(&self) -> u64 { self.chain_watch.new_blocks() }
+
     /// Get block headers storage.
     pub fn block_headers_storage(&self) -> &BlockHeaderStorage { &self.block_headers_storage }
 
@@ -257,7 +295,17 @@ impl JsonRpcClient for ElectrumClient {
     fn client_info(&self) -> String { UtxoJsonRpcClientInfo::client_info(self) }
 
     fn transport(&self, request: JsonRpcRequestEnum) -> JsonRpcResponseFut {
-        Box::new(self.clone().electrum_request_multi(request).boxed().compat())
+        match (&self.request_coalescer, request) {
+            (Some(_), JsonRpcRequestEnum::Single(single)) if ElectrumRequestCoalescer::is_coalesced(&single) => {
+                let client = self.clone();
+                let fut = async move {
+                    let coalescer = client.request_coalescer.as_ref().expect("checked above");
+                    coalescer.request(&client, single).await
+                };
+                Box::new(fut.boxed().compat())
+            },
+            (_, request) => Box::new(self.clone().electrum_request_multi(request).boxed().compat()),
+        }
     }
 }
 
@@ -298,25 +346,43 @@ impl ElectrumClient {
     /// Sends a JSONRPC request to all the connected servers.
     ///
     /// This method will block until a response is received from at least one server.
-    async fn electrum_request_multi(
+    pub(super) async fn electrum_request_multi(
         self,
         request: JsonRpcRequestEnum,
     ) -> Result<(JsonRpcRemoteAddr, JsonRpcResponseEnum), JsonRpcErrorType> {
         // Whether to send the request to all active connections or not.
         let send_to_all = matches!(request, JsonRpcRequestEnum::Single(ref req) if SEND_TO_ALL_METHODS.contains(&req.method.as_str()));
+        let method = match request {
+            JsonRpcRequestEnum::Single(ref req) => req.method.clone(),
+            JsonRpcRequestEnum::Batch(_) => "batch".to_owned(),
+        };
+        let started_at = Instant::now();
         // Request id and serialized request.
         let req_id = request.rpc_id();
         let request = json::to_string(&request).map_err(|e| JsonRpcErrorType::InvalidRequest(e.to_string()))?;
         let request = (req_id, request);
-        // Use the active connections for this request.
+        // Use the active connections for this request, the fastest healthy ones come first.
         let connections = self.connection_manager.get_active_connections();
+        // If the fastest connection doesn't respond within its usual latency, hedge the request to the next one.
+        let hedge_after = if self.hedge_requests && !send_to_all && connections.len() > 1 {
+            self.connection_manager.hedge_delay(connections[0].address())
+        } else {
+            None
+        };
         // Maximum number of connections to establish or use in request concurrently. Could be up to connections.len().
-        let concurrency = if send_to_all { connections.len() } else { 1 };
+        let concurrency = match (send_to_all, hedge_after) {
+            (true, _) => connections.len(),
+            (false, Some(_)) => 2,
+            (false, None) => 1,
+        };
         match self
-            .send_request_using(&request, connections, send_to_all, concurrency)
+            .send_request_using(&request, connections, send_to_all, concurrency, hedge_after)
             .await
         {
-            Ok(response) => Ok(response),
+            Ok(response) => {
+                self.event_handlers.on_request_finished(&method, started_at.elapsed());
+                Ok(response)
+            },
             // If we failed the request using only the active connections, try again using all connections.
             Err(_) if !send_to_all => {
                 warn!(
@@ -333,8 +399,14 @@ impl ElectrumClient {
                 // connections at the same time. This is not as bad though since the manager's background task
                 // tries connections sequentially and we are expected for finish much quicker due to parallelizing.
                 let concurrency = self.connection_manager.config().max_connected;
-                match self.send_request_using(&request, connections, false, concurrency).await {
-                    Ok(response) => Ok(response),
+                match self
+                    .send_request_using(&request, connections, false, concurrency, None)
+                    .await
+                {
+                    Ok(response) => {
+                        self.event_handlers.on_request_finished(&method, started_at.elapsed());
+                        Ok(response)
+                    },
                     Err(err_vec) => Err(JsonRpcErrorType::Internal(format!("All servers errored: {err_vec:?}"))),
                 }
             },
@@ -360,9 +432,16 @@ impl ElectrumClient {
             .await
             .map_err(|err| JsonRpcErrorType::Internal(err.to_string()))?;
 
+        let started_at = Instant::now();
         let response = connection
             .electrum_request(json, request.rpc_id(), ELECTRUM_REQUEST_TIMEOUT)
             .await;
+        match response {
+            Ok(_) => self
+                .connection_manager
+                .on_request_succeeded(&to_addr, started_at.elapsed()),
+            Err(_) => self.connection_manager.on_request_failed(&to_addr),
+        }
         // If the request was not forcefully connected, we shouldn't inform the connection manager that it's
         // not needed anymore, as we didn't force spawn it in the first place.
         // This fixes dropping the connection after the version check request, as we don't mark the connection
@@ -380,21 +459,39 @@ impl ElectrumClient {
     ///
     /// If `send_to_all` is set to `true`, we won't return on first successful response but
     /// wait for all responses to come back first.
+    ///
+    /// If `hedge_after` is set, only the first connection of each chunk is requested right away,
+    /// the rest of the chunk is requested if no response has come back within this time
+    /// or as soon as the first connection has failed.
     async fn send_request_using(
         &self,
         request: &(JsonRpcId, String),
         connections: Vec<Arc<ElectrumConnection>>,
         send_to_all: bool,
         max_concurrency: usize,
+        hedge_after: Option<Duration>,
     ) -> Result<(JsonRpcRemoteAddr, JsonRpcResponseEnum), Vec<(JsonRpcRemoteAddr, JsonRpcErrorType)>> {
         let max_concurrency = max_concurrency.max(1);
         // Create the request
         let chunked_requests = connections.chunks(max_concurrency).map(|chunk| {
-            FuturesUnordered::from_iter(chunk.iter().map(|connection| {
+            // Dropped as soon as the first connection of the chunk is done, so that the hedged requests
+            // are sent right away if it fails before the hedge delay elapses.
+            let (first_done_tx, first_done_rx) = oneshot::channel::<()>();
+            let mut first_done_tx = Some(first_done_tx);
+            let first_done_rx = first_done_rx.shared();
+            FuturesUnordered::from_iter(chunk.iter().enumerate().map(|(index_in_chunk, connection)| {
                 let client = self.clone();
                 let req_id = request.0;
                 let req_json = request.1.clone();
+                let first_done_tx = first_done_tx.take();
+                let hedge_start = hedge_after
+                    .filter(|_| index_in_chunk > 0)
+                    .map(|start_delay| (start_delay, first_done_rx.clone()));
                 async move {
+                    if let Some((start_delay, first_done)) = hedge_start {
+                        // This future is dropped without sending the request if another connection responds earlier.
+                        select(Timer::sleep(start_delay.as_secs_f64()).boxed(), first_done).await;
+                    }
                     let connection_is_established = connection
                         // We first make sure that the connection loop is established before sending the request.
                         .establish_connection_loop(client)
@@ -403,12 +500,20 @@ impl ElectrumClient {
                     let response = match connection_is_established {
                         Ok(_) => {
                             // Perform the request.
-                            connection
+                            let started_at = Instant::now();
+                            let response = connection
                                 .electrum_request(req_json, req_id, ELECTRUM_REQUEST_TIMEOUT)
-                                .await
+                                .await;
+                            if response.is_ok() {
+                                client
+                                    .connection_manager
+                                    .on_request_succeeded(connection.address(), started_at.elapsed());
+                            }
+                            response
                         },
                         Err(e) => Err(e),
                     };
+                    drop(first_done_tx);
                     (response, connection.clone())
                 }
             }))
@@ -436,6 +541,7 @@ impl ElectrumClient {
                             "[coin={}], Error while sending request to {address:?}: {e:?}",
                             client.coin_ticker()
                         );
+                        client.connection_manager.on_request_failed(connection.address());
                         connection.disconnect(Some(ElectrumConnectionErr::Temporary(format!(
                             "Forcefully disconnected for erroring: {e:?}."
                         ))));
@@ -471,6 +577,60 @@ impl ElectrumClient {
         )
     }
 
+    /// Starts watching the new blocks and, if the `script` is given, the changes of its status for a waiting swap.
+    /// The client subscribes to them right away, so the swap can check the chain state after this call.
+    pub async fn watch_chain_updates(&self, script: Option<&[u8]>) -> ElectrumChainUpdates {
+        let script_hash = script.map(|script| hex::encode(electrum_script_hash(script)));
+        let updates = ElectrumChainUpdates::new(self.clone(), script_hash.clone());
+        self.subscribe_for_chain_updates(script_hash.as_deref()).await;
+        updates
+    }
+
+    /// Subscribes to the new block headers and to the `script_hash` status changes if the client isn't subscribed yet.
+    pub(super) async fn subscribe_for_chain_updates(&self, script_hash: Option<&str>) -> ChainSubscription {
+        let mut subscription = ChainSubscription::Existing;
+        let server_address = match self.chain_watch.headers_server() {
+            Some(server_address) => server_address,
+            None => {
+                let server_address = match self.connection_manager.get_active_connections().first() {
+                    Some(connection) => connection.address().to_owned(),
+                    None => return ChainSubscription::Unavailable,
+                };
+                match self.get_block_count_from(&server_address).compat().await {
+                    Ok(height) => self.chain_watch.on_headers_subscribed(server_address.clone(), height),
+                    Err(_) => return ChainSubscription::Unavailable,
+                }
+                subscription = ChainSubscription::New;
+                server_address
+            },
+        };
+
+        if let Some(script_hash) = script_hash {
+            if !self.chain_watch.is_script_hash_subscribed(script_hash) {
+                // The waiter is still woken on the new blocks if the subscription fails.
+                if self
+                    .blockchain_scripthash_subscribe_using(&server_address, script_hash.to_owned())
+                    .compat()
+                    .await
+                    .is_ok()
+                {
+                    self.chain_watch.on_script_hash_subscribed(script_hash, server_address);
+                    subscription = ChainSubscription::New;
+                }
+            }
+        }
+        subscription
+    }
+
+    /// https://electrumx.readthedocs.io/en/latest/protocol-methods.html#blockchain-scripthash-unsubscribe
+    pub(super) fn blockchain_scripthash_unsubscribe_using(
+        &self,
+        server_address: &str,
+        scripthash: String,
+    ) -> RpcRes<bool> {
+        rpc_func_from!(self, server_address, "blockchain.scripthash.unsubscribe", scripthash)
+    }
+
     /// https://electrumx.readthedocs.io/en/latest/protocol-methods.html#blockchain-block-headers
     pub fn get_block_headers_from(
         &self,
@@ -511,7 +671,86 @@ impl ElectrumClient {
     /// It can return duplicates sometimes: https://github.com/artemii235/SuperNET/issues/269
     /// We should remove them to build valid transactions.
     /// Please note the function returns `ScriptHashUnspents` elements in the same order in which they were requested.
+    ///
+    /// If the unspent cache is enabled, only the unspents of the script hashes that aren't cached are requested.
     pub fn scripthash_list_unspent_batch(&self, hashes: Vec<ElectrumScriptHash>) -> RpcRes<Vec<ScriptHashUnspents>> {
+        if self.unspent_cache.is_none() {
+            return self.request_scripthash_list_unspent_batch(hashes);
+        }
+
+        let this = self.clone();
+        let fut = async move {
+            let unspent_cache = this.unspent_cache.as_ref().expect("checked above");
+            // Must be taken before the unspents are requested.
+            let generation = unspent_cache.generation();
+            let cached: Vec<_> = hashes.iter().map(|hash| unspent_cache.get(hash)).collect();
+            let to_request: Vec<_> = hashes
+                .iter()
+                .zip(cached.iter())
+                .filter(|(_, cached)| cached.is_none())
+                .map(|(hash, _)| hash.clone())
+                .collect();
+            let mut requested = if to_request.is_empty() {
+                Vec::new()
+            } else {
+                this.request_scripthash_list_unspent_batch(to_request).compat().await?
+            }
+            .into_iter();
+
+            let unspents = hashes
+                .into_iter()
+                .zip(cached)
+                .map(|(hash, cached)| match cached {
+                    Some(unspents) => unspents,
+                    None => {
+                        // The batch responses are checked to match the requests, so there is one for every hash.
+                        let unspents = requested.next().unwrap_or_default();
+                        unspent_cache.insert(generation, &hash, unspents.clone());
+                        this.subscribe_for_unspent_cache(hash);
+                        unspents
+                    },
+                })
+                .collect();
+            Ok(unspents)
+        };
+        Box::new(fut.boxed().compat())
+    }
+
+    /// Subscribes to the `script_hash` status changes in background, so that its unspents can be cached.
+    fn subscribe_for_unspent_cache(&self, script_hash: ElectrumScriptHash) {
+        let unspent_cache = match &self.unspent_cache {
+            Some(unspent_cache) => unspent_cache,
+            None => return,
+        };
+        if !unspent_cache.start_subscribing(&script_hash) {
+            return;
+        }
+
+        let this = self.clone();
+        self.weak_spawner().spawn(async move {
+            let unspent_cache = this.unspent_cache.as_ref().expect("checked above");
+            let server_address = match this.connection_manager.get_active_connections().first() {
+                Some(connection) => connection.address().to_owned(),
+                None => {
+                    unspent_cache.on_subscription_failed(&script_hash);
+                    return;
+                },
+            };
+            match this
+                .blockchain_scripthash_subscribe_using(&server_address, script_hash.clone())
+                .compat()
+                .await
+            {
+                Ok(_) => unspent_cache.on_subscribed(script_hash, server_address),
+                Err(_) => unspent_cache.on_subscription_failed(&script_hash),
+            }
+        });
+    }
+
+    fn request_scripthash_list_unspent_batch(
+        &self,
+        hashes: Vec<ElectrumScriptHash>,
+    ) -> RpcRes<Vec<ScriptHashUnspents>> {
         let requests = hashes
             .iter()
             .map(|hash| rpc_req!(self, "blockchain.scripthash.listunspent", hash));
@@ -728,13 +967,7 @@ impl ElectrumClient {
                         if headers.count == 0 {
                             return MmError::err(UtxoRpcError::Internal("No headers available".to_string()));
                         }
-                        let len = CompactInteger::from(headers.count);
-                        let mut serialized = serialize(&len).take();
-                        serialized.extend(headers.hex.0.into_iter());
-                        drop_mutability!(serialized);
-                        let mut reader =
-                            Reader::new_with_coin_variant(serialized.as_slice(), coin_name.as_str().into());
-                        let maybe_block_headers = reader.read_list::<BlockHeader>();
+                        let maybe_block_headers = headers.block_headers(coin_name.as_str().into());
                         let block_headers = match maybe_block_headers {
                             Ok(headers) => headers,
                             Err(e) => return MmError::err(UtxoRpcError::InvalidResponse(format!("{:?}", e))),
@@ -1066,11 +1299,7 @@ impl UtxoRpcClientOps for ElectrumClient {
                     if res.count == 0 {
                         return MmError::err(UtxoRpcError::InvalidResponse("Server returned zero count".to_owned()));
                     }
-                    let len = CompactInteger::from(res.count);
-                    let mut serialized = serialize(&len).take();
-                    serialized.extend(res.hex.0.into_iter());
-                    let mut reader = Reader::new_with_coin_variant(serialized.as_slice(), coin_variant);
-                    let headers = reader.read_list::<BlockHeader>()?;
+                    let headers = res.block_headers(coin_variant)?;
                     let mut timestamps: Vec<_> = headers.into_iter().map(|block| block.time).collect();
                     // can unwrap because count is non zero
                     Ok(median(timestamps.as_mut_slice()).unwrap())
@@ -1081,4 +1310,40 @@ impl UtxoRpcClientOps for ElectrumClient {
     async fn get_block_timestamp(&self, height: u64) -> Result<u64, MmError<GetBlockHeaderError>> {
         Ok(self.block_header_from_storage_or_rpc(height).await?.time as u64)
     }
+
+    /// Reads the stored headers by ranges of up to [`MAX_HEADERS_RANGE_READ`] heights,
+    /// the headers that aren't stored are requested one by one.
+    async fn get_block_timestamps(
+        &self,
+        mut heights: Vec<u64>,
+    ) -> Result<HashMap<u64, u64>, MmError<GetBlockHeaderError>> {
+        heights.sort_unstable();
+        heights.dedup();
+
+        let mut timestamps = HashMap::with_capacity(heights.len());
+        let mut window_start = 0;
+        while let Some(from) = heights.get(window_start).copied() {
+            let window_end = heights[window_start..]
+                .iter()
+                .position(|height| height - from >= MAX_HEADERS_RANGE_READ)
+                .map_or(heights.len(), |len| window_start + len);
+            let to = heights[window_end - 1];
+            // The headers may not be stored if the coin doesn't sync them.
+            let stored = self
+                .block_headers_storage()
+                .get_block_headers_in_range(from, to)
+                .await
+                .unwrap_or_default();
+
+            for height in &heights[window_start..window_end] {
+                let timestamp = match stored.get(height) {
+                    Some(header) => header.time as u64,
+                    None => self.get_block_timestamp(*height).await?,
+                };
+                timestamps.insert(*height, timestamp);
+            }
+            window_start = window_end;
+        }
+        Ok(timestamps)
+    }
 }
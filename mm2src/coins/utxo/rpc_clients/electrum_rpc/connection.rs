@@ -1,13 +1,13 @@
 use super::client::ElectrumClient;
 use super::constants::{BLOCKCHAIN_HEADERS_SUB_ID, BLOCKCHAIN_SCRIPTHASH_SUB_ID, CUTOFF_TIMEOUT,
                        DEFAULT_CONNECTION_ESTABLISHMENT_TIMEOUT};
+use super::rpc_responses::{ElectrumBlockHeader, ElectrumRpcMessage};
 
 use crate::{RpcTransportEventHandler, SharableRpcTransportEventHandler};
 use common::custom_futures::timeout::FutureTimerExt;
 use common::executor::{abortable_queue::AbortableQueue, abortable_queue::WeakSpawner, AbortableSystem, SpawnFuture,
                        Timer};
-use common::jsonrpc_client::{JsonRpcBatchResponse, JsonRpcErrorType, JsonRpcId, JsonRpcRequest, JsonRpcResponse,
-                             JsonRpcResponseEnum};
+use common::jsonrpc_client::{JsonRpcErrorType, JsonRpcId, JsonRpcResponseEnum};
 use common::log::{error, info};
 use common::{now_float, now_ms};
 use mm2_rpc::data::legacy::ElectrumProtocol;
@@ -28,7 +28,7 @@ use futures::stream::StreamExt;
 use futures01::sync::mpsc;
 use futures01::{Sink, Stream};
 use http::Uri;
-use serde::Serialize;
+use serde::{Deserialize, Serialize};
 
 cfg_native! {
     use super::tcp_stream::*;
@@ -279,34 +279,9 @@ impl ElectrumConnection {
         // Inform the event handlers.
         client.event_handlers().on_incoming_response(bytes);
 
-        // detect if we got standard JSONRPC response or subscription response as JSONRPC request
-        #[derive(Deserialize)]
-        #[serde(untagged)]
-        enum ElectrumRpcResponseEnum {
-            /// The subscription response as JSONRPC request.
-            ///
-            /// NOTE Because JsonRpcResponse uses default values for each of its field,
-            /// this variant has to stay at top in this enumeration to be properly deserialized
-            /// from serde.
-            SubscriptionNotification(JsonRpcRequest),
-            /// The standard JSONRPC single response.
-            SingleResponse(JsonRpcResponse),
-            /// The batch of standard JSONRPC responses.
-            BatchResponses(JsonRpcBatchResponse),
-        }
-
-        let response: ElectrumRpcResponseEnum = match serde_json::from_slice(bytes) {
-            Ok(res) => res,
-            Err(e) => {
-                error!("{}", e);
-                return;
-            },
-        };
-
-        let response = match response {
-            ElectrumRpcResponseEnum::SingleResponse(single) => JsonRpcResponseEnum::Single(single),
-            ElectrumRpcResponseEnum::BatchResponses(batch) => JsonRpcResponseEnum::Batch(batch),
-            ElectrumRpcResponseEnum::SubscriptionNotification(req) => {
+        let response = match ElectrumRpcMessage::from_slice(bytes) {
+            Ok(ElectrumRpcMessage::Response(response)) => response,
+            Ok(ElectrumRpcMessage::Notification(req)) => {
                 match req.method.as_str() {
                     BLOCKCHAIN_SCRIPTHASH_SUB_ID => {
                         if let Some(scripthash) = req.params.first().and_then(|s| s.as_str()) {
@@ -315,13 +290,20 @@ impl ElectrumConnection {
                             error!("Notification must contain the script hash value, got: {req:?}");
                         }
                     },
-                    BLOCKCHAIN_HEADERS_SUB_ID => {},
+                    BLOCKCHAIN_HEADERS_SUB_ID => match req.params.first().map(ElectrumBlockHeader::deserialize) {
+                        Some(Ok(header)) => client.notify_new_block(header.block_height()),
+                        _ => error!("Notification must contain the block header, got: {req:?}"),
+                    },
                     _ => {
                         error!("Unexpected notification method: {}", req.method);
                     },
                 }
                 return;
             },
+            Err(e) => {
+                error!("{}", e);
+                return;
+            },
         };
 
         // the corresponding sender may not exist, receiver may be dropped
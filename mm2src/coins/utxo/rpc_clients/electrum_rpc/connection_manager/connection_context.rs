@@ -1,10 +1,12 @@
-use std::collections::HashSet;
+use std::collections::{HashSet, VecDeque};
 use std::mem;
 use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::{Arc, Mutex};
+use std::time::Duration;
 
 use super::super::connection::ElectrumConnection;
-use super::super::constants::FIRST_SUSPEND_TIME;
+use super::super::constants::{CONNECTION_STATS_EWMA_ALPHA, FIRST_SUSPEND_TIME, LATENCY_SAMPLES,
+                              MIN_HEDGE_LATENCY_SAMPLES, UNHEALTHY_ERROR_RATE};
 
 use common::now_ms;
 use keys::Address;
@@ -48,6 +50,45 @@ impl SuspendTimer {
     }
 }
 
+/// The request latency and error statistics of a connection, used to route the requests to the fastest healthy one.
+#[derive(Debug, Default)]
+struct RequestStats {
+    /// The moving average of the request round trip time in milliseconds, `None` until the first response.
+    rtt_ms: Option<f64>,
+    /// The moving average of the request outcomes, where a failed request counts as 1 and a successful one as 0.
+    error_rate: f64,
+    /// The latest `LATENCY_SAMPLES` round trip times in milliseconds.
+    recent_rtts_ms: VecDeque<f64>,
+}
+
+impl RequestStats {
+    fn succeeded(&mut self, rtt: Duration) {
+        let rtt_ms = rtt.as_secs_f64() * 1000.;
+        self.rtt_ms = Some(match self.rtt_ms {
+            Some(avg) => avg + CONNECTION_STATS_EWMA_ALPHA * (rtt_ms - avg),
+            None => rtt_ms,
+        });
+        self.error_rate -= CONNECTION_STATS_EWMA_ALPHA * self.error_rate;
+        if self.recent_rtts_ms.len() == LATENCY_SAMPLES {
+            self.recent_rtts_ms.pop_front();
+        }
+        self.recent_rtts_ms.push_back(rtt_ms);
+    }
+
+    fn failed(&mut self) { self.error_rate += CONNECTION_STATS_EWMA_ALPHA * (1. - self.error_rate); }
+
+    /// Returns the 95th percentile of the recent round trip times if there are enough of them.
+    fn p95_rtt(&self) -> Option<Duration> {
+        if self.recent_rtts_ms.len() < MIN_HEDGE_LATENCY_SAMPLES {
+            return None;
+        }
+        let mut rtts: Vec<_> = self.recent_rtts_ms.iter().copied().collect();
+        rtts.sort_by(|a, b| a.total_cmp(b));
+        let index = (rtts.len() * 95 / 100).min(rtts.len() - 1);
+        Some(Duration::from_secs_f64(rtts[index] / 1000.))
+    }
+}
+
 /// A struct that encapsulates an Electrum connection and its information.
 #[derive(Debug)]
 pub struct ConnectionContext {
@@ -57,6 +98,8 @@ pub struct ConnectionContext {
     subs: Mutex<HashSet<Address>>,
     /// The timer deciding when the connection is ready to be used again.
     suspend_timer: SuspendTimer,
+    /// The latency and error statistics of the requests sent using this connection.
+    request_stats: Mutex<RequestStats>,
     /// The ID of this connection which also serves as a priority (lower is better).
     pub id: u32,
 }
@@ -68,6 +111,7 @@ impl ConnectionContext {
             connection: Arc::new(connection),
             subs: Mutex::new(HashSet::new()),
             suspend_timer: SuspendTimer::new(),
+            request_stats: Mutex::new(RequestStats::default()),
             id,
         }
     }
@@ -88,4 +132,52 @@ impl ConnectionContext {
 
     /// Adds a subscription to the connection context.
     pub(super) fn add_sub(&self, address: Address) { self.subs.lock().unwrap().insert(address); }
+
+    /// Records a successful request (or ping) that took `rtt` to be responded.
+    pub(super) fn request_succeeded(&self, rtt: Duration) { self.request_stats.lock().unwrap().succeeded(rtt); }
+
+    /// Records a failed request.
+    pub(super) fn request_failed(&self) { self.request_stats.lock().unwrap().failed(); }
+
+    /// Returns the key to sort the connections by when choosing which one to send a request to, lower is better.
+    ///
+    /// The healthy connections come first, then the connections with a lower average round trip time.
+    /// The connections that haven't responded yet come first among the healthy ones, so they get a chance to be measured,
+    /// and the ties are broken by the connection priority.
+    pub(super) fn routing_key(&self) -> (bool, u64, u32) {
+        let stats = self.request_stats.lock().unwrap();
+        let unhealthy = stats.error_rate > UNHEALTHY_ERROR_RATE;
+        let rtt_ms = stats.rtt_ms.map_or(0, |rtt_ms| rtt_ms.round() as u64);
+        (unhealthy, rtt_ms, self.id)
+    }
+
+    /// Returns the 95th percentile of the recent round trip times if enough requests have been measured.
+    pub(super) fn p95_rtt(&self) -> Option<Duration> { self.request_stats.lock().unwrap().p95_rtt() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_request_stats() {
+        let mut stats = RequestStats::default();
+        assert_eq!(stats.p95_rtt(), None);
+
+        for rtt_ms in 1..=20 {
+            stats.succeeded(Duration::from_millis(rtt_ms));
+        }
+        assert_eq!(stats.p95_rtt(), Some(Duration::from_millis(20)));
+        let rtt_ms = stats.rtt_ms.unwrap();
+        assert!(rtt_ms > 10. && rtt_ms < 20.);
+
+        for _ in 0..5 {
+            stats.failed();
+        }
+        assert!(stats.error_rate > UNHEALTHY_ERROR_RATE);
+        for _ in 0..5 {
+            stats.succeeded(Duration::from_millis(10));
+        }
+        assert!(stats.error_rate < UNHEALTHY_ERROR_RATE);
+    }
 }
@@ -1,5 +1,6 @@
 use std::collections::{BTreeMap, HashMap};
 use std::sync::{Arc, Mutex, RwLock, RwLockReadGuard, RwLockWriteGuard, Weak};
+use std::time::Duration;
 
 use super::super::client::{ElectrumClient, ElectrumClientImpl};
 use super::super::connection::{ElectrumConnection, ElectrumConnectionErr, ElectrumConnectionSettings};
@@ -178,12 +179,10 @@ impl ConnectionManager {
     /// Returns all the server addresses.
     pub fn get_all_server_addresses(&self) -> Vec<String> { self.read_connections().keys().cloned().collect() }
 
-    /// Returns all the connections.
+    /// Returns all the connections, the fastest healthy ones first.
     pub fn get_all_connections(&self) -> Vec<Arc<ElectrumConnection>> {
-        self.read_connections()
-            .values()
-            .map(|conn_ctx| conn_ctx.connection.clone())
-            .collect()
+        let all_connections = self.read_connections();
+        sorted_by_routing_key(all_connections.values())
     }
 
     /// Retrieve a specific electrum connection by its address.
@@ -209,12 +208,37 @@ impl ConnectionManager {
         Ok(connection)
     }
 
-    /// Returns a list of active/maintained connections.
+    /// Returns a list of active/maintained connections, the fastest healthy ones first.
     pub fn get_active_connections(&self) -> Vec<Arc<ElectrumConnection>> {
-        self.read_maintained_connections()
-            .iter()
-            .filter_map(|(_id, address)| self.get_connection(address))
-            .collect()
+        let all_connections = self.read_connections();
+        let maintained_connections = self.read_maintained_connections();
+        sorted_by_routing_key(
+            maintained_connections
+                .values()
+                .filter_map(|address| all_connections.get(address)),
+        )
+    }
+
+    /// Records the round trip time of a successful request sent to the server.
+    pub fn on_request_succeeded(&self, server_address: &str, rtt: Duration) {
+        let all_connections = self.read_connections();
+        let connection_ctx = unwrap_or_return!(all_connections.get(server_address));
+        connection_ctx.request_succeeded(rtt);
+    }
+
+    /// Records a failed request sent to the server.
+    pub fn on_request_failed(&self, server_address: &str) {
+        let all_connections = self.read_connections();
+        let connection_ctx = unwrap_or_return!(all_connections.get(server_address));
+        connection_ctx.request_failed();
+    }
+
+    /// Returns how long to wait for the server to respond before hedging the request to another server,
+    /// i.e. the 95th percentile of its recent round trip times. Returns `None` if there are too few measurements.
+    pub fn hedge_delay(&self, server_address: &str) -> Option<Duration> {
+        self.read_connections()
+            .get(server_address)
+            .and_then(|connection_ctx| connection_ctx.p95_rtt())
     }
 
     /// Returns a boolean `true` if the connection pool is empty, `false` otherwise.
@@ -278,6 +302,10 @@ impl ConnectionManager {
         // Re-subscribe the abandoned addresses using the client.
         let client = unwrap_or_return!(self.get_client());
         client.subscribe_addresses(abandoned_subs).error_log();
+        if let Some(unspent_cache) = &client.unspent_cache {
+            unspent_cache.on_disconnected(server_address);
+        }
+        client.chain_watch.on_disconnected(server_address);
     }
 
     /// A method that should be called after using a specific server for some request.
@@ -453,6 +481,15 @@ impl ConnectionManager {
     }
 }
 
+/// Sorts the connections by [`ConnectionContext::routing_key`].
+fn sorted_by_routing_key<'a>(connections: impl Iterator<Item = &'a ConnectionContext>) -> Vec<Arc<ElectrumConnection>> {
+    let mut connections: Vec<_> = connections
+        .map(|conn_ctx| (conn_ctx.routing_key(), conn_ctx.connection.clone()))
+        .collect();
+    connections.sort_by_key(|(routing_key, _)| *routing_key);
+    connections.into_iter().map(|(_, connection)| connection).collect()
+}
+
 // Abstractions over the accesses of the inner fields of the connection manager.
 impl ConnectionManager {
     #[inline]
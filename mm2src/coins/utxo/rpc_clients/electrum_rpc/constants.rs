@@ -14,6 +14,14 @@ pub const CUTOFF_TIMEOUT: f64 = 60.;
 pub const FIRST_SUSPEND_TIME: u64 = 10;
 /// The timeout used by the background task of the connection manager to re-check the manager's health.
 pub const BACKGROUND_TASK_WAIT_TIMEOUT: f64 = (5 * 60) as f64;
+/// The smoothing factor of the per-connection round trip time and error rate moving averages.
+pub const CONNECTION_STATS_EWMA_ALPHA: f64 = 0.2;
+/// The number of the latest round trip times kept per connection to estimate its p95 latency.
+pub const LATENCY_SAMPLES: usize = 32;
+/// A hedged request is only sent if at least this many round trip times of the primary connection are known.
+pub const MIN_HEDGE_LATENCY_SAMPLES: usize = 8;
+/// Connections whose request error rate (moving average) is above this are used after the healthy ones.
+pub const UNHEALTHY_ERROR_RATE: f64 = 0.5;
 /// Electrum methods that should not be sent without forcing the connection to be established first.
 pub const NO_FORCE_CONNECT_METHODS: &[&str] = &[
     // The server should already be connected if we are querying for its version, don't force connect.
@@ -26,6 +34,22 @@ pub const SEND_TO_ALL_METHODS: &[&str] = &[
     // A ping should be sent to all connections even if we got a response from one of them early.
     "server.ping",
 ];
+/// Electrum methods whose concurrent single requests are coalesced into batches if the client has a batch window.
+/// These are the read-only methods requested per address or per transaction.
+pub const COALESCED_METHODS: &[&str] = &[
+    "blockchain.scripthash.listunspent",
+    "blockchain.scripthash.get_balance",
+    "blockchain.scripthash.get_history",
+    "blockchain.transaction.get",
+    "blockchain.transaction.get_merkle",
+];
+/// The maximum number of requests a coalesced batch can contain.
+pub const MAX_COALESCED_BATCH_LEN: usize = 100;
+/// The longest time a swap waits for a chain update notification before polling the server anyway,
+/// in case the server stopped sending the notifications without disconnecting.
+pub const MAX_CHAIN_UPDATE_WAIT: f64 = (5 * 60) as f64;
+/// The maximum number of block headers read from the storage at once.
+pub const MAX_HEADERS_RANGE_READ: u64 = 2016;
 /// Electrum RPC method for headers subscription.
 pub const BLOCKCHAIN_HEADERS_SUB_ID: &str = "blockchain.headers.subscribe";
 /// Electrum RPC method for script/address subscription.
@@ -1,13 +1,17 @@
 use sha2::{Digest, Sha256};
 
+mod chain_watch;
 mod client;
 mod connection;
 mod connection_manager;
 mod constants;
 mod event_handlers;
+mod request_coalescer;
 mod rpc_responses;
 #[cfg(not(target_arch = "wasm32"))] mod tcp_stream;
+mod unspent_cache;
 
+pub use chain_watch::{ElectrumChainUpdate, ElectrumChainUpdates};
 pub use client::{ElectrumClient, ElectrumClientImpl, ElectrumClientSettings};
 pub use connection::ElectrumConnectionSettings;
 pub use rpc_responses::*;
@@ -0,0 +1,276 @@
+use super::client::ElectrumClient;
+use super::constants::{COALESCED_METHODS, MAX_COALESCED_BATCH_LEN};
+
+use common::executor::{SpawnFuture, Timer};
+use common::jsonrpc_client::{JsonRpcErrorType, JsonRpcRemoteAddr, JsonRpcRequest, JsonRpcRequestEnum,
+                             JsonRpcResponseEnum};
+use futures::channel::oneshot;
+use futures::future::join_all;
+use parking_lot::Mutex as PaMutex;
+use std::collections::HashMap;
+use std::fmt;
+use std::mem;
+use std::time::Duration;
+
+type TransportResult = Result<(JsonRpcRemoteAddr, JsonRpcResponseEnum), JsonRpcErrorType>;
+
+struct PendingRequest {
+    request: JsonRpcRequest,
+    result_tx: oneshot::Sender<TransportResult>,
+}
+
+/// Gathers the single requests of the [`COALESCED_METHODS`] that are issued concurrently
+/// and sends them to the electrum server as JSON-RPC batches.
+///
+/// The first request queued after a flush starts a window of `window` length,
+/// every request queued within this window is sent in the same batch (or batches of [`MAX_COALESCED_BATCH_LEN`]).
+pub struct ElectrumRequestCoalescer {
+    window: Duration,
+    pending: PaMutex<Vec<PendingRequest>>,
+}
+
+impl fmt::Debug for ElectrumRequestCoalescer {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("ElectrumRequestCoalescer")
+            .field("window", &self.window)
+            .finish()
+    }
+}
+
+impl ElectrumRequestCoalescer {
+    pub fn new(window: Duration) -> ElectrumRequestCoalescer {
+        ElectrumRequestCoalescer {
+            window,
+            pending: PaMutex::new(Vec::new()),
+        }
+    }
+
+    /// Whether the `request` should be sent through the coalescer.
+    pub fn is_coalesced(request: &JsonRpcRequest) -> bool { COALESCED_METHODS.contains(&request.method.as_str()) }
+
+    /// Queues the `request` and waits for its response.
+    pub async fn request(&self, client: &ElectrumClient, request: JsonRpcRequest) -> TransportResult {
+        let (opens_window, result_rx) = self.queue(request);
+
+        // The batch is flushed by a spawned future rather than by the request that opened the window,
+        // so that dropping this request's future doesn't leave the other requests of the window waiting forever.
+        if opens_window {
+            let client = client.clone();
+            let window = self.window;
+            client.weak_spawner().spawn(async move {
+                Timer::sleep(window.as_secs_f64()).await;
+                if let Some(coalescer) = client.request_coalescer.as_ref() {
+                    coalescer.flush(&client).await;
+                }
+            });
+        }
+
+        result_rx.await.unwrap_or_else(|_| {
+            Err(JsonRpcErrorType::Internal(
+                "The coalesced electrum request was dropped before sending".to_owned(),
+            ))
+        })
+    }
+
+    /// Queues the `request` and returns whether it's the first request of a new window.
+    fn queue(&self, request: JsonRpcRequest) -> (bool, oneshot::Receiver<TransportResult>) {
+        let (result_tx, result_rx) = oneshot::channel();
+        let mut pending = self.pending.lock();
+        pending.push(PendingRequest { request, result_tx });
+        (pending.len() == 1, result_rx)
+    }
+
+    /// Takes all the pending requests out, split into batches of at most [`MAX_COALESCED_BATCH_LEN`] requests.
+    fn take_batches(&self) -> Vec<Vec<PendingRequest>> {
+        let mut pending = mem::take(&mut *self.pending.lock());
+        let mut batches = Vec::new();
+        while pending.len() > MAX_COALESCED_BATCH_LEN {
+            let rest = pending.split_off(MAX_COALESCED_BATCH_LEN);
+            batches.push(mem::replace(&mut pending, rest));
+        }
+        batches.push(pending);
+        batches
+    }
+
+    async fn flush(&self, client: &ElectrumClient) {
+        let batches = self.take_batches();
+        join_all(batches.into_iter().map(|batch| send_batch(client.clone(), batch))).await;
+    }
+}
+
+async fn send_batch(client: ElectrumClient, mut batch: Vec<PendingRequest>) {
+    // Don't wrap a lonely request into a batch.
+    if batch.len() == 1 {
+        let PendingRequest { request, result_tx } = batch.remove(0);
+        let result = client.electrum_request_multi(JsonRpcRequestEnum::Single(request)).await;
+        result_tx.send(result).ok();
+        return;
+    }
+
+    let (requests, mut result_txs): (Vec<_>, HashMap<_, _>) = batch
+        .into_iter()
+        .map(|PendingRequest { request, result_tx }| {
+            let id = request.id;
+            (request, (id, result_tx))
+        })
+        .unzip();
+
+    let result = client
+        .electrum_request_multi(JsonRpcRequestEnum::new_batch(requests))
+        .await;
+    fan_out_batch_result(result, result_txs);
+}
+
+/// Sends every request of the batch its own response, or the error that applies to it.
+fn fan_out_batch_result(result: TransportResult, mut result_txs: HashMap<u64, oneshot::Sender<TransportResult>>) {
+    match result {
+        Ok((remote_addr, JsonRpcResponseEnum::Batch(responses))) => {
+            for response in responses {
+                if let Some(result_tx) = result_txs.remove(&response.id) {
+                    result_tx
+                        .send(Ok((remote_addr.clone(), JsonRpcResponseEnum::Single(response))))
+                        .ok();
+                }
+            }
+            for (id, result_tx) in result_txs {
+                let error = ERRL!("Coalesced batch response doesn't contain '{}' identifier", id);
+                result_tx
+                    .send(Err(JsonRpcErrorType::Parse(remote_addr.clone(), error)))
+                    .ok();
+            }
+        },
+        Ok((remote_addr, JsonRpcResponseEnum::Single(single))) => {
+            let error = ERRL!("Expected batch response, found single response: {:?}", single);
+            for (_, result_tx) in result_txs {
+                result_tx
+                    .send(Err(JsonRpcErrorType::Parse(remote_addr.clone(), error.clone())))
+                    .ok();
+            }
+        },
+        Err(e) => {
+            for (_, result_tx) in result_txs {
+                result_tx.send(Err(e.clone())).ok();
+            }
+        },
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::jsonrpc_client::JsonRpcResponse;
+    use serde_json::{self as json, json};
+
+    fn request(id: u64) -> JsonRpcRequest {
+        JsonRpcRequest {
+            jsonrpc: "2.0".to_owned(),
+            id,
+            method: "blockchain.scripthash.get_balance".to_owned(),
+            params: vec![json!(format!("scripthash{}", id))],
+        }
+    }
+
+    fn response(id: u64) -> JsonRpcResponse {
+        json::from_value(json!({"jsonrpc": "2.0", "id": id, "result": id})).unwrap()
+    }
+
+    fn pending_senders(
+        ids: &[u64],
+    ) -> (
+        HashMap<u64, oneshot::Sender<TransportResult>>,
+        Vec<(u64, oneshot::Receiver<TransportResult>)>,
+    ) {
+        let mut result_txs = HashMap::new();
+        let mut result_rxs = Vec::new();
+        for id in ids {
+            let (result_tx, result_rx) = oneshot::channel();
+            result_txs.insert(*id, result_tx);
+            result_rxs.push((*id, result_rx));
+        }
+        (result_txs, result_rxs)
+    }
+
+    #[test]
+    fn test_coalescer_queue_opens_one_window() {
+        let coalescer = ElectrumRequestCoalescer::new(Duration::from_millis(10));
+
+        let opens_window: Vec<_> = (0..3).map(|id| coalescer.queue(request(id)).0).collect();
+        assert_eq!(opens_window, vec![true, false, false]);
+
+        let batches = coalescer.take_batches();
+        assert_eq!(batches.len(), 1);
+        let ids: Vec<_> = batches[0].iter().map(|pending| pending.request.id).collect();
+        assert_eq!(ids, vec![0, 1, 2]);
+
+        // The flush empties the queue, so the next request opens a new window.
+        assert!(coalescer.queue(request(3)).0);
+    }
+
+    #[test]
+    fn test_coalescer_flush_boundary() {
+        let coalescer = ElectrumRequestCoalescer::new(Duration::from_millis(10));
+
+        for id in 0..MAX_COALESCED_BATCH_LEN as u64 {
+            let _ = coalescer.queue(request(id));
+        }
+        let lens: Vec<_> = coalescer.take_batches().iter().map(Vec::len).collect();
+        assert_eq!(lens, vec![MAX_COALESCED_BATCH_LEN]);
+
+        for id in 0..MAX_COALESCED_BATCH_LEN as u64 * 2 + 1 {
+            let _ = coalescer.queue(request(id));
+        }
+        let batches = coalescer.take_batches();
+        let lens: Vec<_> = batches.iter().map(Vec::len).collect();
+        assert_eq!(lens, vec![MAX_COALESCED_BATCH_LEN, MAX_COALESCED_BATCH_LEN, 1]);
+        // The requests keep their queue order across the batches.
+        let ids: Vec<_> = batches.iter().flatten().map(|pending| pending.request.id).collect();
+        assert_eq!(ids, (0..MAX_COALESCED_BATCH_LEN as u64 * 2 + 1).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_coalescer_fan_out_batch_response() {
+        let (result_txs, result_rxs) = pending_senders(&[1, 2, 3]);
+        // The server answers out of order and misses the request `2`.
+        let responses = json::from_value(json!([
+            {"jsonrpc": "2.0", "id": 3, "result": 3},
+            {"jsonrpc": "2.0", "id": 1, "result": 1},
+        ]))
+        .unwrap();
+        let remote_addr = JsonRpcRemoteAddr("electrum1".to_owned());
+        fan_out_batch_result(Ok((remote_addr, JsonRpcResponseEnum::Batch(responses))), result_txs);
+
+        for (id, mut result_rx) in result_rxs {
+            match result_rx.try_recv().unwrap().expect("Result must be sent") {
+                Ok((_, JsonRpcResponseEnum::Single(response))) => {
+                    assert_ne!(id, 2);
+                    assert_eq!(response.id, id);
+                    assert_eq!(response.result, json!(id));
+                },
+                Err(JsonRpcErrorType::Parse(remote_addr, _)) => {
+                    assert_eq!(id, 2);
+                    assert_eq!(remote_addr.0, "electrum1");
+                },
+                other => panic!("Unexpected result for '{}': {:?}", id, other),
+            }
+        }
+    }
+
+    #[test]
+    fn test_coalescer_fan_out_errors() {
+        let (result_txs, result_rxs) = pending_senders(&[1, 2]);
+        let error = JsonRpcErrorType::Transport("connection lost".to_owned());
+        fan_out_batch_result(Err(error), result_txs);
+        for (_, mut result_rx) in result_rxs {
+            let result = result_rx.try_recv().unwrap().expect("Result must be sent");
+            assert!(matches!(result, Err(JsonRpcErrorType::Transport(ref e)) if e == "connection lost"));
+        }
+
+        let (result_txs, result_rxs) = pending_senders(&[1, 2]);
+        let remote_addr = JsonRpcRemoteAddr("electrum1".to_owned());
+        fan_out_batch_result(Ok((remote_addr, JsonRpcResponseEnum::Single(response(1)))), result_txs);
+        for (_, mut result_rx) in result_rxs {
+            let result = result_rx.try_recv().unwrap().expect("Result must be sent");
+            assert!(matches!(result, Err(JsonRpcErrorType::Parse(..))));
+        }
+    }
+}
@@ -1,8 +1,67 @@
 use bitcrypto::dhash256;
 use chain::{BlockHeader, BlockHeaderBits, BlockHeaderNonce, Transaction as UtxoTx};
+use common::jsonrpc_client::{JsonRpcBatchResponse, JsonRpcRequest, JsonRpcResponse, JsonRpcResponseEnum};
 use mm2_number::{BigDecimal, BigInt};
 use rpc::v1::types::{Bytes as BytesJson, H256 as H256Json};
-use serialization::serialize;
+use serde_json::Value as Json;
+use serialization::{serialize, CoinVariant, Reader};
+
+/// A message received from the electrum server.
+#[derive(Debug)]
+pub enum ElectrumRpcMessage {
+    /// The response to a single or a batch request.
+    Response(JsonRpcResponseEnum),
+    /// The subscription notification, which the server sends as a JSONRPC request.
+    Notification(JsonRpcRequest),
+}
+
+/// Any single JSONRPC message: a response or a notification.
+#[derive(Deserialize)]
+struct ElectrumSingleMessage {
+    #[serde(default)]
+    jsonrpc: String,
+    #[serde(default)]
+    id: u64,
+    method: Option<String>,
+    #[serde(default)]
+    params: Vec<Json>,
+    #[serde(default)]
+    result: Json,
+    #[serde(default)]
+    error: Json,
+}
+
+impl ElectrumRpcMessage {
+    /// Decodes the message in a single pass over the `bytes`.
+    ///
+    /// An untagged enum of the possible messages would first buffer the whole message into an intermediate tree
+    /// to try the variants one by one, which doubles the allocations for the large responses.
+    /// The batch responses are told by their first byte instead, and a single message is a notification if it has a method.
+    pub fn from_slice(bytes: &[u8]) -> serde_json::Result<ElectrumRpcMessage> {
+        let is_batch = bytes.iter().find(|byte| !byte.is_ascii_whitespace()) == Some(&b'[');
+        if is_batch {
+            let batch: JsonRpcBatchResponse = serde_json::from_slice(bytes)?;
+            return Ok(ElectrumRpcMessage::Response(JsonRpcResponseEnum::Batch(batch)));
+        }
+
+        let message: ElectrumSingleMessage = serde_json::from_slice(bytes)?;
+        let message = match message.method {
+            Some(method) => ElectrumRpcMessage::Notification(JsonRpcRequest {
+                jsonrpc: message.jsonrpc,
+                id: message.id,
+                method,
+                params: message.params,
+            }),
+            None => ElectrumRpcMessage::Response(JsonRpcResponseEnum::Single(JsonRpcResponse {
+                jsonrpc: message.jsonrpc,
+                id: message.id,
+                result: message.result,
+                error: message.error,
+            })),
+        };
+        Ok(message)
+    }
+}
 
 #[derive(Debug, Deserialize)]
 pub struct ElectrumTxHistoryItem {
@@ -44,6 +103,14 @@ pub struct ElectrumBlockHeadersRes {
     max: u64,
 }
 
+impl ElectrumBlockHeadersRes {
+    /// Deserializes the `count` headers right from the `hex` payload, without copying it into a length-prefixed list.
+    pub fn block_headers(&self, coin_variant: CoinVariant) -> Result<Vec<BlockHeader>, serialization::Error> {
+        let mut reader = Reader::new_with_coin_variant(&self.hex.0, coin_variant);
+        (0..self.count).map(|_| reader.read()).collect()
+    }
+}
+
 /// The block header compatible with Electrum 1.2
 #[derive(Clone, Debug, Deserialize)]
 pub struct ElectrumBlockHeaderV12 {
@@ -167,3 +234,40 @@ pub struct ElectrumProtocolVersion {
     pub server_software_version: String,
     pub protocol_version: String,
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_electrum_rpc_message_from_slice() {
+        let response = br#"{"jsonrpc":"2.0","id":3,"result":{"confirmed":1,"unconfirmed":0}}"#;
+        match ElectrumRpcMessage::from_slice(response).unwrap() {
+            ElectrumRpcMessage::Response(JsonRpcResponseEnum::Single(single)) => {
+                assert_eq!(single.id, 3);
+                assert_eq!(single.result["confirmed"], 1);
+                assert!(single.error.is_null());
+            },
+            message => panic!("Unexpected message {:?}", message),
+        }
+
+        let batch = br#" [{"jsonrpc":"2.0","id":4,"result":null},{"jsonrpc":"2.0","id":5,"error":"oops"}]"#;
+        match ElectrumRpcMessage::from_slice(batch).unwrap() {
+            ElectrumRpcMessage::Response(JsonRpcResponseEnum::Batch(batch)) => {
+                let ids: Vec<_> = batch.into_iter().map(|response| response.id).collect();
+                assert_eq!(ids, vec![4, 5]);
+            },
+            message => panic!("Unexpected message {:?}", message),
+        }
+
+        let notification =
+            br#"{"jsonrpc":"2.0","method":"blockchain.scripthash.subscribe","params":["hash","status"]}"#;
+        match ElectrumRpcMessage::from_slice(notification).unwrap() {
+            ElectrumRpcMessage::Notification(request) => {
+                assert_eq!(request.method, "blockchain.scripthash.subscribe");
+                assert_eq!(request.params[0], "hash");
+            },
+            message => panic!("Unexpected message {:?}", message),
+        }
+    }
+}
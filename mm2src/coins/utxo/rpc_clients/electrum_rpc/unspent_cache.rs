@@ -0,0 +1,128 @@
+//! The in-memory cache of the `blockchain.scripthash.listunspent` results.
+//!
+//! Order creation, the maker balance checks and `max_maker_vol` list the unspents of the same addresses repeatedly.
+//! The cache keeps the unspents of a script hash once the client is subscribed to it, so they are requested again
+//! only after the server notifies about a change of the script hash status (a new transaction or a confirmation)
+//! or after the connection the subscription was made with is lost.
+
+use super::rpc_responses::ElectrumUnspent;
+
+use std::collections::{HashMap, HashSet};
+use std::sync::Mutex;
+
+#[derive(Debug, Default)]
+struct UnspentCacheState {
+    /// The subscribed script hashes and the address of the server each of them is subscribed with.
+    subscribed: HashMap<String, String>,
+    /// The script hashes being subscribed to at the moment.
+    subscribing: HashSet<String>,
+    unspents: HashMap<String, Vec<ElectrumUnspent>>,
+    /// Bumped on every change of the subscriptions or invalidation, so that the unspents
+    /// requested before it aren't cached.
+    generation: u64,
+}
+
+#[derive(Debug, Default)]
+pub struct ElectrumUnspentCache {
+    state: Mutex<UnspentCacheState>,
+}
+
+impl ElectrumUnspentCache {
+    /// Returns the value to pass to [`ElectrumUnspentCache::insert`] along with the unspents requested after this call.
+    pub fn generation(&self) -> u64 { self.state.lock().unwrap().generation }
+
+    pub fn get(&self, script_hash: &str) -> Option<Vec<ElectrumUnspent>> {
+        self.state.lock().unwrap().unspents.get(script_hash).cloned()
+    }
+
+    /// Caches the `unspents` if the script hash is subscribed and nothing has been invalidated since `generation`.
+    pub fn insert(&self, generation: u64, script_hash: &str, unspents: Vec<ElectrumUnspent>) {
+        let mut state = self.state.lock().unwrap();
+        if state.generation == generation && state.subscribed.contains_key(script_hash) {
+            state.unspents.insert(script_hash.to_owned(), unspents);
+        }
+    }
+
+    pub fn is_subscribed(&self, script_hash: &str) -> bool {
+        self.state.lock().unwrap().subscribed.contains_key(script_hash)
+    }
+
+    /// Returns `true` if the caller should subscribe to the script hash,
+    /// i.e. it isn't subscribed yet and no one else is subscribing to it at the moment.
+    pub fn start_subscribing(&self, script_hash: &str) -> bool {
+        let mut state = self.state.lock().unwrap();
+        if state.subscribed.contains_key(script_hash) {
+            return false;
+        }
+        state.subscribing.insert(script_hash.to_owned())
+    }
+
+    pub fn on_subscribed(&self, script_hash: String, server_address: String) {
+        let mut state = self.state.lock().unwrap();
+        state.subscribing.remove(&script_hash);
+        state.subscribed.insert(script_hash, server_address);
+        // The unspents requested before the subscription could miss a change no notification will come for.
+        state.generation += 1;
+    }
+
+    pub fn on_subscription_failed(&self, script_hash: &str) {
+        self.state.lock().unwrap().subscribing.remove(script_hash);
+    }
+
+    /// Handles the script hash status change notification.
+    pub fn invalidate(&self, script_hash: &str) {
+        let mut state = self.state.lock().unwrap();
+        state.unspents.remove(script_hash);
+        state.generation += 1;
+    }
+
+    /// Forgets the subscriptions made with the disconnected server as the server won't notify about them anymore.
+    pub fn on_disconnected(&self, server_address: &str) {
+        let mut state = self.state.lock().unwrap();
+        let UnspentCacheState {
+            subscribed, unspents, ..
+        } = &mut *state;
+        subscribed.retain(|script_hash, address| {
+            let keep = address != server_address;
+            if !keep {
+                unspents.remove(script_hash);
+            }
+            keep
+        });
+        state.generation += 1;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_electrum_unspent_cache() {
+        let cache = ElectrumUnspentCache::default();
+        let generation = cache.generation();
+        // not subscribed yet
+        cache.insert(generation, "hash", Vec::new());
+        assert!(cache.get("hash").is_none());
+
+        assert!(cache.start_subscribing("hash"));
+        assert!(!cache.start_subscribing("hash"));
+        cache.on_subscribed("hash".to_owned(), "server".to_owned());
+        assert!(!cache.start_subscribing("hash"));
+
+        // requested before the subscription
+        cache.insert(generation, "hash", Vec::new());
+        assert!(cache.get("hash").is_none());
+
+        cache.insert(cache.generation(), "hash", Vec::new());
+        assert!(cache.get("hash").map_or(false, |unspents| unspents.is_empty()));
+
+        cache.invalidate("hash");
+        assert!(cache.get("hash").is_none());
+
+        cache.insert(cache.generation(), "hash", Vec::new());
+        cache.on_disconnected("server");
+        assert!(cache.get("hash").is_none());
+        assert!(cache.start_subscribing("hash"));
+    }
+}
@@ -8,6 +8,7 @@ use std::sync::Arc;
 
 pub mod dummy_tx_cache;
 #[cfg(not(target_arch = "wasm32"))] pub mod fs_tx_cache;
+#[cfg(not(target_arch = "wasm32"))] pub mod sqlite_tx_cache;
 
 #[cfg(target_arch = "wasm32")]
 pub mod wasm_tx_cache {
@@ -17,7 +18,7 @@ pub mod wasm_tx_cache {
 pub type TxCacheResult<T> = MmResult<T, TxCacheError>;
 pub type UtxoVerboseCacheShared = Arc<dyn UtxoVerboseCacheOps + Send + Sync + 'static>;
 
-#[derive(Debug, Display)]
+#[derive(Clone, Debug, Display)]
 pub enum TxCacheError {
     ErrorLoading(String),
     ErrorSaving(String),
@@ -0,0 +1,309 @@
+//! The verbose transactions cache backed by a single SQLite database.
+//!
+//! [`FsVerboseCache`](super::fs_tx_cache::FsVerboseCache) writes every transaction as a separate JSON file,
+//! which ends up in huge directories and an fsync per transaction as the cache grows.
+//! [`SqliteVerboseCache`] keeps the transactions MessagePack-encoded in one table indexed by txid,
+//! loads a set of transactions with a single query and writes them in a single database transaction.
+//!
+//! The database is placed in the same `TX_CACHE` directory the file cache used,
+//! and the transaction files found there are moved into the database when it's opened for the first time.
+
+use crate::utxo::tx_cache::{TxCacheError, TxCacheResult, UtxoVerboseCacheOps};
+use async_trait::async_trait;
+use common::async_blocking;
+use common::log::{error, info};
+use db_common::sqlite::run_optimization_pragmas;
+use db_common::sqlite::rusqlite::{params, params_from_iter, Connection, Error as SqlError};
+use mm2_err_handle::prelude::*;
+use parking_lot::Mutex as PaMutex;
+use rpc::v1::types::{Transaction as RpcTransaction, H256 as H256Json};
+use std::collections::{HashMap, HashSet};
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Once};
+
+const TX_CACHE_DB_NAME: &str = "tx_cache.sqlite";
+/// The number of transactions loaded with one query, it must not exceed the SQLite variable number limit.
+const LOAD_CHUNK_LEN: usize = 500;
+/// The number of transaction files moved into the database in one database transaction.
+const MIGRATION_BATCH_LEN: usize = 1000;
+
+const CREATE_VERBOSE_TXS_TABLE_SQL: &str = "CREATE TABLE IF NOT EXISTS verbose_txs (
+    txid BLOB NOT NULL PRIMARY KEY,
+    tx BLOB NOT NULL
+) WITHOUT ROWID;";
+const INSERT_VERBOSE_TX_SQL: &str = "INSERT OR REPLACE INTO verbose_txs (txid, tx) VALUES (?1, ?2);";
+
+lazy_static! {
+    /// The caches of all coins share the same database, so they share the connection to it too.
+    static ref TX_CACHE_CONNECTIONS: PaMutex<HashMap<PathBuf, Arc<TxCacheDb>>> = PaMutex::new(HashMap::new());
+}
+
+/// The connection to the database of a `TX_CACHE` directory.
+struct TxCacheDb {
+    conn: PaMutex<Connection>,
+    /// Moves the file cache into the database once, the other users of the database wait for it to complete.
+    fs_cache_migration: Once,
+}
+
+/// The cache instance that assigned to a specified coin.
+///
+/// Please note [`SqliteVerboseCache::ticker`] may not equal to [`Coin::ticker`], see [`FsVerboseCache`](super::fs_tx_cache::FsVerboseCache).
+#[derive(Debug)]
+pub struct SqliteVerboseCache {
+    ticker: String,
+    tx_cache_path: PathBuf,
+}
+
+#[async_trait]
+impl UtxoVerboseCacheOps for SqliteVerboseCache {
+    async fn load_transactions_from_cache_concurrently(
+        &self,
+        tx_ids: HashSet<H256Json>,
+    ) -> HashMap<H256Json, TxCacheResult<Option<RpcTransaction>>> {
+        let tx_cache_path = self.tx_cache_path.clone();
+        let tx_ids: Vec<_> = tx_ids.into_iter().collect();
+        async_blocking(move || {
+            let db = match tx_cache_db(&tx_cache_path) {
+                Ok(db) => db,
+                Err(e) => {
+                    let e = MmError::new(TxCacheError::ErrorLoading(e));
+                    return tx_ids.into_iter().map(|txid| (txid, Err(e.clone()))).collect();
+                },
+            };
+            let conn = db.conn.lock();
+            load_transactions(&conn, tx_ids)
+        })
+        .await
+    }
+
+    async fn cache_transactions_concurrently(&self, txs: &HashMap<H256Json, RpcTransaction>) {
+        if txs.is_empty() {
+            return;
+        }
+        let encoded: TxCacheResult<Vec<_>> = txs
+            .values()
+            .map(|tx| encode_transaction(tx).map(|encoded| (tx.txid, encoded)))
+            .collect();
+        let encoded = match encoded {
+            Ok(encoded) => encoded,
+            Err(e) => {
+                error!("Error caching {} transactions: {}", self.ticker, e);
+                return;
+            },
+        };
+
+        let tx_cache_path = self.tx_cache_path.clone();
+        let result = async_blocking(move || {
+            let db = tx_cache_db(&tx_cache_path).map_to_mm(TxCacheError::ErrorSaving)?;
+            let mut conn = db.conn.lock();
+            insert_transactions(&mut conn, &encoded).map_to_mm(|e| TxCacheError::ErrorSaving(e.to_string()))
+        })
+        .await;
+        if let Err(e) = result {
+            error!("Error caching {} transactions: {}", self.ticker, e);
+        }
+    }
+}
+
+impl SqliteVerboseCache {
+    #[inline]
+    pub fn new(ticker: String, tx_cache_path: PathBuf) -> SqliteVerboseCache {
+        SqliteVerboseCache { ticker, tx_cache_path }
+    }
+}
+
+#[inline]
+fn encode_transaction(tx: &RpcTransaction) -> TxCacheResult<Vec<u8>> {
+    // The named encoding is used as `RpcTransaction` skips some of the fields on serializing.
+    rmp_serde::to_vec_named(tx).map_to_mm(|e| TxCacheError::ErrorSerializing(e.to_string()))
+}
+
+#[inline]
+fn decode_transaction(encoded: &[u8]) -> TxCacheResult<RpcTransaction> {
+    rmp_serde::from_slice(encoded).map_to_mm(|e| TxCacheError::ErrorDeserializing(e.to_string()))
+}
+
+/// Returns the database in the `tx_cache_path` directory, opens and initializes it if needed.
+///
+/// The file cache is moved into the database outside of the [`TX_CACHE_CONNECTIONS`] lock,
+/// so that it doesn't block the coins that use the other `TX_CACHE` directories.
+fn tx_cache_db(tx_cache_path: &Path) -> Result<Arc<TxCacheDb>, String> {
+    let db = {
+        let mut connections = TX_CACHE_CONNECTIONS.lock();
+        match connections.get(tx_cache_path) {
+            Some(db) => db.clone(),
+            None => {
+                let db = Arc::new(TxCacheDb {
+                    conn: PaMutex::new(open_tx_cache_db(tx_cache_path)?),
+                    fs_cache_migration: Once::new(),
+                });
+                connections.insert(tx_cache_path.to_path_buf(), db.clone());
+                db
+            },
+        }
+    };
+    db.fs_cache_migration
+        .call_once(|| migrate_fs_cache(&mut db.conn.lock(), tx_cache_path));
+    Ok(db)
+}
+
+fn open_tx_cache_db(tx_cache_path: &Path) -> Result<Connection, String> {
+    fs::create_dir_all(tx_cache_path).map_err(|e| e.to_string())?;
+    let conn = Connection::open(tx_cache_path.join(TX_CACHE_DB_NAME)).map_err(|e| e.to_string())?;
+    run_optimization_pragmas(&conn).map_err(|e| e.to_string())?;
+    conn.execute(CREATE_VERBOSE_TXS_TABLE_SQL, [])
+        .map_err(|e| e.to_string())?;
+    Ok(conn)
+}
+
+fn load_transactions(
+    conn: &Connection,
+    tx_ids: Vec<H256Json>,
+) -> HashMap<H256Json, TxCacheResult<Option<RpcTransaction>>> {
+    let mut result = HashMap::with_capacity(tx_ids.len());
+    for chunk in tx_ids.chunks(LOAD_CHUNK_LEN) {
+        let sql = format!(
+            "SELECT txid, tx FROM verbose_txs WHERE txid IN ({});",
+            vec!["?"; chunk.len()].join(",")
+        );
+        let rows = conn.prepare(&sql).and_then(|mut stmt| {
+            stmt.query_map(params_from_iter(chunk.iter().map(|txid| txid.0.to_vec())), |row| {
+                Ok((row.get::<_, Vec<u8>>(0)?, row.get::<_, Vec<u8>>(1)?))
+            })?
+            .collect::<Result<Vec<_>, _>>()
+        });
+        let rows = match rows {
+            Ok(rows) => rows,
+            Err(e) => {
+                let e = TxCacheError::ErrorLoading(e.to_string());
+                result.extend(chunk.iter().map(|txid| (*txid, MmError::err(e.clone()))));
+                continue;
+            },
+        };
+
+        let mut found: HashMap<_, _> = rows.into_iter().collect();
+        for txid in chunk {
+            let res = match found.remove(txid.0.as_slice()) {
+                Some(encoded) => decode_transaction(&encoded).map(Some),
+                None => Ok(None),
+            };
+            result.insert(*txid, res);
+        }
+    }
+    result
+}
+
+/// Inserts the transactions in a single database transaction.
+fn insert_transactions(conn: &mut Connection, txs: &[(H256Json, Vec<u8>)]) -> Result<(), SqlError> {
+    let sql_transaction = conn.transaction()?;
+    {
+        let mut stmt = sql_transaction.prepare_cached(INSERT_VERBOSE_TX_SQL)?;
+        for (txid, encoded) in txs {
+            stmt.execute(params![txid.0.as_slice(), encoded])?;
+        }
+    }
+    sql_transaction.commit()
+}
+
+/// Moves the transactions cached by [`FsVerboseCache`](super::fs_tx_cache::FsVerboseCache) into the database.
+///
+/// The transaction files are removed once they are inserted, so the migration continues from where it stopped
+/// if it's interrupted, and the files that can't be decoded are removed as they would have been requested again anyway.
+fn migrate_fs_cache(conn: &mut Connection, tx_cache_path: &Path) {
+    let entries = match fs::read_dir(tx_cache_path) {
+        Ok(entries) => entries,
+        Err(e) => {
+            error!("Error reading the transaction cache {}: {}", tx_cache_path.display(), e);
+            return;
+        },
+    };
+    // The file cache named the transaction files by their txid.
+    let tx_files = entries
+        .filter_map(|entry| entry.ok().map(|entry| entry.path()))
+        .filter(|path| {
+            path.file_name().and_then(|name| name.to_str()).map_or(false, |name| {
+                name.len() == 64 && name.bytes().all(|byte| byte.is_ascii_hexdigit())
+            })
+        });
+
+    let mut migrated = 0;
+    let mut batch = Vec::with_capacity(MIGRATION_BATCH_LEN);
+    let mut batch_files = Vec::with_capacity(MIGRATION_BATCH_LEN);
+    for path in tx_files {
+        let tx = fs::read(&path)
+            .ok()
+            .and_then(|content| serde_json::from_slice::<RpcTransaction>(&content).ok());
+        if let Some(encoded) = tx.and_then(|tx| encode_transaction(&tx).ok().map(|encoded| (tx.txid, encoded))) {
+            batch.push(encoded);
+        }
+        batch_files.push(path);
+
+        if batch_files.len() >= MIGRATION_BATCH_LEN
+            && !flush_migration_batch(conn, &mut batch, &mut batch_files, &mut migrated)
+        {
+            return;
+        }
+    }
+    if !batch_files.is_empty() && !flush_migration_batch(conn, &mut batch, &mut batch_files, &mut migrated) {
+        return;
+    }
+    if migrated > 0 {
+        info!("Moved {} cached transactions into {}", migrated, TX_CACHE_DB_NAME);
+    }
+}
+
+/// Returns `false` if the migration should be stopped.
+fn flush_migration_batch(
+    conn: &mut Connection,
+    batch: &mut Vec<(H256Json, Vec<u8>)>,
+    batch_files: &mut Vec<PathBuf>,
+    migrated: &mut usize,
+) -> bool {
+    if let Err(e) = insert_transactions(conn, batch) {
+        error!("Error moving the cached transactions into {}: {}", TX_CACHE_DB_NAME, e);
+        return false;
+    }
+    *migrated += batch.len();
+    batch.clear();
+    for path in batch_files.drain(..) {
+        fs::remove_file(&path).ok();
+    }
+    true
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::block_on;
+    use mm2_io::fs::write_json;
+
+    const TX_JSON: &str = r#"{"hex":"0400008085202f8901afcadb73880bc1c9e7ce96b8274c2e2a4547415e649f425f98791685be009b73020000006b483045022100b8fbb77efea482b656ad16fc53c5a01d289054c2e429bf1d7bab16c3e822a83602200b87368a95c046b2ce6d0d092185138a3f234a7eb0d7f8227b196ef32358b93f012103b1e544ce2d860219bc91314b5483421a553a7b33044659eff0be9214ed58adddffffffff01dd15c293000000001976a91483762a373935ca241d557dfce89171d582b486de88ac99fe9960000000000000000000000000000000","txid":"535ffa3387d3fca14f4a4d373daf7edf00e463982755afce89bc8c48d8168024","hash":null,"size":null,"vsize":null,"version":4,"locktime":1620704921,"vin":[{"txid":"739b00be851679985f429f645e4147452a2e4c27b896cee7c9c10b8873dbcaaf","vout":2,"scriptSig":{"asm":"3045022100b8fbb77efea482b656ad16fc53c5a01d289054c2e429bf1d7bab16c3e822a83602200b87368a95c046b2ce6d0d092185138a3f234a7eb0d7f8227b196ef32358b93f[ALL] 03b1e544ce2d860219bc91314b5483421a553a7b33044659eff0be9214ed58addd","hex":"483045022100b8fbb77efea482b656ad16fc53c5a01d289054c2e429bf1d7bab16c3e822a83602200b87368a95c046b2ce6d0d092185138a3f234a7eb0d7f8227b196ef32358b93f012103b1e544ce2d860219bc91314b5483421a553a7b33044659eff0be9214ed58addd"},"sequence":4294967295,"txinwitness":null}],"vout":[{"value":24.78970333,"n":0,"scriptPubKey":{"asm":"OP_DUP OP_HASH160 83762a373935ca241d557dfce89171d582b486de OP_EQUALVERIFY OP_CHECKSIG","hex":"76a91483762a373935ca241d557dfce89171d582b486de88ac","reqSigs":1,"type":"pubkeyhash","addresses":["RMGJ9tRST45RnwEKHPGgBLuY3moSYP7Mhk"]}}],"blockhash":"0b438a8e50afddb38fb1c7be4536ffc7f7723b76bbc5edf7c28f2c17924dbdfa","confirmations":33186,"rawconfirmations":33186,"time":1620705483,"blocktime":1620705483,"height":2387532}"#;
+
+    #[test]
+    fn test_sqlite_verbose_cache() {
+        let tx_cache_path = std::env::temp_dir().join(format!("test_sqlite_verbose_cache_{}", std::process::id()));
+        fs::remove_dir_all(&tx_cache_path).ok();
+        fs::create_dir_all(&tx_cache_path).unwrap();
+
+        // the transaction cached by the file cache is moved into the database on the first access
+        let tx: RpcTransaction = serde_json::from_str(TX_JSON).unwrap();
+        let tx_file = tx_cache_path.join(format!("{:?}", tx.txid));
+        block_on(write_json(&tx, &tx_file, true)).unwrap();
+
+        let cache = SqliteVerboseCache::new("RICK".to_owned(), tx_cache_path.clone());
+        let unknown_txid = H256Json::from([1; 32]);
+        let loaded = block_on(cache.load_transactions_from_cache_concurrently(HashSet::from([tx.txid, unknown_txid])));
+        assert_eq!(loaded[&tx.txid].as_ref().unwrap().as_ref(), Some(&tx));
+        assert_eq!(loaded[&unknown_txid].as_ref().unwrap(), &None);
+        assert!(!tx_file.exists());
+
+        let mut other_tx = tx.clone();
+        other_tx.txid = unknown_txid;
+        block_on(cache.cache_transactions_concurrently(&HashMap::from([(unknown_txid, other_tx.clone())])));
+        let loaded = block_on(cache.load_transactions_from_cache_concurrently(HashSet::from([unknown_txid])));
+        assert_eq!(loaded[&unknown_txid].as_ref().unwrap().as_ref(), Some(&other_tx));
+
+        fs::remove_dir_all(&tx_cache_path).ok();
+    }
+}
@@ -89,6 +89,14 @@ impl BlockHeaderStorageOps for BlockHeaderStorage {
         self.inner.get_block_header(height).await
     }
 
+    async fn get_block_headers_in_range(
+        &self,
+        from: u64,
+        to: u64,
+    ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError> {
+        self.inner.get_block_headers_in_range(from, to).await
+    }
+
     async fn get_block_header_raw(&self, height: u64) -> Result<Option<String>, BlockHeaderStorageError> {
         self.inner.get_block_header_raw(height).await
     }
@@ -176,6 +184,35 @@ mod block_headers_storage_tests {
         assert_eq!(height, 520481);
     }
 
+    pub(crate) async fn test_get_block_headers_in_range_impl(for_coin: &str) {
+        let ctx = mm_ctx_with_custom_db();
+        let storage = BlockHeaderStorage::new_from_ctx(ctx, for_coin.to_string())
+            .unwrap()
+            .into_inner();
+        storage.init().await.unwrap();
+
+        let mut headers = HashMap::with_capacity(3);
+        // https://live.blockcypher.com/btc-testnet/block/00000000961a9d117feb57e516e17217207a849bf6cdfce529f31d9a96053530/
+        let block_header: BlockHeader = "02000000ea01a61a2d7420a1b23875e40eb5eb4ca18b378902c8e6384514ad0000000000c0c5a1ae80582b3fe319d8543307fa67befc2a734b8eddb84b1780dfdf11fa2b20e71353ffff001d00805fe0".into();
+        headers.insert(201595, block_header);
+
+        // https://live.blockcypher.com/btc-testnet/block/0000000000ad144538e6c80289378ba14cebb50ee47538b2a120742d1aa601ea/
+        let block_header: BlockHeader = "02000000cbed7fd98f1f06e85c47e13ff956533642056be45e7e6b532d4d768f00000000f2680982f333fcc9afa7f9a5e2a84dc54b7fe10605cd187362980b3aa882e9683be21353ab80011c813e1fc0".into();
+        headers.insert(201594, block_header);
+
+        let block_header: BlockHeader = "020000001f38c8e30b30af912fbd4c3e781506713cfb43e73dff6250348e060000000000afa8f3eede276ccb4c4ee649ad9823fc181632f262848ca330733e7e7e541beb9be51353ffff001d00a63037".into();
+        headers.insert(201593, block_header);
+
+        storage.add_block_headers_to_storage(headers.clone()).await.unwrap();
+
+        let actual = storage.get_block_headers_in_range(201594, 201600).await.unwrap();
+        headers.remove(&201593);
+        assert_eq!(actual, headers);
+
+        let actual = storage.get_block_headers_in_range(201596, 201600).await.unwrap();
+        assert!(actual.is_empty());
+    }
+
     pub(crate) async fn test_get_last_block_header_with_non_max_bits_impl(for_coin: &str) {
         let ctx = mm_ctx_with_custom_db();
         let storage = BlockHeaderStorage::new_from_ctx(ctx, for_coin.to_string())
@@ -318,6 +355,9 @@ mod native_tests {
     #[test]
     fn test_test_get_block_header() { block_on(test_get_block_header_impl(FOR_COIN_GET)) }
 
+    #[test]
+    fn test_get_block_headers_in_range() { block_on(test_get_block_headers_in_range_impl(FOR_COIN_GET)) }
+
     #[test]
     fn test_get_last_block_header_with_non_max_bits() {
         block_on(test_get_last_block_header_with_non_max_bits_impl(FOR_COIN_GET))
@@ -365,6 +405,9 @@ mod wasm_test {
     #[wasm_bindgen_test]
     async fn test_test_get_block_header() { test_get_block_header_impl(FOR_COIN).await }
 
+    #[wasm_bindgen_test]
+    async fn test_get_block_headers_in_range() { test_get_block_headers_in_range_impl(FOR_COIN).await }
+
     #[wasm_bindgen_test]
     async fn test_get_last_block_header_with_non_max_bits() {
         test_get_last_block_header_with_non_max_bits_impl(FOR_COIN).await
@@ -57,6 +57,16 @@ fn get_block_header_by_height(for_coin: &str) -> Result<String, BlockHeaderStora
     Ok(sql)
 }
 
+fn get_block_headers_in_range_sql(for_coin: &str) -> Result<String, BlockHeaderStorageError> {
+    let table_name = get_table_name_and_validate(for_coin)?;
+    let sql = format!(
+        "SELECT block_height, hex FROM {} WHERE block_height BETWEEN ?1 AND ?2;",
+        table_name
+    );
+
+    Ok(sql)
+}
+
 fn get_last_block_height_sql(for_coin: &str) -> Result<String, BlockHeaderStorageError> {
     let table_name = get_table_name_and_validate(for_coin)?;
     let sql = format!(
@@ -97,6 +107,20 @@ fn remove_headers_from_to_height_sql(for_coin: &str) -> Result<String, BlockHead
     Ok(sql)
 }
 
+fn decode_block_header(coin: &str, header_raw: &str) -> Result<BlockHeader, BlockHeaderStorageError> {
+    let serialized = &hex::decode(header_raw).map_err(|e| BlockHeaderStorageError::DecodeError {
+        coin: coin.to_string(),
+        reason: e.to_string(),
+    })?;
+    let mut reader = Reader::new_with_coin_variant(serialized, coin.into());
+    reader
+        .read()
+        .map_err(|e: serialization::Error| BlockHeaderStorageError::DecodeError {
+            coin: coin.to_string(),
+            reason: e.to_string(),
+        })
+}
+
 #[derive(Clone, Debug)]
 pub struct SqliteBlockHeadersStorage {
     pub ticker: String,
@@ -202,23 +226,48 @@ impl BlockHeaderStorageOps for SqliteBlockHeadersStorage {
     }
 
     async fn get_block_header(&self, height: u64) -> Result<Option<BlockHeader>, BlockHeaderStorageError> {
-        let coin = self.ticker.clone();
-        if let Some(header_raw) = self.get_block_header_raw(height).await? {
-            let serialized = &hex::decode(header_raw).map_err(|e| BlockHeaderStorageError::DecodeError {
-                coin: coin.clone(),
-                reason: e.to_string(),
-            })?;
-            let mut reader = Reader::new_with_coin_variant(serialized, coin.as_str().into());
-            let header: BlockHeader =
-                reader
-                    .read()
-                    .map_err(|e: serialization::Error| BlockHeaderStorageError::DecodeError {
-                        coin,
-                        reason: e.to_string(),
-                    })?;
-            return Ok(Some(header));
+        match self.get_block_header_raw(height).await? {
+            Some(header_raw) => decode_block_header(&self.ticker, &header_raw).map(Some),
+            None => Ok(None),
         }
-        Ok(None)
+    }
+
+    async fn get_block_headers_in_range(
+        &self,
+        from: u64,
+        to: u64,
+    ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError> {
+        let coin = self.ticker.clone();
+        let sql = get_block_headers_in_range_sql(&coin)?;
+        let params = [from as i64, to as i64];
+        let selfi = self.clone();
+
+        async_blocking(move || {
+            let conn = selfi.conn.lock().unwrap();
+            let mut stmt = conn
+                .prepare_cached(&sql)
+                .map_err(|e| BlockHeaderStorageError::QueryError {
+                    query: sql.clone(),
+                    reason: e.to_string(),
+                })?;
+            let rows = stmt
+                .query_map(params, |row| Ok((row.get::<_, i64>(0)?, row.get::<_, String>(1)?)))
+                .map_err(|e| BlockHeaderStorageError::QueryError {
+                    query: sql.clone(),
+                    reason: e.to_string(),
+                })?;
+
+            let mut headers = HashMap::new();
+            for row in rows {
+                let (height, header_raw) = row.map_err(|e| BlockHeaderStorageError::GetFromStorageError {
+                    coin: coin.clone(),
+                    reason: e.to_string(),
+                })?;
+                headers.insert(height as u64, decode_block_header(&coin, &header_raw)?);
+            }
+            Ok(headers)
+        })
+        .await
     }
 
     async fn get_block_header_raw(&self, height: u64) -> Result<Option<String>, BlockHeaderStorageError> {
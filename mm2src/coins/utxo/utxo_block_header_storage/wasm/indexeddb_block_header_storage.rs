@@ -133,6 +133,62 @@ impl BlockHeaderStorageOps for IDBBlockHeadersStorage {
         Ok(None)
     }
 
+    async fn get_block_headers_in_range(
+        &self,
+        from: u64,
+        to: u64,
+    ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError> {
+        let ticker = &self.ticker;
+        let locked_db = self
+            .lock_db()
+            .await
+            .map_err(|err| BlockHeaderStorageError::get_err(ticker, err.to_string()))?;
+        let db_transaction = locked_db
+            .get_inner()
+            .transaction()
+            .await
+            .map_err(|err| BlockHeaderStorageError::get_err(ticker, err.to_string()))?;
+        let block_headers_db = db_transaction
+            .table::<BlockHeaderStorageTable>()
+            .await
+            .map_err(|err| BlockHeaderStorageError::table_err(ticker, err.to_string()))?;
+
+        let items = block_headers_db
+            .cursor_builder()
+            .only("ticker", self.ticker.clone())
+            .map_err(|err| BlockHeaderStorageError::get_err(ticker, err.to_string()))?
+            .bound("height", BeBigUint::from(from), BeBigUint::from(to))
+            .open_cursor(BlockHeaderStorageTable::TICKER_HEIGHT_INDEX)
+            .await
+            .map_err(|err| BlockHeaderStorageError::get_err(ticker, err.to_string()))?
+            .collect()
+            .await
+            .map_err(|err| BlockHeaderStorageError::get_err(ticker, err.to_string()))?;
+
+        items
+            .into_iter()
+            .map(|(_item_id, item)| {
+                let height = item
+                    .height
+                    .to_u64()
+                    .ok_or_else(|| BlockHeaderStorageError::get_err(ticker, "height is too large".to_string()))?;
+                let serialized = &hex::decode(item.raw_header).map_err(|e| BlockHeaderStorageError::DecodeError {
+                    coin: ticker.clone(),
+                    reason: e.to_string(),
+                })?;
+                let mut reader = Reader::new_with_coin_variant(serialized, ticker.as_str().into());
+                let header: BlockHeader =
+                    reader
+                        .read()
+                        .map_err(|e: serialization::Error| BlockHeaderStorageError::DecodeError {
+                            coin: ticker.clone(),
+                            reason: e.to_string(),
+                        })?;
+                Ok((height, header))
+            })
+            .collect()
+    }
+
     async fn get_block_header_raw(&self, height: u64) -> Result<Option<String>, BlockHeaderStorageError> {
         let ticker = &self.ticker;
         let locked_db = self
@@ -10,3 +10,5 @@ pub use utxo_conf_builder::{UtxoConfBuilder, UtxoConfError, UtxoConfResult};
 
 #[cfg(test)]
 pub(crate) use utxo_arc_builder::{block_header_utxo_loop, BlockHeaderUtxoLoopExtraArgs};
+#[cfg(test)]
+pub(crate) use utxo_arc_builder::{prefetch_headers_chunks, validate_prefetched_headers, PrefetchedHeadersChunk};
@@ -1,4 +1,5 @@
-use crate::utxo::rpc_clients::{ElectrumClient, ElectrumClientImpl, UtxoJsonRpcClientInfo, UtxoRpcClientEnum};
+use crate::utxo::rpc_clients::{ElectrumClient, ElectrumClientImpl, UtxoJsonRpcClientInfo, UtxoRpcClientEnum,
+                               UtxoRpcError};
 
 use crate::utxo::utxo_block_header_storage::BlockHeaderStorage;
 use crate::utxo::utxo_builder::{UtxoCoinBuildError, UtxoCoinBuilder, UtxoCoinBuilderCommonOps,
@@ -9,12 +10,14 @@ use crate::utxo::{generate_and_send_tx, FeePolicy, GetUtxoListOps, UtxoArc, Utxo
 use crate::{DerivationMethod, PrivKeyBuildPolicy, UtxoActivationParams};
 use async_trait::async_trait;
 use chain::{BlockHeader, TransactionOutput};
-use common::executor::{AbortSettings, SpawnAbortable, Timer};
+use common::executor::{AbortSettings, SpawnAbortable, SpawnFuture, Timer};
 use common::log::{debug, error, info, warn};
+use futures::channel::oneshot;
 use futures::compat::Future01CompatExt;
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
 #[cfg(test)] use mocktopus::macros::*;
+use primitives::hash::H256;
 use rand::Rng;
 use script::Builder;
 use serde_json::Value as Json;
@@ -28,6 +31,10 @@ use std::sync::{Arc, Weak};
 
 const CHUNK_SIZE_REDUCER_VALUE: u64 = 100;
 const TRY_TO_RETRIEVE_HEADERS_ATTEMPTS: u8 = 10;
+/// The maximum number of chunks that are retrieved from the other servers while the current chunk is being validated.
+const MAX_PREFETCHED_HEADERS_CHUNKS: u64 = 3;
+
+pub(crate) type RetrievedHeaders = (HashMap<u64, BlockHeader>, Vec<BlockHeader>);
 
 pub struct UtxoArcBuilder<'a, F, T>
 where
@@ -332,18 +339,8 @@ pub(crate) async fn block_header_utxo_loop(
             continue;
         }
 
-        // Check if there should be a limit on the number of headers stored in storage.
-        if let Some(max_stored_block_headers) = spv_conf.max_stored_block_headers {
-            if let Err(err) =
-                remove_excessive_headers_from_storage(storage, retrieve_to, max_stored_block_headers).await
-            {
-                error!("Error {} on removing excessive {} headers from storage!", err, ticker);
-                sync_status_loop_handle.notify_on_temp_error(err);
-                Timer::sleep(args.error_sleep).await;
-            };
-        }
-
-        sync_status_loop_handle.notify_blocks_headers_sync_status(last_height_in_storage + 1, retrieve_to);
+        let prefetch_to = block_count.min(retrieve_to + MAX_PREFETCHED_HEADERS_CHUNKS * args.chunk_size);
+        sync_status_loop_handle.notify_blocks_headers_sync_status(last_height_in_storage + 1, prefetch_to);
 
         let index = rand::thread_rng().gen_range(0, electrum_addresses.len());
         let server_address = match electrum_addresses.get(index) {
@@ -385,6 +382,16 @@ pub(crate) async fn block_header_utxo_loop(
             },
         };
 
+        // Download the next chunks while the retrieved ones are being validated.
+        let prefetched = prefetch_headers_chunks(
+            &client,
+            &electrum_addresses,
+            index,
+            retrieve_to + 1,
+            prefetch_to,
+            args.chunk_size,
+        );
+
         // Validate retrieved block headers.
         if let Err(err) = validate_headers(ticker, last_height_in_storage, &block_headers, storage, &spv_conf).await {
             error!("Error {} on validating the latest headers for {}!", err, ticker);
@@ -434,11 +441,218 @@ pub(crate) async fn block_header_utxo_loop(
             continue;
         }
 
+        let retrieved_to = last_height_in_storage + block_headers.len() as u64;
+        let block_registry =
+            validate_prefetched_headers(&client, &spv_conf, retrieved_to, block_registry, prefetched).await;
+        let last_validated_height = block_registry.keys().max().copied().unwrap_or(retrieved_to);
+
+        // Check if there should be a limit on the number of headers stored in storage.
+        if let Some(max_stored_block_headers) = spv_conf.max_stored_block_headers {
+            if let Err(err) =
+                remove_excessive_headers_from_storage(storage, last_validated_height, max_stored_block_headers).await
+            {
+                error!("Error {} on removing excessive {} headers from storage!", err, ticker);
+                sync_status_loop_handle.notify_on_temp_error(err);
+                Timer::sleep(args.error_sleep).await;
+            };
+        }
+
+        // All the validated chunks are stored in one transaction.
         let sleep = args.error_sleep;
         ok_or_continue_after_sleep!(storage.add_block_headers_to_storage(block_registry).await, sleep);
     }
 }
 
+/// A chunk of headers that is being retrieved in background.
+pub(crate) struct PrefetchedHeadersChunk {
+    pub(crate) from: u64,
+    pub(crate) result_rx: oneshot::Receiver<MmResult<RetrievedHeaders, UtxoRpcError>>,
+}
+
+/// Starts retrieving the `from..=to` headers by `chunk_size` chunks,
+/// every chunk is requested from the next server after the one at `server_index`.
+pub(crate) fn prefetch_headers_chunks(
+    client: &ElectrumClient,
+    electrum_addresses: &[String],
+    server_index: usize,
+    from: u64,
+    to: u64,
+    chunk_size: u64,
+) -> Vec<PrefetchedHeadersChunk> {
+    let mut chunks = Vec::new();
+    let mut chunk_from = from;
+    while chunk_from <= to {
+        let chunk_to = to.min(chunk_from + chunk_size - 1);
+        let server_address = &electrum_addresses[(server_index + chunks.len() + 1) % electrum_addresses.len()];
+        let (result_tx, result_rx) = oneshot::channel();
+        let fut = client
+            .retrieve_headers_from(server_address, chunk_from, chunk_to)
+            .compat();
+        client.weak_spawner().spawn(async move {
+            result_tx.send(fut.await).ok();
+        });
+        chunks.push(PrefetchedHeadersChunk {
+            from: chunk_from,
+            result_rx,
+        });
+        chunk_from = chunk_to + 1;
+    }
+    chunks
+}
+
+/// Validates the `prefetched` chunks in order and adds them to the already validated `block_registry`
+/// that ends at `last_validated_height`.
+///
+/// The prefetched chunks are optional: the first chunk that fails to be retrieved or validated is dropped
+/// along with the following ones, so that it's retrieved again by the next loop iteration with all the retries
+/// and the chain reorganization handling.
+pub(crate) async fn validate_prefetched_headers(
+    client: &ElectrumClient,
+    spv_conf: &SPVConf,
+    mut last_validated_height: u64,
+    block_registry: HashMap<u64, BlockHeader>,
+    prefetched: Vec<PrefetchedHeadersChunk>,
+) -> HashMap<u64, BlockHeader> {
+    let ticker = client.coin_name();
+    let mut validated = PendingBlockHeadersStorage {
+        client: client.clone(),
+        pending: block_registry,
+    };
+
+    for PrefetchedHeadersChunk { from, result_rx } in prefetched {
+        if from != last_validated_height + 1 {
+            break;
+        }
+        let (chunk_registry, chunk_headers) = match result_rx.await {
+            Ok(Ok(retrieved)) => retrieved,
+            Ok(Err(err)) => {
+                debug!("Error {} on prefetching {} headers from {}", err, ticker, from);
+                break;
+            },
+            Err(_) => break,
+        };
+        if let Err(err) = validate_headers(ticker, last_validated_height, &chunk_headers, &validated, spv_conf).await {
+            debug!(
+                "Error {} on validating the prefetched {} headers from {}",
+                err, ticker, from
+            );
+            break;
+        }
+        last_validated_height += chunk_headers.len() as u64;
+        validated.pending.extend(chunk_registry);
+    }
+    validated.pending
+}
+
+/// Lets the headers that are validated but not stored yet be used to validate the following ones.
+/// The lookups check the pending headers first, the changes are applied to the underlying storage directly.
+struct PendingBlockHeadersStorage {
+    client: ElectrumClient,
+    pending: HashMap<u64, BlockHeader>,
+}
+
+#[async_trait]
+impl BlockHeaderStorageOps for PendingBlockHeadersStorage {
+    async fn init(&self) -> Result<(), BlockHeaderStorageError> { self.client.block_headers_storage().init().await }
+
+    async fn is_initialized_for(&self) -> Result<bool, BlockHeaderStorageError> {
+        self.client.block_headers_storage().is_initialized_for().await
+    }
+
+    async fn add_block_headers_to_storage(
+        &self,
+        headers: HashMap<u64, BlockHeader>,
+    ) -> Result<(), BlockHeaderStorageError> {
+        self.client
+            .block_headers_storage()
+            .add_block_headers_to_storage(headers)
+            .await
+    }
+
+    async fn get_block_header(&self, height: u64) -> Result<Option<BlockHeader>, BlockHeaderStorageError> {
+        match self.pending.get(&height) {
+            Some(header) => Ok(Some(header.clone())),
+            None => self.client.block_headers_storage().get_block_header(height).await,
+        }
+    }
+
+    async fn get_block_headers_in_range(
+        &self,
+        from: u64,
+        to: u64,
+    ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError> {
+        let mut headers = self
+            .client
+            .block_headers_storage()
+            .get_block_headers_in_range(from, to)
+            .await?;
+        headers.extend(
+            self.pending
+                .iter()
+                .filter(|(height, _)| (from..=to).contains(*height))
+                .map(|(height, header)| (*height, header.clone())),
+        );
+        Ok(headers)
+    }
+
+    async fn get_block_header_raw(&self, height: u64) -> Result<Option<String>, BlockHeaderStorageError> {
+        match self.pending.get(&height) {
+            Some(header) => Ok(Some(hex::encode(header.raw()))),
+            None => self.client.block_headers_storage().get_block_header_raw(height).await,
+        }
+    }
+
+    async fn get_last_block_height(&self) -> Result<Option<u64>, BlockHeaderStorageError> {
+        match self.pending.keys().max() {
+            Some(height) => Ok(Some(*height)),
+            None => self.client.block_headers_storage().get_last_block_height().await,
+        }
+    }
+
+    async fn get_last_block_header_with_non_max_bits(
+        &self,
+        max_bits: u32,
+    ) -> Result<Option<BlockHeader>, BlockHeaderStorageError> {
+        let last_pending = self
+            .pending
+            .iter()
+            .filter(|(_, header)| u32::from(header.bits.clone()) != max_bits)
+            .max_by_key(|(height, _)| **height);
+        match last_pending {
+            Some((_, header)) => Ok(Some(header.clone())),
+            None => {
+                self.client
+                    .block_headers_storage()
+                    .get_last_block_header_with_non_max_bits(max_bits)
+                    .await
+            },
+        }
+    }
+
+    async fn get_block_height_by_hash(&self, hash: H256) -> Result<Option<i64>, BlockHeaderStorageError> {
+        let pending_height = self
+            .pending
+            .iter()
+            .find(|(_, header)| header.hash().reversed() == hash)
+            .map(|(height, _)| *height as i64);
+        match pending_height {
+            Some(height) => Ok(Some(height)),
+            None => self.client.block_headers_storage().get_block_height_by_hash(hash).await,
+        }
+    }
+
+    async fn remove_headers_from_storage(&self, from: u64, to: u64) -> Result<(), BlockHeaderStorageError> {
+        self.client
+            .block_headers_storage()
+            .remove_headers_from_storage(from, to)
+            .await
+    }
+
+    async fn is_table_empty(&self) -> Result<(), BlockHeaderStorageError> {
+        self.client.block_headers_storage().is_table_empty().await
+    }
+}
+
 #[derive(Debug, Display)]
 enum TryToRetrieveHeadersUntilSuccessError {
     #[display(
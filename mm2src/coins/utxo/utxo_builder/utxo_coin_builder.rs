@@ -6,7 +6,7 @@ use crate::utxo::tx_cache::{UtxoVerboseCacheOps, UtxoVerboseCacheShared};
 use crate::utxo::utxo_block_header_storage::BlockHeaderStorage;
 use crate::utxo::utxo_builder::utxo_conf_builder::{UtxoConfBuilder, UtxoConfError};
 use crate::utxo::{output_script, ElectrumBuilderArgs, FeeRate, RecentlySpentOutPoints, UtxoCoinConf, UtxoCoinFields,
-                  UtxoHDWallet, UtxoRpcMode, UtxoSyncStatus, UtxoSyncStatusLoopHandle, UTXO_DUST_AMOUNT};
+                  UtxoHDWallet, UtxoRpcCache, UtxoRpcMode, UtxoSyncStatus, UtxoSyncStatusLoopHandle, UTXO_DUST_AMOUNT};
 use crate::{BlockchainNetwork, CoinTransportMetrics, DerivationMethod, HistorySyncState, IguanaPrivKey,
             PrivKeyBuildPolicy, PrivKeyPolicy, PrivKeyPolicyNotAllowed, RpcClientType,
             SharableRpcTransportEventHandler, UtxoActivationParams};
@@ -28,14 +28,14 @@ use serde_json::{self as json, Value as Json};
 use spv_validation::conf::SPVConf;
 use spv_validation::helpers_validation::SPVError;
 use spv_validation::storage::{BlockHeaderStorageError, BlockHeaderStorageOps};
-use std::sync::Mutex;
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
 
 cfg_native! {
     use crate::utxo::coin_daemon_data_dir;
     use crate::utxo::rpc_clients::{ConcurrentRequestMap, NativeClient, NativeClientImpl};
     use dirs::home_dir;
     use std::path::{Path, PathBuf};
-    use std::sync::Arc;
 }
 
 /// Number of seconds in a day (24 hours * 60 * 60)
@@ -263,6 +263,11 @@ where
     let tx_cache = builder.tx_cache();
     let (block_headers_status_notifier, block_headers_status_watcher) =
         builder.block_header_status_channel(&conf.spv_conf);
+    let rpc_cache = Arc::new(UtxoRpcCache::new(
+        &conf.ticker,
+        conf.avg_blocktime,
+        builder.ctx().metrics.weak(),
+    ));
 
     let coin = UtxoCoinFields {
         conf,
@@ -281,6 +286,7 @@ where
         block_headers_status_watcher,
         ctx: builder.ctx().clone().weak(),
         abortable_system,
+        rpc_cache,
     };
 
     Ok(coin)
@@ -339,6 +345,11 @@ pub trait UtxoFieldsWithHardwareWalletBuilder: UtxoCoinBuilderCommonOps {
         let tx_cache = self.tx_cache();
         let (block_headers_status_notifier, block_headers_status_watcher) =
             self.block_header_status_channel(&conf.spv_conf);
+        let rpc_cache = Arc::new(UtxoRpcCache::new(
+            &conf.ticker,
+            conf.avg_blocktime,
+            self.ctx().metrics.weak(),
+        ));
 
         let coin = UtxoCoinFields {
             conf,
@@ -357,6 +368,7 @@ pub trait UtxoFieldsWithHardwareWalletBuilder: UtxoCoinBuilderCommonOps {
             block_headers_status_watcher,
             ctx: self.ctx().clone().weak(),
             abortable_system,
+            rpc_cache,
         };
         Ok(coin)
     }
@@ -552,6 +564,12 @@ pub trait UtxoCoinBuilderCommonOps {
         let gui = ctx.gui().unwrap_or("UNKNOWN").to_string();
         let mm_version = ctx.mm_version().to_string();
         let (min_connected, max_connected) = (min_connected.unwrap_or(1), max_connected.unwrap_or(servers.len()));
+        // Coalescing the concurrent requests into batches is opt-in, as some servers limit the batch requests.
+        let batch_window = self.conf()["electrum_batch_window_ms"]
+            .as_u64()
+            .map(Duration::from_millis);
+        let hedge_requests = self.conf()["electrum_hedged_requests"].as_bool().unwrap_or(false);
+        let cache_unspents = self.conf()["electrum_unspent_cache"].as_bool().unwrap_or(false);
         let client_settings = ElectrumClientSettings {
             client_name: format!("{} GUI/MM2 {}", gui, mm_version),
             servers: servers.clone(),
@@ -560,6 +578,9 @@ pub trait UtxoCoinBuilderCommonOps {
             negotiate_version: args.negotiate_version,
             min_connected,
             max_connected,
+            batch_window,
+            hedge_requests,
+            cache_unspents,
         };
 
         ElectrumClient::try_new(
@@ -673,7 +694,7 @@ pub trait UtxoCoinBuilderCommonOps {
 
     #[cfg(not(target_arch = "wasm32"))]
     fn tx_cache(&self) -> UtxoVerboseCacheShared {
-        crate::utxo::tx_cache::fs_tx_cache::FsVerboseCache::new(self.ticker().to_owned(), self.tx_cache_path())
+        crate::utxo::tx_cache::sqlite_tx_cache::SqliteVerboseCache::new(self.ticker().to_owned(), self.tx_cache_path())
             .into_shared()
     }
 
@@ -12,7 +12,7 @@ use crate::utxo::tx_cache::TxCacheResult;
 use crate::utxo::utxo_hd_wallet::UtxoHDAddress;
 use crate::utxo::utxo_withdraw::{InitUtxoWithdraw, StandardUtxoWithdraw, UtxoWithdraw};
 use crate::watcher_common::validate_watcher_reward;
-use crate::{scan_for_new_addresses_impl, CanRefundHtlc, CoinBalance, CoinWithDerivationMethod, ConfirmPaymentInput,
+use crate::{scan_chain_for_new_addresses, CanRefundHtlc, CoinBalance, CoinWithDerivationMethod, ConfirmPaymentInput,
             DexFee, DexFeeBurnDestination, GenPreimageResult, GenTakerFundingSpendArgs, GenTakerPaymentSpendArgs,
             GetWithdrawSenderAddress, RawTransactionError, RawTransactionRequest, RawTransactionRes,
             RawTransactionResult, RefundFundingSecretArgs, RefundMakerPaymentSecretArgs, RefundPaymentArgs,
@@ -40,7 +40,7 @@ use common::jsonrpc_client::JsonRpcErrorType;
 use common::log::{debug, error};
 use crypto::Bip44Chain;
 use futures::compat::Future01CompatExt;
-use futures::future::{FutureExt, TryFutureExt};
+use futures::future::{try_join, FutureExt, TryFutureExt};
 use futures01::future::Either;
 use itertools::Itertools;
 use keys::bytes::Bytes;
@@ -99,9 +99,13 @@ pub async fn get_fee_rate(coin: &UtxoCoinFields) -> UtxoRpcResult<ActualFeeRate>
     match &coin.tx_fee {
         FeeRate::Dynamic(method) => {
             let fee_rate = coin
-                .rpc_client
-                .estimate_fee_sat(coin.decimals, method, &conf.estimate_fee_mode, conf.estimate_fee_blocks)
-                .compat()
+                .rpc_cache
+                .fee_rate
+                .get_or_fetch(coin.rpc_client.new_blocks_seen(), || {
+                    coin.rpc_client
+                        .estimate_fee_sat(coin.decimals, method, &conf.estimate_fee_mode, conf.estimate_fee_blocks)
+                        .compat()
+                })
                 .await?;
             Ok(ActualFeeRate::Dynamic(fee_rate))
         },
@@ -166,6 +170,7 @@ where
     Ok(UtxoAddressScanner::init(coin.as_ref().rpc_client.clone()).await?)
 }
 
+/// Scans the [`Bip44Chain::External`] and [`Bip44Chain::Internal`] chains concurrently.
 pub async fn scan_for_new_addresses<T>(
     coin: &T,
     hd_wallet: &T::HDWallet,
@@ -177,30 +182,22 @@ where
     T: HDWalletBalanceOps + Sync,
     HDCoinAddress<T>: std::fmt::Display,
 {
-    let mut addresses = scan_for_new_addresses_impl(
-        coin,
-        hd_wallet,
-        hd_account,
-        address_scanner,
-        Bip44Chain::External,
-        gap_limit,
+    let ((mut addresses, external_addresses), (internal_balances, internal_addresses)) = try_join(
+        scan_chain_for_new_addresses(coin, hd_account, address_scanner, Bip44Chain::External, gap_limit),
+        scan_chain_for_new_addresses(coin, hd_account, address_scanner, Bip44Chain::Internal, gap_limit),
     )
     .await?;
-    addresses.extend(
-        scan_for_new_addresses_impl(
-            coin,
-            hd_wallet,
-            hd_account,
-            address_scanner,
-            Bip44Chain::Internal,
-            gap_limit,
-        )
-        .await?,
-    );
+    addresses.extend(internal_balances);
+
+    coin.set_known_addresses_number(hd_wallet, hd_account, Bip44Chain::External, external_addresses)
+        .await?;
+    coin.set_known_addresses_number(hd_wallet, hd_account, Bip44Chain::Internal, internal_addresses)
+        .await?;
 
     Ok(addresses)
 }
 
+/// Requests the balances of the [`Bip44Chain::External`] and [`Bip44Chain::Internal`] chains concurrently.
 pub async fn all_known_addresses_balances<T>(
     coin: &T,
     hd_account: &HDCoinHDAccount<T>,
@@ -218,13 +215,12 @@ where
         // A UTXO coin should support both [`Bip44Chain::External`] and [`Bip44Chain::Internal`].
         .mm_err(|e| BalanceError::Internal(e.to_string()))?;
 
-    let mut balances = coin
-        .known_addresses_balances_with_ids(hd_account, Bip44Chain::External, 0..external_addresses)
-        .await?;
-    balances.extend(
-        coin.known_addresses_balances_with_ids(hd_account, Bip44Chain::Internal, 0..internal_addresses)
-            .await?,
-    );
+    let (mut balances, internal_balances) = try_join(
+        coin.known_addresses_balances_with_ids(hd_account, Bip44Chain::External, 0..external_addresses),
+        coin.known_addresses_balances_with_ids(hd_account, Bip44Chain::Internal, 0..internal_addresses),
+    )
+    .await?;
+    balances.extend(internal_balances);
 
     Ok(balances)
 }
@@ -402,10 +398,24 @@ pub fn checked_address_from_str<T: UtxoCommonOps>(coin: &T, address: &str) -> Mm
 }
 
 pub async fn get_current_mtp(coin: &UtxoCoinFields, coin_variant: CoinVariant) -> UtxoRpcResult<u32> {
-    let current_block = coin.rpc_client.get_block_count().compat().await?;
-    coin.rpc_client
-        .get_median_time_past(current_block, coin.conf.mtp_block_count, coin_variant)
-        .compat()
+    let generation = coin.rpc_client.new_blocks_seen();
+    coin.rpc_cache
+        .median_time_past
+        .get_or_fetch(generation, || async {
+            let current_block = get_block_count_cached(&coin.rpc_client, &coin.rpc_cache).await?;
+            coin.rpc_client
+                .get_median_time_past(current_block, coin.conf.mtp_block_count, coin_variant)
+                .compat()
+                .await
+        })
+        .await
+}
+
+/// Returns the current block count, requested once for all the concurrent callers, see [`crate::rpc_cache`].
+pub async fn get_block_count_cached(rpc_client: &UtxoRpcClientEnum, rpc_cache: &UtxoRpcCache) -> UtxoRpcResult<u64> {
+    rpc_cache
+        .block_count
+        .get_or_fetch(rpc_client.new_blocks_seen(), || rpc_client.get_block_count().compat())
         .await
 }
 
@@ -3188,7 +3198,10 @@ pub async fn wait_for_output_spend_impl(
         .get(output_index)
         .or_mm_err(|| WaitForOutputSpendErr::NoOutputWithIndex(output_index))?
         .script_pubkey;
+    // The spending transaction changes the status of the output script.
+    let chain_updates = coin.rpc_client.watch_chain_updates(Some(&script_pubkey[..])).await;
     loop {
+        let chain_update = chain_updates.next_update();
         match coin
             .rpc_client
             .find_output_spend(
@@ -3204,7 +3217,14 @@ pub async fn wait_for_output_spend_impl(
             Ok(Some(spent_output_info)) => {
                 return Ok(spent_output_info.spending_tx);
             },
-            Ok(None) => (),
+            Ok(None) => {
+                let now = now_sec();
+                if now > wait_until {
+                    return MmError::err(WaitForOutputSpendErr::Timeout { wait_until, now });
+                }
+                chain_update.wait(check_every, wait_until).await;
+                continue;
+            },
             Err(e) => error!("Error on find_output_spend_of_tx: {}", e),
         };
 
@@ -3250,7 +3270,14 @@ pub fn tx_enum_from_bytes(coin: &UtxoCoinFields, bytes: &[u8]) -> Result<Transac
 }
 
 pub fn current_block(coin: &UtxoCoinFields) -> Box<dyn Future<Item = u64, Error = String> + Send> {
-    Box::new(coin.rpc_client.get_block_count().map_err(|e| ERRL!("{}", e)))
+    let rpc_client = coin.rpc_client.clone();
+    let rpc_cache = coin.rpc_cache.clone();
+    let fut = async move {
+        get_block_count_cached(&rpc_client, &rpc_cache)
+            .await
+            .map_err(|e| ERRL!("{}", e))
+    };
+    Box::new(fut.boxed().compat())
 }
 
 pub fn display_priv_key(coin: &UtxoCoinFields) -> Result<String, String> {
@@ -10,6 +10,7 @@ use crate::utxo::{output_script, RequestTxHistoryResult, UtxoCoinFields, UtxoCom
 use crate::{big_decimal_from_sat_unsigned, compare_transactions, BalanceResult, CoinWithDerivationMethod,
             DerivationMethod, HDPathAccountToAddressId, MarketCoinOps, NumConversError, TransactionDetails,
             TxFeeDetails, TxIdHeight, UtxoFeeDetails, UtxoTx};
+use chain::TransactionRef;
 use common::jsonrpc_client::JsonRpcErrorType;
 use crypto::Bip44Chain;
 use futures::compat::Future01CompatExt;
@@ -18,7 +19,8 @@ use keys::Address;
 use mm2_err_handle::prelude::*;
 use mm2_metrics::MetricsArc;
 use mm2_number::BigDecimal;
-use rpc::v1::types::{TransactionInputEnum, H256 as H256Json};
+use rpc::v1::types::{Bytes as BytesJson, TransactionInputEnum, H256 as H256Json};
+use script::Script;
 use serialization::deserialize;
 use std::collections::{HashMap, HashSet};
 use std::convert::{TryFrom, TryInto};
@@ -151,22 +153,22 @@ where
 
         let prev_tx_hash: H256Json = input.previous_output.hash.reversed().into();
 
-        let prev_tx = coin.tx_from_storage_or_rpc(&prev_tx_hash, params.storage).await?;
+        let prev_tx_bytes = tx_bytes_from_storage_or_rpc(coin, &prev_tx_hash, params.storage).await?;
 
         let prev_output_index: usize = input.previous_output.index.try_into().map_to_mm(|e: TryFromIntError| {
             UtxoTxDetailsError::NumConversionErr(NumConversError::new(e.to_string()))
         })?;
-        let prev_tx_output = prev_tx.outputs.get(prev_output_index).ok_or_else(|| {
-            UtxoTxDetailsError::Internal(format!(
-                "Previous output index is out of bound: coin={}, prev_output_index={}, prev_tx_hash={}, tx_hash={}, tx_hex={:02x}",
-                ticker, prev_output_index, prev_tx_hash, params.hash, verbose_tx.hex
-            ))
-        })?;
+        let (prev_value, prev_script) = prev_tx_output(coin.as_ref(), &prev_tx_bytes, prev_output_index)?
+            .ok_or_else(|| {
+                UtxoTxDetailsError::Internal(format!(
+                    "Previous output index is out of bound: coin={}, prev_output_index={}, prev_tx_hash={}, tx_hash={}, tx_hex={:02x}",
+                    ticker, prev_output_index, prev_tx_hash, params.hash, verbose_tx.hex
+                ))
+            })?;
 
-        input_amount += prev_tx_output.value;
-        let amount = big_decimal_from_sat_unsigned(prev_tx_output.value, decimals);
+        input_amount += prev_value;
+        let amount = big_decimal_from_sat_unsigned(prev_value, decimals);
 
-        let prev_script = prev_tx_output.script_pubkey.clone().into();
         let from: Vec<Address> = coin
             .addresses_from_script(&prev_script)
             .map_to_mm(UtxoTxDetailsError::TxAddressDeserializationError)?;
@@ -215,12 +217,49 @@ where
     Ok(vec![tx_builder.build()])
 }
 
+/// Returns the value and the script of the `index` output of the serialized transaction.
+/// The output is read through [`TransactionRef`] that doesn't decode the rest of the transaction,
+/// the transaction is deserialized entirely only if its format isn't supported by the view.
+fn prev_tx_output(
+    coin: &UtxoCoinFields,
+    tx_bytes: &BytesJson,
+    index: usize,
+) -> MmResult<Option<(u64, Script)>, UtxoTxDetailsError> {
+    if let Ok(tx_ref) = TransactionRef::parse(&tx_bytes.0, coin.conf.is_pos) {
+        return Ok(tx_ref
+            .output(index)
+            .map(|output| (output.value, Script::from(output.script_pubkey.to_vec()))));
+    }
+
+    let tx: UtxoTx = deserialize(tx_bytes.0.as_slice())?;
+    Ok(tx
+        .outputs
+        .into_iter()
+        .nth(index)
+        .map(|output| (output.value, output.script_pubkey.into())))
+}
+
 /// [`UtxoTxHistoryOps::tx_from_storage_or_rpc`] implementation.
 pub async fn tx_from_storage_or_rpc<Coin, Storage>(
     coin: &Coin,
     tx_hash: &H256Json,
     storage: &Storage,
 ) -> MmResult<UtxoTx, UtxoTxDetailsError>
+where
+    Coin: CoinWithTxHistoryV2 + UtxoCommonOps,
+    Storage: TxHistoryStorage,
+{
+    let tx_bytes = tx_bytes_from_storage_or_rpc(coin, tx_hash, storage).await?;
+    let tx = deserialize(tx_bytes.0.as_slice())?;
+    Ok(tx)
+}
+
+/// Loads the serialized transaction from `storage` or requests it using coin RPC.
+pub async fn tx_bytes_from_storage_or_rpc<Coin, Storage>(
+    coin: &Coin,
+    tx_hash: &H256Json,
+    storage: &Storage,
+) -> MmResult<BytesJson, UtxoTxDetailsError>
 where
     Coin: CoinWithTxHistoryV2 + UtxoCommonOps,
     Storage: TxHistoryStorage,
@@ -235,8 +274,7 @@ where
             tx_bytes
         },
     };
-    let tx = deserialize(tx_bytes.0.as_slice())?;
-    Ok(tx)
+    Ok(tx_bytes)
 }
 
 /// [`UtxoTxHistoryOps::my_addresses_balances`] implementation.
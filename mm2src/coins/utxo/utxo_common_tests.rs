@@ -149,6 +149,7 @@ pub(super) fn utxo_coin_fields_for_test(
         block_headers_status_watcher: None,
         ctx: MmWeak::default(),
         abortable_system: AbortableQueue::default(),
+        rpc_cache: Arc::new(UtxoRpcCache::new(TEST_COIN_NAME, None, MetricsWeak::new())),
     }
 }
 
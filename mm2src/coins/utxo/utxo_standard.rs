@@ -1331,6 +1331,10 @@ impl UtxoTxHistoryOps for UtxoStandardCoin {
         self.as_ref().rpc_client.get_block_timestamp(height).await
     }
 
+    async fn get_block_timestamps(&self, heights: Vec<u64>) -> MmResult<HashMap<u64, u64>, GetBlockHeaderError> {
+        self.as_ref().rpc_client.get_block_timestamps(heights).await
+    }
+
     async fn my_addresses_balances(&self) -> BalanceResult<HashMap<String, BigDecimal>> {
         utxo_common::utxo_tx_history_v2_common::my_addresses_balances(self).await
     }
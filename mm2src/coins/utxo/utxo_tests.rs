@@ -3,7 +3,7 @@ use crate::coin_balance::HDAddressBalance;
 use crate::coin_errors::ValidatePaymentError;
 use crate::hd_wallet::{HDAccountsMap, HDAccountsMutex, HDAddressesCache, HDConfirmAddress, HDConfirmAddressError,
                        HDWallet, HDWalletCoinStorage, HDWalletMockStorage, HDWalletStorageInternalOps,
-                       MockableConfirmAddress};
+                       MockableConfirmAddress, MAX_SCAN_WINDOW_LEN};
 use crate::my_tx_history_v2::for_tests::init_storage_for;
 use crate::my_tx_history_v2::CoinWithTxHistoryV2;
 use crate::rpc_command::account_balance::{AccountBalanceParams, AccountBalanceRpcOps, HDAccountBalanceResponse};
@@ -12,7 +12,7 @@ use crate::rpc_command::init_scan_for_new_addresses::{InitScanAddressesRpcOps, S
                                                       ScanAddressesResponse};
 use crate::utxo::qtum::{qtum_coin_with_priv_key, QtumCoin, QtumDelegationOps, QtumDelegationRequest};
 #[cfg(not(target_arch = "wasm32"))]
-use crate::utxo::rpc_clients::{BlockHashOrHeight, ElectrumClientSettings, NativeUnspent};
+use crate::utxo::rpc_clients::{BlockHashOrHeight, ElectrumClientSettings, ElectrumTxHistoryItem, NativeUnspent};
 use crate::utxo::rpc_clients::{ElectrumBalance, ElectrumBlockHeader, ElectrumClient, ElectrumClientImpl,
                                GetAddressInfoRes, ListSinceBlockRes, NativeClient, NativeClientImpl, NetworkInfo,
                                UtxoRpcClientOps, ValidateAddressRes, VerboseBlock};
@@ -27,9 +27,10 @@ use crate::utxo::utxo_common_tests::{self, utxo_coin_fields_for_test, utxo_coin_
 use crate::utxo::utxo_hd_wallet::UtxoHDAccount;
 use crate::utxo::utxo_standard::{utxo_standard_coin_with_priv_key, UtxoStandardCoin};
 use crate::utxo::utxo_tx_history_v2::{UtxoTxDetailsParams, UtxoTxHistoryOps};
-use crate::{BlockHeightAndTime, CoinBalance, CoinBalanceMap, ConfirmPaymentInput, DexFee, IguanaPrivKey,
-            PrivKeyBuildPolicy, SearchForSwapTxSpendInput, SpendPaymentArgs, StakingInfosDetails, SwapOps,
-            TradePreimageValue, TxFeeDetails, TxMarshalingErr, ValidateFeeArgs, INVALID_SENDER_ERR_LOG};
+use crate::{scan_chain_for_new_addresses, BlockHeightAndTime, CoinBalance, CoinBalanceMap, ConfirmPaymentInput,
+            DexFee, IguanaPrivKey, PrivKeyBuildPolicy, SearchForSwapTxSpendInput, SpendPaymentArgs,
+            StakingInfosDetails, SwapOps, TradePreimageValue, TxFeeDetails, TxMarshalingErr, ValidateFeeArgs,
+            INVALID_SENDER_ERR_LOG};
 #[cfg(not(target_arch = "wasm32"))]
 use crate::{WaitForHTLCTxSpendArgs, WithdrawFee};
 use chain::{BlockHeader, BlockHeaderBits, OutPoint};
@@ -97,6 +98,37 @@ pub fn electrum_client_for_test(servers: &[&str]) -> ElectrumClient {
 #[cfg(not(target_arch = "wasm32"))]
 fn native_client_for_test() -> NativeClient { NativeClient(Arc::new(NativeClientImpl::default())) }
 
+/// Returned client isn't connected to any server, requires some mocks to be usable
+#[cfg(not(target_arch = "wasm32"))]
+fn electrum_client_without_servers() -> ElectrumClient {
+    let block_headers_storage = BlockHeaderStorage {
+        inner: Box::new(SqliteBlockHeadersStorage {
+            ticker: TEST_COIN_NAME.into(),
+            conn: Arc::new(Mutex::new(Connection::open_in_memory().unwrap())),
+        }),
+    };
+    let client_settings = ElectrumClientSettings {
+        client_name: "test".to_string(),
+        servers: vec![],
+        coin_ticker: TEST_COIN_NAME.into(),
+        spawn_ping: false,
+        negotiate_version: false,
+        min_connected: 1,
+        max_connected: 1,
+        batch_window: None,
+        hedge_requests: false,
+        cache_unspents: false,
+    };
+    ElectrumClient::try_new(
+        client_settings,
+        Default::default(),
+        block_headers_storage,
+        StreamingManager::default(),
+        AbortableQueue::default(),
+    )
+    .expect("Expected electrum_client_impl constructed without a problem")
+}
+
 fn utxo_coin_for_test(
     rpc_client: UtxoRpcClientEnum,
     force_seed: Option<&str>,
@@ -480,6 +512,9 @@ fn test_wait_for_payment_spend_timeout_electrum() {
         negotiate_version: true,
         min_connected: 1,
         max_connected: 1,
+        batch_window: None,
+        hedge_requests: false,
+        cache_unspents: false,
     };
     let client = ElectrumClient::try_new(
         client_settings,
@@ -4708,6 +4743,115 @@ fn test_scan_for_new_addresses() {
     assert_eq!(unsafe { &CHECKED_ADDRESSES }, &expected_checked_addresses);
 }
 
+#[test]
+fn test_scan_for_new_addresses_by_windows() {
+    const GAP_LIMIT: u32 = MAX_SCAN_WINDOW_LEN + 50;
+    const USED_ADDRESS_ID: u32 = 120;
+
+    // The number of addresses checked by every [`UtxoAddressScanner::are_addresses_used`] call.
+    static mut WINDOW_LENS: Vec<usize> = Vec::new();
+
+    NativeClient::display_balance
+        .mock_safe(move |_, _, _| MockResult::Return(Box::new(futures01::future::ok(BigDecimal::from(1)))));
+
+    let client = NativeClient(Arc::new(NativeClientImpl::default()));
+    let fields = utxo_coin_fields_for_test(UtxoRpcClientEnum::Native(client), None, false);
+    let coin = utxo_coin_from_fields(fields);
+    let hd_account = UtxoHDAccount {
+        account_id: 0,
+        extended_pubkey: Secp256k1ExtendedPublicKey::from_str("xpub6DEHSksajpRPM59RPw7Eg6PKdU7E2ehxJWtYdrfQ6JFmMGBsrR6jA78ANCLgzKYm4s5UqQ4ydLEYPbh3TRVvn5oAZVtWfi4qJLMntpZ8uGJ").unwrap(),
+        account_derivation_path: HDPathToAccount::from_str("m/44'/141'/0'").unwrap(),
+        external_addresses_number: 0,
+        internal_addresses_number: 0,
+        derived_addresses: HDAddressesCache::default(),
+    };
+
+    let used_address = block_on(coin.derive_address(&hd_account, Bip44Chain::External, USED_ADDRESS_ID))
+        .unwrap()
+        .address();
+    UtxoAddressScanner::are_addresses_used.mock_safe(move |_, addresses| {
+        unsafe {
+            WINDOW_LENS.push(addresses.len());
+        }
+        let used = addresses.iter().map(|address| *address == used_address).collect();
+        MockResult::Return(Box::pin(futures::future::ok(used)))
+    });
+
+    let address_scanner = UtxoAddressScanner::Native {
+        non_empty_addresses: HashSet::new(),
+    };
+    let (balances, known_addresses_number) = block_on(scan_chain_for_new_addresses(
+        &coin,
+        &hd_account,
+        &address_scanner,
+        Bip44Chain::External,
+        GAP_LIMIT,
+    ))
+    .unwrap();
+
+    // The same addresses are checked as if they were checked one by one,
+    // up to the `GAP_LIMIT + 1`th consecutive empty address after the used one,
+    // but never more than `MAX_SCAN_WINDOW_LEN` at once.
+    let expected_window_lens = [MAX_SCAN_WINDOW_LEN as usize, 51, MAX_SCAN_WINDOW_LEN as usize, 21];
+    assert_eq!(unsafe { &WINDOW_LENS }, &expected_window_lens);
+    let checked_addresses_number: usize = expected_window_lens.iter().sum();
+    assert_eq!(checked_addresses_number, (USED_ADDRESS_ID + GAP_LIMIT + 2) as usize);
+
+    assert_eq!(known_addresses_number, USED_ADDRESS_ID + 1);
+    assert_eq!(balances.len(), USED_ADDRESS_ID as usize + 1);
+    let (used_balance, empty_balances) = balances.split_last().unwrap();
+    assert!(empty_balances.iter().all(|balance| balance.balance.is_empty()));
+    let derivation_path = DerivationPath::from_str(&format!("m/44'/141'/0'/0/{}", USED_ADDRESS_ID)).unwrap();
+    assert_eq!(used_balance.derivation_path, RpcDerivationPath(derivation_path));
+    let expected_balance = HashMap::from([(TEST_COIN_NAME.to_string(), CoinBalance::new(BigDecimal::from(1)))]);
+    assert_eq!(used_balance.balance, expected_balance);
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+#[test]
+fn test_electrum_address_scanner_checks_addresses_in_batch() {
+    let addresses: Vec<Address> = [
+        "RU1gRFXWXNx7uPRAEJ7wdZAW1RZ4TE6Vv1",
+        "RUkEvRzb7mtwfVeKiSFEbYupLkcvU5KJBw",
+        "RP8deqVfjBbkvxbGbsQ2EGdamMaP1wxizR",
+    ]
+    .iter()
+    .map(|address| Address::from_legacyaddress(address, &KMD_PREFIXES).unwrap())
+    .collect();
+    let expected_hashes: Vec<String> = addresses
+        .iter()
+        .map(|address| hex::encode(electrum_script_hash(&output_script(address).unwrap())))
+        .collect();
+    // Only the second address has a transaction history.
+    let used_hash = expected_hashes[1].clone();
+
+    ElectrumClient::scripthash_get_history
+        .mock_safe(|_, _| panic!("The addresses are expected to be checked in a single batch"));
+    ElectrumClient::scripthash_get_history_batch::<Vec<String>>.mock_safe(move |_, hashes| {
+        // The histories are requested in the order of the addresses.
+        assert_eq!(hashes, expected_hashes);
+        let histories = hashes
+            .iter()
+            .map(|hash| {
+                if *hash == used_hash {
+                    vec![ElectrumTxHistoryItem {
+                        height: 1,
+                        tx_hash: H256Json::default(),
+                        fee: None,
+                    }]
+                } else {
+                    Vec::new()
+                }
+            })
+            .collect();
+        MockResult::Return(Box::new(futures01::future::ok(histories)))
+    });
+
+    let address_scanner = UtxoAddressScanner::Electrum(electrum_client_without_servers());
+    let used = block_on(address_scanner.are_addresses_used(&addresses)).unwrap();
+    assert_eq!(used, vec![false, true, false]);
+}
+
 #[test]
 fn test_get_new_address() {
     static mut EXPECTED_CHECKED_ADDRESSES: Vec<String> = Vec::new();
@@ -5459,6 +5603,154 @@ fn test_block_header_utxo_loop_with_reorg() {
     };
 }
 
+/// Returns the valid RICK headers of the `2..=10` heights that follow the `starting_block_header` of [`rick_spv_conf`].
+#[cfg(not(target_arch = "wasm32"))]
+fn rick_valid_headers() -> HashMap<u64, BlockHeader> {
+    let rick_headers: Vec<String> = serde_json::from_str(include_str!("../for_tests/RICK_HEADERS.json")).unwrap();
+    let mut headers: HashMap<_, _> = rick_headers
+        .into_iter()
+        .enumerate()
+        .map(|(idx, header)| {
+            let header = BlockHeader::try_from_string_with_coin_variant(header, "RICK".into()).unwrap();
+            ((idx + 2) as u64, header)
+        })
+        .collect();
+    // The header at height 5 of the file is the one of the reorganized chain.
+    headers.insert(5, rick_blocker_5());
+    headers
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+fn rick_spv_conf() -> SPVConf {
+    json::from_value(json!({
+        "starting_block_header": {
+            "height": 1,
+            "hash": "0918169860eda78df99319a4d073d325017fbda08dd10375a6de8b6214cef3f5",
+            "time": 1681404988,
+            "bits": 537857807
+        }
+    }))
+    .unwrap()
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+fn rick_headers_range(
+    headers: &HashMap<u64, BlockHeader>,
+    from: u64,
+    to: u64,
+) -> (HashMap<u64, BlockHeader>, Vec<BlockHeader>) {
+    let headers_vec: Vec<_> = (from..=to).map(|height| headers[&height].clone()).collect();
+    let headers_map = (from..=to).zip(headers_vec.iter().cloned()).collect();
+    (headers_map, headers_vec)
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+#[test]
+fn test_prefetched_headers_chunks_out_of_order() {
+    use crate::utxo::utxo_builder::{prefetch_headers_chunks, validate_prefetched_headers};
+
+    let headers = rick_valid_headers();
+    let requested = Arc::new(Mutex::new(Vec::new()));
+    ElectrumClient::retrieve_headers_from.mock_safe({
+        let headers = headers.clone();
+        let requested = requested.clone();
+        move |_this, server_address, from_height, to_height| {
+            requested
+                .lock()
+                .unwrap()
+                .push((server_address.to_owned(), from_height, to_height));
+            // The later chunks arrive first.
+            let delay = (10 - from_height) as f64 * 0.1;
+            let retrieved = rick_headers_range(&headers, from_height, to_height);
+            let fut = async move {
+                Timer::sleep(delay).await;
+                Ok::<_, MmError<UtxoRpcError>>(retrieved)
+            };
+            MockResult::Return(Box::new(fut.boxed().compat()))
+        }
+    });
+
+    let client = electrum_client_for_test(DOC_ELECTRUM_ADDRS);
+    let servers: Vec<_> = ["server0", "server1", "server2"]
+        .iter()
+        .map(|s| s.to_string())
+        .collect();
+    // The headers `2..=3` are retrieved from `server0` and validated already.
+    let prefetched = prefetch_headers_chunks(&client, &servers, 0, 4, 9, 2);
+    let expected_requests = vec![
+        ("server1".to_owned(), 4, 5),
+        ("server2".to_owned(), 6, 7),
+        ("server0".to_owned(), 8, 9),
+    ];
+    assert_eq!(*requested.lock().unwrap(), expected_requests);
+
+    let (block_registry, _) = rick_headers_range(&headers, 2, 3);
+    let validated = block_on(validate_prefetched_headers(
+        &client,
+        &rick_spv_conf(),
+        3,
+        block_registry,
+        prefetched,
+    ));
+    let mut validated_heights: Vec<_> = validated.keys().copied().collect();
+    validated_heights.sort_unstable();
+    assert_eq!(validated_heights, (2..=9).collect::<Vec<_>>());
+    for (height, header) in validated {
+        assert_eq!(header, headers[&height]);
+    }
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+#[test]
+fn test_prefetched_headers_chunk_fails_validation() {
+    use crate::utxo::utxo_builder::{validate_prefetched_headers, PrefetchedHeadersChunk};
+    use futures::channel::oneshot;
+
+    let headers = rick_valid_headers();
+    let prefetched_chunk = |from: u64, retrieved| {
+        let (result_tx, result_rx) = oneshot::channel();
+        result_tx.send(retrieved).ok();
+        PrefetchedHeadersChunk { from, result_rx }
+    };
+    let validated_heights = |validated: HashMap<u64, BlockHeader>| {
+        let mut heights: Vec<_> = validated.into_keys().collect();
+        heights.sort_unstable();
+        heights
+    };
+    let client = electrum_client_for_test(DOC_ELECTRUM_ADDRS);
+    let (block_registry, _) = rick_headers_range(&headers, 2, 3);
+
+    // The chunk that starts at 6 contains `7..=8` headers that don't link to the header 5,
+    // so it's dropped along with the valid chunk that follows it.
+    let prefetched = vec![
+        prefetched_chunk(4, Ok(rick_headers_range(&headers, 4, 5))),
+        prefetched_chunk(6, Ok(rick_headers_range(&headers, 7, 8))),
+        prefetched_chunk(8, Ok(rick_headers_range(&headers, 8, 9))),
+    ];
+    let validated = block_on(validate_prefetched_headers(
+        &client,
+        &rick_spv_conf(),
+        3,
+        block_registry.clone(),
+        prefetched,
+    ));
+    assert_eq!(validated_heights(validated), vec![2, 3, 4, 5]);
+
+    // A chunk that failed to be retrieved stops the validation too.
+    let prefetched = vec![
+        prefetched_chunk(4, MmError::err(UtxoRpcError::Internal("Connection lost".to_owned()))),
+        prefetched_chunk(6, Ok(rick_headers_range(&headers, 6, 7))),
+    ];
+    let validated = block_on(validate_prefetched_headers(
+        &client,
+        &rick_spv_conf(),
+        3,
+        block_registry,
+        prefetched,
+    ));
+    assert_eq!(validated_heights(validated), vec![2, 3]);
+}
+
 #[test]
 fn test_electrum_v14_block_hash() {
     let client = electrum_client_for_test(DOC_ELECTRUM_ADDRS);
@@ -134,6 +134,9 @@ pub trait UtxoTxHistoryOps:
 
     async fn get_block_timestamp(&self, height: u64) -> MmResult<u64, GetBlockHeaderError>;
 
+    /// Requests timestamps of the blocks at the given `heights`.
+    async fn get_block_timestamps(&self, heights: Vec<u64>) -> MmResult<HashMap<u64, u64>, GetBlockHeaderError>;
+
     /// Requests balances of all activated coin's addresses.
     async fn my_addresses_balances(&self) -> BalanceResult<HashMap<String, BigDecimal>>;
 
@@ -593,18 +596,32 @@ where
 
         let my_addresses = try_or_stop_unknown!(ctx.coin.my_addresses().await, "Error on getting my addresses");
 
+        let mut txs_to_fetch = Vec::new();
         for (tx_hash, height) in self.all_tx_ids_with_height {
             let tx_hash_string = format!("{:02x}", tx_hash);
             match ctx.storage.history_has_tx_hash(&wallet_id, &tx_hash_string).await {
                 Ok(true) => continue,
-                Ok(false) => (),
+                Ok(false) => txs_to_fetch.push((tx_hash, height)),
                 Err(e) => return Self::change_state(Stopped::storage_error(e)),
             }
+        }
+
+        // Request the timestamps of all the blocks at once, so that the stored headers are read by ranges.
+        let heights = txs_to_fetch
+            .iter()
+            .map(|(_, height)| *height)
+            .filter(|height| *height > 0)
+            .collect();
+        let timestamps = match ctx.coin.get_block_timestamps(heights).await {
+            Ok(timestamps) => timestamps,
+            Err(_) => return Self::change_state(OnIoErrorCooldown::new(self.requested_for_addresses)),
+        };
 
+        for (tx_hash, height) in txs_to_fetch {
             let block_height_and_time = if height > 0 {
-                let timestamp = match ctx.coin.get_block_timestamp(height).await {
-                    Ok(time) => time,
-                    Err(_) => return Self::change_state(OnIoErrorCooldown::new(self.requested_for_addresses)),
+                let timestamp = match timestamps.get(&height) {
+                    Some(time) => *time,
+                    None => return Self::change_state(OnIoErrorCooldown::new(self.requested_for_addresses)),
                 };
                 Some(BlockHeightAndTime { height, timestamp })
             } else {
@@ -825,6 +825,9 @@ pub struct ZcoinActivationParams {
     pub zcash_params_path: Option<String>,
     pub scan_blocks_per_iteration: NonZeroU32,
     pub scan_interval_ms: u64,
+    /// The number of the already scanned blocks to keep in the compact blocks cache,
+    /// the older blocks are pruned after every scan. The cache isn't pruned if not set.
+    pub blocks_cache_retention: Option<NonZeroU32>,
     pub account: u32,
 }
 
@@ -844,6 +847,7 @@ impl Default for ZcoinActivationParams {
             zcash_params_path: None,
             scan_blocks_per_iteration: NonZeroU32::new(1000).expect("1000 is a valid value"),
             scan_interval_ms: Default::default(),
+            blocks_cache_retention: None,
             account: Default::default(),
         }
     }
@@ -1,3 +1,5 @@
+use crate::z_coin::tx_history_events::ZCoinTxHistoryEventStreamer;
+use crate::z_coin::z_balance_streaming::ZCoinBalanceEventStreamer;
 use crate::z_coin::{ValidateBlocksError, ZcoinConsensusParams, ZcoinStorageError};
 use mm2_event_stream::StreamingManager;
 
@@ -14,22 +16,30 @@ pub(crate) use z_locked_notes::{LockedNotesStorage, LockedNotesStorageError};
 #[cfg(target_arch = "wasm32")]
 pub(crate) use z_params::ZcashParamsWasmImpl;
 
+#[cfg(not(target_arch = "wasm32"))] use common::async_blocking;
+#[cfg(not(target_arch = "wasm32"))]
+use futures::future::join_all;
 use mm2_err_handle::mm_error::MmResult;
+use protobuf::Message;
+use std::collections::HashSet;
+use std::mem;
+#[cfg(not(target_arch = "wasm32"))] use std::num::NonZeroUsize;
+use std::sync::Arc;
 #[cfg(target_arch = "wasm32")]
 use walletdb::wasm::storage::DataConnStmtCacheWasm;
 #[cfg(debug_assertions)]
 use zcash_client_backend::data_api::error::Error;
 use zcash_client_backend::data_api::PrunedBlock;
-use zcash_client_backend::proto::compact_formats::CompactBlock;
+use zcash_client_backend::proto::compact_formats::{CompactBlock, CompactOutput, CompactTx};
 use zcash_client_backend::wallet::{AccountId, WalletTx};
 use zcash_client_backend::welding_rig::scan_block;
 #[cfg(not(target_arch = "wasm32"))]
 use zcash_client_sqlite::for_async::DataConnStmtCacheAsync;
-use zcash_extras::{WalletRead, WalletWrite};
+use zcash_extras::{NoteId, WalletRead, WalletWrite};
 use zcash_primitives::block::BlockHash;
 use zcash_primitives::consensus::BlockHeight;
-use zcash_primitives::merkle_tree::CommitmentTree;
-use zcash_primitives::sapling::Nullifier;
+use zcash_primitives::merkle_tree::{CommitmentTree, IncrementalWitness};
+use zcash_primitives::sapling::{Node, Nullifier};
 use zcash_primitives::zip32::ExtendedFullViewingKey;
 
 pub type ZcoinStorageRes<T> = MmResult<T, ZcoinStorageError>;
@@ -117,87 +127,402 @@ pub async fn validate_chain(
 /// Scanned blocks are required to be height-sequential. If a block is missing from
 /// the cache, an error will be returned with kind [`ChainInvalid::BlockHeightDiscontinuity`].
 ///
-pub async fn scan_cached_block(
+/// The `rows` are decoded and trial-decrypted in parallel (see [`decode_blocks`]), then committed
+/// to `data` one by one in the height order. The transactions that have neither outputs decryptable by the tracked
+/// accounts nor spends of the tracked notes only append their note commitments to the tree and the witnesses,
+/// the rest are scanned again with [`scan_block`] against the actual tree to get their witnesses and nullifiers.
+pub async fn scan_cached_blocks(
     data: &DataConnStmtCacheWrapper,
     params: &ZcoinConsensusParams,
-    block: &CompactBlock,
+    rows: Vec<CompactBlockRow>,
     locked_notes_db: &LockedNotesStorage,
-    last_height: &mut BlockHeight,
-) -> Result<Vec<WalletTx<Nullifier>>, ValidateBlocksError> {
+    streaming_manager: &StreamingManager,
+    ticker: &str,
+    mut last_height: BlockHeight,
+) -> Result<(), ValidateBlocksError> {
     let mut data_guard = data.inner().clone();
     // Fetch the ExtendedFullViewingKeys we are tracking
-    let extfvks = data_guard.get_extended_full_viewing_keys().await?;
-    let extfvks: Vec<(&AccountId, &ExtendedFullViewingKey)> = extfvks.iter().collect();
+    let extfvks: Vec<(AccountId, ExtendedFullViewingKey)> =
+        data_guard.get_extended_full_viewing_keys().await?.into_iter().collect();
+    let blocks = decode_blocks(params, rows, Arc::new(extfvks.clone()), ticker).await?;
+    let extfvks: Vec<(&AccountId, &ExtendedFullViewingKey)> =
+        extfvks.iter().map(|(account, extfvk)| (account, extfvk)).collect();
 
     // Get the most recent CommitmentTree
     let mut tree = data_guard
-        .get_commitment_tree(*last_height)
+        .get_commitment_tree(last_height)
         .await
         .map(|t| t.unwrap_or_else(CommitmentTree::empty))?;
     // Get most recent incremental witnesses for the notes we are tracking
-    let mut witnesses = data_guard.get_witnesses(*last_height).await?;
+    let mut witnesses = data_guard.get_witnesses(last_height).await?;
 
     // Get the nullifiers for the notes we are tracking
     let mut nullifiers = data_guard.get_nullifiers().await?;
 
-    let current_height = block.height();
-    // Scanned blocks MUST be height-sequential.
-    if current_height != (*last_height + 1) {
-        return Err(ValidateBlocksError::block_height_discontinuity(
-            *last_height + 1,
-            current_height,
-        ));
+    for DecodedBlock {
+        mut block,
+        received_notes_txs,
+    } in blocks
+    {
+        let current_height = block.height();
+        // Scanned blocks MUST be height-sequential.
+        if current_height != (last_height + 1) {
+            return Err(ValidateBlocksError::block_height_discontinuity(
+                last_height + 1,
+                current_height,
+            ));
+        }
+
+        // Only the transactions with the trial decryption hits or spends of the tracked notes are scanned again,
+        // the nullifiers are checked here since the notes received by the previous blocks of the batch can be spent.
+        let vtx = mem::take(&mut block.vtx);
+        let mut txs: Vec<WalletTx<Nullifier>> = Vec::new();
+        for tx in vtx {
+            if received_notes_txs.contains(&(tx.index as usize)) || spends_tracked_notes(&tx, &nullifiers) {
+                let mut tx_block = block.clone();
+                tx_block.vtx.push(tx);
+                let mut witness_refs = tracked_witnesses(&mut witnesses, &mut txs);
+                let scanned = scan_block(
+                    params,
+                    tx_block,
+                    &extfvks,
+                    &nullifiers,
+                    &mut tree,
+                    &mut witness_refs[..],
+                );
+                txs.extend(scanned);
+            } else {
+                let mut witness_refs = tracked_witnesses(&mut witnesses, &mut txs);
+                append_note_commitments(current_height, &tx.outputs, &mut tree, &mut witness_refs[..])?;
+            }
+        }
+
+        // To enforce that all roots match,
+        // see -> https://github.com/KomodoPlatform/librustzcash/blob/e92443a7bbd1c5e92e00e6deb45b5a33af14cea4/zcash_client_backend/src/data_api/chain.rs#L304-L326
+        let new_witnesses = data_guard
+            .advance_by_block(
+                &(PrunedBlock {
+                    block_height: current_height,
+                    block_hash: BlockHash::from_slice(&block.hash),
+                    block_time: block.time,
+                    commitment_tree: &tree,
+                    transactions: &txs,
+                }),
+                &witnesses,
+            )
+            .await?;
+
+        let spent_nf: Vec<Nullifier> = txs
+            .iter()
+            .flat_map(|tx| tx.shielded_spends.iter().map(|spend| spend.nf))
+            .collect();
+        nullifiers.retain(|(_, nf)| !spent_nf.contains(nf));
+        nullifiers.extend(
+            txs.iter()
+                .flat_map(|tx| tx.shielded_outputs.iter().map(|out| (out.account, out.nf))),
+        );
+
+        witnesses.extend(new_witnesses);
+        last_height = current_height;
+
+        if txs.is_empty() {
+            continue;
+        }
+
+        // TODO: Execute updates to `locked_notes_db` and `wallet_db` in a single transaction.
+        // This will be possible with a newer librustzcash that supports both spent notes and unconfirmed change tracking.
+        // See: https://github.com/KomodoPlatform/komodo-defi-framework/pull/2331#pullrequestreview-2883773336
+        for tx in &txs {
+            locked_notes_db
+                .remove_notes_for_txid(tx.txid.to_string())
+                .await
+                .map_err(|err| ValidateBlocksError::DbError(err.to_string()))?;
+        }
+
+        // Stream out the new transactions.
+        streaming_manager
+            .send(&ZCoinTxHistoryEventStreamer::derive_streamer_id(ticker), txs)
+            .ok();
+        // And also stream balance changes.
+        streaming_manager
+            .send(&ZCoinBalanceEventStreamer::derive_streamer_id(ticker), ())
+            .ok();
     }
 
-    let txs: Vec<WalletTx<Nullifier>> = {
-        let mut witness_refs: Vec<_> = witnesses.iter_mut().map(|w| &mut w.1).collect();
-        scan_block(
-            params,
-            block.clone(),
-            &extfvks,
-            &nullifiers,
-            &mut tree,
-            &mut witness_refs[..],
-        )
+    Ok(())
+}
+
+struct DecodedBlock {
+    block: CompactBlock,
+    /// The indexes of the block transactions that have outputs decryptable by the tracked accounts.
+    received_notes_txs: HashSet<usize>,
+}
+
+/// Decodes the `rows` and trial-decrypts their outputs with the `extfvks`,
+/// the rows are sharded across the blocking threads pool. The blocks are returned in the `rows` order.
+#[cfg(not(target_arch = "wasm32"))]
+async fn decode_blocks(
+    params: &ZcoinConsensusParams,
+    mut rows: Vec<CompactBlockRow>,
+    extfvks: Arc<Vec<(AccountId, ExtendedFullViewingKey)>>,
+    ticker: &str,
+) -> Result<Vec<DecodedBlock>, ValidateBlocksError> {
+    let workers = std::thread::available_parallelism().map_or(1, NonZeroUsize::get);
+    let shard_len = ((rows.len() + workers - 1) / workers).max(1);
+    let mut shards = Vec::with_capacity(workers);
+    while rows.len() > shard_len {
+        let rest = rows.split_off(shard_len);
+        shards.push(mem::replace(&mut rows, rest));
+    }
+    shards.push(rows);
+
+    let tasks = shards.into_iter().map(|shard| {
+        let params = params.clone();
+        let extfvks = extfvks.clone();
+        let ticker = ticker.to_owned();
+        async_blocking(move || {
+            shard
+                .into_iter()
+                .map(|row| decode_block(&params, row, &extfvks, &ticker))
+                .collect::<Result<Vec<_>, _>>()
+        })
+    });
+
+    let mut blocks = Vec::new();
+    for shard in join_all(tasks).await {
+        blocks.extend(shard?);
+    }
+    Ok(blocks)
+}
+
+/// Decodes the `rows` and trial-decrypts their outputs with the `extfvks`.
+/// There are no threads to shard the rows across in the browser.
+#[cfg(target_arch = "wasm32")]
+async fn decode_blocks(
+    params: &ZcoinConsensusParams,
+    rows: Vec<CompactBlockRow>,
+    extfvks: Arc<Vec<(AccountId, ExtendedFullViewingKey)>>,
+    ticker: &str,
+) -> Result<Vec<DecodedBlock>, ValidateBlocksError> {
+    rows.into_iter()
+        .map(|row| decode_block(params, row, &extfvks, ticker))
+        .collect()
+}
+
+fn decode_block(
+    params: &ZcoinConsensusParams,
+    row: CompactBlockRow,
+    extfvks: &[(AccountId, ExtendedFullViewingKey)],
+    ticker: &str,
+) -> Result<DecodedBlock, ValidateBlocksError> {
+    let block =
+        CompactBlock::parse_from_bytes(&row.data).map_err(|err| ValidateBlocksError::DecodingError(err.to_string()))?;
+    if block.height() != row.height {
+        return Err(ValidateBlocksError::CorruptedData(format!(
+            "{ticker}, Block height {} did not match row's height field value {}",
+            block.height(),
+            row.height
+        )));
+    }
+
+    let received_notes_txs = if block.vtx.iter().any(|tx| !tx.outputs.is_empty()) {
+        let extfvks: Vec<(&AccountId, &ExtendedFullViewingKey)> =
+            extfvks.iter().map(|(account, extfvk)| (account, extfvk)).collect();
+        // The tree is a throwaway one, only the trial decryption hits matter here.
+        // The actual tree is updated when the blocks are committed in the height order.
+        let mut tree = CommitmentTree::empty();
+        scan_block(params, block.clone(), &extfvks, &[], &mut tree, &mut [])
+            .into_iter()
+            .map(|tx| tx.index)
+            .collect()
+    } else {
+        HashSet::new()
     };
 
-    // To enforce that all roots match,
-    // see -> https://github.com/KomodoPlatform/librustzcash/blob/e92443a7bbd1c5e92e00e6deb45b5a33af14cea4/zcash_client_backend/src/data_api/chain.rs#L304-L326
-    let new_witnesses = data_guard
-        .advance_by_block(
-            &(PrunedBlock {
-                block_height: current_height,
-                block_hash: BlockHash::from_slice(&block.hash),
-                block_time: block.time,
-                commitment_tree: &tree,
-                transactions: &txs,
-            }),
-            &witnesses,
-        )
-        .await?;
+    Ok(DecodedBlock {
+        block,
+        received_notes_txs,
+    })
+}
 
-    let spent_nf: Vec<Nullifier> = txs
+fn spends_tracked_notes(tx: &CompactTx, nullifiers: &[(AccountId, Nullifier)]) -> bool {
+    tx.spends
         .iter()
-        .flat_map(|tx| tx.shielded_spends.iter().map(|spend| spend.nf))
-        .collect();
-    nullifiers.retain(|(_, nf)| !spent_nf.contains(nf));
-    nullifiers.extend(
-        txs.iter()
-            .flat_map(|tx| tx.shielded_outputs.iter().map(|out| (out.account, out.nf))),
-    );
-
-    witnesses.extend(new_witnesses);
-    *last_height = current_height;
-
-    // TODO: Execute updates to `locked_notes_db` and `wallet_db` in a single transaction.
-    // This will be possible with a newer librustzcash that supports both spent notes and unconfirmed change tracking.
-    // See: https://github.com/KomodoPlatform/komodo-defi-framework/pull/2331#pullrequestreview-2883773336
-    for tx in &txs {
-        locked_notes_db
-            .remove_notes_for_txid(tx.txid.to_string())
-            .await
-            .map_err(|err| ValidateBlocksError::DbError(err.to_string()))?;
+        .any(|spend| nullifiers.iter().any(|(_, nf)| nf.0.as_slice() == spend.nf.as_slice()))
+}
+
+/// The witnesses of the tracked notes followed by the witnesses of the notes received by the `txs` scanned so far
+/// in the current block, in the order [`scan_block`] would update them.
+fn tracked_witnesses<'a>(
+    witnesses: &'a mut [(NoteId, IncrementalWitness<Node>)],
+    txs: &'a mut [WalletTx<Nullifier>],
+) -> Vec<&'a mut IncrementalWitness<Node>> {
+    witnesses
+        .iter_mut()
+        .map(|(_, witness)| witness)
+        .chain(
+            txs.iter_mut()
+                .flat_map(|tx| tx.shielded_outputs.iter_mut().map(|output| &mut output.witness)),
+        )
+        .collect()
+}
+
+/// Does what [`scan_block`] does with the note commitments of a transaction that has nothing for the tracked accounts.
+/// A malformed commitment is reported as a decoding error.
+fn append_note_commitments(
+    height: BlockHeight,
+    outputs: &[CompactOutput],
+    tree: &mut CommitmentTree<Node>,
+    witnesses: &mut [&mut IncrementalWitness<Node>],
+) -> Result<(), ValidateBlocksError> {
+    let full_tree_err = || ValidateBlocksError::CorruptedData("Note commitment tree is full".to_owned());
+    for output in outputs {
+        let mut cmu = [0; 32];
+        if output.cmu.len() != cmu.len() {
+            return Err(ValidateBlocksError::DecodingError(format!(
+                "Invalid note commitment length {} at height {height}",
+                output.cmu.len(),
+            )));
+        }
+        cmu.copy_from_slice(&output.cmu);
+        let node = Node::new(cmu);
+        for witness in witnesses.iter_mut() {
+            witness.append(node).map_err(|_| full_tree_err())?;
+        }
+        tree.append(node).map_err(|_| full_tree_err())?;
+    }
+    Ok(())
+}
+
+#[cfg(all(test, not(target_arch = "wasm32")))]
+mod tests {
+    use super::*;
+    use crate::z_coin::z_rpc::z_coin_grpc::{CompactBlock as TonicCompactBlock, CompactOutput as TonicCompactOutput,
+                                            CompactSpend as TonicCompactSpend, CompactTx as TonicCompactTx};
+    use crate::z_coin::ZcoinProtocolInfo;
+    use crate::CoinProtocol;
+    use common::block_on;
+    use mm2_test_helpers::for_tests::zombie_conf;
+    use prost::Message as ProstMessage;
+
+    const TICKER: &str = "ZOMBIE";
+
+    fn consensus_params() -> ZcoinConsensusParams {
+        let protocol_info: ZcoinProtocolInfo = match serde_json::from_value(zombie_conf()["protocol"].take()).unwrap() {
+            CoinProtocol::ZHTLC(protocol_info) => protocol_info,
+            other_protocol => panic!("Failed to get protocol from config: {:?}", other_protocol),
+        };
+        protocol_info.consensus_params
     }
 
-    Ok(txs)
+    fn compact_tx(index: u64, spends: &[[u8; 32]], cmus: &[[u8; 32]]) -> TonicCompactTx {
+        TonicCompactTx {
+            index,
+            hash: vec![index as u8; 32],
+            fee: 0,
+            spends: spends.iter().map(|nf| TonicCompactSpend { nf: nf.to_vec() }).collect(),
+            outputs: cmus
+                .iter()
+                .map(|cmu| TonicCompactOutput {
+                    cmu: cmu.to_vec(),
+                    epk: vec![0; 32],
+                    ciphertext: vec![0; 52],
+                })
+                .collect(),
+        }
+    }
+
+    fn block_row(height: u32, vtx: Vec<TonicCompactTx>) -> CompactBlockRow {
+        let block = TonicCompactBlock {
+            proto_version: 0,
+            height: height as u64,
+            hash: vec![height as u8; 32],
+            prev_hash: vec![height.wrapping_sub(1) as u8; 32],
+            time: height,
+            header: Vec::new(),
+            vtx,
+        };
+        CompactBlockRow {
+            height: BlockHeight::from_u32(height),
+            data: block.encode_to_vec(),
+        }
+    }
+
+    #[test]
+    fn test_decode_blocks_keeps_rows_order() {
+        let params = consensus_params();
+        let rows: Vec<_> = (1..=97)
+            .map(|height| block_row(height, vec![compact_tx(0, &[], &[[height as u8; 32]])]))
+            .collect();
+
+        let blocks = block_on(decode_blocks(&params, rows, Arc::new(Vec::new()), TICKER)).unwrap();
+        let heights: Vec<_> = blocks.iter().map(|decoded| u32::from(decoded.block.height())).collect();
+        assert_eq!(heights, (1..=97).collect::<Vec<_>>());
+        // There are no tracked accounts to decrypt the outputs for.
+        assert!(blocks.iter().all(|decoded| decoded.received_notes_txs.is_empty()));
+
+        let mut rows: Vec<_> = (1..=10).map(|height| block_row(height, Vec::new())).collect();
+        rows[7].height = BlockHeight::from_u32(100);
+        let err = block_on(decode_blocks(&params, rows, Arc::new(Vec::new()), TICKER))
+            .err()
+            .unwrap();
+        assert!(matches!(err, ValidateBlocksError::CorruptedData(_)), "{err:?}");
+
+        let mut rows: Vec<_> = (1..=10).map(|height| block_row(height, Vec::new())).collect();
+        rows[3].data = vec![0xff; 4];
+        let err = block_on(decode_blocks(&params, rows, Arc::new(Vec::new()), TICKER))
+            .err()
+            .unwrap();
+        assert!(matches!(err, ValidateBlocksError::DecodingError(_)), "{err:?}");
+    }
+
+    #[test]
+    fn test_spends_tracked_notes() {
+        let row = block_row(1, vec![
+            compact_tx(0, &[[1; 32], [2; 32]], &[]),
+            compact_tx(1, &[[3; 32]], &[[4; 32]]),
+            compact_tx(2, &[], &[[5; 32]]),
+        ]);
+        let block = CompactBlock::parse_from_bytes(&row.data).unwrap();
+        let nullifiers = vec![(AccountId(0), Nullifier([2; 32])), (AccountId(1), Nullifier([4; 32]))];
+
+        assert!(spends_tracked_notes(&block.vtx[0], &nullifiers));
+        // The output commitments are not the nullifiers.
+        assert!(!spends_tracked_notes(&block.vtx[1], &nullifiers));
+        assert!(!spends_tracked_notes(&block.vtx[2], &nullifiers));
+        assert!(!spends_tracked_notes(&block.vtx[0], &[]));
+    }
+
+    #[test]
+    fn test_append_note_commitments() {
+        let height = BlockHeight::from_u32(1);
+        let row = block_row(1, vec![compact_tx(0, &[], &[[1; 32], [2; 32]])]);
+        let block = CompactBlock::parse_from_bytes(&row.data).unwrap();
+
+        let mut tree = CommitmentTree::empty();
+        tree.append(Node::new([3; 32])).unwrap();
+        let mut witness = IncrementalWitness::from_tree(&tree);
+        append_note_commitments(height, &block.vtx[0].outputs, &mut tree, &mut [&mut witness]).unwrap();
+        assert_eq!(tree.size(), 3);
+        assert_eq!(witness.root(), tree.root());
+
+        let mut expected = CommitmentTree::empty();
+        for cmu in [[3; 32], [1; 32], [2; 32]] {
+            expected.append(Node::new(cmu)).unwrap();
+        }
+        assert_eq!(tree.root(), expected.root());
+
+        let row = block_row(1, vec![TonicCompactTx {
+            outputs: vec![TonicCompactOutput {
+                cmu: vec![1; 31],
+                epk: vec![0; 32],
+                ciphertext: vec![0; 52],
+            }],
+            ..compact_tx(0, &[], &[])
+        }]);
+        let block = CompactBlock::parse_from_bytes(&row.data).unwrap();
+        let err = append_note_commitments(height, &block.vtx[0].outputs, &mut tree, &mut []).unwrap_err();
+        assert!(matches!(err, ValidateBlocksError::DecodingError(_)), "{err:?}");
+        assert_eq!(tree.size(), 3);
+    }
 }
@@ -1,13 +1,11 @@
-use crate::z_coin::storage::{scan_cached_block, validate_chain, BlockDbImpl, BlockProcessingMode, CompactBlockRow,
+use crate::z_coin::storage::{scan_cached_blocks, validate_chain, BlockDbImpl, BlockProcessingMode, CompactBlockRow,
                              LockedNotesStorage, ZcoinConsensusParams, ZcoinStorageRes};
-use crate::z_coin::tx_history_events::ZCoinTxHistoryEventStreamer;
-use crate::z_coin::z_balance_streaming::ZCoinBalanceEventStreamer;
 use crate::z_coin::z_coin_errors::ZcoinStorageError;
 
 use async_trait::async_trait;
 use mm2_core::mm_ctx::MmArc;
 use mm2_db::indexed_db::{BeBigUint, ConstructibleDb, DbIdentifier, DbInstance, DbLocked, DbUpgrader, IndexedDb,
-                         IndexedDbBuilder, InitDbResult, MultiIndex, OnUpgradeResult, TableSignature};
+                         IndexedDbBuilder, InitDbResult, MultiIndex, OnUpgradeError, OnUpgradeResult, TableSignature};
 use mm2_err_handle::prelude::*;
 use protobuf::Message;
 use zcash_client_backend::proto::compact_formats::CompactBlock;
@@ -16,7 +14,7 @@ use zcash_primitives::block::BlockHash;
 use zcash_primitives::consensus::BlockHeight;
 
 const DB_NAME: &str = "z_compactblocks_cache";
-const DB_VERSION: u32 = 1;
+const DB_VERSION: u32 = 2;
 
 pub type BlockDbInnerLocked<'a> = DbLocked<'a, BlockDbInner>;
 
@@ -34,12 +32,62 @@ impl BlockDbTable {
 impl TableSignature for BlockDbTable {
     const TABLE_NAME: &'static str = "compactblocks";
 
-    fn on_upgrade_needed(upgrader: &DbUpgrader, old_version: u32, new_version: u32) -> OnUpgradeResult<()> {
-        if let (0, 1) = (old_version, new_version) {
-            let table = upgrader.create_table(Self::TABLE_NAME)?;
-            table.create_multi_index(Self::TICKER_HEIGHT_INDEX, &["ticker", "height"], true)?;
-            table.create_index("ticker", false)?;
-            table.create_index("height", false)?;
+    fn on_upgrade_needed(upgrader: &DbUpgrader, mut old_version: u32, new_version: u32) -> OnUpgradeResult<()> {
+        while old_version < new_version {
+            match old_version {
+                0 => {
+                    let table = upgrader.create_table(Self::TABLE_NAME)?;
+                    table.create_multi_index(Self::TICKER_HEIGHT_INDEX, &["ticker", "height"], true)?;
+                    table.create_index("ticker", false)?;
+                    table.create_index("height", false)?;
+                },
+                1 => {},
+                unsupported_version => {
+                    return MmError::err(OnUpgradeError::UnsupportedVersion {
+                        unsupported_version,
+                        old_version,
+                        new_version,
+                    })
+                },
+            }
+
+            old_version += 1;
+        }
+        Ok(())
+    }
+}
+
+/// The height the blocks cache of the `ticker` was synced from.
+/// Unlike the earliest cached block, it's not moved forward by the blocks cache retention.
+#[derive(Clone, Debug, Deserialize, Serialize)]
+pub struct SyncStartTable {
+    ticker: String,
+    height: u32,
+}
+
+impl TableSignature for SyncStartTable {
+    const TABLE_NAME: &'static str = "sync_start";
+
+    fn on_upgrade_needed(upgrader: &DbUpgrader, mut old_version: u32, new_version: u32) -> OnUpgradeResult<()> {
+        while old_version < new_version {
+            match old_version {
+                0 => {
+                    // The table is created on the upgrade from version 1 to 2 to not break the existing databases.
+                },
+                1 => {
+                    let table = upgrader.create_table(Self::TABLE_NAME)?;
+                    table.create_index("ticker", true)?;
+                },
+                unsupported_version => {
+                    return MmError::err(OnUpgradeError::UnsupportedVersion {
+                        unsupported_version,
+                        old_version,
+                        new_version,
+                    })
+                },
+            }
+
+            old_version += 1;
         }
         Ok(())
     }
@@ -55,6 +103,7 @@ impl DbInstance for BlockDbInner {
         let inner = IndexedDbBuilder::new(db_id)
             .with_version(DB_VERSION)
             .with_table::<BlockDbTable>()
+            .with_table::<SyncStartTable>()
             .build()
             .await?;
 
@@ -123,6 +172,63 @@ impl BlockDbImpl {
             .get_id() as usize)
     }
 
+    /// Inserts the `(height, data)` blocks within a single transaction.
+    pub async fn insert_blocks(&self, blocks: Vec<(u32, Vec<u8>)>) -> ZcoinStorageRes<usize> {
+        let locked_db = self.lock_db().await?;
+        let db_transaction = locked_db.get_inner().transaction().await?;
+        let block_db = db_transaction.table::<BlockDbTable>().await?;
+
+        let inserted = blocks.len();
+        for (height, data) in blocks {
+            let indexes = MultiIndex::new(BlockDbTable::TICKER_HEIGHT_INDEX)
+                .with_value(&self.ticker)?
+                .with_value(BeBigUint::from(height))?;
+            let block = BlockDbTable {
+                height,
+                data,
+                ticker: self.ticker.clone(),
+            };
+            block_db
+                .add_item_or_ignore_by_unique_multi_index(indexes, &block)
+                .await?;
+        }
+
+        Ok(inserted)
+    }
+
+    /// Removes the blocks below the given `height`, e.g. the ones that are already scanned into the wallet db.
+    pub async fn remove_blocks_below(&self, height: BlockHeight) -> ZcoinStorageRes<usize> {
+        let height = u32::from(height);
+        if height == 0 {
+            return Ok(0);
+        }
+
+        let locked_db = self.lock_db().await?;
+        let db_transaction = locked_db.get_inner().transaction().await?;
+        let block_db = db_transaction.table::<BlockDbTable>().await?;
+
+        let blocks = block_db
+            .cursor_builder()
+            .only("ticker", &self.ticker)?
+            .bound("height", 0u32, height - 1)
+            .open_cursor(BlockDbTable::TICKER_HEIGHT_INDEX)
+            .await?
+            .collect()
+            .await?;
+
+        for (_, block) in &blocks {
+            block_db
+                .delete_item_by_unique_multi_index(
+                    MultiIndex::new(BlockDbTable::TICKER_HEIGHT_INDEX)
+                        .with_value(&self.ticker)?
+                        .with_value(block.height)?,
+                )
+                .await?;
+        }
+
+        Ok(blocks.len())
+    }
+
     /// Asynchronously rewinds the storage to a specified block height, effectively
     /// removing data beyond the specified height from the storage.
     pub async fn rewind_to_height(&self, height: BlockHeight) -> ZcoinStorageRes<usize> {
@@ -173,6 +279,32 @@ impl BlockDbImpl {
         Ok(maybe_min_block.map(|(_, b)| b.height).unwrap_or(0))
     }
 
+    /// Returns the height the blocks cache was synced from, see [`BlockDbImpl::set_sync_start_height`].
+    pub(crate) async fn get_sync_start_height(&self) -> ZcoinStorageRes<Option<u32>> {
+        let locked_db = self.lock_db().await?;
+        let db_transaction = locked_db.get_inner().transaction().await?;
+        let sync_start_db = db_transaction.table::<SyncStartTable>().await?;
+        let maybe_sync_start = sync_start_db.get_item_by_unique_index("ticker", &self.ticker).await?;
+
+        Ok(maybe_sync_start.map(|(_, sync_start)| sync_start.height))
+    }
+
+    /// Persists the height the blocks cache is synced from.
+    pub(crate) async fn set_sync_start_height(&self, height: u32) -> ZcoinStorageRes<()> {
+        let locked_db = self.lock_db().await?;
+        let db_transaction = locked_db.get_inner().transaction().await?;
+        let sync_start_db = db_transaction.table::<SyncStartTable>().await?;
+        let sync_start = SyncStartTable {
+            ticker: self.ticker.clone(),
+            height,
+        };
+        sync_start_db
+            .replace_item_by_unique_index("ticker", &self.ticker, &sync_start)
+            .await?;
+
+        Ok(())
+    }
+
     /// Queries and retrieves a list of `CompactBlockRow` records from the database, starting
     /// from a specified block height and optionally limited by a maximum number of blocks.
     pub async fn query_blocks_by_limit(
@@ -223,7 +355,7 @@ impl BlockDbImpl {
         locked_notes_db: &LockedNotesStorage,
     ) -> ZcoinStorageRes<()> {
         let ticker = self.ticker.to_owned();
-        let mut from_height = match &mode {
+        let from_height = match &mode {
             BlockProcessingMode::Validate => validate_from
                 .map(|(height, _)| height)
                 .unwrap_or(BlockHeight::from_u32(params.sapling_activation_height) - 1),
@@ -232,10 +364,25 @@ impl BlockDbImpl {
                     .unwrap_or(BlockHeight::from_u32(params.sapling_activation_height) - 1)
             })?,
         };
+        let blocks_to_scan = self.query_blocks_by_limit(from_height, limit).await?;
+
+        if let BlockProcessingMode::Scan(data, streaming_manager) = &mode {
+            scan_cached_blocks(
+                data,
+                &params,
+                blocks_to_scan,
+                locked_notes_db,
+                streaming_manager,
+                &ticker,
+                from_height,
+            )
+            .await?;
+            return Ok(());
+        }
+
         let mut prev_height = from_height;
         let mut prev_hash: Option<BlockHash> = validate_from.map(|(_, hash)| hash);
 
-        let blocks_to_scan = self.query_blocks_by_limit(from_height, limit).await?;
         for block in blocks_to_scan {
             let cbr = block;
             let block = CompactBlock::parse_from_bytes(&cbr.data)
@@ -249,24 +396,7 @@ impl BlockDbImpl {
                 )));
             }
 
-            match &mode.clone() {
-                BlockProcessingMode::Validate => {
-                    validate_chain(block, &mut prev_height, &mut prev_hash).await?;
-                },
-                BlockProcessingMode::Scan(data, streaming_manager) => {
-                    let txs = scan_cached_block(data, &params, &block, locked_notes_db, &mut from_height).await?;
-                    if !txs.is_empty() {
-                        // Stream out the new transactions.
-                        streaming_manager
-                            .send(&ZCoinTxHistoryEventStreamer::derive_streamer_id(&ticker), txs)
-                            .ok();
-                        // And also stream balance changes.
-                        streaming_manager
-                            .send(&ZCoinBalanceEventStreamer::derive_streamer_id(&ticker), ())
-                            .ok();
-                    };
-                },
-            }
+            validate_chain(block, &mut prev_height, &mut prev_hash).await?;
         }
 
         Ok(())
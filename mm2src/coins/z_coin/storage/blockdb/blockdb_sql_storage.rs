@@ -1,12 +1,10 @@
-use crate::z_coin::storage::{scan_cached_block, validate_chain, BlockDbImpl, BlockProcessingMode, CompactBlockRow,
+use crate::z_coin::storage::{scan_cached_blocks, validate_chain, BlockDbImpl, BlockProcessingMode, CompactBlockRow,
                              LockedNotesStorage, ZcoinStorageRes};
-use crate::z_coin::tx_history_events::ZCoinTxHistoryEventStreamer;
-use crate::z_coin::z_balance_streaming::ZCoinBalanceEventStreamer;
 use crate::z_coin::z_coin_errors::ZcoinStorageError;
 use crate::z_coin::ZcoinConsensusParams;
 
 use common::async_blocking;
-use db_common::sqlite::rusqlite::{params, Connection};
+use db_common::sqlite::rusqlite::{params, params_from_iter, Connection, ToSql};
 use db_common::sqlite::{query_single_row, run_optimization_pragmas, rusqlite};
 use itertools::Itertools;
 use mm2_core::mm_ctx::MmArc;
@@ -21,6 +19,17 @@ use zcash_extras::WalletRead;
 use zcash_primitives::block::BlockHash;
 use zcash_primitives::consensus::BlockHeight;
 
+/// The maximum number of rows inserted by a single `INSERT` statement.
+/// Every row takes 2 parameters, this keeps the statement below the default `SQLITE_MAX_VARIABLE_NUMBER` of 999.
+const INSERT_BLOCKS_CHUNK_SIZE: usize = 256;
+
+/// Keeps the height the blocks cache was synced from in a single row.
+/// Unlike the earliest cached block, it's not moved forward by the blocks cache retention.
+const CREATE_SYNC_START_TABLE: &str = "CREATE TABLE IF NOT EXISTS sync_start (
+    id INTEGER PRIMARY KEY CHECK (id = 0),
+    height INTEGER NOT NULL
+)";
+
 impl From<ZcashClientError> for ZcoinStorageError {
     fn from(value: ZcashClientError) -> Self {
         match value {
@@ -62,6 +71,9 @@ impl BlockDbImpl {
                     [],
                 )
                 .map_to_mm(|err| ZcoinStorageError::DbError(err.to_string()))?;
+            conn_lock
+                .execute(CREATE_SYNC_START_TABLE, [])
+                .map_to_mm(|err| ZcoinStorageError::DbError(err.to_string()))?;
             drop(conn_lock);
 
             Ok(Self { db: conn, ticker })
@@ -89,6 +101,9 @@ impl BlockDbImpl {
                     [],
                 )
                 .map_to_mm(|err| ZcoinStorageError::DbError(err.to_string()))?;
+            conn_lock
+                .execute(CREATE_SYNC_START_TABLE, [])
+                .map_to_mm(|err| ZcoinStorageError::DbError(err.to_string()))?;
             drop(conn_lock);
 
             Ok(BlockDbImpl { db: conn, ticker })
@@ -126,6 +141,52 @@ impl BlockDbImpl {
         .await
     }
 
+    /// Inserts the `(height, data)` blocks within a single transaction using multi-row inserts.
+    /// The blocks already stored are ignored as on IndexedDB, e.g. when a sync is restarted after a partial batch.
+    pub(crate) async fn insert_blocks(&self, blocks: Vec<(u32, Vec<u8>)>) -> ZcoinStorageRes<usize> {
+        let db = self.db.clone();
+        async_blocking(move || {
+            let mut db = db.lock().unwrap();
+            let tx = db
+                .transaction()
+                .map_to_mm(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))?;
+
+            let mut inserted = 0;
+            for chunk in blocks.chunks(INSERT_BLOCKS_CHUNK_SIZE) {
+                let sql = format!(
+                    "INSERT OR IGNORE INTO compactblocks (height, data) VALUES {}",
+                    vec!["(?, ?)"; chunk.len()].join(", ")
+                );
+                let params = chunk
+                    .iter()
+                    .flat_map(|(height, data)| [height as &dyn ToSql, data as &dyn ToSql]);
+                // All the chunks but the last one have the same size, so the statement is prepared at most twice.
+                inserted += tx
+                    .prepare_cached(&sql)
+                    .map_to_mm(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))?
+                    .execute(params_from_iter(params))
+                    .map_to_mm(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))?;
+            }
+
+            tx.commit()
+                .map_to_mm(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))?;
+            Ok(inserted)
+        })
+        .await
+    }
+
+    /// Removes the blocks below the given `height`, e.g. the ones that are already scanned into the wallet db.
+    pub(crate) async fn remove_blocks_below(&self, height: BlockHeight) -> ZcoinStorageRes<usize> {
+        let db = self.db.clone();
+        async_blocking(move || {
+            db.lock()
+                .unwrap()
+                .execute("DELETE from compactblocks WHERE height < ?1", [u32::from(height)])
+                .map_to_mm(|err| ZcoinStorageError::RemoveFromStorageErr(err.to_string()))
+        })
+        .await
+    }
+
     pub(crate) async fn rewind_to_height(&self, height: BlockHeight) -> ZcoinStorageRes<usize> {
         let db = self.db.clone();
         async_blocking(move || {
@@ -153,6 +214,36 @@ impl BlockDbImpl {
         .unwrap_or(0))
     }
 
+    /// Returns the height the blocks cache was synced from, see [`BlockDbImpl::set_sync_start_height`].
+    pub(crate) async fn get_sync_start_height(&self) -> ZcoinStorageRes<Option<u32>> {
+        let db = self.db.clone();
+        async_blocking(move || {
+            query_single_row(
+                &db.lock().unwrap(),
+                "SELECT height FROM sync_start WHERE id = 0",
+                [],
+                |row| row.get::<_, u32>(0),
+            )
+        })
+        .await
+        .map_to_mm(|err| ZcoinStorageError::GetFromStorageError(err.to_string()))
+    }
+
+    /// Persists the height the blocks cache is synced from.
+    pub(crate) async fn set_sync_start_height(&self, height: u32) -> ZcoinStorageRes<()> {
+        let db = self.db.clone();
+        async_blocking(move || {
+            db.lock()
+                .unwrap()
+                .execute("INSERT OR REPLACE INTO sync_start (id, height) VALUES (0, ?1)", [
+                    height,
+                ])
+                .map(|_| ())
+                .map_to_mm(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))
+        })
+        .await
+    }
+
     pub(crate) async fn query_blocks_by_limit(
         &self,
         from_height: BlockHeight,
@@ -195,7 +286,7 @@ impl BlockDbImpl {
         locked_notes_db: &LockedNotesStorage,
     ) -> ZcoinStorageRes<()> {
         let ticker = self.ticker.to_owned();
-        let mut from_height = match &mode {
+        let from_height = match &mode {
             BlockProcessingMode::Validate => validate_from
                 .map(|(height, _)| height)
                 .unwrap_or(BlockHeight::from_u32(params.sapling_activation_height) - 1),
@@ -210,6 +301,24 @@ impl BlockDbImpl {
 
         let rows = self.query_blocks_by_limit(from_height, limit).await?;
 
+        if let BlockProcessingMode::Scan(data, streaming_manager) = &mode {
+            let rows = rows
+                .into_iter()
+                .collect::<Result<Vec<_>, _>>()
+                .map_err(|err| ZcoinStorageError::AddToStorageErr(err.to_string()))?;
+            scan_cached_blocks(
+                data,
+                &params,
+                rows,
+                locked_notes_db,
+                streaming_manager,
+                &ticker,
+                from_height,
+            )
+            .await?;
+            return Ok(());
+        }
+
         let mut prev_height = from_height;
         let mut prev_hash: Option<BlockHash> = validate_from.map(|(_, hash)| hash);
 
@@ -226,24 +335,7 @@ impl BlockDbImpl {
                 )));
             }
 
-            match &mode.clone() {
-                BlockProcessingMode::Validate => {
-                    validate_chain(block, &mut prev_height, &mut prev_hash).await?;
-                },
-                BlockProcessingMode::Scan(data, streaming_manager) => {
-                    let txs = scan_cached_block(data, &params, &block, locked_notes_db, &mut from_height).await?;
-                    if !txs.is_empty() {
-                        // Stream out the new transactions.
-                        streaming_manager
-                            .send(&ZCoinTxHistoryEventStreamer::derive_streamer_id(&ticker), txs)
-                            .ok();
-                        // And also stream balance changes.
-                        streaming_manager
-                            .send(&ZCoinBalanceEventStreamer::derive_streamer_id(&ticker), ())
-                            .ok();
-                    };
-                },
-            }
+            validate_chain(block, &mut prev_height, &mut prev_hash).await?;
         }
         Ok(())
     }
@@ -69,6 +69,48 @@ mod block_db_storage_tests {
         assert_eq!(1900000, last_height)
     }
 
+    pub(crate) async fn test_insert_blocks_and_remove_blocks_below_impl() {
+        let ctx = mm_ctx_with_custom_db();
+        let db = BlockDbImpl::new(&ctx, TICKER.to_string()).await.unwrap();
+        let blocks: Vec<_> = HEADERS
+            .iter()
+            .map(|(height, data)| (*height, hex::decode(data).unwrap()))
+            .collect();
+        let inserted = db.insert_blocks(blocks.clone()).await.unwrap();
+        assert_eq!(HEADERS.len(), inserted);
+        assert_eq!(1900000, db.get_earliest_block().await.unwrap());
+        assert_eq!(1900002, db.get_latest_block().await.unwrap());
+
+        // The blocks already stored are ignored.
+        db.insert_blocks(blocks[1..].to_vec()).await.unwrap();
+        assert_eq!(1900000, db.get_earliest_block().await.unwrap());
+        assert_eq!(1900002, db.get_latest_block().await.unwrap());
+
+        db.remove_blocks_below(1900002.into()).await.unwrap();
+        assert_eq!(1900002, db.get_earliest_block().await.unwrap());
+        assert_eq!(1900002, db.get_latest_block().await.unwrap());
+    }
+
+    pub(crate) async fn test_sync_start_height_impl() {
+        let ctx = mm_ctx_with_custom_db();
+        let db = BlockDbImpl::new(&ctx, TICKER.to_string()).await.unwrap();
+        assert_eq!(None, db.get_sync_start_height().await.unwrap());
+
+        db.set_sync_start_height(1900000).await.unwrap();
+        let blocks = HEADERS
+            .iter()
+            .map(|(height, data)| (*height, hex::decode(data).unwrap()))
+            .collect();
+        db.insert_blocks(blocks).await.unwrap();
+        // Neither the retention nor the rewind moves the sync start.
+        db.remove_blocks_below(1900002.into()).await.unwrap();
+        db.rewind_to_height(u32::MIN.into()).await.unwrap();
+        assert_eq!(Some(1900000), db.get_sync_start_height().await.unwrap());
+
+        db.set_sync_start_height(1900001).await.unwrap();
+        assert_eq!(Some(1900001), db.get_sync_start_height().await.unwrap());
+    }
+
     #[allow(unused)]
     pub(crate) async fn test_process_blocks_with_mode_impl() {
         let ctx = mm_ctx_with_custom_db();
@@ -88,20 +130,30 @@ mod block_db_storage_tests {
 #[cfg(all(test, not(target_arch = "wasm32")))]
 mod native_tests {
     use crate::z_coin::storage::blockdb::block_db_storage_tests::{test_insert_block_and_get_latest_block_impl,
-                                                                  test_rewind_to_height_impl};
+                                                                  test_insert_blocks_and_remove_blocks_below_impl,
+                                                                  test_rewind_to_height_impl,
+                                                                  test_sync_start_height_impl};
     use common::block_on;
 
     #[test]
     fn test_insert_block_and_get_latest_block() { block_on(test_insert_block_and_get_latest_block_impl()) }
 
+    #[test]
+    fn test_insert_blocks_and_remove_blocks_below() { block_on(test_insert_blocks_and_remove_blocks_below_impl()) }
+
     #[test]
     fn test_rewind_to_height() { block_on(test_rewind_to_height_impl()) }
+
+    #[test]
+    fn test_sync_start_height() { block_on(test_sync_start_height_impl()) }
 }
 
 #[cfg(target_arch = "wasm32")]
 mod wasm_tests {
     use crate::z_coin::storage::blockdb::block_db_storage_tests::{test_insert_block_and_get_latest_block_impl,
-                                                                  test_rewind_to_height_impl};
+                                                                  test_insert_blocks_and_remove_blocks_below_impl,
+                                                                  test_rewind_to_height_impl,
+                                                                  test_sync_start_height_impl};
     // use crate::z_coin::z_rpc::{LightRpcClient, ZRpcOps};
     // use common::log::info;
     // use common::log::wasm_log::register_wasm_log;
@@ -113,9 +165,15 @@ mod wasm_tests {
     #[wasm_bindgen_test]
     async fn test_insert_block_and_get_latest_block() { test_insert_block_and_get_latest_block_impl().await }
 
+    #[wasm_bindgen_test]
+    async fn test_insert_blocks_and_remove_blocks_below() { test_insert_blocks_and_remove_blocks_below_impl().await }
+
     #[wasm_bindgen_test]
     async fn test_rewind_to_height() { test_rewind_to_height_impl().await }
 
+    #[wasm_bindgen_test]
+    async fn test_sync_start_height() { test_sync_start_height_impl().await }
+
     #[wasm_bindgen_test]
     async fn test_transport() {
         warn!("Skipping test_transport since it's failing, check https://github.com/KomodoPlatform/komodo-defi-framework/issues/2366");
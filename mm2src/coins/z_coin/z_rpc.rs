@@ -1,7 +1,7 @@
 use super::{z_coin_errors::*, BlockDbImpl, CheckPointBlockInfo, WalletDbShared, ZCoinBuilder, ZcoinConsensusParams};
 use crate::utxo::utxo_builder::{UtxoCoinBuilderCommonOps, DAY_IN_SECONDS};
 use crate::z_coin::storage::z_locked_notes::LockedNotesStorage;
-use crate::z_coin::storage::{BlockProcessingMode, DataConnStmtCacheWrapper};
+use crate::z_coin::storage::{BlockProcessingMode, DataConnStmtCacheWrapper, ZcoinStorageRes};
 use crate::z_coin::SyncStartPoint;
 use crate::RpcCommonOps;
 
@@ -10,12 +10,13 @@ use common::executor::Timer;
 use common::executor::{spawn_abortable, AbortOnDropHandle};
 use common::log::LogOnError;
 use common::log::{debug, error, info};
-use common::now_sec;
+use common::{now_ms, now_sec};
 use futures::channel::mpsc::channel;
 use futures::channel::mpsc::{Receiver as AsyncReceiver, Sender as AsyncSender};
 use futures::channel::oneshot::{channel as oneshot_channel, Sender as OneshotSender};
+use futures::future::join_all;
 use futures::lock::{Mutex as AsyncMutex, MutexGuard as AsyncMutexGuard};
-use futures::StreamExt;
+use futures::{stream, Future, Stream, StreamExt, TryStreamExt};
 use hex::{FromHex, FromHexError};
 use mm2_err_handle::prelude::*;
 use mm2_event_stream::StreamingManager;
@@ -55,12 +56,15 @@ cfg_native!(
 );
 
 cfg_wasm32!(
-    use futures_util::future::try_join_all;
     use mm2_net::wasm::tonic_client::TonicClient;
-
-    const MAX_CHUNK_SIZE: u64 = 20000;
 );
 
+/// The number of blocks requested from a light client with a single `get_block_range` call.
+const BLOCK_RANGE_CHUNK_SIZE: u64 = 1000;
+/// The number of block ranges downloaded at the same time.
+/// The chunks are handled in the height order, so this also bounds the number of blocks kept in memory.
+const CONCURRENT_BLOCK_RANGES: usize = 4;
+
 /// ZRpcOps trait provides asynchronous methods for performing various operations related to
 /// Zcoin blockchain and wallet synchronization.
 #[async_trait]
@@ -170,6 +174,89 @@ impl LightRpcClient {
         let conn = tonic::transport::Endpoint::new(dst)?.connect().await?;
         Ok(CompactTxStreamerClient::new(conn))
     }
+
+    /// Returns all the clients that pass the health check, unlike [`RpcCommonOps::get_live_client`]
+    /// which stops at the first one.
+    async fn live_clients(&self) -> Result<Vec<CompactTxStreamerClient<RpcClientType>>, MmError<UpdateBlocksCacheErr>> {
+        let clients = self.0.lock().await.clone();
+        let health_checks = clients.into_iter().map(|mut client| async move {
+            // use get_latest_block method as a health check
+            let latest = client.get_latest_block(tonic::Request::new(ChainSpec {})).await;
+            latest.is_ok().then_some(client)
+        });
+        let live_clients: Vec<_> = join_all(health_checks).await.into_iter().flatten().collect();
+        if live_clients.is_empty() {
+            return MmError::err(UpdateBlocksCacheErr::GetLiveLightClientError(
+                "All the current light clients are unavailable.".to_string(),
+            ));
+        }
+        Ok(live_clients)
+    }
+}
+
+/// Downloads the `start..=end` blocks from the first of the `clients`,
+/// the rest of the clients are tried in turn if it fails or returns an incomplete range.
+async fn get_block_range(
+    clients: Vec<CompactTxStreamerClient<RpcClientType>>,
+    start: u64,
+    end: u64,
+) -> Result<Vec<TonicCompactBlock>, MmError<UpdateBlocksCacheErr>> {
+    let mut error =
+        UpdateBlocksCacheErr::GetLiveLightClientError("No light clients to request blocks from".to_string());
+    for mut client in clients {
+        let request = tonic::Request::new(BlockRange {
+            start: Some(BlockId {
+                height: start,
+                hash: Vec::new(),
+            }),
+            end: Some(BlockId {
+                height: end,
+                hash: Vec::new(),
+            }),
+        });
+        let blocks = match client.get_block_range(request).await {
+            Ok(response) => response.into_inner().try_collect::<Vec<_>>().await,
+            Err(status) => Err(status),
+        };
+        match blocks {
+            Ok(blocks) if blocks.len() as u64 == end - start + 1 => return Ok(blocks),
+            Ok(blocks) => {
+                error = UpdateBlocksCacheErr::DecodeError(format!(
+                    "Expected {} blocks in the {start}..={end} range, got {}",
+                    end - start + 1,
+                    blocks.len()
+                ))
+            },
+            Err(status) => error = UpdateBlocksCacheErr::GrpcError(status),
+        }
+    }
+    MmError::err(error)
+}
+
+/// Splits the `start..=last` range into `BLOCK_RANGE_CHUNK_SIZE` chunks downloaded with `get_range`,
+/// at most `CONCURRENT_BLOCK_RANGES` at a time. The chunks are spread across the `clients` by rotating them
+/// by the chunk index, so every chunk can fall back to the others, and are yielded in the height order.
+pub(super) fn block_range_chunks<C, F, Fut>(
+    clients: Vec<C>,
+    start: u64,
+    last: u64,
+    get_range: F,
+) -> impl Stream<Item = Fut::Output>
+where
+    C: Clone,
+    F: Fn(Vec<C>, u64, u64) -> Fut,
+    Fut: Future,
+{
+    let chunks = (start..=last)
+        .step_by(BLOCK_RANGE_CHUNK_SIZE as usize)
+        .enumerate()
+        .map(move |(i, chunk_start)| {
+            let chunk_end = (chunk_start + BLOCK_RANGE_CHUNK_SIZE - 1).min(last);
+            let mut chunk_clients = clients.clone();
+            chunk_clients.rotate_left(i % clients.len().max(1));
+            get_range(chunk_clients, chunk_start, chunk_end)
+        });
+    stream::iter(chunks).buffered(CONCURRENT_BLOCK_RANGES)
 }
 
 #[async_trait]
@@ -194,21 +281,30 @@ impl RpcCommonOps for LightRpcClient {
     }
 }
 
-async fn handle_block_cache_update(
+/// Caches the downloaded `blocks` with a single batched insert.
+async fn handle_block_range_cache_update(
     db: &BlockDbImpl,
     handler: &mut SaplingSyncLoopHandle,
-    block: Result<TonicCompactBlock, tonic::Status>,
+    blocks: Vec<TonicCompactBlock>,
     last_block: u64,
 ) -> Result<(), MmError<UpdateBlocksCacheErr>> {
-    let block = block.map_err(|_| UpdateBlocksCacheErr::DecodeError("Error getting block".to_string()))?;
-    debug!("Got block {}", block.height);
-    let height = u32::try_from(block.height)
-        .map_err(|_| UpdateBlocksCacheErr::DecodeError("Block height too large".to_string()))?;
-    db.insert_block(height, block.encode_to_vec())
+    let Some(last_in_range) = blocks.last().map(|block| block.height) else {
+        return Ok(());
+    };
+    debug!("Got blocks {}..={}", blocks[0].height, last_in_range);
+    let blocks = blocks
+        .into_iter()
+        .map(|block| {
+            let height = u32::try_from(block.height)
+                .map_err(|_| UpdateBlocksCacheErr::DecodeError("Block height too large".to_string()))?;
+            Ok((height, block.encode_to_vec()))
+        })
+        .collect::<Result<Vec<_>, UpdateBlocksCacheErr>>()?;
+    db.insert_blocks(blocks)
         .await
         .map_err(|err| UpdateBlocksCacheErr::ZcashDBError(err.to_string()))?;
 
-    handler.notify_blocks_cache_status(block.height, last_block);
+    handler.notify_blocks_cache_status(last_in_range, last_block);
     Ok(())
 }
 
@@ -239,7 +335,8 @@ impl ZRpcOps for LightRpcClient {
             .into_inner())
     }
 
-    #[cfg(target_arch = "wasm32")]
+    /// Splits the range into `BLOCK_RANGE_CHUNK_SIZE` chunks which are downloaded concurrently from the live clients
+    /// in turn, and caches every chunk with a single batched insert in the height order as the chunks arrive.
     async fn scan_blocks(
         &self,
         start_block: u64,
@@ -247,81 +344,11 @@ impl ZRpcOps for LightRpcClient {
         db: &BlockDbImpl,
         handler: &mut SaplingSyncLoopHandle,
     ) -> Result<(), MmError<UpdateBlocksCacheErr>> {
-        let mut requests = Vec::new();
-        let mut current_start = start_block;
-        let selfi = self.get_live_client().await?;
-
-        /// Wraps the client (`selfi`) in an `Arc` to enable safe cloning and sharing across futures.
-        /// This is necessary to avoid the error "cannot return reference to local variable `selfi`."
-        async fn get_block_range_wrapper(
-            mut selfi: CompactTxStreamerClient<RpcClientType>,
-            request: BlockRange,
-        ) -> Result<tonic::Response<tonic::Streaming<TonicCompactBlock>>, tonic::Status> {
-            selfi.get_block_range(tonic::Request::new(request)).await
-        }
-
-        // Generate multiple gRPC requests to fetch block ranges efficiently.
-        // It takes the starting block height and the last block height as input and constructs requests for fetching
-        // consecutive block ranges within the specified limits.
-        while current_start <= last_block {
-            let current_end = if current_start + MAX_CHUNK_SIZE - 1 <= last_block {
-                current_start + MAX_CHUNK_SIZE - 1
-            } else {
-                last_block
-            };
-
-            let block_range = BlockRange {
-                start: Some(BlockId {
-                    height: current_start,
-                    hash: Vec::new(),
-                }),
-                end: Some(BlockId {
-                    height: current_end,
-                    hash: Vec::new(),
-                }),
-            };
+        let clients = self.live_clients().await?;
+        let mut chunks = block_range_chunks(clients, start_block, last_block, get_block_range);
 
-            requests.push(get_block_range_wrapper(selfi.clone(), block_range));
-            current_start = current_end + 1;
-        }
-
-        let responses = try_join_all(requests).await?;
-        for response in responses {
-            let mut response = response.into_inner();
-            while let Some(block) = response.next().await {
-                handle_block_cache_update(db, handler, block, last_block).await?;
-            }
-        }
-
-        Ok(())
-    }
-
-    #[cfg(not(target_arch = "wasm32"))]
-    async fn scan_blocks(
-        &self,
-        start_block: u64,
-        last_block: u64,
-        db: &BlockDbImpl,
-        handler: &mut SaplingSyncLoopHandle,
-    ) -> Result<(), MmError<UpdateBlocksCacheErr>> {
-        let mut selfi = self.get_live_client().await?;
-        let request = tonic::Request::new(BlockRange {
-            start: Some(BlockId {
-                height: start_block,
-                hash: Vec::new(),
-            }),
-            end: Some(BlockId {
-                height: last_block,
-                hash: Vec::new(),
-            }),
-        });
-        let mut response = selfi
-            .get_block_range(request)
-            .await
-            .map_to_mm(UpdateBlocksCacheErr::GrpcError)?
-            .into_inner();
-        while let Some(block) = response.next().await {
-            handle_block_cache_update(db, handler, block, last_block).await?;
+        while let Some(blocks) = chunks.next().await {
+            handle_block_range_cache_update(db, handler, blocks?, last_block).await?;
         }
 
         Ok(())
@@ -500,6 +527,33 @@ impl ZRpcOps for NativeClient {
     }
 }
 
+/// Returns the height the blocks cache was synced from, or 0 if nothing was synced yet.
+/// The blocks cache retention moves the earliest cached block forward, so the sync start height is persisted.
+/// The caches synced before it was persisted started from their earliest block.
+async fn blocks_cache_sync_start(blocks_db: &BlockDbImpl) -> ZcoinStorageRes<u64> {
+    if let Some(height) = blocks_db.get_sync_start_height().await? {
+        return Ok(height as u64);
+    }
+    let earliest = blocks_db.get_earliest_block().await?;
+    if earliest > 0 {
+        blocks_db.set_sync_start_height(earliest).await?;
+    }
+    Ok(earliest as u64)
+}
+
+/// Checks if no sync_params was provided or they match the previous sync start, so syncing is continued from
+/// the last height in db if it's > 0, or skip_sync_params is true.
+fn continue_from_prev_sync(
+    prev_sync_start: u64,
+    sync_start_height: u64,
+    sync_params: &Option<SyncStartPoint>,
+    skip_sync_params: bool,
+    sapling_activation_height: u64,
+) -> bool {
+    (prev_sync_start > 0 && (sync_params.is_none() || prev_sync_start == sync_start_height))
+        || (skip_sync_params && prev_sync_start < sapling_activation_height)
+}
+
 pub(super) async fn init_light_client<'a>(
     builder: &ZCoinBuilder<'a>,
     lightwalletd_urls: Vec<String>,
@@ -514,7 +568,7 @@ pub(super) async fn init_light_client<'a>(
 
     let light_rpc_clients = LightRpcClient::new(lightwalletd_urls).await?;
 
-    let min_height = blocks_db.get_earliest_block().await? as u64;
+    let min_height = blocks_cache_sync_start(&blocks_db).await?;
     let current_block_height = light_rpc_clients
         .get_block_height()
         .await
@@ -532,21 +586,29 @@ pub(super) async fn init_light_client<'a>(
             .mm_err(ZcoinClientInitError::UtxoCoinBuildError)?
             .unwrap_or(sapling_activation_height),
     };
+    let sync_start_height = sync_height.max(sapling_activation_height);
     let maybe_checkpoint_block = light_rpc_clients
-        .checkpoint_block_from_height(sync_height.max(sapling_activation_height), &coin)
+        .checkpoint_block_from_height(sync_start_height, &coin)
         .await?;
 
-    // check if no sync_params was provided and continue syncing from last height in db if it's > 0 or skip_sync_params is true.
-    let continue_from_prev_sync =
-        (min_height > 0 && sync_params.is_none()) || (skip_sync_params && min_height < sapling_activation_height);
+    let continue_from_prev_sync = continue_from_prev_sync(
+        min_height,
+        sync_start_height,
+        sync_params,
+        skip_sync_params,
+        sapling_activation_height,
+    );
     let wallet_db = WalletDbShared::new(builder, maybe_checkpoint_block, continue_from_prev_sync).await?;
-    // Check min_height in blocks_db and rewind blocks_db to 0 if sync_height != min_height
-    if !continue_from_prev_sync && (sync_height != min_height) {
+    // Rewind blocks_db to 0 and start it over from the new sync height.
+    if !continue_from_prev_sync {
         // let user know we're clearing cache and re-syncing from new provided height.
         if min_height > 0 {
             info!("Older/Newer sync height detected!, rewinding blocks_db to new height: {sync_height:?}");
         }
         blocks_db.rewind_to_height(u32::MIN.into()).await?;
+        let sync_start_height = u32::try_from(sync_start_height)
+            .map_to_mm(|err| ZcoinClientInitError::ZcoinStorageError(err.to_string()))?;
+        blocks_db.set_sync_start_height(sync_start_height).await?;
     };
 
     let first_sync_block = FirstSyncBlock {
@@ -566,9 +628,11 @@ pub(super) async fn init_light_client<'a>(
         watch_for_tx: None,
         scan_blocks_per_iteration: builder.z_coin_params.scan_blocks_per_iteration.into(),
         scan_interval_ms: builder.z_coin_params.scan_interval_ms,
+        blocks_cache_retention: builder.z_coin_params.blocks_cache_retention.map(u32::from),
         first_sync_block: first_sync_block.clone(),
         streaming_manager: builder.ctx.event_stream_manager.clone(),
         locked_notes_db,
+        sync_rate: SyncRate::default(),
     };
 
     let abort_handle = spawn_abortable(light_wallet_db_sync_loop(sync_handle, Box::new(light_rpc_clients)));
@@ -614,9 +678,11 @@ pub(super) async fn init_native_client<'a>(
         watch_for_tx: None,
         scan_blocks_per_iteration: builder.z_coin_params.scan_blocks_per_iteration.into(),
         scan_interval_ms: builder.z_coin_params.scan_interval_ms,
+        blocks_cache_retention: builder.z_coin_params.blocks_cache_retention.map(u32::from),
         first_sync_block: first_sync_block.clone(),
         streaming_manager: builder.ctx.event_stream_manager.clone(),
         locked_notes_db,
+        sync_rate: SyncRate::default(),
     };
     let abort_handle = spawn_abortable(light_wallet_db_sync_loop(sync_handle, Box::new(native_client)));
 
@@ -657,9 +723,10 @@ impl SaplingSyncRespawnGuard {
 /// Zcoin-related operations during block sync.
 ///
 /// - `UpdatingBlocksCache`: Represents the state of updating the blocks cache, with associated data
-///   about the first synchronization block, the current scanned block, and the latest block.
+///   about the first synchronization block, the current scanned block, the latest block
+///   and the blocks download rate.
 /// - `BuildingWalletDb`: Denotes the state of building the wallet db, with associated data about
-///   the first synchronization block, the current scanned block, and the latest block.
+///   the first synchronization block, the current scanned block, the latest block and the blocks scanning rate.
 /// - `TemporaryError(String)`: Represents a temporary error state, with an associated error message
 ///   providing details about the error.
 /// - `Finishing`: Represents the finishing state of an operation.
@@ -668,10 +735,12 @@ pub enum SyncStatus {
     UpdatingBlocksCache {
         current_scanned_block: u64,
         latest_block: u64,
+        blocks_per_second: u64,
     },
     BuildingWalletDb {
         current_scanned_block: u64,
         latest_block: u64,
+        blocks_per_second: u64,
     },
     TemporaryError(String),
     Finished {
@@ -715,9 +784,42 @@ pub struct SaplingSyncLoopHandle {
     watch_for_tx: Option<TxId>,
     scan_blocks_per_iteration: u32,
     scan_interval_ms: u64,
+    /// The number of the scanned blocks to keep in the blocks cache, all the blocks are kept if `None`.
+    blocks_cache_retention: Option<u32>,
     first_sync_block: FirstSyncBlock,
     /// A copy of the streaming manager to send notifications to the streamers upon new txs, balance change, etc...
     streaming_manager: StreamingManager,
+    /// The rate of the current sync stage reported along with the sync status.
+    sync_rate: SyncRate,
+}
+
+/// Measures the blocks per second rate of a sync stage, i.e. of updating the blocks cache or building the wallet db.
+#[derive(Default)]
+struct SyncRate {
+    /// The time in milliseconds and the block the stage was started at.
+    stage_start: Option<(u64, u64)>,
+}
+
+impl SyncRate {
+    fn start_stage(&mut self) { self.stage_start = None; }
+
+    /// Returns the rate since the first `current_block` reported in the current stage.
+    fn blocks_per_second(&mut self, current_block: u64) -> u64 {
+        let now = now_ms();
+        match self.stage_start {
+            Some((start_ms, start_block)) => {
+                let elapsed_ms = now.saturating_sub(start_ms);
+                if elapsed_ms == 0 {
+                    return 0;
+                }
+                current_block.saturating_sub(start_block) * 1000 / elapsed_ms
+            },
+            None => {
+                self.stage_start = Some((now, current_block));
+                0
+            },
+        }
+    }
 }
 
 impl SaplingSyncLoopHandle {
@@ -730,6 +832,7 @@ impl SaplingSyncLoopHandle {
             .try_send(SyncStatus::UpdatingBlocksCache {
                 current_scanned_block,
                 latest_block,
+                blocks_per_second: self.sync_rate.blocks_per_second(current_scanned_block),
             })
             .debug_log_with_msg("No one seems interested in SyncStatus");
     }
@@ -742,6 +845,7 @@ impl SaplingSyncLoopHandle {
             .try_send(SyncStatus::BuildingWalletDb {
                 current_scanned_block,
                 latest_block,
+                blocks_per_second: self.sync_rate.blocks_per_second(current_scanned_block),
             })
             .debug_log_with_msg("No one seems interested in SyncStatus");
     }
@@ -769,6 +873,7 @@ impl SaplingSyncLoopHandle {
     }
 
     async fn update_blocks_cache(&mut self, rpc: &dyn ZRpcOps) -> Result<(), MmError<UpdateBlocksCacheErr>> {
+        self.sync_rate.start_stage();
         let current_block = rpc.get_block_height().await?;
         let block_db = self.blocks_db.clone();
         let current_block_in_db = &self.blocks_db.get_latest_block().await?;
@@ -794,6 +899,7 @@ impl SaplingSyncLoopHandle {
     /// Scans cached blocks, validates the chain and updates WalletDb.
     /// For more notes on the process, check https://github.com/zcash/librustzcash/blob/master/zcash_client_backend/src/data_api/chain.rs#L2
     async fn scan_validate_and_update_blocks(&mut self) -> Result<(), MmError<ZcoinStorageError>> {
+        self.sync_rate.start_stage();
         let blocks_db = self.blocks_db.clone();
         let wallet_db = self.wallet_db.db.clone();
         let mut wallet_ops = wallet_db.get_update_ops().expect("get_update_ops always returns Ok");
@@ -858,6 +964,13 @@ impl SaplingSyncLoopHandle {
             }
         }
 
+        if let Some(retention) = self.blocks_cache_retention {
+            // The blocks cache is caught up with the wallet db here, the last `retention` scanned blocks are kept
+            // so the cache can still be validated against the wallet db and isn't re-downloaded.
+            let keep_from = u32::from(current_block).saturating_sub(retention - 1);
+            blocks_db.remove_blocks_below(BlockHeight::from_u32(keep_from)).await?;
+        }
+
         Ok(())
     }
 
@@ -1000,3 +1113,127 @@ pub(super) struct SaplingSyncGuard<'a> {
     pub(super) _connector_guard: AsyncMutexGuard<'a, SaplingSyncConnector>,
     pub(super) respawn_guard: SaplingSyncRespawnGuard,
 }
+
+#[cfg(all(test, not(target_arch = "wasm32")))]
+mod tests {
+    use super::*;
+    use common::block_on;
+    use mm2_test_helpers::for_tests::mm_ctx_with_custom_db;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[test]
+    fn test_block_range_chunks_boundaries_and_clients() {
+        let chunks = block_range_chunks(vec![0, 1, 2], 10, 3009, |clients, start, end| async move {
+            (clients[0], start, end)
+        });
+        let chunks: Vec<_> = block_on(chunks.collect());
+        assert_eq!(chunks, vec![(0, 10, 1009), (1, 1010, 2009), (2, 2010, 3009)]);
+
+        let chunks = block_range_chunks(vec![0, 1], 1, 3001, |clients, start, end| async move {
+            (clients, start, end)
+        });
+        let chunks: Vec<_> = block_on(chunks.collect());
+        assert_eq!(chunks, vec![
+            (vec![0, 1], 1, 1000),
+            (vec![1, 0], 1001, 2000),
+            (vec![0, 1], 2001, 3000),
+            (vec![1, 0], 3001, 3001)
+        ]);
+    }
+
+    #[test]
+    fn test_block_range_chunks_order_and_concurrency() {
+        const CHUNKS: u64 = 10;
+
+        let in_flight = Arc::new(AtomicUsize::new(0));
+        let max_in_flight = Arc::new(AtomicUsize::new(0));
+        let last = CHUNKS * BLOCK_RANGE_CHUNK_SIZE - 1;
+        let chunks = block_range_chunks(vec![()], 0, last, |_, start, end| {
+            let in_flight = in_flight.clone();
+            let max_in_flight = max_in_flight.clone();
+            async move {
+                let running = in_flight.fetch_add(1, Ordering::SeqCst) + 1;
+                max_in_flight.fetch_max(running, Ordering::SeqCst);
+                // The earlier chunks take longer, so they complete in the reverse order.
+                let delay = (CHUNKS - start / BLOCK_RANGE_CHUNK_SIZE) as f64 * 0.01;
+                Timer::sleep(delay).await;
+                in_flight.fetch_sub(1, Ordering::SeqCst);
+                (start, end)
+            }
+        });
+
+        let chunks: Vec<_> = block_on(chunks.collect());
+        let expected: Vec<_> = (0..CHUNKS)
+            .map(|i| (i * BLOCK_RANGE_CHUNK_SIZE, (i + 1) * BLOCK_RANGE_CHUNK_SIZE - 1))
+            .collect();
+        assert_eq!(chunks, expected);
+        assert_eq!(max_in_flight.load(Ordering::SeqCst), CONCURRENT_BLOCK_RANGES);
+    }
+
+    #[test]
+    fn test_restart_after_blocks_cache_retention() {
+        const SAPLING_ACTIVATION_HEIGHT: u64 = 1000;
+
+        let ctx = mm_ctx_with_custom_db();
+        let db = block_on(BlockDbImpl::new(&ctx, "ZOMBIE".to_string())).unwrap();
+        let sync_params = Some(SyncStartPoint::Height(1900000));
+
+        // The first start syncs the blocks cache from the requested height.
+        let prev_sync_start = block_on(blocks_cache_sync_start(&db)).unwrap();
+        assert_eq!(prev_sync_start, 0);
+        assert!(!continue_from_prev_sync(
+            prev_sync_start,
+            1900000,
+            &sync_params,
+            false,
+            SAPLING_ACTIVATION_HEIGHT
+        ));
+        block_on(db.set_sync_start_height(1900000)).unwrap();
+        let blocks = (1900000..1900010).map(|height| (height, vec![0])).collect();
+        block_on(db.insert_blocks(blocks)).unwrap();
+        // The retention prunes the scanned blocks, including the first synced one.
+        block_on(db.remove_blocks_below(BlockHeight::from_u32(1900005))).unwrap();
+        assert_eq!(block_on(db.get_earliest_block()).unwrap(), 1900005);
+
+        // A restart with the same sync params continues the previous sync.
+        let prev_sync_start = block_on(blocks_cache_sync_start(&db)).unwrap();
+        assert_eq!(prev_sync_start, 1900000);
+        assert!(continue_from_prev_sync(
+            prev_sync_start,
+            1900000,
+            &sync_params,
+            false,
+            SAPLING_ACTIVATION_HEIGHT
+        ));
+        assert!(continue_from_prev_sync(
+            prev_sync_start,
+            1950000,
+            &None,
+            false,
+            SAPLING_ACTIVATION_HEIGHT
+        ));
+        // While the new sync params still start the sync over.
+        assert!(!continue_from_prev_sync(
+            prev_sync_start,
+            1800000,
+            &Some(SyncStartPoint::Height(1800000)),
+            false,
+            SAPLING_ACTIVATION_HEIGHT
+        ));
+    }
+
+    #[test]
+    fn test_blocks_cache_sync_start_falls_back_to_earliest_block() {
+        let ctx = mm_ctx_with_custom_db();
+        let db = block_on(BlockDbImpl::new(&ctx, "ZOMBIE".to_string())).unwrap();
+        let blocks = (1900000..1900010).map(|height| (height, vec![0])).collect();
+        block_on(db.insert_blocks(blocks)).unwrap();
+
+        // The cache synced before the sync start was persisted.
+        assert_eq!(block_on(db.get_sync_start_height()).unwrap(), None);
+        assert_eq!(block_on(blocks_cache_sync_start(&db)).unwrap(), 1900000);
+        // The earliest block is persisted as the sync start, so it survives the retention.
+        block_on(db.remove_blocks_below(BlockHeight::from_u32(1900005))).unwrap();
+        assert_eq!(block_on(blocks_cache_sync_start(&db)).unwrap(), 1900000);
+    }
+}
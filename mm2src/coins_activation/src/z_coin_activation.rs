@@ -67,9 +67,10 @@ impl GetAddressesBalances for ZcoinActivationResult {
 ///
 /// - `ActivatingCoin`: Indicates that Zcoin is in the process of activating.
 /// - `UpdatingBlocksCache`: Represents the state of updating the blocks cache, with associated data
-///   about the first synchronization block, the current scanned block, and the latest block.
+///   about the first synchronization block, the current scanned block, the latest block
+///   and the blocks download rate.
 /// - `BuildingWalletDb`: Denotes the state of building the wallet db, with associated data about
-///   the first synchronization block, the current scanned block, and the latest block.
+///   the first synchronization block, the current scanned block, the latest block and the blocks scanning rate.
 /// - `TemporaryError(String)`: Represents a temporary error state, with an associated error message
 ///   providing details about the error.
 /// - `RequestingWalletBalance`: Indicates the process of requesting the wallet balance.
@@ -84,10 +85,12 @@ pub enum ZcoinInProgressStatus {
     UpdatingBlocksCache {
         current_scanned_block: u64,
         latest_block: u64,
+        blocks_per_second: u64,
     },
     BuildingWalletDb {
         current_scanned_block: u64,
         latest_block: u64,
+        blocks_per_second: u64,
     },
     TemporaryError(String),
     RequestingWalletBalance,
@@ -252,16 +255,20 @@ impl InitStandaloneCoinActivationOps for ZCoin {
                 SyncStatus::UpdatingBlocksCache {
                     current_scanned_block,
                     latest_block,
+                    blocks_per_second,
                 } => ZcoinInProgressStatus::UpdatingBlocksCache {
                     current_scanned_block,
                     latest_block,
+                    blocks_per_second,
                 },
                 SyncStatus::BuildingWalletDb {
                     current_scanned_block,
                     latest_block,
+                    blocks_per_second,
                 } => ZcoinInProgressStatus::BuildingWalletDb {
                     current_scanned_block,
                     latest_block,
+                    blocks_per_second,
                 },
                 SyncStatus::TemporaryError(e) => ZcoinInProgressStatus::TemporaryError(e),
                 SyncStatus::Finished { .. } => break,
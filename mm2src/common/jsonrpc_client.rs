@@ -1,7 +1,7 @@
 use futures01::Future;
 use itertools::Itertools;
 use serde::de::DeserializeOwned;
-use serde_json::{self as json, Value as Json};
+use serde_json::Value as Json;
 use std::collections::HashMap;
 use std::fmt;
 
@@ -440,7 +440,8 @@ fn process_single_response<T: DeserializeOwned + Send + 'static>(
         return Err(JsonRpcErrorType::Response(remote_addr, response.error));
     }
 
-    json::from_value(response.result.clone()).map_err(|e| {
+    // Deserialize from a reference so that the response doesn't have to be cloned to be reported on error.
+    T::deserialize(&response.result).map_err(|e| {
         JsonRpcErrorType::Parse(
             remote_addr,
             ERRL!("error {:?} parsing result from response {:?}", e, response),
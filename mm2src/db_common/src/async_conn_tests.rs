@@ -111,6 +111,46 @@ async fn close_call_test() -> AsyncConnResult<()> {
     Ok(())
 }
 
+#[tokio::test]
+async fn pooled_call_read_test() -> AsyncConnResult<()> {
+    let path = std::env::temp_dir().join(format!("pooled_call_read_test_{}.db", std::process::id()));
+    let mut conn = AsyncConnection::open_pooled(&path, 2).await?;
+
+    conn.call(|conn| {
+        conn.execute_batch(
+            "CREATE TABLE person(id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL);
+            INSERT INTO person (name) VALUES ('alice'), ('bob');",
+        )
+        .map_err(|e| e.into())
+    })
+    .await?;
+
+    let count: i64 = conn
+        .call_read(|conn| {
+            conn.query_row("SELECT COUNT(*) FROM person;", [], |row| row.get(0))
+                .map_err(|e| e.into())
+        })
+        .await?;
+    assert_eq!(count, 2);
+
+    // the readers are read-only
+    let result = conn
+        .call_read(|conn| conn.execute("DELETE FROM person;", []).map_err(|e| e.into()))
+        .await;
+    assert!(matches!(result.unwrap_err(), AsyncConnError::Rusqlite(_)));
+
+    assert!(conn.close().await.is_ok());
+    let result = conn
+        .call_read(|conn| conn.execute("SELECT 1;", []).map_err(|e| e.into()))
+        .await;
+    assert!(matches!(result.unwrap_err(), AsyncConnError::ConnectionClosed));
+
+    for suffix in ["", "-wal", "-shm"] {
+        std::fs::remove_file(format!("{}{}", path.display(), suffix)).ok();
+    }
+    Ok(())
+}
+
 #[tokio::test]
 #[should_panic]
 async fn close_call_unwrap_test() {
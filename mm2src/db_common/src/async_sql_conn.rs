@@ -1,5 +1,6 @@
 use crate::sqlite::rusqlite::Error as SqlError;
-use crossbeam_channel::Sender;
+use crate::sqlite::{enable_wal_mode, STATEMENT_CACHE_CAPACITY};
+use crossbeam_channel::{Receiver, Sender};
 use futures::channel::oneshot::{self};
 use rusqlite::OpenFlags;
 use std::fmt::{self, Debug, Display};
@@ -74,6 +75,15 @@ enum Message {
 #[derive(Clone)]
 pub struct AsyncConnection {
     sender: Sender<Message>,
+    readers: Option<ReaderThreads>,
+}
+
+/// The read-only connections opened by [`AsyncConnection::open_pooled`].
+/// The threads share one channel, so a request is taken by the first reader that is free.
+#[derive(Clone)]
+struct ReaderThreads {
+    sender: Sender<Message>,
+    count: usize,
 }
 
 impl AsyncConnection {
@@ -92,6 +102,42 @@ impl AsyncConnection {
         start(move || rusqlite::Connection::open(path)).await
     }
 
+    /// Open a new connection to a SQLite database in WAL mode along with `readers` read-only connections.
+    ///
+    /// [`AsyncConnection::call`] executes the functions on the only writer connection,
+    /// while [`AsyncConnection::call_read`] executes them on any free reader, so the reads don't queue
+    /// behind the writes.
+    ///
+    /// # Failure
+    ///
+    /// Will return `Err` if `path` cannot be converted to a C-compatible
+    /// string or if the underlying SQLite open call fails.
+    pub async fn open_pooled<P: AsRef<Path>>(path: P, readers: usize) -> Result<Self> {
+        let path = path.as_ref().to_owned();
+        let writer_path = path.clone();
+        let mut conn = start(move || {
+            let conn = rusqlite::Connection::open(writer_path)?;
+            enable_wal_mode(&conn)?;
+            Ok(conn)
+        })
+        .await?;
+        if readers == 0 {
+            return Ok(conn);
+        }
+
+        let (sender, receiver) = crossbeam_channel::unbounded::<Message>();
+        for _ in 0..readers {
+            let path = path.clone();
+            let flags = OpenFlags::SQLITE_OPEN_READ_ONLY | OpenFlags::SQLITE_OPEN_NO_MUTEX;
+            start_thread(receiver.clone(), move || {
+                rusqlite::Connection::open_with_flags(path, flags)
+            })
+            .await?;
+        }
+        conn.readers = Some(ReaderThreads { sender, count: readers });
+        Ok(conn)
+    }
+
     /// Open a new AsyncConnection to an in-memory SQLite database.
     ///
     /// # Failure
@@ -166,16 +212,26 @@ impl AsyncConnection {
         F: FnOnce(&mut rusqlite::Connection) -> Result<R> + 'static + Send,
         R: Send + 'static,
     {
-        let (sender, receiver) = oneshot::channel::<Result<R>>();
-
-        self.sender
-            .send(Message::Execute(Box::new(move |conn| {
-                let value = function(conn);
-                let _ = sender.send(value);
-            })))
-            .map_err(|_| AsyncConnError::ConnectionClosed)?;
+        call_on(&self.sender, function).await
+    }
 
-        receiver.await.map_err(|_| AsyncConnError::ConnectionClosed)?
+    /// Call a read-only function in a reader background thread if the connection has been opened
+    /// by [`AsyncConnection::open_pooled`], or in the writer thread otherwise.
+    ///
+    /// Please note the readers see the data committed by the writer only.
+    ///
+    /// # Failure
+    ///
+    /// Will return `Err` if the database connection has been closed.
+    pub async fn call_read<F, R>(&self, function: F) -> Result<R>
+    where
+        F: FnOnce(&mut rusqlite::Connection) -> Result<R> + 'static + Send,
+        R: Send + 'static,
+    {
+        match &self.readers {
+            Some(readers) => call_on(&readers.sender, function).await,
+            None => call_on(&self.sender, function).await,
+        }
     }
 
     /// Call a function in background thread and get the result asynchronously.
@@ -218,6 +274,20 @@ impl AsyncConnection {
     ///
     /// Will return `Err` if the underlying SQLite close call fails.
     pub async fn close(&mut self) -> Result<()> {
+        if let Some(readers) = &self.readers {
+            // Every reader thread takes one `Close` message and stops.
+            for _ in 0..readers.count {
+                let (sender, receiver) = oneshot::channel::<std::result::Result<(), SqlError>>();
+                if readers.sender.send(Message::Close(sender)).is_err() {
+                    // The readers are closed already.
+                    break;
+                }
+                if let Ok(Err(e)) = receiver.await {
+                    return Err(AsyncConnError::Close((self.clone(), e)));
+                }
+            }
+        }
+
         let (sender, receiver) = oneshot::channel::<std::result::Result<(), SqlError>>();
 
         if let Err(crossbeam_channel::SendError(_)) = self.sender.send(Message::Close(sender)) {
@@ -242,11 +312,37 @@ impl Debug for AsyncConnection {
     fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result { f.debug_struct("AsyncConnection").finish() }
 }
 
+async fn call_on<F, R>(sender: &Sender<Message>, function: F) -> Result<R>
+where
+    F: FnOnce(&mut rusqlite::Connection) -> Result<R> + 'static + Send,
+    R: Send + 'static,
+{
+    let (result_sender, receiver) = oneshot::channel::<Result<R>>();
+
+    sender
+        .send(Message::Execute(Box::new(move |conn| {
+            let value = function(conn);
+            let _ = result_sender.send(value);
+        })))
+        .map_err(|_| AsyncConnError::ConnectionClosed)?;
+
+    receiver.await.map_err(|_| AsyncConnError::ConnectionClosed)?
+}
+
 async fn start<F>(open: F) -> Result<AsyncConnection>
 where
     F: FnOnce() -> rusqlite::Result<rusqlite::Connection> + Send + 'static,
 {
     let (sender, receiver) = crossbeam_channel::unbounded::<Message>();
+    start_thread(receiver, open).await?;
+    Ok(AsyncConnection { sender, readers: None })
+}
+
+/// Opens a connection in a new thread that executes the messages from the `receiver` until it's closed.
+async fn start_thread<F>(receiver: Receiver<Message>, open: F) -> Result<()>
+where
+    F: FnOnce() -> rusqlite::Result<rusqlite::Connection> + Send + 'static,
+{
     let (result_sender, result_receiver) = oneshot::channel();
 
     thread::spawn(move || {
@@ -257,6 +353,7 @@ where
                 return;
             },
         };
+        conn.set_prepared_statement_cache_capacity(STATEMENT_CACHE_CAPACITY);
 
         if let Err(_e) = result_sender.send(Ok(())) {
             return;
@@ -291,6 +388,6 @@ where
 
     result_receiver
         .await
-        .map_err(|e| AsyncConnError::Internal(InternalError(e.to_string())))
-        .map(|_| AsyncConnection { sender })
+        .map_err(|e| AsyncConnError::Internal(InternalError(e.to_string())))?
+        .map_err(AsyncConnError::Rusqlite)
 }
@@ -1,9 +1,9 @@
 use crate::sql_value::{FromQuoted, SqlValueOptional, SqlValueToString};
-use crate::sqlite::{OwnedSqlParam, OwnedSqlParams, SqlParamsBuilder, ToValidSqlIdent};
+use crate::sqlite::{OwnedSqlParam, OwnedSqlParams, SqlParamsBuilder, StringError, ToValidSqlIdent};
 use common::write_safe;
 use common::write_safe::fmt::{WriteSafe, WriteSafeJoin};
 use log::debug;
-use rusqlite::{params_from_iter, Connection, Result as SqlResult};
+use rusqlite::{params_from_iter, Connection, Error as SqlError, Result as SqlResult};
 use std::fmt;
 
 enum InsertMode {
@@ -21,11 +21,16 @@ impl fmt::Display for InsertMode {
 }
 
 /// An `INSERT` SQL request builder.
+///
+/// Many records can be inserted by one request, see [`SqlInsert::next_row`].
 pub struct SqlInsert<'a> {
     conn: &'a Connection,
     table_name: &'static str,
     columns: Vec<String>,
+    /// The values of the current row.
     values: Vec<String>,
+    /// The rows finished by [`SqlInsert::next_row`].
+    rows: Vec<Vec<String>>,
     params: SqlParamsBuilder,
     mode: Option<InsertMode>,
 }
@@ -42,6 +47,7 @@ impl<'a> SqlInsert<'a> {
             table_name,
             columns: Vec::new(),
             values: Vec::new(),
+            rows: Vec::new(),
             params: SqlParamsBuilder::default(),
             mode: None,
         }
@@ -71,9 +77,8 @@ impl<'a> SqlInsert<'a> {
         S: ToValidSqlIdent,
         SqlValueOptional: From<T>,
     {
-        self.columns.push(column.to_valid_sql_ident()?);
-        self.values.push(SqlValueOptional::from(value).to_string());
-        Ok(self)
+        let column = column.to_valid_sql_ident()?;
+        self.push_value(column, SqlValueOptional::from(value).to_string())
     }
 
     /// Adds the quoted `value` of the specified `column` to the `INSERT` request.
@@ -86,9 +91,8 @@ impl<'a> SqlInsert<'a> {
         S: ToValidSqlIdent,
         SqlValueOptional: FromQuoted<T>,
     {
-        self.columns.push(column.to_valid_sql_ident()?);
-        self.values.push(SqlValueOptional::quoted_value_to_string(value));
-        Ok(self)
+        let column = column.to_valid_sql_ident()?;
+        self.push_value(column, SqlValueOptional::quoted_value_to_string(value))
     }
 
     /// Adds the `value` of the specified `column` to the `INSERT` request.
@@ -100,8 +104,21 @@ impl<'a> SqlInsert<'a> {
         S: ToValidSqlIdent,
         OwnedSqlParam: From<T>,
     {
-        self.columns.push(column.to_valid_sql_ident()?);
-        self.values.push(self.params.push_param(param));
+        let column = column.to_valid_sql_ident()?;
+        let value = self.params.push_param(param);
+        self.push_value(column, value)
+    }
+
+    /// Finishes the current row, so the following `column` calls add the values of the next record
+    /// to the same `INSERT` request.
+    ///
+    /// Please note every row must specify the same columns in the same order as the first one.
+    /// Keep the number of params in mind: SQLite limits it to 32766 per request.
+    pub fn next_row(&mut self) -> SqlResult<&mut Self> {
+        if self.values.len() != self.columns.len() {
+            return Err(incomplete_row_error(self.values.len(), self.columns.len()));
+        }
+        self.rows.push(std::mem::take(&mut self.values));
         Ok(self)
     }
 
@@ -131,16 +148,53 @@ impl<'a> SqlInsert<'a> {
 
         if self.columns.is_empty() {
             write_safe!(sql, " DEFAULT VALUES;");
-        } else {
-            write_safe!(sql, " (");
-            self.columns.iter().write_safe_join(&mut sql, ", ");
-            write_safe!(sql, ") VALUES (");
-            self.values.iter().write_safe_join(&mut sql, ", ");
-            write_safe!(sql, ");");
+            return Ok(sql);
+        }
+
+        // The current row may be left empty after the last `SqlInsert::next_row` call.
+        let current_row = Some(&self.values).filter(|values| !values.is_empty() || self.rows.is_empty());
+        write_safe!(sql, " (");
+        self.columns.iter().write_safe_join(&mut sql, ", ");
+        write_safe!(sql, ") VALUES ");
+        for (i, row) in self.rows.iter().chain(current_row).enumerate() {
+            if row.len() != self.columns.len() {
+                return Err(incomplete_row_error(row.len(), self.columns.len()));
+            }
+            if i > 0 {
+                write_safe!(sql, ", ");
+            }
+            write_safe!(sql, "(");
+            row.iter().write_safe_join(&mut sql, ", ");
+            write_safe!(sql, ")");
         }
+        write_safe!(sql, ";");
 
         Ok(sql)
     }
+
+    fn push_value(&mut self, column: String, value: String) -> SqlResult<&mut Self> {
+        if self.rows.is_empty() {
+            self.columns.push(column);
+        } else if self.columns.get(self.values.len()) != Some(&column) {
+            let error = format!(
+                "Expected the {:?} columns in every row, found '{}' at the {} position",
+                self.columns,
+                column,
+                self.values.len()
+            );
+            return Err(SqlError::ToSqlConversionFailure(StringError::from(error).into_boxed()));
+        }
+        self.values.push(value);
+        Ok(self)
+    }
+}
+
+fn incomplete_row_error(values: usize, columns: usize) -> SqlError {
+    let error = format!(
+        "Expected {} values in the row as in the first one, found {}",
+        columns, values
+    );
+    SqlError::ToSqlConversionFailure(StringError::from(error).into_boxed())
 }
 
 #[cfg(test)]
@@ -306,6 +360,49 @@ mod tests {
         assert_eq!(actual_items, expected_items);
     }
 
+    #[test]
+    fn test_sql_insert_many_rows() {
+        let conn = Connection::open_in_memory().unwrap();
+        conn.execute(CREATE_TX_HISTORY_TABLE, []).unwrap();
+
+        let mut insert = SqlInsert::new(&conn, "tx_history");
+        for (i, tx_hash) in ["tx_hash_0", "tx_hash_1"].into_iter().enumerate() {
+            insert
+                .column_quoted("tx_hash", tx_hash)
+                .unwrap()
+                .column_param("tx_hex", vec![i as u8 + 1])
+                .unwrap()
+                .column("height", i as i64)
+                .unwrap()
+                .next_row()
+                .unwrap();
+        }
+
+        let actual = insert.sql().unwrap();
+        let expected =
+            "INSERT INTO tx_history (tx_hash, tx_hex, height) VALUES ('tx_hash_0', :1, 0), ('tx_hash_1', :2, 1);";
+        assert_eq!(actual, expected);
+
+        assert_eq!(insert.insert().unwrap(), 2);
+
+        let actual_items = select_from_tx_history(&conn);
+        let expected_items: Vec<_> = (0..2)
+            .map(|i| TxHistoryItem {
+                tx_hash: format!("tx_hash_{}", i),
+                description: None,
+                tx_hex: Some(vec![i as u8 + 1]),
+                height: Some(i),
+                total_amount: None,
+            })
+            .collect();
+        assert_eq!(actual_items, expected_items);
+
+        // every row must specify the same columns
+        insert.column_quoted("tx_hash", "tx_hash_2").unwrap();
+        insert.column("height", 2).unwrap_err();
+        insert.next_row().unwrap_err();
+    }
+
     #[test]
     fn test_sql_create_no_columns() {
         let conn = Connection::open_in_memory().unwrap();
@@ -5,15 +5,22 @@ pub use sql_builder;
 
 use log::debug;
 use rusqlite::types::{FromSql, Type as SqlType, Value};
-use rusqlite::{Connection, Error as SqlError, Result as SqlResult, Row, ToSql};
+use rusqlite::{Connection, Error as SqlError, OpenFlags, Result as SqlResult, Row, ToSql};
 use sql_builder::SqlBuilder;
 use std::error::Error as StdError;
 use std::fmt;
-use std::sync::{Arc, Mutex, Weak};
+use std::path::Path;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard, Weak};
 use uuid::Uuid;
 
 pub const CHECK_TABLE_EXISTS_SQL: &str = "SELECT name FROM sqlite_master WHERE type='table' AND name=?1;";
 
+/// The number of the prepared statements every connection keeps, see [`Connection::prepare_cached`].
+/// The statements are keyed by the SQL text, so only the fixed queries with all the values passed as params
+/// should be cached. The builders may inline the quoted values, so their queries are prepared without the cache.
+pub const STATEMENT_CACHE_CAPACITY: usize = 128;
+
 /// The macro returns `OwnedSqlNamedParams`.
 #[macro_export]
 macro_rules! owned_named_params {
@@ -27,6 +34,55 @@ macro_rules! owned_named_params {
 
 pub type SqliteConnShared = Arc<Mutex<Connection>>;
 pub type SqliteConnWeak = Weak<Mutex<Connection>>;
+pub type SqliteReadPoolShared = Arc<SqliteReadPool>;
+
+/// The read-only connections to a database in WAL mode.
+///
+/// In WAL mode the readers don't block the writer and aren't blocked by it, so the read requests
+/// can be served by these connections while the only writer connection is busy.
+/// Please note the readers see the data committed by the writer only.
+pub struct SqliteReadPool {
+    conns: Vec<Mutex<Connection>>,
+    next: AtomicUsize,
+}
+
+impl SqliteReadPool {
+    /// Opens `size` read-only connections to the database at `path`, which is expected to be in WAL mode already,
+    /// see [`enable_wal_mode`].
+    pub fn open<P: AsRef<Path>>(path: P, size: usize) -> SqlResult<SqliteReadPool> {
+        let flags = OpenFlags::SQLITE_OPEN_READ_ONLY | OpenFlags::SQLITE_OPEN_NO_MUTEX;
+        let conns = (0..size.max(1))
+            .map(|_| {
+                let conn = Connection::open_with_flags(path.as_ref(), flags)?;
+                conn.set_prepared_statement_cache_capacity(STATEMENT_CACHE_CAPACITY);
+                Ok(Mutex::new(conn))
+            })
+            .collect::<SqlResult<_>>()?;
+        Ok(SqliteReadPool {
+            conns,
+            next: AtomicUsize::new(0),
+        })
+    }
+
+    /// Returns a connection no one uses at the moment if there is any,
+    /// otherwise waits for the connections to be released in turn.
+    pub fn conn(&self) -> MutexGuard<Connection> {
+        let start = self.next.fetch_add(1, Ordering::Relaxed);
+        for i in 0..self.conns.len() {
+            if let Ok(conn) = self.conns[(start + i) % self.conns.len()].try_lock() {
+                return conn;
+            }
+        }
+        self.conns[start % self.conns.len()].lock().unwrap()
+    }
+}
+
+/// Switches the database to WAL mode, so the [`SqliteReadPool`] readers can run concurrently with the writer.
+/// The journal mode is persistent, so it's enough to call this on the writer connection once.
+pub fn enable_wal_mode(conn: &Connection) -> SqlResult<()> {
+    conn.query_row("pragma journal_mode = WAL;", [], |row| row.get::<_, String>(0))?;
+    Ok(())
+}
 
 pub(crate) type ParamId = String;
 
@@ -315,7 +371,7 @@ where
 /// be safe to use, while giving great speed boost.
 /// With these, Mac and Linux have comparable SQLite performance.
 pub fn run_optimization_pragmas(conn: &Connection) -> Result<(), SqlError> {
-    conn.query_row("pragma journal_mode = WAL;", [], |row| row.get::<_, String>(0))?;
+    enable_wal_mode(conn)?;
     conn.execute("pragma synchronous = normal;", [])?;
     conn.execute("pragma temp_store = memory;", [])?;
     conn.execute("pragma foreign_keys = ON;", [])?;
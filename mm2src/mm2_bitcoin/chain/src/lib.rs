@@ -14,6 +14,7 @@ mod merkle_root;
 mod raw_block;
 pub use raw_block::{RawBlockHeader, RawHeaderError};
 mod transaction;
+mod transaction_ref;
 
 /// `IndexedBlock` extension
 mod read_and_hash;
@@ -29,6 +30,7 @@ pub use block_header::{BlockHeader, BlockHeaderBits, BlockHeaderNonce};
 pub use merkle_root::{merkle_node_hash, merkle_root};
 pub use transaction::{JoinSplit, OutPoint, ShieldedOutput, ShieldedSpend, Transaction, TransactionInput,
                       TransactionOutput, TxHashAlgo};
+pub use transaction_ref::{TransactionInputRef, TransactionOutputRef, TransactionRef};
 
 pub use read_and_hash::{HashedData, ReadAndHash};
 
@@ -21,9 +21,9 @@ use std::io::Read;
 /// Must be zero.
 const WITNESS_MARKER: u8 = 0;
 /// Must be nonzero.
-const WITNESS_FLAG: u8 = 1;
+pub(crate) const WITNESS_FLAG: u8 = 1;
 /// Maximum supported list size (inputs, outputs, etc.)
-const MAX_LIST_SIZE: usize = 8192;
+pub(crate) const MAX_LIST_SIZE: usize = 8192;
 
 #[derive(Clone, Copy, Debug, Default, Deserializable, Eq, Hash, PartialEq, Serializable)]
 pub struct OutPoint {
@@ -624,7 +624,7 @@ mod tests {
     use hash::{H256, H512};
     use hex::ToHex;
     use ser::{deserialize, serialize, serialize_with_flags, Serializable, SERIALIZE_TRANSACTION_WITNESS};
-    use TxHashAlgo;
+    use {TransactionRef, TxHashAlgo};
 
     // real transaction from block 80000
     // https://blockchain.info/rawtx/5a4ebf66822b0b2d56bd9dc64ece0bc38ee7844a23ff1d7320a88c5fdb2ad3e2
@@ -679,6 +679,20 @@ mod tests {
 
         let serialized = serialize(&t);
         assert_eq!(Bytes::from(raw), serialized);
+
+        let tx_ref = TransactionRef::parse(&serialized, false).unwrap();
+        assert_eq!(tx_ref.hash(TxHashAlgo::DSHA256), t.hash());
+        assert_eq!(tx_ref.inputs_len(), 0);
+        let outputs: Vec<_> = tx_ref
+            .outputs()
+            .map(|output| (output.value, output.script_pubkey.to_vec()))
+            .collect();
+        let expected: Vec<_> = t
+            .outputs
+            .iter()
+            .map(|output| (output.value, output.script_pubkey.to_vec()))
+            .collect();
+        assert_eq!(outputs, expected);
     }
 
     // https://github.com/artemii235/SuperNET/issues/342
@@ -0,0 +1,421 @@
+//! Borrowed view of a serialized transaction.
+//!
+//! [`TransactionRef`] only walks the transaction bytes to find where its inputs, outputs and witness data are,
+//! the inputs and outputs are decoded on iteration and reference the scripts in the original buffer.
+//! It's intended for the hot paths that need a few outputs of many transactions (e.g. the tx history
+//! looking up the spent outputs), where [`Transaction`](::Transaction) would allocate every script and witness.
+//!
+//! The view covers the transparent part of the transaction formats that [`Transaction`](::Transaction) supports,
+//! the shielded data of the overwintered Zcash transactions is skipped without being decoded.
+//! The transactions that have any other data after the lock time are rejected,
+//! so that the callers can fall back to deserializing them entirely.
+
+use crypto::{dhash256, dhash256_parts, sha256, sha256_parts};
+use hash::H256;
+use ser::{CompactInteger, Error};
+use transaction::{MAX_LIST_SIZE, WITNESS_FLAG};
+use {OutPoint, TxHashAlgo};
+
+/// The outpoint size: the previous tx hash and the output index.
+const OUTPOINT_SIZE: usize = 36;
+/// The [`ShieldedSpend`](::ShieldedSpend) size.
+const SHIELDED_SPEND_SIZE: usize = 384;
+/// The [`ShieldedOutput`](::ShieldedOutput) size.
+const SHIELDED_OUTPUT_SIZE: usize = 948;
+/// The [`JoinSplit`](::JoinSplit) size without the proof.
+const JOIN_SPLIT_SIZE_WITHOUT_PROOF: usize = 1506;
+const PHGR_PROOF_SIZE: usize = 296;
+const GROTH_PROOF_SIZE: usize = 192;
+
+struct Cursor<'a> {
+    raw: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Cursor<'a> {
+    fn new(raw: &'a [u8], pos: usize) -> Cursor<'a> { Cursor { raw, pos } }
+
+    fn take(&mut self, len: usize) -> Result<&'a [u8], Error> {
+        let end = self.pos.checked_add(len).ok_or(Error::MalformedData)?;
+        let bytes = self.raw.get(self.pos..end).ok_or(Error::UnexpectedEnd)?;
+        self.pos = end;
+        Ok(bytes)
+    }
+
+    fn peek_u8(&self) -> Option<u8> { self.raw.get(self.pos).copied() }
+
+    fn read_u32(&mut self) -> Result<u32, Error> {
+        let mut buf = [0; 4];
+        buf.copy_from_slice(self.take(4)?);
+        Ok(u32::from_le_bytes(buf))
+    }
+
+    fn read_u64(&mut self) -> Result<u64, Error> {
+        let mut buf = [0; 8];
+        buf.copy_from_slice(self.take(8)?);
+        Ok(u64::from_le_bytes(buf))
+    }
+
+    fn read_compact(&mut self) -> Result<u64, Error> {
+        let flag = self.take(1)?[0];
+        let length = CompactInteger::data_length(flag) as usize;
+        if length == 0 {
+            return Ok(flag as u64);
+        }
+        let mut buf = [0; 8];
+        buf[..length].copy_from_slice(self.take(length)?);
+        Ok(u64::from_le_bytes(buf))
+    }
+
+    fn read_list_len(&mut self) -> Result<usize, Error> {
+        let len = self.read_compact()?;
+        if len > MAX_LIST_SIZE as u64 {
+            return Err(Error::MalformedData);
+        }
+        Ok(len as usize)
+    }
+
+    fn read_var_bytes(&mut self) -> Result<&'a [u8], Error> {
+        let len = self.read_compact()?;
+        if len > self.raw.len() as u64 {
+            return Err(Error::UnexpectedEnd);
+        }
+        self.take(len as usize)
+    }
+
+    fn read_input(&mut self) -> Result<TransactionInputRef<'a>, Error> {
+        let outpoint = self.take(OUTPOINT_SIZE)?;
+        let mut hash = [0; 32];
+        hash.copy_from_slice(&outpoint[..32]);
+        let mut index = [0; 4];
+        index.copy_from_slice(&outpoint[32..]);
+        let script_sig = self.read_var_bytes()?;
+        let sequence = self.read_u32()?;
+        Ok(TransactionInputRef {
+            previous_output: OutPoint {
+                hash: hash.into(),
+                index: u32::from_le_bytes(index),
+            },
+            script_sig,
+            sequence,
+        })
+    }
+
+    fn read_output(&mut self) -> Result<TransactionOutputRef<'a>, Error> {
+        let value = self.read_u64()?;
+        let script_pubkey = self.read_var_bytes()?;
+        Ok(TransactionOutputRef { value, script_pubkey })
+    }
+
+    fn skip_witness(&mut self) -> Result<(), Error> {
+        let len = self.read_list_len()?;
+        for _ in 0..len {
+            self.read_var_bytes()?;
+        }
+        Ok(())
+    }
+
+    /// Skips a list of `item_size` items.
+    fn skip_list(&mut self, item_size: usize) -> Result<usize, Error> {
+        let len = self.read_list_len()?;
+        self.take(len.checked_mul(item_size).ok_or(Error::MalformedData)?)?;
+        Ok(len)
+    }
+
+    fn skip_join_splits(&mut self, version: i32) -> Result<(), Error> {
+        let proof_size = if version > 2 { GROTH_PROOF_SIZE } else { PHGR_PROOF_SIZE };
+        if self.skip_list(JOIN_SPLIT_SIZE_WITHOUT_PROOF + proof_size)? > 0 {
+            // join_split_pubkey and join_split_sig
+            self.take(32 + 64)?;
+        }
+        Ok(())
+    }
+
+    /// Skips the fields that follow the lock time of an overwintered transaction.
+    fn skip_overwintered_data(&mut self, version: i32) -> Result<(), Error> {
+        let mut has_sapling_data = false;
+        if version >= 3 {
+            // expiry_height
+            self.take(4)?;
+            if version >= 4 {
+                // value_balance
+                self.take(8)?;
+                let spends_len = self.skip_list(SHIELDED_SPEND_SIZE)?;
+                let outputs_len = self.skip_list(SHIELDED_OUTPUT_SIZE)?;
+                has_sapling_data = spends_len > 0 || outputs_len > 0;
+            }
+        }
+
+        self.skip_join_splits(version)?;
+        if has_sapling_data {
+            // binding_sig
+            self.take(64)?;
+        }
+        Ok(())
+    }
+}
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+pub struct TransactionInputRef<'a> {
+    pub previous_output: OutPoint,
+    pub script_sig: &'a [u8],
+    pub sequence: u32,
+}
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+pub struct TransactionOutputRef<'a> {
+    pub value: u64,
+    pub script_pubkey: &'a [u8],
+}
+
+/// Offsets of the segwit parts that aren't covered by the transaction hash.
+#[derive(Clone, Copy, Debug)]
+struct WitnessLayout {
+    /// The offset of the witness marker, the flag goes right after it.
+    marker: usize,
+    /// The witness data is between the outputs and the lock time.
+    witness_end: usize,
+}
+
+#[derive(Clone, Copy, Debug)]
+pub struct TransactionRef<'a> {
+    raw: &'a [u8],
+    version: i32,
+    overwintered: bool,
+    inputs_start: usize,
+    inputs_len: usize,
+    outputs_start: usize,
+    outputs_len: usize,
+    outputs_end: usize,
+    witness: Option<WitnessLayout>,
+    lock_time: u32,
+}
+
+impl<'a> TransactionRef<'a> {
+    /// Walks the transaction `raw` bytes.
+    /// `n_time_prefix` must be set for the PoS coins that have the `nTime` field right after the version
+    /// (see `UtxoCoinConf::is_pos`), since such transactions can't be told from the other formats by their bytes.
+    pub fn parse(raw: &'a [u8], n_time_prefix: bool) -> Result<TransactionRef<'a>, Error> {
+        let mut cursor = Cursor::new(raw, 0);
+        let header = cursor.read_u32()? as i32;
+        let overwintered = (header >> 31) != 0;
+        let version = if overwintered { header & 0x7FFFFFFF } else { header };
+        if overwintered {
+            // version_group_id
+            cursor.take(4)?;
+        }
+        if n_time_prefix {
+            cursor.take(4)?;
+        }
+
+        let mut witness_marker = None;
+        let mut inputs_start = cursor.pos;
+        let mut inputs_len = cursor.read_list_len()?;
+        if inputs_len == 0 && !overwintered && !n_time_prefix && cursor.peek_u8() == Some(WITNESS_FLAG) {
+            witness_marker = Some(inputs_start);
+            cursor.take(1)?;
+            inputs_start = cursor.pos;
+            inputs_len = cursor.read_list_len()?;
+        }
+        for _ in 0..inputs_len {
+            cursor.read_input()?;
+        }
+
+        let outputs_start = cursor.pos;
+        let outputs_len = cursor.read_list_len()?;
+        for _ in 0..outputs_len {
+            cursor.read_output()?;
+        }
+        let outputs_end = cursor.pos;
+
+        let witness = match witness_marker {
+            Some(marker) => {
+                if outputs_len == 0 {
+                    return Err(Error::Custom("Transaction has no output".into()));
+                }
+                for _ in 0..inputs_len {
+                    cursor.skip_witness()?;
+                }
+                Some(WitnessLayout {
+                    marker,
+                    witness_end: cursor.pos,
+                })
+            },
+            None => None,
+        };
+        let lock_time = cursor.read_u32()?;
+
+        if overwintered {
+            cursor.skip_overwintered_data(version)?;
+        } else if version == 2 && !n_time_prefix && cursor.peek_u8().is_some() {
+            // The join splits of the Zcash (e.g. CHIPS) transactions before the overwinter upgrade.
+            cursor.skip_join_splits(version)?;
+        }
+        if n_time_prefix && cursor.peek_u8().is_some() {
+            // The optional `strDZeel` string.
+            cursor.read_var_bytes()?;
+        }
+        // The rest is either a format the view doesn't cover (e.g. the PoSV `nTime` after the lock time)
+        // or garbage that must not be hashed as a part of the transaction.
+        if cursor.pos != raw.len() {
+            return Err(Error::UnreadData);
+        }
+
+        Ok(TransactionRef {
+            raw,
+            version,
+            overwintered,
+            inputs_start,
+            inputs_len,
+            outputs_start,
+            outputs_len,
+            outputs_end,
+            witness,
+            lock_time,
+        })
+    }
+
+    pub fn raw(&self) -> &'a [u8] { self.raw }
+
+    pub fn version(&self) -> i32 { self.version }
+
+    pub fn overwintered(&self) -> bool { self.overwintered }
+
+    pub fn lock_time(&self) -> u32 { self.lock_time }
+
+    pub fn has_witness(&self) -> bool { self.witness.is_some() }
+
+    pub fn inputs_len(&self) -> usize { self.inputs_len }
+
+    pub fn outputs_len(&self) -> usize { self.outputs_len }
+
+    pub fn inputs(&self) -> impl Iterator<Item = TransactionInputRef<'a>> + 'a {
+        let mut cursor = Cursor::new(self.raw, self.inputs_start);
+        let len = cursor.read_list_len().unwrap_or_default();
+        // The inputs have been validated by `TransactionRef::parse`, so the reading never fails.
+        (0..len).map_while(move |_| cursor.read_input().ok())
+    }
+
+    pub fn outputs(&self) -> impl Iterator<Item = TransactionOutputRef<'a>> + 'a {
+        let mut cursor = Cursor::new(self.raw, self.outputs_start);
+        let len = cursor.read_list_len().unwrap_or_default();
+        // The outputs have been validated by `TransactionRef::parse`, so the reading never fails.
+        (0..len).map_while(move |_| cursor.read_output().ok())
+    }
+
+    pub fn output(&self, index: usize) -> Option<TransactionOutputRef<'a>> { self.outputs().nth(index) }
+
+    /// Same as [`Transaction::hash`](::Transaction::hash), but the witness data is skipped instead of
+    /// serializing the transaction without it.
+    pub fn hash(&self, tx_hash_algo: TxHashAlgo) -> H256 {
+        match self.witness {
+            Some(witness) => {
+                let parts = [
+                    &self.raw[..witness.marker],
+                    // skip the marker and the flag
+                    &self.raw[witness.marker + 2..self.outputs_end],
+                    &self.raw[witness.witness_end..],
+                ];
+                match tx_hash_algo {
+                    TxHashAlgo::DSHA256 => dhash256_parts(&parts),
+                    TxHashAlgo::SHA256 => sha256_parts(&parts),
+                }
+            },
+            None => match tx_hash_algo {
+                TxHashAlgo::DSHA256 => dhash256(self.raw),
+                TxHashAlgo::SHA256 => sha256(self.raw),
+            },
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use hex::FromHex;
+    use ser::deserialize;
+    use Transaction;
+
+    fn assert_matches_transaction(raw: &[u8], n_time_prefix: bool) {
+        let tx: Transaction = deserialize(raw).unwrap();
+        let tx_ref = TransactionRef::parse(raw, n_time_prefix).unwrap();
+
+        assert_eq!(tx_ref.version(), tx.version);
+        assert_eq!(tx_ref.overwintered(), tx.overwintered);
+        assert_eq!(tx_ref.lock_time(), tx.lock_time);
+        assert_eq!(tx_ref.has_witness(), tx.has_witness());
+        assert_eq!(tx_ref.hash(TxHashAlgo::DSHA256), tx.hash());
+        assert_eq!(tx_ref.inputs_len(), tx.inputs.len());
+        assert_eq!(tx_ref.outputs_len(), tx.outputs.len());
+
+        let inputs: Vec<_> = tx_ref.inputs().collect();
+        assert_eq!(inputs.len(), tx.inputs.len());
+        for (input_ref, input) in inputs.iter().zip(tx.inputs.iter()) {
+            assert_eq!(input_ref.previous_output, input.previous_output);
+            assert_eq!(input_ref.script_sig, &input.script_sig[..]);
+            assert_eq!(input_ref.sequence, input.sequence);
+        }
+
+        let outputs: Vec<_> = tx_ref.outputs().collect();
+        assert_eq!(outputs.len(), tx.outputs.len());
+        for (output_ref, output) in outputs.iter().zip(tx.outputs.iter()) {
+            assert_eq!(output_ref.value, output.value);
+            assert_eq!(output_ref.script_pubkey, &output.script_pubkey[..]);
+        }
+        assert_eq!(tx_ref.output(tx.outputs.len()), None);
+    }
+
+    #[test]
+    fn test_transaction_ref_standard() {
+        let raw: Vec<u8> = "0100000001a6b97044d03da79c005b20ea9c0e1a6d9dc12d9f7b91a5911c9030a439eed8f5000000004948304502206e21798a42fae0e854281abd38bacd1aeed3ee3738d9e1446618c4571d1090db022100e2ac980643b0b82c0e88ffdfec6b64e3e6ba35e7ba5fdd7d5d6cc8d25c6b241501ffffffff0100f2052a010000001976a914404371705fa9bd789a2fcd52d2c580b65d35549d88ac00000000".from_hex().unwrap();
+        assert_matches_transaction(&raw, false);
+
+        let tx_ref = TransactionRef::parse(&raw, false).unwrap();
+        let expected = H256::from_reversed_str("5a4ebf66822b0b2d56bd9dc64ece0bc38ee7844a23ff1d7320a88c5fdb2ad3e2");
+        assert_eq!(tx_ref.hash(TxHashAlgo::DSHA256), expected);
+    }
+
+    #[test]
+    fn test_transaction_ref_witness() {
+        // tBTC txid: 303d1797bd67895dab9289e6729886518d6e1ef34f15e49fbaaa3204db832b7f
+        let raw: Vec<u8> = "01000000000101b62722419e6529830e548eb7944b0bb8af2dfd102c30d9accc5be57da6276f320100000000ffffffff02e8030000000000001976a9146d9d2b554d768232320587df75c4338ecc8bf37d88ac3f7b00000000000016001405aab5342166f8594baf17a7d9bef5d567443327024730440220229efa569066639fd94d737d3981c7e1fe39e4605637b8c46c28413abb3e759b022034f2b1ea17481c6fb34c9074f8d1ab1c7cc1a2dcdfe7060c53a31fd5fc606504012102031d4256c4bc9f99ac88bf3dba21773132281f65f9bf23a59928bce08961e2f33fcec160".from_hex().unwrap();
+        assert_matches_transaction(&raw, false);
+
+        let tx_ref = TransactionRef::parse(&raw, false).unwrap();
+        let expected = H256::from_reversed_str("303d1797bd67895dab9289e6729886518d6e1ef34f15e49fbaaa3204db832b7f");
+        assert_eq!(tx_ref.hash(TxHashAlgo::DSHA256), expected);
+    }
+
+    #[test]
+    fn test_transaction_ref_pos_n_time() {
+        // ECC transaction having the nTime field after the version
+        let raw: Vec<u8> = "0100000046fea85c01aa6350db797b0a96e8609a66f2d060643b723426618fc2ef069a04e8527cbdf0000000006a47304402204b125c386d45fe4db92b9d0da61e811eb948a17d258678dad592e5087585a4260220285b56596b600fca0c7ca8fc4b8bbf5dd890d43a9fa640ca489bb6de2a8ca780012103940de0b0de5c237a124e7142339eace1e529772cd475b0e842fa644bcafe49ccfeffffff02c1c62d00000000001976a9148305167ef95a1b1e9acdf634a7686cb76993406a88ac7f841e00000000001976a914c3f710deb7320b0efa6edb14e3ebeeb9155fa90d88acee642000".from_hex().unwrap();
+        assert_matches_transaction(&raw, true);
+    }
+
+    #[test]
+    fn test_transaction_ref_truncated() {
+        let raw: Vec<u8> = "0100000001a6b97044d03da79c005b20ea9c0e1a6d9dc12d9f7b91a5911c9030a439eed8f5000000004948304502206e21798a42fae0e854281abd38bacd1aeed3ee3738d9e1446618c4571d1090db022100e2ac980643b0b82c0e88ffdfec6b64e3e6ba35e7ba5fdd7d5d6cc8d25c6b241501ffffffff0100f2052a010000001976a914404371705fa9bd789a2fcd52d2c580b65d35549d88ac00000000".from_hex().unwrap();
+        for len in [0, 4, 40, 150, raw.len() - 1] {
+            assert!(TransactionRef::parse(&raw[..len], false).is_err(), "len {}", len);
+        }
+    }
+
+    #[test]
+    fn test_transaction_ref_trailing_bytes() {
+        let raw: Vec<u8> = "0100000001a6b97044d03da79c005b20ea9c0e1a6d9dc12d9f7b91a5911c9030a439eed8f5000000004948304502206e21798a42fae0e854281abd38bacd1aeed3ee3738d9e1446618c4571d1090db022100e2ac980643b0b82c0e88ffdfec6b64e3e6ba35e7ba5fdd7d5d6cc8d25c6b241501ffffffff0100f2052a010000001976a914404371705fa9bd789a2fcd52d2c580b65d35549d88ac00000000".from_hex().unwrap();
+        for trailing in [&[0][..], &[1, 2, 3, 4]] {
+            let mut with_trailing = raw.clone();
+            with_trailing.extend_from_slice(trailing);
+            assert_eq!(
+                TransactionRef::parse(&with_trailing, false).unwrap_err(),
+                Error::UnreadData
+            );
+        }
+
+        // tBTC txid: 303d1797bd67895dab9289e6729886518d6e1ef34f15e49fbaaa3204db832b7f
+        let mut raw: Vec<u8> = "01000000000101b62722419e6529830e548eb7944b0bb8af2dfd102c30d9accc5be57da6276f320100000000ffffffff02e8030000000000001976a9146d9d2b554d768232320587df75c4338ecc8bf37d88ac3f7b00000000000016001405aab5342166f8594baf17a7d9bef5d567443327024730440220229efa569066639fd94d737d3981c7e1fe39e4605637b8c46c28413abb3e759b022034f2b1ea17481c6fb34c9074f8d1ab1c7cc1a2dcdfe7060c53a31fd5fc606504012102031d4256c4bc9f99ac88bf3dba21773132281f65f9bf23a59928bce08961e2f33fcec160".from_hex().unwrap();
+        raw.push(0);
+        assert_eq!(TransactionRef::parse(&raw, false).unwrap_err(), Error::UnreadData);
+    }
+}
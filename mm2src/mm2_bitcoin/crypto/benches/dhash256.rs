@@ -0,0 +1,54 @@
+//! Compares the double SHA-256 built on the compression function with two chained `sha256` calls
+//! on the inputs the SPV validation hashes the most: block headers and merkle nodes.
+//!
+//! Run with `cargo bench -p bitcrypto --bench dhash256`.
+
+#![feature(test)]
+
+extern crate bitcrypto;
+extern crate test;
+
+use bitcrypto::{dhash256, dhash256_many, dhash256_merkle_step, sha256};
+use test::{black_box, Bencher};
+
+const HEADERS_NUMBER: usize = 2016;
+const HEADER_LEN: usize = 80;
+
+fn headers() -> Vec<Vec<u8>> { (0..HEADERS_NUMBER).map(|i| vec![i as u8; HEADER_LEN]).collect() }
+
+#[bench]
+fn bench_chained_sha256_headers(b: &mut Bencher) {
+    let headers = headers();
+    b.iter(|| {
+        let hashes: Vec<_> = headers.iter().map(|header| sha256(&*sha256(header))).collect();
+        black_box(hashes)
+    });
+}
+
+#[bench]
+fn bench_dhash256_headers(b: &mut Bencher) {
+    let headers = headers();
+    b.iter(|| {
+        let hashes: Vec<_> = headers.iter().map(|header| dhash256(header)).collect();
+        black_box(hashes)
+    });
+}
+
+#[bench]
+fn bench_dhash256_many_headers(b: &mut Bencher) {
+    let headers = headers();
+    b.iter(|| black_box(dhash256_many(&headers)));
+}
+
+#[bench]
+fn bench_chained_sha256_merkle_step(b: &mut Bencher) {
+    let node = [7u8; 64];
+    b.iter(|| black_box(sha256(&*sha256(black_box(&node)))));
+}
+
+#[bench]
+fn bench_dhash256_merkle_step(b: &mut Bencher) {
+    let left = [7u8; 32];
+    let right = [7u8; 32];
+    b.iter(|| black_box(dhash256_merkle_step(black_box(&left), black_box(&right))));
+}
@@ -7,6 +7,10 @@ extern crate sha2;
 extern crate sha3;
 extern crate siphasher;
 
+mod sha256d;
+
+pub use sha256d::{dhash256, dhash256_many, dhash256_merkle_step, dhash256_parts};
+
 use groestl::Groestl512;
 use primitives::hash::{H160, H256, H32, H512};
 use ripemd160::{Digest, Ripemd160};
@@ -56,6 +60,17 @@ pub fn sha256(input: &[u8]) -> H256 {
     array.into()
 }
 
+/// SHA-256 of the `parts` concatenation
+#[inline]
+pub fn sha256_parts(parts: &[&[u8]]) -> H256 {
+    let mut hasher = Sha256::new();
+    for part in parts {
+        hasher.update(part);
+    }
+    let array: [u8; 32] = hasher.finalize().into();
+    array.into()
+}
+
 /// Groestl-512
 #[inline]
 pub fn groestl512(input: &[u8]) -> H512 {
@@ -82,10 +97,6 @@ pub fn dkeccak256(input: &[u8]) -> H256 { keccak256(&*keccak256(input)) }
 #[inline]
 pub fn dhash160(input: &[u8]) -> H160 { ripemd160(&*sha256(input)) }
 
-/// Double SHA-256
-#[inline]
-pub fn dhash256(input: &[u8]) -> H256 { sha256(&*sha256(input)) }
-
 /// SipHash-2-4
 #[inline]
 pub fn siphash24(key0: u64, key1: u64, input: &[u8]) -> u64 {
@@ -0,0 +1,135 @@
+//! Double SHA-256 on top of the raw SHA-256 compression function.
+//!
+//! `sha2::compress256` uses the SHA extensions on x86 CPUs that have them and the software implementation otherwise.
+//! The second SHA-256 of a double hash always consumes a 32-byte digest, so it is a single block with the padding
+//! known in advance, and a merkle node (two 32-byte hashes) is a data block followed by a constant padding block.
+
+use primitives::hash::H256;
+use sha2::compress256;
+use sha2::digest::generic_array::GenericArray;
+use sha2::{Digest, Sha256};
+
+const INITIAL_STATE: [u32; 8] = [
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+];
+
+/// The padding block of a 64-byte message: the `0x80` marker and the 512 bits length.
+const PADDING_64: [u8; 64] = {
+    let mut block = [0; 64];
+    block[0] = 0x80;
+    block[62] = 0x02;
+    block
+};
+
+#[inline]
+fn compress(state: &mut [u32; 8], block: &[u8; 64]) { compress256(state, &[*GenericArray::from_slice(block)]); }
+
+#[inline]
+fn state_to_bytes(state: &[u32; 8], out: &mut [u8]) {
+    for (chunk, word) in out.chunks_exact_mut(4).zip(state.iter()) {
+        chunk.copy_from_slice(&word.to_be_bytes());
+    }
+}
+
+/// Hashes the 32-byte `digest` as the only block of the second SHA-256.
+#[inline]
+fn second_sha256(digest: &[u8]) -> H256 {
+    let mut block = [0; 64];
+    block[..32].copy_from_slice(digest);
+    block[32] = 0x80;
+    // The message length is 256 bits.
+    block[62] = 0x01;
+
+    let mut state = INITIAL_STATE;
+    compress(&mut state, &block);
+    let mut result = [0; 32];
+    state_to_bytes(&state, &mut result);
+    result.into()
+}
+
+/// Double SHA-256
+#[inline]
+pub fn dhash256(input: &[u8]) -> H256 { second_sha256(&Sha256::digest(input)) }
+
+/// Double SHA-256 of many inputs.
+/// A single hasher is reused for all the inputs, the results are in the order of the `inputs`.
+pub fn dhash256_many<I, T>(inputs: I) -> Vec<H256>
+where
+    I: IntoIterator<Item = T>,
+    T: AsRef<[u8]>,
+{
+    let inputs = inputs.into_iter();
+    let mut hashes = Vec::with_capacity(inputs.size_hint().0);
+    let mut hasher = Sha256::new();
+    for input in inputs {
+        hasher.update(input.as_ref());
+        hashes.push(second_sha256(&hasher.finalize_reset()));
+    }
+    hashes
+}
+
+/// Double SHA-256 of the `parts` concatenation, e.g. a transaction with its witness data skipped.
+pub fn dhash256_parts(parts: &[&[u8]]) -> H256 {
+    let mut hasher = Sha256::new();
+    for part in parts {
+        hasher.update(part);
+    }
+    second_sha256(&hasher.finalize())
+}
+
+/// Double SHA-256 of the `left` and `right` concatenation, i.e. the parent of two merkle tree nodes.
+#[inline]
+pub fn dhash256_merkle_step(left: &[u8; 32], right: &[u8; 32]) -> H256 {
+    let mut block = [0; 64];
+    block[..32].copy_from_slice(left);
+    block[32..].copy_from_slice(right);
+
+    let mut state = INITIAL_STATE;
+    compress(&mut state, &block);
+    compress(&mut state, &PADDING_64);
+    let mut digest = [0; 32];
+    state_to_bytes(&state, &mut digest);
+    second_sha256(&digest)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn reference_dhash256(input: &[u8]) -> H256 {
+        let digest: [u8; 32] = Sha256::digest(Sha256::digest(input)).into();
+        digest.into()
+    }
+
+    #[test]
+    fn test_dhash256_matches_reference() {
+        // Cover the inputs that end just before, at and after the padding boundaries.
+        for len in [0, 1, 31, 32, 55, 56, 63, 64, 65, 80, 119, 120, 128, 1000] {
+            let input: Vec<u8> = (0..len).map(|i| i as u8).collect();
+            assert_eq!(dhash256(&input), reference_dhash256(&input), "len {}", len);
+        }
+    }
+
+    #[test]
+    fn test_dhash256_many() {
+        let inputs: Vec<Vec<u8>> = (0..100).map(|len| vec![len as u8; len]).collect();
+        let expected: Vec<_> = inputs.iter().map(|input| reference_dhash256(input)).collect();
+        assert_eq!(dhash256_many(&inputs), expected);
+    }
+
+    #[test]
+    fn test_dhash256_parts() {
+        let input: Vec<u8> = (0..200).map(|i| i as u8).collect();
+        let parts = [&input[..10], &input[10..10], &input[10..150], &input[150..]];
+        assert_eq!(dhash256_parts(&parts), reference_dhash256(&input));
+    }
+
+    #[test]
+    fn test_dhash256_merkle_step() {
+        let left = [1; 32];
+        let right = [2; 32];
+        let mut concat = left.to_vec();
+        concat.extend_from_slice(&right);
+        assert_eq!(dhash256_merkle_step(&left, &right), reference_dhash256(&concat));
+    }
+}
@@ -41,9 +41,14 @@ pub struct SPVBlockHeader {
 
 impl SPVBlockHeader {
     pub(crate) fn from_block_header_and_height(header: &BlockHeader, height: u64) -> Self {
+        Self::from_block_header_with_hash(header, height, header.hash())
+    }
+
+    /// Same as [`SPVBlockHeader::from_block_header_and_height`] for the `header` whose `hash` is already computed.
+    pub(crate) fn from_block_header_with_hash(header: &BlockHeader, height: u64, hash: H256) -> Self {
         Self {
             height,
-            hash: header.hash(),
+            hash,
             time: header.time,
             bits: header.bits.clone(),
         }
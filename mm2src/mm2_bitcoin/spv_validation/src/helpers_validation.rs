@@ -1,12 +1,14 @@
 use crate::conf::{SPVBlockHeader, SPVConf};
 use crate::storage::{BlockHeaderStorageError, BlockHeaderStorageOps};
 use crate::work::{next_block_bits, NextBlockBitsError};
+use bitcrypto::{dhash256_many, dhash256_merkle_step};
 use chain::{BlockHeader, RawHeaderError};
 use derive_more::Display;
 use primitives::hash::H256;
 use serialization::parse_compact_int;
 use sha2::digest::Digest;
 use sha2::Sha256;
+use std::convert::TryFrom;
 
 #[derive(Clone, Debug, Display, Eq, PartialEq)]
 pub enum SPVError {
@@ -246,7 +248,12 @@ fn hash256(preimages: &[&[u8]]) -> H256 {
 ///
 /// * `a` - The first hash
 /// * `b` - The second hash
-fn hash256_merkle_step(a: &[u8], b: &[u8]) -> H256 { hash256(&[a, b]) }
+fn hash256_merkle_step(a: &[u8], b: &[u8]) -> H256 {
+    match (<&[u8; 32]>::try_from(a), <&[u8; 32]>::try_from(b)) {
+        (Ok(a), Ok(b)) => dhash256_merkle_step(a, b),
+        _ => hash256(&[a, b]),
+    }
+}
 
 /// Verifies a Bitcoin-style merkle tree.
 /// Leaves are 0-indexed.
@@ -356,7 +363,9 @@ pub async fn validate_headers(
     let mut last_validated_hash = last_validated_header.hash;
     let mut last_validated_bits = last_validated_header.bits.clone();
 
-    for header_to_validate in headers_to_validate.iter() {
+    // Hash the whole batch at once rather than every header when it's validated.
+    let header_hashes = dhash256_many(headers_to_validate.iter().map(BlockHeader::raw));
+    for (header_to_validate, header_hash) in headers_to_validate.iter().zip(header_hashes) {
         if !validate_header_prev_hash(&header_to_validate.previous_header_hash, &last_validated_hash) {
             // Detect for chain reorganization and return the last header(previous_height + 1).
             return Err(SPVError::ParentHashMismatch {
@@ -389,7 +398,8 @@ pub async fn validate_headers(
 
         last_validated_bits = block_bits_to_validate;
         last_validated_height += 1;
-        last_validated_header = SPVBlockHeader::from_block_header_and_height(header_to_validate, last_validated_height);
+        last_validated_header =
+            SPVBlockHeader::from_block_header_with_hash(header_to_validate, last_validated_height, header_hash);
         last_validated_hash = last_validated_header.hash
     }
     Ok(())
@@ -105,6 +105,14 @@ pub trait BlockHeaderStorageOps: Send + Sync + 'static {
     /// Gets the block header by height from the selected coin's storage as BlockHeader
     async fn get_block_header(&self, height: u64) -> Result<Option<BlockHeader>, BlockHeaderStorageError>;
 
+    /// Gets the block headers with `from..=to` heights from the selected coin's storage in one read.
+    /// The heights that aren't stored are absent in the result.
+    async fn get_block_headers_in_range(
+        &self,
+        from: u64,
+        to: u64,
+    ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError>;
+
     /// Gets the block header by height from the selected coin's storage as hex
     async fn get_block_header_raw(&self, height: u64) -> Result<Option<String>, BlockHeaderStorageError>;
 
@@ -217,6 +217,16 @@ pub(crate) mod tests {
             Ok(get_block_headers_for_coin(&self.ticker).get(&height).cloned())
         }
 
+        async fn get_block_headers_in_range(
+            &self,
+            from: u64,
+            to: u64,
+        ) -> Result<HashMap<u64, BlockHeader>, BlockHeaderStorageError> {
+            let mut headers = get_block_headers_for_coin(&self.ticker);
+            headers.retain(|height, _| (from..=to).contains(height));
+            Ok(headers)
+        }
+
         async fn get_block_header_raw(&self, _height: u64) -> Result<Option<String>, BlockHeaderStorageError> {
             Ok(None)
         }
@@ -33,6 +33,7 @@ cfg_wasm32! {
 cfg_native! {
     use db_common::async_sql_conn::AsyncConnection;
     use db_common::sqlite::rusqlite::Connection;
+    use db_common::sqlite::{enable_wal_mode, SqliteReadPool, SqliteReadPoolShared, STATEMENT_CACHE_CAPACITY};
     use rustls::ServerName;
     use mm2_metrics::prometheus;
     use mm2_metrics::MmMetricsError;
@@ -44,6 +45,10 @@ cfg_native! {
 
 /// Default interval to export and record metrics to log.
 const EXPORT_METRICS_INTERVAL: f64 = 5. * 60.;
+/// The number of the read-only connections to `MM2.db` and `KOMODEFI.db` serving the reads
+/// concurrently with the writer connection.
+#[cfg(not(target_arch = "wasm32"))]
+const SQLITE_READERS: usize = 4;
 /// File extension for files containing a wallet's encrypted mnemonic phrase.
 pub const WALLET_FILE_EXTENSION: &str = "json";
 
@@ -126,6 +131,9 @@ pub struct MmCtx {
     /// Deprecated, please use `async_sqlite_connection` for new implementations.
     #[cfg(not(target_arch = "wasm32"))]
     pub sqlite_connection: OnceLock<Arc<Mutex<Connection>>>,
+    /// The read-only connections to the same database as `sqlite_connection`.
+    #[cfg(not(target_arch = "wasm32"))]
+    pub sqlite_read_pool: OnceLock<SqliteReadPoolShared>,
     /// Deprecated, please create `shared_async_sqlite_conn` for new implementations and call db `KOMODEFI-shared.db`.
     #[cfg(not(target_arch = "wasm32"))]
     pub shared_sqlite_conn: OnceLock<Arc<Mutex<Connection>>>,
@@ -160,6 +168,10 @@ pub struct MmCtx {
     /// asynchronous handle for rusqlite connection.
     #[cfg(not(target_arch = "wasm32"))]
     pub async_sqlite_connection: OnceLock<Arc<AsyncMutex<AsyncConnection>>>,
+    /// A handle to the same connection as `async_sqlite_connection` for the read-only queries.
+    /// [`AsyncConnection::call_read`] doesn't need the mutex, so the reads don't wait for a locked write operation.
+    #[cfg(not(target_arch = "wasm32"))]
+    pub async_sqlite_reader: OnceLock<AsyncConnection>,
     /// Links the RPC context to the P2P context to handle health check responses.
     pub healthcheck_response_handler: AsyncMutex<TimedMap<PeerId, oneshot::Sender<()>>>,
     pub wallet_connect: Mutex<Option<Arc<dyn Any + 'static + Send + Sync>>>,
@@ -201,6 +213,8 @@ impl MmCtx {
             #[cfg(not(target_arch = "wasm32"))]
             sqlite_connection: OnceLock::default(),
             #[cfg(not(target_arch = "wasm32"))]
+            sqlite_read_pool: OnceLock::default(),
+            #[cfg(not(target_arch = "wasm32"))]
             shared_sqlite_conn: OnceLock::default(),
             #[cfg(all(feature = "new-db-arch", not(target_arch = "wasm32")))]
             global_db_conn: OnceLock::default(),
@@ -218,6 +232,8 @@ impl MmCtx {
             nft_ctx: Mutex::new(None),
             #[cfg(not(target_arch = "wasm32"))]
             async_sqlite_connection: OnceLock::default(),
+            #[cfg(not(target_arch = "wasm32"))]
+            async_sqlite_reader: OnceLock::default(),
             healthcheck_response_handler: AsyncMutex::new(
                 TimedMap::new_with_map_kind(MapKind::FxHashMap).expiration_tick_cap(3),
             ),
@@ -414,6 +430,7 @@ impl MmCtx {
         mm2_io::fs::create_parents(&path).map_err(|err| AddressDataError::CreateAddressDirFailure(err.into_inner()))?;
         log_sqlite_file_open_attempt(&path);
         let connection = Connection::open(path).map_err(AddressDataError::SqliteConnectionFailure)?;
+        connection.set_prepared_statement_cache_capacity(STATEMENT_CACHE_CAPACITY);
         Ok(connection)
     }
 
@@ -498,11 +515,18 @@ impl MmCtx {
     pub fn init_sqlite_connection(&self) -> Result<(), String> {
         let sqlite_file_path = self.dbdir().join("MM2.db");
         log_sqlite_file_open_attempt(&sqlite_file_path);
-        let connection = try_s!(Connection::open(sqlite_file_path));
+        let connection = try_s!(Connection::open(&sqlite_file_path));
+        connection.set_prepared_statement_cache_capacity(STATEMENT_CACHE_CAPACITY);
+        try_s!(enable_wal_mode(&connection));
+        let read_pool = try_s!(SqliteReadPool::open(&sqlite_file_path, SQLITE_READERS));
         try_s!(self
             .sqlite_connection
             .set(Arc::new(Mutex::new(connection)))
             .map_err(|_| "Already initialized".to_string()));
+        try_s!(self
+            .sqlite_read_pool
+            .set(Arc::new(read_pool))
+            .map_err(|_| "Already initialized".to_string()));
         Ok(())
     }
 
@@ -511,6 +535,7 @@ impl MmCtx {
         let sqlite_file_path = self.shared_dbdir().join("MM2-shared.db");
         log_sqlite_file_open_attempt(&sqlite_file_path);
         let connection = try_s!(Connection::open(sqlite_file_path));
+        connection.set_prepared_statement_cache_capacity(STATEMENT_CACHE_CAPACITY);
         try_s!(self
             .shared_sqlite_conn
             .set(Arc::new(Mutex::new(connection)))
@@ -522,7 +547,11 @@ impl MmCtx {
     pub async fn init_async_sqlite_connection(&self) -> Result<(), String> {
         let sqlite_file_path = self.dbdir().join("KOMODEFI.db");
         log_sqlite_file_open_attempt(&sqlite_file_path);
-        let async_conn = try_s!(AsyncConnection::open(sqlite_file_path).await);
+        let async_conn = try_s!(AsyncConnection::open_pooled(sqlite_file_path, SQLITE_READERS).await);
+        try_s!(self
+            .async_sqlite_reader
+            .set(async_conn.clone())
+            .map_err(|_| "Already initialized".to_string()));
         try_s!(self
             .async_sqlite_connection
             .set(Arc::new(AsyncMutex::new(async_conn)))
@@ -784,6 +813,10 @@ impl MmArc {
                 .init_with_dashboard(&self.spawner(), self.log.weak(), interval));
         }
 
+        // The spans of the hot paths are measured unless disabled explicitly.
+        let spans_enabled = self.conf["metrics_spans"].as_bool().unwrap_or(true);
+        self.metrics.set_spans_enabled(spans_enabled);
+
         #[cfg(not(target_arch = "wasm32"))]
         try_s!(self.spawn_prometheus_exporter());
 
@@ -0,0 +1,220 @@
+//! A bounded per-client event queue that coalesces the queued events of the same item.
+//!
+//! A client that reads its events slower than they are broadcast (e.g. a GUI subscribed to a busy orderbook) would
+//! otherwise receive a long backlog of stale updates or lose the newest ones once its queue is full.
+//! Events with a [`Event::coalesce_key`] replace the queued, not yet delivered event of the same key, and the
+//! events that don't fit into a full queue are dropped, not blocking the broadcast to other clients.
+use std::collections::{HashMap, VecDeque};
+use std::fmt;
+use std::hash::{Hash, Hasher};
+use std::sync::Arc;
+
+use crate::Event;
+use common::log::warn;
+
+use parking_lot::Mutex;
+use tokio::sync::mpsc::error::TryRecvError;
+use tokio::sync::Notify;
+
+/// How many events can be queued for a single client before the new ones get dropped.
+// Note that events queued are `Arc<` shared. So a 1024 long buffer isn't actually heavy on memory.
+pub(crate) const CLIENT_QUEUE_CAPACITY: usize = 1024;
+
+/// Identifies the queued event of a streamer for some item, see [`Event::coalesce_key`].
+struct CoalesceKey(Arc<Event>);
+
+impl PartialEq for CoalesceKey {
+    fn eq(&self, other: &Self) -> bool {
+        self.0.origin() == other.0.origin() && self.0.coalesce_key() == other.0.coalesce_key()
+    }
+}
+
+impl Eq for CoalesceKey {}
+
+impl Hash for CoalesceKey {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.0.origin().hash(state);
+        self.0.coalesce_key().hash(state);
+    }
+}
+
+#[derive(Default)]
+struct QueueState {
+    events: VecDeque<Arc<Event>>,
+    /// The sequence number of the event in the front of the queue.
+    front_seq: u64,
+    /// The sequence numbers of the queued events that have a coalesce key.
+    pending: HashMap<CoalesceKey, u64>,
+    /// How many events were dropped since the last received event.
+    dropped: usize,
+    /// Whether the client is removed and no more events will be queued.
+    closed: bool,
+}
+
+pub(crate) struct ClientQueue {
+    client_id: u64,
+    state: Mutex<QueueState>,
+    notify: Notify,
+}
+
+impl fmt::Debug for ClientQueue {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("ClientQueue")
+            .field("client_id", &self.client_id)
+            .finish()
+    }
+}
+
+impl ClientQueue {
+    pub(crate) fn new(client_id: u64) -> Self {
+        Self {
+            client_id,
+            state: Mutex::new(QueueState::default()),
+            notify: Notify::new(),
+        }
+    }
+
+    /// Queues the event for the client, never blocking.
+    pub(crate) fn push(&self, event: Arc<Event>) {
+        let mut state = self.state.lock();
+        if state.closed {
+            return;
+        }
+
+        let key = event.coalesce_key().map(|_| CoalesceKey(event.clone()));
+        if let Some(key) = key {
+            if let Some(seq) = state.pending.remove(&key) {
+                // The client didn't receive the previous state of this item yet, so replace it in place.
+                let index = (seq - state.front_seq) as usize;
+                state.events[index] = event;
+                state.pending.insert(key, seq);
+                return;
+            }
+            if state.events.len() >= CLIENT_QUEUE_CAPACITY {
+                state.dropped += 1;
+                return;
+            }
+            let seq = state.front_seq + state.events.len() as u64;
+            state.pending.insert(key, seq);
+        } else if state.events.len() >= CLIENT_QUEUE_CAPACITY {
+            state.dropped += 1;
+            return;
+        }
+
+        state.events.push_back(event);
+        drop(state);
+        self.notify.notify_one();
+    }
+
+    /// Closes the queue. The events that are already queued can still be received.
+    pub(crate) fn close(&self) {
+        self.state.lock().closed = true;
+        self.notify.notify_one();
+    }
+
+    /// Pops the next event if there is any.
+    pub(crate) fn try_pop(&self) -> Result<Arc<Event>, TryRecvError> {
+        let mut state = self.state.lock();
+        let Some(event) = state.events.pop_front() else {
+            return Err(if state.closed {
+                TryRecvError::Disconnected
+            } else {
+                TryRecvError::Empty
+            });
+        };
+        state.front_seq += 1;
+        if event.coalesce_key().is_some() {
+            state.pending.remove(&CoalesceKey(event.clone()));
+        }
+        let dropped = std::mem::take(&mut state.dropped);
+        drop(state);
+
+        if dropped > 0 {
+            warn!(
+                "{dropped} events were dropped for client {} since its queue was full",
+                self.client_id
+            );
+        }
+        Ok(event)
+    }
+
+    /// Waits for the next event. Returns `None` once the queue is closed and all the queued events are received.
+    pub(crate) async fn pop(&self) -> Option<Arc<Event>> {
+        loop {
+            match self.try_pop() {
+                Ok(event) => return Some(event),
+                Err(TryRecvError::Disconnected) => return None,
+                // `Notify` stores a permit if an event is pushed before we start waiting.
+                Err(TryRecvError::Empty) => self.notify.notified().await,
+            }
+        }
+    }
+}
+
+#[cfg(any(test, target_arch = "wasm32"))]
+mod tests {
+    use super::*;
+    use crate::StreamerId;
+
+    use common::{cfg_wasm32, cross_test};
+    use serde_json::json;
+    cfg_wasm32! {
+        use wasm_bindgen_test::*;
+        wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+    }
+
+    fn streamer_id(name: &str) -> StreamerId {
+        StreamerId::ForTesting {
+            test_streamer: name.to_string(),
+        }
+    }
+
+    cross_test!(test_coalesce_queued_events, {
+        let queue = ClientQueue::new(1);
+        let update = |key: &str, value: u32| {
+            Arc::new(Event::new(streamer_id("orderbook"), json!(value)).with_coalesce_key(key.to_string()))
+        };
+
+        queue.push(update("a", 1));
+        queue.push(update("b", 1));
+        queue.push(Arc::new(Event::new(streamer_id("orderbook"), json!("no key"))));
+        // Supersedes the queued state of "a".
+        queue.push(update("a", 2));
+        // The same key from a different streamer isn't coalesced.
+        queue.push(Arc::new(
+            Event::new(streamer_id("other"), json!(1)).with_coalesce_key("a".to_string()),
+        ));
+
+        assert_eq!(queue.try_pop().unwrap().get().1, &json!(2));
+        // "a" is delivered, so the next state of it is queued again.
+        queue.push(update("a", 3));
+        assert_eq!(queue.try_pop().unwrap().get().1, &json!(1));
+        assert_eq!(queue.try_pop().unwrap().get().1, &json!("no key"));
+        assert_eq!(queue.try_pop().unwrap().origin(), &streamer_id("other"));
+        assert_eq!(queue.try_pop().unwrap().get().1, &json!(3));
+        assert!(matches!(queue.try_pop(), Err(TryRecvError::Empty)));
+    });
+
+    cross_test!(test_full_queue_drops_events, {
+        let queue = ClientQueue::new(1);
+        for i in 0..CLIENT_QUEUE_CAPACITY + 1 {
+            queue.push(Arc::new(Event::new(streamer_id("test"), json!(i))));
+        }
+        // An event of an item that isn't queued yet is dropped too.
+        queue.push(Arc::new(
+            Event::new(streamer_id("test"), json!("first")).with_coalesce_key("a".to_string()),
+        ));
+
+        for i in 0..CLIENT_QUEUE_CAPACITY {
+            assert_eq!(queue.try_pop().unwrap().get().1, &json!(i));
+        }
+        assert!(matches!(queue.try_pop(), Err(TryRecvError::Empty)));
+
+        queue.push(Arc::new(Event::new(streamer_id("test"), json!("last"))));
+        queue.close();
+        // Pushing to a closed queue is ignored, but the queued events are still received.
+        queue.push(Arc::new(Event::new(streamer_id("test"), json!("ignored"))));
+        assert_eq!(queue.pop().await.unwrap().get().1, &json!("last"));
+        assert!(queue.pop().await.is_none());
+    });
+}
@@ -1,5 +1,7 @@
 use crate::StreamerId;
+use serde::Serialize;
 use serde_json::Value as Json;
+use std::sync::OnceLock;
 
 // Note `Event` shouldn't be `Clone`able, but rather Arc/Rc wrapped and then shared.
 // This is only for testing.
@@ -12,6 +14,21 @@ pub struct Event {
     message: Json,
     /// Indicating whether this event is an error event or a normal one.
     error: bool,
+    /// The item this event reports the state of (e.g. an order UUID), if any.
+    ///
+    /// A queued event that isn't delivered to a client yet is replaced by a newer event from the same streamer
+    /// with the same key, so slow clients of high-rate streamers only receive the latest state of every item.
+    coalesce_key: Option<String>,
+    /// The serialized event, serialized once on the first use and shared by all the clients.
+    payload: OnceLock<String>,
+}
+
+/// The serialized form of an event as sent to the clients.
+#[derive(Serialize)]
+struct EventPayload<'a> {
+    #[serde(rename = "_type")]
+    event_type: String,
+    message: &'a Json,
 }
 
 impl Event {
@@ -22,6 +39,8 @@ impl Event {
             streamer_id,
             message,
             error: false,
+            coalesce_key: None,
+            payload: OnceLock::new(),
         }
     }
 
@@ -32,9 +51,18 @@ impl Event {
             streamer_id,
             message,
             error: true,
+            coalesce_key: None,
+            payload: OnceLock::new(),
         }
     }
 
+    /// Marks the event as reporting the state of the item with `key`, see [`Event::coalesce_key`].
+    #[inline(always)]
+    pub fn with_coalesce_key(mut self, key: String) -> Self {
+        self.coalesce_key = Some(key);
+        self
+    }
+
     /// Returns whether this event is an error or not
     #[inline(always)]
     pub fn is_error(&self) -> bool { self.error }
@@ -43,9 +71,50 @@ impl Event {
     #[inline(always)]
     pub fn origin(&self) -> &StreamerId { &self.streamer_id }
 
+    /// Returns the key of the item the event reports the state of, if any.
+    #[inline(always)]
+    pub fn coalesce_key(&self) -> Option<&str> { self.coalesce_key.as_deref() }
+
     /// Returns the event type and message as a pair.
     pub fn get(&self) -> (String, &Json) {
         let prefix = if self.error { "ERROR:" } else { "" };
         (format!("{prefix}{}", self.streamer_id), &self.message)
     }
+
+    /// Returns the event serialized as `{"_type": <event type>, "message": <message>}`.
+    ///
+    /// The event is serialized on the first call only, so broadcasting it to many clients doesn't
+    /// serialize it once per client.
+    pub fn payload(&self) -> &str {
+        self.payload.get_or_init(|| {
+            let (event_type, message) = self.get();
+            serde_json::to_string(&EventPayload { event_type, message }).expect("Serialization shouldn't fail.")
+        })
+    }
+}
+
+#[cfg(any(test, target_arch = "wasm32"))]
+mod tests {
+    use super::*;
+    use common::{cfg_wasm32, cross_test};
+    use serde_json::json;
+    cfg_wasm32! {
+        use wasm_bindgen_test::*;
+        wasm_bindgen_test::wasm_bindgen_test_configure!(run_in_browser);
+    }
+
+    cross_test!(test_event_payload, {
+        let streamer_id = StreamerId::ForTesting {
+            test_streamer: "test".to_string(),
+        };
+        let event = Event::new(streamer_id.clone(), json!({"a": 1}));
+        let expected = json!({"_type": streamer_id.to_string(), "message": {"a": 1}});
+        assert_eq!(serde_json::from_str::<Json>(event.payload()).unwrap(), expected);
+        // The payload is serialized once and then reused.
+        assert!(std::ptr::eq(event.payload(), event.payload()));
+
+        let event = Event::err(streamer_id.clone(), json!("error"));
+        let expected = json!({"_type": format!("ERROR:{streamer_id}"), "message": "error"});
+        assert_eq!(serde_json::from_str::<Json>(event.payload()).unwrap(), expected);
+    });
 }
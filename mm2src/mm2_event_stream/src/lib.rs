@@ -1,3 +1,4 @@
+mod client_queue;
 pub mod configuration;
 pub mod event;
 pub mod manager;
@@ -7,6 +8,6 @@ pub mod streamer_ids;
 // Re-export important types.
 pub use configuration::EventStreamingConfiguration;
 pub use event::Event;
-pub use manager::{StreamingManager, StreamingManagerError};
+pub use manager::{ClientHandle, StreamingManager, StreamingManagerError};
 pub use streamer::{Broadcaster, EventStreamer, NoDataIn, StreamHandlerInput};
 pub use streamer_ids::StreamerId;
@@ -3,16 +3,17 @@ use std::collections::{HashMap, HashSet};
 use std::ops::{Deref, DerefMut};
 use std::sync::Arc;
 
+use crate::client_queue::ClientQueue;
 use crate::streamer::spawn;
 use crate::{Event, EventStreamer, StreamerId};
 use common::executor::abortable_queue::WeakSpawner;
-use common::log::{error, LogOnError};
+use common::log::error;
 
 use common::on_drop_callback::OnDropCallback;
 use futures::channel::mpsc::UnboundedSender;
 use futures::channel::oneshot;
 use parking_lot::{RwLock, RwLockReadGuard, RwLockWriteGuard};
-use tokio::sync::mpsc;
+use tokio::sync::mpsc::error::TryRecvError;
 
 /// The errors that could originate from the streaming manager.
 #[derive(Debug)]
@@ -63,20 +64,15 @@ impl StreamerInfo {
 struct ClientInfo {
     /// The streamers the client is listening to.
     listening_to: HashSet<StreamerId>,
-    /// The communication/stream-out channel to the client.
-    // NOTE: Here we are using `tokio`'s `mpsc` because the one in `futures` have some extra feature
-    // (ref: https://users.rust-lang.org/t/why-does-try-send-from-crate-futures-require-mut-self/100389).
-    // This feature is aimed towards the multi-producer case (which we don't use) and requires a mutable
-    // reference on `try_send` calls. This will require us to put the channel in a mutex and degrade the
-    // broadcasting performance.
-    channel: mpsc::Sender<Arc<Event>>,
+    /// The stream-out queue of the client.
+    queue: Arc<ClientQueue>,
 }
 
 impl ClientInfo {
-    fn new(channel: mpsc::Sender<Arc<Event>>) -> Self {
+    fn new(queue: Arc<ClientQueue>) -> Self {
         Self {
             listening_to: HashSet::new(),
-            channel,
+            queue,
         }
     }
 
@@ -85,13 +81,11 @@ impl ClientInfo {
     fn remove_streamer(&mut self, streamer_id: &StreamerId) { self.listening_to.remove(streamer_id); }
 
     fn listens_to(&self, streamer_id: &StreamerId) -> bool { self.listening_to.contains(streamer_id) }
+}
 
-    fn send_event(&self, event: Arc<Event>) {
-        // Only `try_send` here. If the channel is full (client is slow), the message
-        // will be dropped and the client won't receive it.
-        // This avoids blocking the broadcast to other receivers.
-        self.channel.try_send(event).error_log();
-    }
+impl Drop for ClientInfo {
+    /// The client is removed from the manager, so no more events will be sent to it.
+    fn drop(&mut self) { self.queue.close(); }
 }
 
 #[derive(Default, Debug)]
@@ -102,15 +96,96 @@ struct StreamingManagerInner {
     clients: HashMap<u64, ClientInfo>,
 }
 
+/// The data in/out channels of a streamer.
+#[derive(Debug)]
+struct StreamerFanOut {
+    /// The communication channel to the streamer.
+    data_in: Option<UnboundedSender<Box<dyn Any + Send>>>,
+    /// The queues of the clients the streamer is serving for.
+    clients: Vec<Arc<ClientQueue>>,
+}
+
+/// A read-only snapshot of [`StreamingManagerInner`] keeping only what's needed to send and broadcast.
+///
+/// Sending data to streamers and broadcasting events to clients happen far more often than (un)subscribing,
+/// so these hot paths only clone the current snapshot and never hold the registry lock while fanning out.
+/// A new snapshot is published on every change of the registry instead.
+#[derive(Default, Debug)]
+struct FanOut {
+    streamers: HashMap<StreamerId, StreamerFanOut>,
+    clients: HashMap<u64, Arc<ClientQueue>>,
+}
+
+impl FanOut {
+    fn new(inner: &StreamingManagerInner) -> Self {
+        let streamers = inner
+            .streamers
+            .iter()
+            .map(|(streamer_id, streamer_info)| {
+                let clients = streamer_info
+                    .clients
+                    .iter()
+                    .filter_map(|client_id| inner.clients.get(client_id))
+                    .map(|client_info| client_info.queue.clone())
+                    .collect();
+                let fan_out = StreamerFanOut {
+                    data_in: streamer_info.data_in.clone(),
+                    clients,
+                };
+                (streamer_id.clone(), fan_out)
+            })
+            .collect();
+        let clients = inner
+            .clients
+            .iter()
+            .map(|(client_id, client_info)| (*client_id, client_info.queue.clone()))
+            .collect();
+        FanOut { streamers, clients }
+    }
+}
+
+/// A write guard over the streaming manager that publishes a new [`FanOut`] snapshot when dropped.
+struct WriteGuard<'a> {
+    inner: RwLockWriteGuard<'a, StreamingManagerInner>,
+    fan_out: &'a RwLock<Arc<FanOut>>,
+}
+
+impl Deref for WriteGuard<'_> {
+    type Target = StreamingManagerInner;
+    fn deref(&self) -> &Self::Target { &self.inner }
+}
+
+impl DerefMut for WriteGuard<'_> {
+    fn deref_mut(&mut self) -> &mut Self::Target { &mut self.inner }
+}
+
+impl Drop for WriteGuard<'_> {
+    // The snapshot is published while the registry is still locked, so the snapshots are published in order.
+    fn drop(&mut self) { *self.fan_out.write() = Arc::new(FanOut::new(&self.inner)); }
+}
+
 #[derive(Clone, Default, Debug)]
-pub struct StreamingManager(Arc<RwLock<StreamingManagerInner>>);
+pub struct StreamingManager {
+    /// The registry of streamers and clients.
+    inner: Arc<RwLock<StreamingManagerInner>>,
+    /// The latest snapshot of `inner`, see [`FanOut`].
+    fan_out: Arc<RwLock<Arc<FanOut>>>,
+}
 
 impl StreamingManager {
     /// Returns a read guard over the streaming manager.
-    fn read(&self) -> RwLockReadGuard<StreamingManagerInner> { self.0.read() }
+    fn read(&self) -> RwLockReadGuard<StreamingManagerInner> { self.inner.read() }
 
     /// Returns a write guard over the streaming manager.
-    fn write(&self) -> RwLockWriteGuard<StreamingManagerInner> { self.0.write() }
+    fn write(&self) -> WriteGuard {
+        WriteGuard {
+            inner: self.inner.write(),
+            fan_out: &self.fan_out,
+        }
+    }
+
+    /// Returns the latest snapshot of the streaming manager.
+    fn fan_out(&self) -> Arc<FanOut> { self.fan_out.read().clone() }
 
     /// Spawns and adds a new streamer `streamer` to the manager.
     pub async fn add(
@@ -174,8 +249,8 @@ impl StreamingManager {
 
     /// Sends data to a streamer with `streamer_id`.
     pub fn send<T: Send + 'static>(&self, streamer_id: &StreamerId, data: T) -> Result<(), StreamingManagerError> {
-        let this = self.read();
-        let streamer_info = this
+        let fan_out = self.fan_out();
+        let streamer_info = fan_out
             .streamers
             .get(streamer_id)
             .ok_or(StreamingManagerError::StreamerNotFound)?;
@@ -195,8 +270,8 @@ impl StreamingManager {
         streamer_id: &StreamerId,
         data_fn: impl FnOnce() -> T,
     ) -> Result<(), StreamingManagerError> {
-        let this = self.read();
-        let streamer_info = this
+        let fan_out = self.fan_out();
+        let streamer_info = fan_out
             .streamers
             .get(streamer_id)
             .ok_or(StreamingManagerError::StreamerNotFound)?;
@@ -234,13 +309,9 @@ impl StreamingManager {
     /// of any streamer (i.e. bypassing any streamer).
     pub fn broadcast(&self, event: Event) {
         let event = Arc::new(event);
-        let this = self.read();
-        if let Some(client_ids) = this.streamers.get(event.origin()).map(|info| &info.clients) {
-            client_ids.iter().for_each(|client_id| {
-                if let Some(info) = this.clients.get(client_id) {
-                    info.send_event(event.clone());
-                }
-            });
+        let fan_out = self.fan_out();
+        if let Some(streamer_info) = fan_out.streamers.get(event.origin()) {
+            streamer_info.clients.iter().for_each(|queue| queue.push(event.clone()));
         };
     }
 
@@ -249,18 +320,18 @@ impl StreamingManager {
     /// Could be used in case we have a single known client and don't want to spawn up a streamer just for that.
     pub fn broadcast_to(&self, event: Event, client_id: u64) -> Result<(), StreamingManagerError> {
         let event = Arc::new(event);
-        self.read()
+        self.fan_out()
             .clients
             .get(&client_id)
-            .map(|info| info.send_event(event))
+            .map(|queue| queue.push(event))
             .ok_or(StreamingManagerError::UnknownClient)
     }
 
     /// Forcefully broadcasts an event to all known clients even if they are not listening for such an event.
     pub fn broadcast_all(&self, event: Event) {
         let event = Arc::new(event);
-        self.read().clients.values().for_each(|info| {
-            info.send_event(event.clone());
+        self.fan_out().clients.values().for_each(|queue| {
+            queue.push(event.clone());
         });
     }
 
@@ -270,14 +341,12 @@ impl StreamingManager {
         if this.clients.contains_key(&client_id) {
             return Err(StreamingManagerError::ClientExists);
         }
-        // Note that events queued in the channel are `Arc<` shared.
-        // So a 1024 long buffer isn't actually heavy on memory.
-        let (tx, rx) = mpsc::channel(1024);
-        let client_info = ClientInfo::new(tx);
+        let queue = Arc::new(ClientQueue::new(client_id));
+        let client_info = ClientInfo::new(queue.clone());
         this.clients.insert(client_id, client_info);
         let manager = self.clone();
         Ok(ClientHandle {
-            rx,
+            queue,
             _on_drop_callback: OnDropCallback::new(move || {
                 manager.remove_client(client_id).ok();
             }),
@@ -293,15 +362,15 @@ impl StreamingManager {
             .remove(&client_id)
             .ok_or(StreamingManagerError::UnknownClient)?;
         // Remove the client from all the streamers it was listening to.
-        for streamer_id in client_info.listening_to {
-            if let Some(streamer_info) = this.streamers.get_mut(&streamer_id) {
+        for streamer_id in &client_info.listening_to {
+            if let Some(streamer_info) = this.streamers.get_mut(streamer_id) {
                 streamer_info.remove_client(&client_id);
             } else {
                 error!("Client {client_id} was listening to a non-existent streamer {streamer_id}. This is a bug!");
             }
             // If there are no more listening clients, terminate the streamer.
-            if this.streamers.get(&streamer_id).map(|info| info.clients.len()) == Some(0) {
-                this.streamers.remove(&streamer_id);
+            if this.streamers.get(streamer_id).map(|info| info.clients.len()) == Some(0) {
+                this.streamers.remove(streamer_id);
             }
         }
         Ok(())
@@ -337,19 +406,18 @@ impl StreamingManager {
 /// the client when dropped.
 /// So this handle must live as long as the client is connected.
 pub struct ClientHandle {
-    rx: mpsc::Receiver<Arc<Event>>,
+    queue: Arc<ClientQueue>,
     _on_drop_callback: OnDropCallback,
 }
 
-/// Deref the handle to the receiver inside for ease of use.
-impl Deref for ClientHandle {
-    type Target = mpsc::Receiver<Arc<Event>>;
-    fn deref(&self) -> &Self::Target { &self.rx }
-}
+impl ClientHandle {
+    /// Receives the next event for the client.
+    ///
+    /// Returns `None` if the client is removed from the manager and all its queued events are received.
+    pub async fn recv(&mut self) -> Option<Arc<Event>> { self.queue.pop().await }
 
-/// Also DerefMut since the receiver inside is mutated when consumed.
-impl DerefMut for ClientHandle {
-    fn deref_mut(&mut self) -> &mut Self::Target { &mut self.rx }
+    /// Receives the next event for the client if there is any queued.
+    pub fn try_recv(&mut self) -> Result<Arc<Event>, TryRecvError> { self.queue.try_pop() }
 }
 
 #[cfg(any(test, target_arch = "wasm32"))]
@@ -520,7 +588,6 @@ mod tests {
 
         // The streamer is up and streaming to `client_id`.
         assert!(manager
-            .0
             .read()
             .streamers
             .get(&streamer_id)
@@ -529,13 +596,7 @@ mod tests {
             .contains(&client_id));
 
         // The client should be registered and listening to `streamer_id`.
-        assert!(manager
-            .0
-            .read()
-            .clients
-            .get(&client_id)
-            .unwrap()
-            .listens_to(&streamer_id));
+        assert!(manager.read().clients.get(&client_id).unwrap().listens_to(&streamer_id));
 
         // Abort the system to kill the streamer.
         system.abort_all().unwrap();
@@ -547,12 +608,6 @@ mod tests {
         // The streamer should be removed.
         assert!(manager.read().streamers.get(&streamer_id).is_none());
         // And the client is no more listening to it.
-        assert!(!manager
-            .0
-            .read()
-            .clients
-            .get(&client_id)
-            .unwrap()
-            .listens_to(&streamer_id));
+        assert!(!manager.read().clients.get(&client_id).unwrap().listens_to(&streamer_id));
     });
 }
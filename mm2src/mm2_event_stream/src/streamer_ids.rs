@@ -13,6 +13,7 @@ const TX_HISTORY_PREFIX: &str = "TX_HISTORY:";
 const FEE_ESTIMATION_PREFIX: &str = "FEE_ESTIMATION:";
 const DATA_NEEDED_PREFIX: &str = "DATA_NEEDED:";
 const ORDERBOOK_UPDATE_PREFIX: &str = "ORDERBOOK_UPDATE:";
+const ORDERBOOK_DEPTH_PREFIX: &str = "ORDERBOOK_DEPTH:";
 #[cfg(any(test, target_arch = "wasm32"))]
 const FOR_TESTING_PREFIX: &str = "TEST_STREAMER:";
 
@@ -40,6 +41,10 @@ pub enum StreamerId {
     OrderbookUpdate {
         topic: String,
     },
+    OrderbookDepth {
+        base: String,
+        rel: String,
+    },
     #[cfg(any(test, target_arch = "wasm32"))]
     ForTesting {
         test_streamer: String,
@@ -59,6 +64,7 @@ impl fmt::Display for StreamerId {
             StreamerId::FeeEstimation { coin } => write!(f, "{}{}", FEE_ESTIMATION_PREFIX, coin),
             StreamerId::DataNeeded { data_type } => write!(f, "{}{}", DATA_NEEDED_PREFIX, data_type),
             StreamerId::OrderbookUpdate { topic } => write!(f, "{}{}", ORDERBOOK_UPDATE_PREFIX, topic),
+            StreamerId::OrderbookDepth { base, rel } => write!(f, "{}{}/{}", ORDERBOOK_DEPTH_PREFIX, base, rel),
             #[cfg(any(test, target_arch = "wasm32"))]
             StreamerId::ForTesting { test_streamer } => write!(f, "{}{}", FOR_TESTING_PREFIX, test_streamer),
         }
@@ -115,6 +121,15 @@ impl<'de> Deserialize<'de> for StreamerId {
                     v if v.starts_with(ORDERBOOK_UPDATE_PREFIX) => Ok(StreamerId::OrderbookUpdate {
                         topic: v[ORDERBOOK_UPDATE_PREFIX.len()..].to_string(),
                     }),
+                    v if v.starts_with(ORDERBOOK_DEPTH_PREFIX) => {
+                        let (base, rel) = v[ORDERBOOK_DEPTH_PREFIX.len()..]
+                            .split_once('/')
+                            .ok_or_else(|| de::Error::custom(format!("Invalid StreamerId: {}", value)))?;
+                        Ok(StreamerId::OrderbookDepth {
+                            base: base.to_string(),
+                            rel: rel.to_string(),
+                        })
+                    },
                     #[cfg(any(test, target_arch = "wasm32"))]
                     v if v.starts_with(FOR_TESTING_PREFIX) => Ok(StreamerId::ForTesting {
                         test_streamer: v[FOR_TESTING_PREFIX.len()..].to_string(),
@@ -0,0 +1,91 @@
+//! Compares `PriceIndex` with the `BTreeSet` keyed by `BigRational` prices the orderbook used previously.
+//!
+//! Run with `cargo bench -p mm2_main --bench orderbook_price_index`.
+
+#![feature(test)]
+
+extern crate test;
+
+use mm2_main::lp_ordermatch::price_index::PriceIndex;
+use mm2_number::{BigInt, BigRational};
+use std::collections::BTreeSet;
+use test::{black_box, Bencher};
+use uuid::Uuid;
+
+const ORDERS_NUMBER: usize = 10_000;
+const TOP_N: usize = 100;
+
+/// Generates `ORDERS_NUMBER` deterministic prices with 8 decimal places, as the GUI prices usually are.
+fn orders() -> Vec<(BigRational, Uuid)> {
+    let mut seed: u64 = 0x2545_f491_4f6c_dd1d;
+    (0..ORDERS_NUMBER)
+        .map(|i| {
+            seed = seed
+                .wrapping_mul(6_364_136_223_846_793_005)
+                .wrapping_add(1_442_695_040_888_963_407);
+            let numer = BigInt::from(seed >> 32);
+            let price = BigRational::new(numer, BigInt::from(100_000_000u64));
+            (price, Uuid::from_u128(i as u128))
+        })
+        .collect()
+}
+
+fn btree_set(orders: &[(BigRational, Uuid)]) -> BTreeSet<(BigRational, Uuid)> { orders.iter().cloned().collect() }
+
+fn price_index(orders: &[(BigRational, Uuid)]) -> PriceIndex {
+    let mut index = PriceIndex::default();
+    for (price, uuid) in orders {
+        index.insert(price, *uuid);
+    }
+    index
+}
+
+#[bench]
+fn bench_btree_set_insert(b: &mut Bencher) {
+    let orders = orders();
+    b.iter(|| black_box(btree_set(&orders)));
+}
+
+#[bench]
+fn bench_price_index_insert(b: &mut Bencher) {
+    let orders = orders();
+    b.iter(|| black_box(price_index(&orders)));
+}
+
+#[bench]
+fn bench_btree_set_remove(b: &mut Bencher) {
+    let orders = orders();
+    let set = btree_set(&orders);
+    b.iter(|| {
+        let mut set = set.clone();
+        for order in orders.iter() {
+            set.remove(order);
+        }
+        black_box(set)
+    });
+}
+
+#[bench]
+fn bench_price_index_remove(b: &mut Bencher) {
+    let orders = orders();
+    let index = price_index(&orders);
+    b.iter(|| {
+        let mut index = index.clone();
+        for (price, uuid) in orders.iter() {
+            index.remove(price, uuid);
+        }
+        black_box(index)
+    });
+}
+
+#[bench]
+fn bench_btree_set_top_n(b: &mut Bencher) {
+    let set = btree_set(&orders());
+    b.iter(|| black_box(set.iter().take(TOP_N).map(|(_, uuid)| *uuid).collect::<Vec<_>>()));
+}
+
+#[bench]
+fn bench_price_index_top_n(b: &mut Bencher) {
+    let index = price_index(&orders());
+    b.iter(|| black_box(index.iter().take(TOP_N).copied().collect::<Vec<_>>()));
+}
@@ -0,0 +1,264 @@
+//! Measures the ordermatch of a relay node: applying the maker gossip to the orderbook, answering the orderbook sync,
+//! best orders and orderbook requests of the other peers, matching a taker request against the maker orders
+//! and dispatching the RPC requests.
+//!
+//! Matching the taker requests is the part of the request to `MakerReserved` latency not depending
+//! on the activated coins, and the whole latency is recorded by the `ordermatch.taker_request.duration` span.
+//!
+//! Run with `cargo bench -p mm2_main --bench ordermatch`.
+
+#![feature(test)]
+
+extern crate test;
+
+mod ordermatch_gossip;
+
+use common::{block_on, new_uuid};
+use mm2_core::mm_ctx::MmArc;
+use mm2_libp2p::application::request_response::ordermatch::{BestOrdersAction, OrdermatchRequest};
+use mm2_main::lp_ordermatch::maker_orders_index::MakerOrdersIndex;
+use mm2_main::lp_ordermatch::{process_peer_request, pubkey_trie_roots, MakerOrder, OrderMatchResult, TakerRequest};
+use mm2_main::rpc::process_json_request;
+use mm2_number::{BigInt, BigRational};
+use ordermatch_gossip::{makers, order_created, order_emptied, order_price_updated, pair, relay_ctx, seed_orders, Lcg,
+                        SyntheticMaker, COINS, RPC_PASSWORD};
+use serde_json::{self as json, json, Value as Json};
+use std::collections::HashMap;
+use std::net::SocketAddr;
+use test::{black_box, Bencher};
+use uuid::Uuid;
+
+const MAKERS_NUMBER: usize = 100;
+const ORDERS_PER_MAKER: usize = 10;
+const MAKER_ORDERS_NUMBER: usize = 1000;
+/// The number of pairs the maker orders of a market making node are spread over.
+const MAKER_ORDERS_PAIRS: usize = 50;
+const SEED: u64 = 0x2545_f491_4f6c_dd1d;
+
+/// The relay with `MAKERS_NUMBER * ORDERS_PER_MAKER` orders spread over all the pairs of `COINS`.
+fn seeded_relay() -> (MmArc, Vec<SyntheticMaker>, Vec<Vec<Uuid>>) {
+    let ctx = relay_ctx();
+    let makers = makers(MAKERS_NUMBER);
+    let uuids = seed_orders(&ctx, &makers, ORDERS_PER_MAKER, &mut Lcg::new(SEED));
+    (ctx, makers, uuids)
+}
+
+fn process_request(ctx: &MmArc, request: OrdermatchRequest) -> Option<Vec<u8>> {
+    process_peer_request(ctx.clone(), request).expect("!process_peer_request")
+}
+
+#[bench]
+fn bench_gossip_order_insert_remove(b: &mut Bencher) {
+    let (ctx, makers, _) = seeded_relay();
+    let mut rng = Lcg::new(SEED);
+    let uuid = new_uuid();
+    let created = makers[0].sign(order_created(uuid, pair(0), &mut rng));
+    let emptied = makers[0].sign(order_emptied(uuid));
+    b.iter(|| {
+        ordermatch_gossip::process(&ctx, &created);
+        ordermatch_gossip::process(&ctx, &emptied);
+    });
+}
+
+#[bench]
+fn bench_gossip_order_update(b: &mut Bencher) {
+    let (ctx, makers, uuids) = seeded_relay();
+    let mut rng = Lcg::new(SEED);
+    let updates: Vec<_> = makers
+        .iter()
+        .zip(uuids.iter())
+        .map(|(maker, uuids)| maker.sign(order_price_updated(uuids[0], &mut rng)))
+        .collect();
+    let mut updates = updates.iter().cycle();
+    b.iter(|| ordermatch_gossip::process(&ctx, updates.next().unwrap()));
+}
+
+#[bench]
+fn bench_sync_pubkey_orderbook_state_full_trie(b: &mut Bencher) {
+    let (ctx, makers, _) = seeded_relay();
+    let pubkey = makers[0].pubkey.clone();
+    // The roots unknown to the relay are answered with the full pair tries.
+    let trie_roots: Vec<_> = pubkey_trie_roots(&ctx, &pubkey).into_keys().collect();
+    b.iter(|| {
+        let trie_roots = trie_roots.iter().map(|pair| (pair.clone(), [0; 8])).collect();
+        black_box(process_request(&ctx, OrdermatchRequest::SyncPubkeyOrderbookState {
+            pubkey: pubkey.clone(),
+            trie_roots,
+        }))
+    });
+}
+
+#[bench]
+fn bench_sync_pubkey_orderbook_state_delta(b: &mut Bencher) {
+    let (ctx, makers, uuids) = seeded_relay();
+    let pubkey = makers[0].pubkey.clone();
+    let trie_roots = pubkey_trie_roots(&ctx, &pubkey);
+    // Every pair trie of the maker gets one order updated since the requester synced it.
+    let mut rng = Lcg::new(SEED);
+    for uuid in &uuids[0] {
+        ordermatch_gossip::process(&ctx, &makers[0].sign(order_price_updated(*uuid, &mut rng)));
+    }
+    b.iter(|| {
+        black_box(process_request(&ctx, OrdermatchRequest::SyncPubkeyOrderbookState {
+            pubkey: pubkey.clone(),
+            trie_roots: trie_roots.clone(),
+        }))
+    });
+}
+
+#[bench]
+fn bench_best_orders_by_volume(b: &mut Bencher) {
+    let (ctx, _, _) = seeded_relay();
+    b.iter(|| {
+        black_box(process_request(&ctx, OrdermatchRequest::BestOrders {
+            coin: COINS[0].to_owned(),
+            action: BestOrdersAction::Buy,
+            volume: BigRational::from_integer(BigInt::from(50)),
+        }))
+    });
+}
+
+#[bench]
+fn bench_best_orders_by_number(b: &mut Bencher) {
+    let (ctx, _, _) = seeded_relay();
+    b.iter(|| {
+        black_box(process_request(&ctx, OrdermatchRequest::BestOrdersByNumber {
+            coin: COINS[0].to_owned(),
+            action: BestOrdersAction::Sell,
+            number: 10,
+        }))
+    });
+}
+
+#[bench]
+fn bench_get_orderbook(b: &mut Bencher) {
+    let (ctx, _, _) = seeded_relay();
+    let (base, rel) = pair(0);
+    b.iter(|| {
+        black_box(process_request(&ctx, OrdermatchRequest::GetOrderbook {
+            base: base.to_owned(),
+            rel: rel.to_owned(),
+        }))
+    });
+}
+
+/// `MAKER_ORDERS_NUMBER` maker orders over the first `pairs` pairs with the prices in the `[0.002, 10.002)` range.
+fn maker_orders(pairs: usize) -> Vec<(Uuid, MakerOrder)> {
+    let mut rng = Lcg::new(SEED);
+    (0..MAKER_ORDERS_NUMBER)
+        .map(|i| {
+            let (base, rel) = pair(i % pairs);
+            let uuid = new_uuid();
+            let order = json::from_value(json!({
+                "base": base,
+                "rel": rel,
+                "price": rng.price(),
+                "max_base_vol": rng.volume(),
+                "min_base_vol": "0.001",
+                "created_at": 0,
+                "updated_at": null,
+                "matches": {},
+                "started_swaps": [],
+                "uuid": uuid,
+                "conf_settings": null,
+            }))
+            .expect("!MakerOrder");
+            (uuid, order)
+        })
+        .collect()
+}
+
+fn taker_request(action: &str, base: &str, rel: &str) -> TakerRequest {
+    json::from_value(json!({
+        "base": base,
+        "rel": rel,
+        "base_amount": "1",
+        "rel_amount": "5",
+        "action": action,
+        "uuid": new_uuid(),
+        "sender_pubkey": "0".repeat(64),
+        "dest_pub_key": "0".repeat(64),
+        "conf_settings": null,
+    }))
+    .expect("!TakerRequest")
+}
+
+fn is_matched(order: &MakerOrder, request: &TakerRequest) -> bool {
+    matches!(order.match_with_request(request), OrderMatchResult::Matched(_))
+}
+
+fn count_matched<'a>(orders: impl Iterator<Item = &'a MakerOrder>, request: &TakerRequest) -> usize {
+    orders.filter(|order| is_matched(order, request)).count()
+}
+
+#[bench]
+fn bench_taker_buy_request_matching(b: &mut Bencher) {
+    let orders = maker_orders(1);
+    let (base, rel) = pair(0);
+    let request = taker_request("Buy", base, rel);
+    b.iter(|| black_box(count_matched(orders.iter().map(|(_, order)| order), &request)));
+}
+
+#[bench]
+fn bench_taker_sell_request_matching(b: &mut Bencher) {
+    let orders = maker_orders(1);
+    let (base, rel) = pair(0);
+    let request = taker_request("Sell", rel, base);
+    b.iter(|| black_box(count_matched(orders.iter().map(|(_, order)| order), &request)));
+}
+
+/// Matches the request against every maker order of the node, as the orders were matched before `MakerOrdersIndex`.
+#[bench]
+fn bench_taker_request_matching_all_pairs(b: &mut Bencher) {
+    let orders = maker_orders(MAKER_ORDERS_PAIRS);
+    let (base, rel) = pair(0);
+    let request = taker_request("Buy", base, rel);
+    b.iter(|| black_box(count_matched(orders.iter().map(|(_, order)| order), &request)));
+}
+
+#[bench]
+fn bench_taker_request_matching_pair_index(b: &mut Bencher) {
+    let orders: HashMap<_, _> = maker_orders(MAKER_ORDERS_PAIRS).into_iter().collect();
+    let mut index = MakerOrdersIndex::default();
+    for order in orders.values() {
+        index.insert(order);
+    }
+    let (base, rel) = pair(0);
+    let request = taker_request("Buy", base, rel);
+    b.iter(|| {
+        black_box(count_matched(
+            index.request_candidates(&request).map(|uuid| &orders[uuid]),
+            &request,
+        ))
+    });
+}
+
+fn rpc_request(method: &str, mmrpc: bool) -> Json {
+    let mut request = json!({ "userpass": RPC_PASSWORD, "method": method });
+    if mmrpc {
+        request["mmrpc"] = json!("2.0");
+    }
+    request
+}
+
+fn bench_rpc(b: &mut Bencher, request: Json) {
+    let ctx = relay_ctx();
+    let client: SocketAddr = "127.0.0.1:7783".parse().unwrap();
+    b.iter(|| {
+        black_box(block_on(process_json_request(ctx.clone(), request.clone(), client)).expect("!process_json_request"))
+    });
+}
+
+#[bench]
+fn bench_rpc_dispatcher_legacy(b: &mut Bencher) { bench_rpc(b, rpc_request("version", false)) }
+
+#[bench]
+fn bench_rpc_dispatcher_v2(b: &mut Bencher) { bench_rpc(b, rpc_request("get_enabled_coins", true)) }
+
+#[bench]
+fn bench_rpc_dispatcher_batch(b: &mut Bencher) {
+    let batch = (0..16)
+        .map(|i| rpc_request(if i % 2 == 0 { "version" } else { "get_enabled_coins" }, i % 2 == 1))
+        .collect();
+    bench_rpc(b, Json::Array(batch))
+}
@@ -0,0 +1,153 @@
+//! Synthetic maker gossip shared by the `ordermatch` benches and the `ordermatch_load_gen` load generator.
+//!
+//! The gossip is signed by deterministic maker key pairs and is processed by an in-process relay node
+//! through `lp_ordermatch::process_msg`, the same way the messages received from the network are.
+
+#![allow(dead_code)]
+
+use common::{block_on, new_uuid, now_sec};
+use crypto::privkey::key_pair_from_seed;
+use mm2_core::mm_ctx::{MmArc, MmCtxBuilder};
+use mm2_libp2p::encode_and_sign;
+use mm2_main::lp_ordermatch::new_protocol::{MakerOrderCancelled, MakerOrderCreated, MakerOrderUpdated,
+                                            OrdermatchMessage};
+use mm2_main::lp_ordermatch::{init_ordermatch_context, process_msg};
+use mm2_number::{BigInt, BigRational};
+use mm2_rpc::data::legacy::OrderConfirmationsSettings;
+use serde_json::json;
+use uuid::Uuid;
+
+pub const COINS: &[&str] = &["RICK", "MORTY", "KMD", "BTC", "LTC", "DOC", "MARTY", "ZOMBIE"];
+pub const RPC_PASSWORD: &str = "synthetic-relay-password";
+/// The peer the relay receives the gossip from. It's only used to request the missing orders on keep alive.
+const FROM_PEER: &str = "12D3KooWSyntheticMakerGossipPeer";
+
+/// A linear congruential generator, so every run replays the same gossip.
+pub struct Lcg(u64);
+
+impl Lcg {
+    pub fn new(seed: u64) -> Lcg { Lcg(seed) }
+
+    pub fn next_u64(&mut self) -> u64 {
+        self.0 = self
+            .0
+            .wrapping_mul(6_364_136_223_846_793_005)
+            .wrapping_add(1_442_695_040_888_963_407);
+        self.0 >> 32
+    }
+
+    /// Returns a price with 6 decimal places in the `[0.002, 10.002)` range.
+    pub fn price(&mut self) -> BigRational {
+        BigRational::new(
+            BigInt::from(2_000 + self.next_u64() % 10_000_000),
+            BigInt::from(1_000_000),
+        )
+    }
+
+    /// Returns an integer volume in the `[1, 100]` range.
+    pub fn volume(&mut self) -> BigRational { BigRational::from_integer(BigInt::from(1 + self.next_u64() % 100)) }
+}
+
+/// A maker signing its gossip with the key pair derived from its index.
+pub struct SyntheticMaker {
+    pub pubkey: String,
+    secret: [u8; 32],
+}
+
+impl SyntheticMaker {
+    pub fn new(index: usize) -> SyntheticMaker {
+        let key_pair = key_pair_from_seed(&format!("synthetic maker {}", index)).expect("!key_pair_from_seed");
+        SyntheticMaker {
+            pubkey: hex::encode(&**key_pair.public()),
+            secret: *key_pair.private().secret,
+        }
+    }
+
+    pub fn sign(&self, message: OrdermatchMessage) -> Vec<u8> {
+        encode_and_sign(&message, &self.secret).expect("!encode_and_sign")
+    }
+}
+
+pub fn makers(number: usize) -> Vec<SyntheticMaker> { (0..number).map(SyntheticMaker::new).collect() }
+
+/// Returns the `index`-th of the `COINS.len() * (COINS.len() - 1)` ordered pairs of distinct coins.
+pub fn pair(index: usize) -> (&'static str, &'static str) {
+    let base = index % COINS.len();
+    let rel = (base + 1 + index / COINS.len() % (COINS.len() - 1)) % COINS.len();
+    (COINS[base], COINS[rel])
+}
+
+pub fn order_created(uuid: Uuid, (base, rel): (&str, &str), rng: &mut Lcg) -> OrdermatchMessage {
+    let now = now_sec();
+    OrdermatchMessage::MakerOrderCreated(MakerOrderCreated {
+        uuid: uuid.into(),
+        base: base.to_owned(),
+        rel: rel.to_owned(),
+        price: rng.price(),
+        max_volume: rng.volume(),
+        min_volume: BigRational::new(BigInt::from(1), BigInt::from(1000)),
+        created_at: now,
+        conf_settings: OrderConfirmationsSettings::default(),
+        timestamp: now,
+        pair_trie_root: [0; 8],
+        base_protocol_info: Vec::new(),
+        rel_protocol_info: Vec::new(),
+    })
+}
+
+pub fn order_price_updated(uuid: Uuid, rng: &mut Lcg) -> OrdermatchMessage {
+    let mut updated = MakerOrderUpdated::new(uuid);
+    updated.with_new_price(rng.price());
+    updated.into()
+}
+
+/// The relay removes the order whose max volume is updated to zero, but unlike a cancelled one,
+/// the order can be created again with the same uuid.
+pub fn order_emptied(uuid: Uuid) -> OrdermatchMessage {
+    let mut updated = MakerOrderUpdated::new(uuid);
+    updated.with_new_max_volume(BigRational::from_integer(BigInt::from(0)));
+    updated.into()
+}
+
+pub fn order_cancelled(uuid: Uuid) -> OrdermatchMessage {
+    OrdermatchMessage::MakerOrderCancelled(MakerOrderCancelled {
+        uuid: uuid.into(),
+        timestamp: now_sec(),
+        pair_trie_root: [0; 8],
+    })
+}
+
+/// Creates the relay node context with the ordermatch context initialized for `COINS`.
+pub fn relay_ctx() -> MmArc {
+    let coins: Vec<_> = COINS.iter().map(|coin| json!({ "coin": coin })).collect();
+    let ctx = MmCtxBuilder::new()
+        .with_conf(json!({ "coins": coins, "rpc_password": RPC_PASSWORD }))
+        .into_mm_arc();
+    init_ordermatch_context(&ctx).expect("!init_ordermatch_context");
+    ctx
+}
+
+/// Processes the signed gossip `msg` as the relay does on receiving it from the network.
+pub fn process(ctx: &MmArc, msg: &[u8]) {
+    block_on(process_msg(ctx.clone(), FROM_PEER.to_owned(), msg, true)).expect("!process_msg")
+}
+
+/// Creates `orders_per_maker` orders of every maker on the relay, each one on its own pair if there are enough pairs.
+///
+/// Returns the uuids of the orders of every maker.
+pub fn seed_orders(ctx: &MmArc, makers: &[SyntheticMaker], orders_per_maker: usize, rng: &mut Lcg) -> Vec<Vec<Uuid>> {
+    makers
+        .iter()
+        .enumerate()
+        .map(|(maker_index, maker)| {
+            (0..orders_per_maker)
+                .map(|order_index| {
+                    let uuid = new_uuid();
+                    let msg = maker.sign(order_created(uuid, pair(maker_index + order_index), rng));
+                    process(ctx, &msg);
+                    uuid
+                })
+                .collect()
+        })
+        .collect()
+}
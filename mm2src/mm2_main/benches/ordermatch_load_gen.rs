@@ -0,0 +1,191 @@
+//! Replays the synthetic maker gossip into an in-process relay node while its orderbook is queried by the other peers,
+//! and reports the gossip and the request throughput and latencies of every phase.
+//!
+//! Every round the makers create their orders, update their prices and cancel them, each phase being replayed
+//! by `--threads` threads concurrently, as the relay processes the messages received from the network.
+//!
+//! Run with `cargo bench -p mm2_main --bench ordermatch_load_gen -- --makers 200 --orders 20 --rounds 3 --threads 4`,
+//! all the options being optional with these defaults.
+
+mod ordermatch_gossip;
+
+use common::new_uuid;
+use mm2_core::mm_ctx::MmArc;
+use mm2_libp2p::application::request_response::ordermatch::{BestOrdersAction, OrdermatchRequest};
+use mm2_main::lp_ordermatch::new_protocol::OrdermatchMessage;
+use mm2_main::lp_ordermatch::process_peer_request;
+use mm2_metrics::metrics::HistogramFn;
+use mm2_metrics::recorder::ShardedHistogram;
+use mm2_number::{BigInt, BigRational};
+use ordermatch_gossip::{makers, order_cancelled, order_created, order_price_updated, pair, relay_ctx, Lcg,
+                        SyntheticMaker, COINS};
+use std::env;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::thread;
+use std::time::{Duration, Instant};
+use uuid::Uuid;
+
+const SEED: u64 = 0x2545_f491_4f6c_dd1d;
+
+struct Options {
+    makers: usize,
+    orders_per_maker: usize,
+    rounds: usize,
+    threads: usize,
+}
+
+impl Options {
+    /// Parses the options skipping the `--bench` flag cargo passes to the bench targets.
+    fn from_args() -> Options {
+        let mut options = Options {
+            makers: 200,
+            orders_per_maker: 20,
+            rounds: 3,
+            threads: 4,
+        };
+        let mut args = env::args().skip(1);
+        while let Some(arg) = args.next() {
+            let option = match arg.as_str() {
+                "--makers" => &mut options.makers,
+                "--orders" => &mut options.orders_per_maker,
+                "--rounds" => &mut options.rounds,
+                "--threads" => &mut options.threads,
+                _ => continue,
+            };
+            *option = args
+                .next()
+                .and_then(|value| value.parse().ok())
+                .unwrap_or_else(|| panic!("{} expects a number", arg));
+        }
+        options.threads = options.threads.max(1);
+        options
+    }
+}
+
+/// Processes the signed gossip `messages` by `threads` threads, while the peer requests are served
+/// from the same orderbook by another thread, and prints the throughput and latencies of both.
+fn replay_phase(ctx: &MmArc, phase: &str, messages: Vec<Vec<u8>>, threads: usize) {
+    let gossip_latencies = ShardedHistogram::default();
+    let request_latencies = ShardedHistogram::default();
+    let gossip_done = AtomicBool::new(false);
+    let chunk_size = (messages.len() + threads - 1) / threads;
+    let started_at = Instant::now();
+
+    thread::scope(|scope| {
+        scope.spawn(|| {
+            let mut rng = Lcg::new(SEED);
+            while !gossip_done.load(Ordering::Relaxed) {
+                let coin = COINS[rng.next_u64() as usize % COINS.len()].to_owned();
+                let (base, rel) = pair(rng.next_u64() as usize);
+                let request = match rng.next_u64() % 3 {
+                    0 => OrdermatchRequest::BestOrders {
+                        coin,
+                        action: BestOrdersAction::Buy,
+                        volume: BigRational::from_integer(BigInt::from(10)),
+                    },
+                    1 => OrdermatchRequest::BestOrdersByNumber {
+                        coin,
+                        action: BestOrdersAction::Sell,
+                        number: 10,
+                    },
+                    _ => OrdermatchRequest::GetOrderbook {
+                        base: base.to_owned(),
+                        rel: rel.to_owned(),
+                    },
+                };
+                let request_started_at = Instant::now();
+                process_peer_request(ctx.clone(), request).expect("!process_peer_request");
+                request_latencies.record(request_started_at.elapsed().as_secs_f64());
+            }
+        });
+
+        let gossip_latencies = &gossip_latencies;
+        let replayers: Vec<_> = messages
+            .chunks(chunk_size.max(1))
+            .map(|chunk| {
+                scope.spawn(move || {
+                    for msg in chunk {
+                        let msg_started_at = Instant::now();
+                        ordermatch_gossip::process(ctx, msg);
+                        gossip_latencies.record(msg_started_at.elapsed().as_secs_f64());
+                    }
+                })
+            })
+            .collect();
+        for replayer in replayers {
+            replayer.join().expect("!replayer");
+        }
+        gossip_done.store(true, Ordering::Relaxed);
+    });
+
+    let elapsed = started_at.elapsed();
+    report(phase, "gossip", &gossip_latencies, elapsed);
+    report(phase, "requests", &request_latencies, elapsed);
+}
+
+fn report(phase: &str, kind: &str, latencies: &ShardedHistogram, elapsed: Duration) {
+    let snapshot = latencies.snapshot();
+    let micros = |q: f64| snapshot.quantile(q).unwrap_or_default() * 1_000_000.;
+    println!(
+        "{:<9} {:<8} {:>8} in {:>8.3}s {:>10.0}/s  p50 {:>8.1}us  p99 {:>8.1}us  max {:>8.1}us",
+        phase,
+        kind,
+        snapshot.count,
+        elapsed.as_secs_f64(),
+        snapshot.count as f64 / elapsed.as_secs_f64(),
+        micros(0.5),
+        micros(0.99),
+        micros(1.),
+    );
+}
+
+/// Signs the created orders of every maker, each order getting a fresh uuid since the cancelled ones are ignored.
+fn sign_created(makers: &[SyntheticMaker], orders_per_maker: usize, rng: &mut Lcg) -> (Vec<Vec<Uuid>>, Vec<Vec<u8>>) {
+    let mut uuids = Vec::with_capacity(makers.len());
+    let mut messages = Vec::with_capacity(makers.len() * orders_per_maker);
+    for (maker_index, maker) in makers.iter().enumerate() {
+        let maker_uuids: Vec<_> = (0..orders_per_maker).map(|_| new_uuid()).collect();
+        for (order_index, uuid) in maker_uuids.iter().enumerate() {
+            messages.push(maker.sign(order_created(*uuid, pair(maker_index + order_index), rng)));
+        }
+        uuids.push(maker_uuids);
+    }
+    (uuids, messages)
+}
+
+fn sign_for_each_order(
+    makers: &[SyntheticMaker],
+    uuids: &[Vec<Uuid>],
+    mut message: impl FnMut(Uuid) -> OrdermatchMessage,
+) -> Vec<Vec<u8>> {
+    let mut messages = Vec::with_capacity(uuids.iter().map(Vec::len).sum());
+    for (maker, maker_uuids) in makers.iter().zip(uuids) {
+        for uuid in maker_uuids {
+            messages.push(maker.sign(message(*uuid)));
+        }
+    }
+    messages
+}
+
+fn main() {
+    let options = Options::from_args();
+    println!(
+        "Replaying the gossip of {} makers with {} orders each in {} rounds by {} threads",
+        options.makers, options.orders_per_maker, options.rounds, options.threads
+    );
+
+    let ctx = relay_ctx();
+    let makers = makers(options.makers);
+    let mut rng = Lcg::new(SEED);
+    for round in 0..options.rounds {
+        println!("Round {}", round);
+        // All the messages are signed in advance to measure only the relay.
+        let (uuids, created) = sign_created(&makers, options.orders_per_maker, &mut rng);
+        let updated = sign_for_each_order(&makers, &uuids, |uuid| order_price_updated(uuid, &mut rng));
+        let cancelled = sign_for_each_order(&makers, &uuids, order_cancelled);
+
+        replay_phase(&ctx, "created", created, options.threads);
+        replay_phase(&ctx, "updated", updated, options.threads);
+        replay_phase(&ctx, "cancelled", cancelled, options.threads);
+    }
+}
@@ -2,6 +2,8 @@
 ///
 pub mod my_orders;
 pub mod my_swaps;
+pub mod saved_orders;
+pub mod saved_swaps;
 pub mod stats_nodes;
 pub mod stats_swaps;
 
@@ -12,6 +14,8 @@ use db_common::sqlite::rusqlite::{params_from_iter, Result as SqlResult};
 use mm2_core::mm_ctx::MmArc;
 
 use my_swaps::{fill_my_swaps_from_json_statements, set_is_finished_for_legacy_swaps_statements};
+use saved_orders::fill_saved_orders_from_json_statements;
+use saved_swaps::fill_saved_swaps_from_json_statements;
 use stats_swaps::create_and_fill_stats_swaps_from_json_statements;
 
 const SELECT_MIGRATION: &str = "SELECT * FROM migration ORDER BY current_migration DESC LIMIT 1;";
@@ -126,6 +130,20 @@ fn migration_13() -> Vec<(&'static str, Vec<String>)> {
     ]
 }
 
+/// Moves the saved swaps and orders from the JSON files to the SQLite tables.
+/// The JSON files are left as they are, so they can still be read by the older versions.
+async fn migration_14(ctx: &MmArc) -> Vec<(&'static str, Vec<String>)> {
+    let mut statements = vec![
+        (saved_swaps::CREATE_SAVED_SWAPS_TABLE, vec![]),
+        (saved_swaps::CREATE_SAVED_SWAP_EVENTS_TABLE, vec![]),
+        (saved_orders::CREATE_MY_ACTIVE_ORDERS_TABLE, vec![]),
+        (saved_orders::CREATE_MY_HISTORY_ORDERS_TABLE, vec![]),
+    ];
+    statements.extend(fill_saved_swaps_from_json_statements(ctx).await);
+    statements.extend(fill_saved_orders_from_json_statements(ctx).await);
+    statements
+}
+
 async fn statements_for_migration(ctx: &MmArc, current_migration: i64) -> Option<Vec<(&'static str, Vec<String>)>> {
     match current_migration {
         1 => Some(migration_1(ctx).await),
@@ -141,6 +159,7 @@ async fn statements_for_migration(ctx: &MmArc, current_migration: i64) -> Option
         11 => Some(migration_11()),
         12 => Some(migration_12()),
         13 => Some(migration_13()),
+        14 => Some(migration_14(ctx).await),
         _ => None,
     }
 }
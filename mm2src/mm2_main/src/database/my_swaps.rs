@@ -1,7 +1,7 @@
 #![allow(deprecated)] // TODO: remove this once rusqlite is >= 0.29
 
 /// This module contains code to work with my_swaps table in MM2 SQLite DB
-use crate::lp_swap::{MyRecentSwapsUuids, MySwapsFilter, SavedSwap, SavedSwapIo};
+use crate::lp_swap::{MyRecentSwapsUuids, MySwapsFilter, SavedSwap};
 use common::log::debug;
 use common::PagingOptions;
 use db_common::sqlite::rusqlite::{Connection, Error as SqlError, Result as SqlResult, ToSql};
@@ -135,7 +135,9 @@ pub fn insert_new_swap_v2(ctx: &MmArc, params: &[(&str, &dyn ToSql)]) -> SqlResu
 /// Returns SQL statements to initially fill my_swaps table using existing DB with JSON files
 /// Use this only in migration code!
 pub async fn fill_my_swaps_from_json_statements(ctx: &MmArc) -> Vec<(&'static str, Vec<String>)> {
-    let swaps = SavedSwap::load_all_my_swaps_from_db(ctx).await.unwrap_or_default();
+    let swaps = SavedSwap::load_all_my_swaps_from_json_files(ctx)
+        .await
+        .unwrap_or_default();
     swaps
         .into_iter()
         .filter_map(insert_saved_swap_sql_migration_1)
@@ -354,7 +356,9 @@ WHERE uuid = :uuid;
 
 /// Returns SQL statements to set is_finished to 1 for completed legacy swaps
 pub async fn set_is_finished_for_legacy_swaps_statements(ctx: &MmArc) -> Vec<(&'static str, Vec<String>)> {
-    let swaps = SavedSwap::load_all_my_swaps_from_db(ctx).await.unwrap_or_default();
+    let swaps = SavedSwap::load_all_my_swaps_from_json_files(ctx)
+        .await
+        .unwrap_or_default();
     swaps
         .into_iter()
         .filter_map(|swap| {
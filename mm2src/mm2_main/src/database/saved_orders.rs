@@ -0,0 +1,168 @@
+/// This module contains code to work with my_active_orders and my_history_orders tables in MM2 SQLite DB
+///
+/// The tables keep the serialized orders by their uuid, so the active maker or taker orders are loaded in one query
+/// on start, and the historical orders are loaded one by one on request.
+use crate::lp_ordermatch::{my_maker_orders_dir, my_orders_history_dir, my_taker_orders_dir, MakerOrder, Order,
+                           TakerOrder};
+use common::log::{debug, error};
+use db_common::sqlite::query_single_row;
+use db_common::sqlite::rusqlite::{params, Connection, Result as SqlResult};
+use mm2_core::mm_ctx::MmArc;
+use mm2_io::fs::read_dir_json;
+use serde::de::DeserializeOwned;
+use serde::Serialize;
+use serde_json as json;
+use std::path::Path;
+use uuid::Uuid;
+
+pub const MAKER_ORDER_TYPE: &str = "Maker";
+pub const TAKER_ORDER_TYPE: &str = "Taker";
+
+pub const CREATE_MY_ACTIVE_ORDERS_TABLE: &str = "CREATE TABLE IF NOT EXISTS my_active_orders (
+    uuid VARCHAR(255) NOT NULL PRIMARY KEY,
+    type VARCHAR(255) NOT NULL,
+    order_json TEXT NOT NULL
+);";
+
+pub const CREATE_MY_HISTORY_ORDERS_TABLE: &str = "CREATE TABLE IF NOT EXISTS my_history_orders (
+    uuid VARCHAR(255) NOT NULL PRIMARY KEY,
+    order_json TEXT NOT NULL
+);";
+
+const INSERT_ACTIVE_ORDER: &str =
+    "INSERT OR REPLACE INTO my_active_orders (uuid, type, order_json) VALUES (?1, ?2, ?3);";
+
+const DELETE_ACTIVE_ORDER: &str = "DELETE FROM my_active_orders WHERE uuid = ?1 AND type = ?2;";
+
+const SELECT_ACTIVE_ORDERS: &str = "SELECT order_json FROM my_active_orders WHERE type = ?1;";
+
+const SELECT_ACTIVE_ORDER: &str = "SELECT order_json FROM my_active_orders WHERE uuid = ?1 AND type = ?2;";
+
+const INSERT_HISTORY_ORDER: &str = "INSERT OR REPLACE INTO my_history_orders (uuid, order_json) VALUES (?1, ?2);";
+
+const SELECT_HISTORY_ORDER: &str = "SELECT order_json FROM my_history_orders WHERE uuid = ?1;";
+
+pub fn save_active_order(conn: &Connection, uuid: &Uuid, order_type: &str, order_json: &str) -> SqlResult<()> {
+    conn.prepare_cached(INSERT_ACTIVE_ORDER)?
+        .execute(params![uuid.to_string(), order_type, order_json])
+        .map(|_| ())
+}
+
+pub fn delete_active_order(conn: &Connection, uuid: &Uuid, order_type: &str) -> SqlResult<()> {
+    conn.prepare_cached(DELETE_ACTIVE_ORDER)?
+        .execute(params![uuid.to_string(), order_type])
+        .map(|_| ())
+}
+
+pub fn select_active_orders(conn: &Connection, order_type: &str) -> SqlResult<Vec<String>> {
+    let mut stmt = conn.prepare_cached(SELECT_ACTIVE_ORDERS)?;
+    let orders = stmt.query_map([order_type], |row| row.get(0))?;
+    orders.collect()
+}
+
+pub fn select_active_order(conn: &Connection, uuid: &Uuid, order_type: &str) -> SqlResult<Option<String>> {
+    query_single_row(
+        conn,
+        SELECT_ACTIVE_ORDER,
+        params![uuid.to_string(), order_type],
+        |row| row.get(0),
+    )
+}
+
+pub fn save_history_order(conn: &Connection, uuid: &Uuid, order_json: &str) -> SqlResult<()> {
+    conn.prepare_cached(INSERT_HISTORY_ORDER)?
+        .execute(params![uuid.to_string(), order_json])
+        .map(|_| ())
+}
+
+pub fn select_history_order(conn: &Connection, uuid: &Uuid) -> SqlResult<Option<String>> {
+    query_single_row(conn, SELECT_HISTORY_ORDER, [uuid.to_string()], |row| row.get(0))
+}
+
+/// Returns the `(uuid, serialized order)` pairs of the orders saved to the JSON files of the `dir`.
+async fn read_orders_dir<T, F>(dir: &Path, uuid: F) -> Vec<(String, String)>
+where
+    T: DeserializeOwned + Serialize,
+    F: Fn(&T) -> Uuid,
+{
+    let orders: Vec<T> = read_dir_json(dir).await.unwrap_or_else(|e| {
+        error!("Error {} on loading the orders JSON files from {}", e, dir.display());
+        Vec::new()
+    });
+    orders
+        .iter()
+        .filter_map(|order| match json::to_string(order) {
+            Ok(order_json) => Some((uuid(order).to_string(), order_json)),
+            Err(e) => {
+                error!("Error {} on serializing the order {}", e, uuid(order));
+                None
+            },
+        })
+        .collect()
+}
+
+/// Returns SQL statements to fill my_active_orders and my_history_orders tables using the existing orders JSON files.
+/// Use this only in migration code!
+pub async fn fill_saved_orders_from_json_statements(ctx: &MmArc) -> Vec<(&'static str, Vec<String>)> {
+    let maker_orders = read_orders_dir(&my_maker_orders_dir(ctx), |order: &MakerOrder| order.uuid).await;
+    let taker_orders = read_orders_dir(&my_taker_orders_dir(ctx), |order: &TakerOrder| order.request.uuid).await;
+    let history_orders = read_orders_dir(&my_orders_history_dir(ctx), Order::uuid).await;
+    debug!(
+        "Moving {} maker, {} taker and {} historical orders from the JSON files to the SQLite database",
+        maker_orders.len(),
+        taker_orders.len(),
+        history_orders.len()
+    );
+
+    let active_orders = maker_orders
+        .into_iter()
+        .map(|(uuid, order_json)| (uuid, MAKER_ORDER_TYPE, order_json))
+        .chain(
+            taker_orders
+                .into_iter()
+                .map(|(uuid, order_json)| (uuid, TAKER_ORDER_TYPE, order_json)),
+        )
+        .map(|(uuid, order_type, order_json)| (INSERT_ACTIVE_ORDER, vec![uuid, order_type.to_owned(), order_json]));
+    let history_orders = history_orders
+        .into_iter()
+        .map(|(uuid, order_json)| (INSERT_HISTORY_ORDER, vec![uuid, order_json]));
+    active_orders.chain(history_orders).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::new_uuid;
+
+    #[test]
+    fn test_saved_orders() {
+        let conn = Connection::open_in_memory().unwrap();
+        conn.execute_batch(CREATE_MY_ACTIVE_ORDERS_TABLE).unwrap();
+        conn.execute_batch(CREATE_MY_HISTORY_ORDERS_TABLE).unwrap();
+        let maker_uuid = new_uuid();
+        let taker_uuid = new_uuid();
+
+        save_active_order(&conn, &maker_uuid, MAKER_ORDER_TYPE, "{\"maker\":1}").unwrap();
+        save_active_order(&conn, &taker_uuid, TAKER_ORDER_TYPE, "{\"taker\":1}").unwrap();
+        // an update
+        save_active_order(&conn, &maker_uuid, MAKER_ORDER_TYPE, "{\"maker\":2}").unwrap();
+        assert_eq!(select_active_orders(&conn, MAKER_ORDER_TYPE).unwrap(), vec![
+            "{\"maker\":2}".to_owned()
+        ]);
+        assert_eq!(select_active_orders(&conn, TAKER_ORDER_TYPE).unwrap(), vec![
+            "{\"taker\":1}".to_owned()
+        ]);
+        assert_eq!(select_active_order(&conn, &maker_uuid, TAKER_ORDER_TYPE).unwrap(), None);
+
+        delete_active_order(&conn, &maker_uuid, MAKER_ORDER_TYPE).unwrap();
+        assert_eq!(select_active_order(&conn, &maker_uuid, MAKER_ORDER_TYPE).unwrap(), None);
+        assert!(select_active_orders(&conn, MAKER_ORDER_TYPE).unwrap().is_empty());
+
+        save_history_order(&conn, &maker_uuid, "{\"maker\":2}").unwrap();
+        assert_eq!(
+            select_history_order(&conn, &maker_uuid).unwrap().as_deref(),
+            Some("{\"maker\":2}")
+        );
+        assert_eq!(select_history_order(&conn, &taker_uuid).unwrap(), None);
+    }
+}
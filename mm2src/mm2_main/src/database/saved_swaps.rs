@@ -0,0 +1,274 @@
+/// This module contains code to work with saved_swaps and saved_swap_events tables in MM2 SQLite DB
+///
+/// A saved legacy swap is stored without its events, and every event is stored in its own row.
+/// A running swap is saved on every new event, so only the new events are appended instead of rewriting the whole swap,
+/// and the event bodies are only read for the swaps requested by uuid.
+use crate::lp_swap::SavedSwap;
+use common::log::{debug, error};
+use db_common::sqlite::query_single_row;
+use db_common::sqlite::rusqlite::{params, Connection, Result as SqlResult};
+use mm2_core::mm_ctx::MmArc;
+use serde_json::{self as json, Value as Json};
+use std::collections::HashMap;
+use uuid::Uuid;
+
+pub const CREATE_SAVED_SWAPS_TABLE: &str = "CREATE TABLE IF NOT EXISTS saved_swaps (
+    uuid VARCHAR(255) NOT NULL PRIMARY KEY,
+    swap_json TEXT NOT NULL,
+    events_count INTEGER NOT NULL
+);";
+
+pub const CREATE_SAVED_SWAP_EVENTS_TABLE: &str = "CREATE TABLE IF NOT EXISTS saved_swap_events (
+    uuid VARCHAR(255) NOT NULL,
+    event_index INTEGER NOT NULL,
+    event_json TEXT NOT NULL,
+    PRIMARY KEY (uuid, event_index)
+);";
+
+const INSERT_SAVED_SWAP: &str =
+    "INSERT OR REPLACE INTO saved_swaps (uuid, swap_json, events_count) VALUES (?1, ?2, ?3);";
+
+const INSERT_SAVED_SWAP_EVENT: &str =
+    "INSERT OR REPLACE INTO saved_swap_events (uuid, event_index, event_json) VALUES (?1, ?2, ?3);";
+
+const DELETE_SAVED_SWAP_EVENTS: &str = "DELETE FROM saved_swap_events WHERE uuid = ?1;";
+
+/// Selects the number of the stored events of the swap and the last of them.
+const SELECT_SAVED_SWAP_LAST_EVENT: &str = "SELECT saved_swaps.events_count, saved_swap_events.event_json
+    FROM saved_swaps LEFT JOIN saved_swap_events
+    ON saved_swap_events.uuid = saved_swaps.uuid AND saved_swap_events.event_index = saved_swaps.events_count - 1
+    WHERE saved_swaps.uuid = ?1;";
+
+const SELECT_SAVED_SWAP: &str = "SELECT swap_json FROM saved_swaps WHERE uuid = ?1;";
+
+const SELECT_SAVED_SWAP_EVENTS: &str = "SELECT event_json FROM saved_swap_events WHERE uuid = ?1 ORDER BY event_index;";
+
+const SELECT_ALL_SAVED_SWAPS: &str = "SELECT uuid, swap_json FROM saved_swaps;";
+
+const SELECT_ALL_SAVED_SWAP_EVENTS: &str = "SELECT uuid, event_json FROM saved_swap_events ORDER BY uuid, event_index;";
+
+/// Splits the serialized saved swap into the swap without its events and the serialized events.
+pub fn split_swap_events(mut swap: Json) -> (String, Vec<String>) {
+    let events = match swap.as_object_mut().and_then(|fields| fields.remove("events")) {
+        Some(Json::Array(events)) => events.iter().map(Json::to_string).collect(),
+        _ => Vec::new(),
+    };
+    (swap.to_string(), events)
+}
+
+/// Joins the swap stored without its events and the stored `events` back into the serialized saved swap.
+fn join_swap_events(swap_json: &str, events: &[String]) -> String {
+    // The swap is a serialized object, so the events are added as its last field.
+    let fields = swap_json.trim_end().strip_suffix('}').unwrap_or(swap_json).trim_end();
+    let separator = if fields.ends_with('{') { "" } else { "," };
+    format!("{}{}\"events\":[{}]}}", fields, separator, events.join(","))
+}
+
+/// Saves the swap and appends its events that aren't stored yet.
+///
+/// The events of a swap are only appended while it's running, so the stored events are checked by their number
+/// and the last of them only, and the events after them are written.
+/// If the swap has fewer events or its event at the last stored index differs, e.g. another copy of the swap
+/// is imported, all the stored events are replaced.
+pub fn save_saved_swap(conn: &Connection, uuid: &Uuid, swap_json: &str, events: &[String]) -> SqlResult<()> {
+    let uuid = uuid.to_string();
+    let transaction = conn.unchecked_transaction()?;
+
+    let last_stored_event = query_single_row(&transaction, SELECT_SAVED_SWAP_LAST_EVENT, [&uuid], |row| {
+        Ok((row.get::<_, i64>(0)? as usize, row.get::<_, Option<String>>(1)?))
+    })?;
+    let first_new_event = match last_stored_event {
+        None | Some((0, _)) => 0,
+        Some((stored_count, Some(last_event)))
+            if stored_count <= events.len() && events[stored_count - 1] == last_event =>
+        {
+            stored_count
+        },
+        Some(_) => {
+            transaction.prepare_cached(DELETE_SAVED_SWAP_EVENTS)?.execute([&uuid])?;
+            0
+        },
+    };
+
+    transaction
+        .prepare_cached(INSERT_SAVED_SWAP)?
+        .execute(params![uuid, swap_json, events.len() as i64])?;
+    {
+        let mut insert_event = transaction.prepare_cached(INSERT_SAVED_SWAP_EVENT)?;
+        for (index, event) in events.iter().enumerate().skip(first_new_event) {
+            insert_event.execute(params![uuid, index as i64, event])?;
+        }
+    }
+    transaction.commit()
+}
+
+/// Loads the serialized saved swap with its events.
+pub fn load_saved_swap(conn: &Connection, uuid: &Uuid) -> SqlResult<Option<String>> {
+    let uuid = uuid.to_string();
+    let swap_json = match query_single_row(conn, SELECT_SAVED_SWAP, [&uuid], |row| row.get::<_, String>(0))? {
+        Some(swap_json) => swap_json,
+        None => return Ok(None),
+    };
+
+    let events = select_saved_swap_events(conn, &uuid)?;
+    Ok(Some(join_swap_events(&swap_json, &events)))
+}
+
+/// Loads all the serialized saved swaps with their events.
+pub fn load_all_saved_swaps(conn: &Connection) -> SqlResult<Vec<String>> {
+    let mut events: HashMap<String, Vec<String>> = HashMap::new();
+    {
+        let mut stmt = conn.prepare(SELECT_ALL_SAVED_SWAP_EVENTS)?;
+        let rows = stmt.query_map([], |row| Ok((row.get::<_, String>(0)?, row.get::<_, String>(1)?)))?;
+        for row in rows {
+            let (uuid, event) = row?;
+            events.entry(uuid).or_default().push(event);
+        }
+    }
+
+    let mut stmt = conn.prepare(SELECT_ALL_SAVED_SWAPS)?;
+    let swaps = stmt
+        .query_map([], |row| Ok((row.get::<_, String>(0)?, row.get::<_, String>(1)?)))?
+        .map(|row| {
+            let (uuid, swap_json) = row?;
+            let events = events.remove(&uuid).unwrap_or_default();
+            Ok(join_swap_events(&swap_json, &events))
+        })
+        .collect::<SqlResult<Vec<_>>>()?;
+    Ok(swaps)
+}
+
+fn select_saved_swap_events(conn: &Connection, uuid: &str) -> SqlResult<Vec<String>> {
+    let mut stmt = conn.prepare_cached(SELECT_SAVED_SWAP_EVENTS)?;
+    let events = stmt
+        .query_map([uuid], |row| row.get::<_, String>(0))?
+        .collect::<SqlResult<Vec<_>>>()?;
+    Ok(events)
+}
+
+/// Returns SQL statements to fill saved_swaps and saved_swap_events tables using the existing swaps JSON files.
+/// Use this only in migration code!
+pub async fn fill_saved_swaps_from_json_statements(ctx: &MmArc) -> Vec<(&'static str, Vec<String>)> {
+    let swaps = SavedSwap::load_all_my_swaps_from_json_files(ctx)
+        .await
+        .unwrap_or_else(|e| {
+            error!("Error {} on loading the swaps JSON files", e);
+            Vec::new()
+        });
+    debug!(
+        "Moving {} swaps from the JSON files to the SQLite database",
+        swaps.len()
+    );
+
+    let mut statements = Vec::new();
+    for swap in swaps {
+        let uuid = swap.uuid().to_string();
+        let swap = match json::to_value(&swap) {
+            Ok(swap) => swap,
+            Err(e) => {
+                error!("Error {} on serializing the swap {}", e, uuid);
+                continue;
+            },
+        };
+        let (swap_json, events) = split_swap_events(swap);
+        statements.push((INSERT_SAVED_SWAP, vec![
+            uuid.clone(),
+            swap_json,
+            events.len().to_string(),
+        ]));
+        statements.extend(
+            events
+                .into_iter()
+                .enumerate()
+                .map(|(index, event)| (INSERT_SAVED_SWAP_EVENT, vec![uuid.clone(), index.to_string(), event])),
+        );
+    }
+    statements
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::new_uuid;
+
+    #[test]
+    fn test_save_and_load_saved_swap() {
+        let conn = Connection::open_in_memory().unwrap();
+        conn.execute_batch(CREATE_SAVED_SWAPS_TABLE).unwrap();
+        conn.execute_batch(CREATE_SAVED_SWAP_EVENTS_TABLE).unwrap();
+        let uuid = new_uuid();
+        assert_eq!(load_saved_swap(&conn, &uuid).unwrap(), None);
+
+        let swap = json!({"type": "Maker", "uuid": uuid, "events": [{"event": "Started"}], "maker_coin": "RICK"});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        assert_eq!(events.len(), 1);
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        let actual: Json = json::from_str(&load_saved_swap(&conn, &uuid).unwrap().unwrap()).unwrap();
+        assert_eq!(actual, swap);
+
+        // a new event is appended
+        let swap = json!({"type": "Maker", "uuid": uuid, "events": [{"event": "Started"}, {"event": "Negotiated"}]});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        let actual: Json = json::from_str(&load_saved_swap(&conn, &uuid).unwrap().unwrap()).unwrap();
+        assert_eq!(actual, swap);
+
+        // the same swap saved again doesn't change the events
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        assert_eq!(select_saved_swap_events(&conn, &uuid.to_string()).unwrap(), events);
+
+        // a copy with as many but different events replaces them
+        let swap = json!({"type": "Maker", "uuid": uuid, "events": [{"event": "Started"}, {"event": "Imported"}]});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        let actual: Json = json::from_str(&load_saved_swap(&conn, &uuid).unwrap().unwrap()).unwrap();
+        assert_eq!(actual, swap);
+
+        // an older copy replaces all the events
+        let swap = json!({"type": "Maker", "uuid": uuid, "events": [{"event": "Imported"}]});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        let actual: Json = json::from_str(&load_saved_swap(&conn, &uuid).unwrap().unwrap()).unwrap();
+        assert_eq!(actual, swap);
+        assert_eq!(select_saved_swap_events(&conn, &uuid.to_string()).unwrap(), events);
+
+        // a copy with more events and a different last stored one replaces them
+        let swap = json!({"type": "Maker", "uuid": uuid, "events": [{"event": "Started"}, {"event": "Negotiated"}]});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+        assert_eq!(select_saved_swap_events(&conn, &uuid.to_string()).unwrap(), events);
+
+        let swap = json!({"events": []});
+        let (swap_json, events) = split_swap_events(swap.clone());
+        let actual: Json = json::from_str(&join_swap_events(&swap_json, &events)).unwrap();
+        assert_eq!(actual, swap);
+    }
+
+    #[test]
+    fn test_load_all_saved_swaps() {
+        let conn = Connection::open_in_memory().unwrap();
+        conn.execute_batch(CREATE_SAVED_SWAPS_TABLE).unwrap();
+        conn.execute_batch(CREATE_SAVED_SWAP_EVENTS_TABLE).unwrap();
+        assert!(load_all_saved_swaps(&conn).unwrap().is_empty());
+
+        let mut expected = Vec::new();
+        for events_number in 0..3 {
+            let uuid = new_uuid();
+            let events: Vec<_> = (0..events_number).map(|index| json!({ "event": index })).collect();
+            let swap = json!({"type": "Taker", "uuid": uuid, "events": events});
+            let (swap_json, events) = split_swap_events(swap.clone());
+            save_saved_swap(&conn, &uuid, &swap_json, &events).unwrap();
+            expected.push(swap);
+        }
+
+        let mut actual: Vec<Json> = load_all_saved_swaps(&conn)
+            .unwrap()
+            .iter()
+            .map(|swap_json| json::from_str(swap_json).unwrap())
+            .collect();
+        let uuid = |swap: &Json| swap["uuid"].as_str().unwrap().to_owned();
+        actual.sort_by_key(uuid);
+        expected.sort_by_key(uuid);
+        assert_eq!(actual, expected);
+    }
+}
@@ -324,16 +324,19 @@ fn insert_stats_taker_swap_sql_init(swap: &TakerSavedSwap) -> Option<(&'static s
 
 fn execute_query_with_params(conn: &Connection, sql: &str, params: OwnedSqlNamedParams) {
     debug!("Executing query {} with params {:?}", sql, params);
-    if let Err(e) = conn.execute_named(sql, &params.as_sql_named_params()) {
+    let result = conn
+        .prepare_cached(sql)
+        .and_then(|mut stmt| stmt.execute_named(&params.as_sql_named_params()));
+    if let Err(e) = result {
         error!("Error {} on query {} with params {:?}", e, sql, params);
     };
 }
 
 pub fn add_swap_to_index(conn: &Connection, swap: &SavedSwap) {
     let params = vec![swap.uuid().to_string()];
-    let query_row = conn.query_row(SELECT_ID_BY_UUID, params_from_iter(params.iter()), |row| {
-        row.get::<_, i64>(0)
-    });
+    let query_row = conn
+        .prepare_cached(SELECT_ID_BY_UUID)
+        .and_then(|mut stmt| stmt.query_row(params_from_iter(params.iter()), |row| row.get::<_, i64>(0)));
     match query_row.optional() {
         // swap is not indexed yet, insert it into the DB
         Ok(None) => {
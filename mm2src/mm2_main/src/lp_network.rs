@@ -35,11 +35,21 @@ use mm2_libp2p::{decode_message, encode_message, DecodingError, GossipsubEvent,
                  Libp2pSecpPublic, MessageId, NetworkPorts, PeerId, TOPIC_SEPARATOR};
 use mm2_libp2p::{AdexBehaviourCmd, AdexBehaviourEvent, AdexEventRx, AdexResponse};
 use mm2_libp2p::{PeerAddresses, RequestResponseBehaviourEvent};
-use mm2_metrics::{mm_label, mm_timing};
+use mm2_metrics::{mm_counter, mm_gauge, mm_label, mm_timing};
 use serde::de;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
 
 use crate::{lp_healthcheck, lp_ordermatch, lp_stats, lp_swap};
 
+/// The maximum number of orderbook gossip messages being processed at the same time.
+/// The orderbook messages received above this limit are dropped instead of piling up as pending tasks during bursts,
+/// the makers rebroadcast their orderbook state with every keep alive anyway.
+const MAX_PENDING_ORDERBOOK_MESSAGES: usize = 1000;
+/// The prefix the queue depth of the gossip messages with an unknown topic is reported by.
+const OTHER_TOPICS: &str = "other";
+
 pub type P2PRequestResult<T> = Result<T, MmError<P2PRequestError>>;
 pub type P2PProcessResult<T> = Result<T, MmError<P2PProcessError>>;
 
@@ -88,7 +98,22 @@ impl From<rmp_serde::decode::Error> for P2PRequestError {
     fn from(e: rmp_serde::decode::Error) -> Self { P2PRequestError::DecodeError(e.to_string()) }
 }
 
+/// Returns the known prefix of the gossip `topic` to account its messages by.
+fn gossip_topic_prefix(topic: &str) -> &'static str {
+    match topic.split(TOPIC_SEPARATOR).next() {
+        Some(lp_ordermatch::ORDERBOOK_PREFIX) => lp_ordermatch::ORDERBOOK_PREFIX,
+        Some(lp_swap::SWAP_PREFIX) => lp_swap::SWAP_PREFIX,
+        Some(lp_swap::SWAP_V2_PREFIX) => lp_swap::SWAP_V2_PREFIX,
+        Some(lp_swap::WATCHER_PREFIX) => lp_swap::WATCHER_PREFIX,
+        Some(lp_swap::TX_HELPER_PREFIX) => lp_swap::TX_HELPER_PREFIX,
+        Some(lp_healthcheck::PEER_HEALTHCHECK_PREFIX) => lp_healthcheck::PEER_HEALTHCHECK_PREFIX,
+        _ => OTHER_TOPICS,
+    }
+}
+
 pub async fn p2p_event_process_loop(ctx: MmWeak, mut rx: AdexEventRx, i_am_relay: bool) {
+    // The number of gossip messages being processed by topic prefix.
+    let mut queue_depths: HashMap<&'static str, Arc<AtomicUsize>> = HashMap::new();
     loop {
         let adex_event = rx.next().await;
         let ctx = match MmArc::from_weak(&ctx) {
@@ -102,14 +127,23 @@ pub async fn p2p_event_process_loop(ctx: MmWeak, mut rx: AdexEventRx, i_am_relay
                     message_id,
                     message,
                 } => {
+                    let prefix = gossip_topic_prefix(message.topic.as_str());
+                    let queue_depth = queue_depths.entry(prefix).or_default().clone();
+                    let depth = queue_depth.fetch_add(1, Ordering::Relaxed) + 1;
+                    if prefix == lp_ordermatch::ORDERBOOK_PREFIX && depth > MAX_PENDING_ORDERBOOK_MESSAGES {
+                        queue_depth.fetch_sub(1, Ordering::Relaxed);
+                        mm_counter!(ctx.metrics, "p2p.gossip.dropped", 1, "topic" => prefix);
+                        continue;
+                    }
+                    mm_gauge!(ctx.metrics, "p2p.gossip.queue_depth", depth as f64, "topic" => prefix);
+
                     let spawner = ctx.spawner();
-                    spawner.spawn(process_p2p_message(
-                        ctx,
-                        propagation_source,
-                        message_id,
-                        message,
-                        i_am_relay,
-                    ));
+                    spawner.spawn(async move {
+                        let metrics = ctx.metrics.clone();
+                        process_p2p_message(ctx, propagation_source, message_id, message, i_am_relay).await;
+                        let depth = queue_depth.fetch_sub(1, Ordering::Relaxed) - 1;
+                        mm_gauge!(metrics, "p2p.gossip.queue_depth", depth as f64, "topic" => prefix);
+                    });
                 },
                 GossipsubEvent::GossipsubNotSupported { peer_id } => {
                     log::error!("Received unsupported event from Peer: {peer_id}");
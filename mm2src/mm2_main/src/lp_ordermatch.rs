@@ -45,7 +45,7 @@ use mm2_libp2p::application::request_response::ordermatch::OrdermatchRequest;
 use mm2_libp2p::application::request_response::P2PRequest;
 use mm2_libp2p::{decode_signed, encode_and_sign, encode_message, pub_sub_topic, PublicKey, TopicHash, TopicPrefix,
                  TOPIC_SEPARATOR};
-use mm2_metrics::mm_gauge;
+use mm2_metrics::{mm_counter, mm_gauge, mm_span};
 use mm2_number::{BigDecimal, BigRational, MmNumber, MmNumberMultiRepr};
 use mm2_rpc::data::legacy::{MatchBy, Mm2RpcResult, OrderConfirmationsSettings, OrderType, RpcOrderbookEntry,
                             SellBuyRequest, SellBuyResponse, TakerAction, TakerRequestForRpc};
@@ -56,6 +56,7 @@ use my_orders_storage::{delete_my_maker_order, delete_my_taker_order, save_maker
                         MyOrdersHistory, MyOrdersStorage};
 use num_traits::identities::Zero;
 use order_events::{OrderStatusEvent, OrderStatusStreamer};
+use orderbook_depth_events::{update_depth_books, OrderbookDepthBook};
 use orderbook_events::{OrderbookItemChangeEvent, OrderbookStreamer};
 use parking_lot::Mutex as PaMutex;
 use rpc::v1::types::H256 as H256Json;
@@ -63,12 +64,12 @@ use secp256k1::PublicKey as Secp256k1Pubkey;
 use serde_json::{self as json, Value as Json};
 use sp_trie::{delta_trie_root, MemoryDB, Trie, TrieConfiguration, TrieDB, TrieDBMut, TrieHash, TrieMut};
 use std::collections::hash_map::{Entry, HashMap, RawEntryMut};
-use std::collections::{BTreeSet, HashSet};
+use std::collections::HashSet;
 use std::convert::TryInto;
 use std::fmt;
 use std::ops::Deref;
 use std::path::PathBuf;
-use std::sync::Arc;
+use std::sync::{Arc, Weak};
 use std::time::Duration;
 use timed_map::{MapKind, TimedMap};
 use trie_db::NodeCodec as NodeCodecT;
@@ -94,8 +95,14 @@ use coins::rpc_command::tendermint::ibc::ChannelId;
 
 pub use best_orders::{best_orders_rpc, best_orders_rpc_v2};
 use crypto::secret_hash_algo::SecretHashAlgo;
+use expiry_index::ExpiryIndex;
+use maker_orders_index::MakerOrdersIndex;
 pub use orderbook_depth::orderbook_depth_rpc;
+use orderbook_interner::{CompactPubkey, PairIds, TickerId, TickerInterner};
+use orderbook_lock::{OrderbookLock, OrderbookLockStats};
+use orderbook_read_views::{OrderbookReadViews, PairOrdersView};
 pub use orderbook_rpc::{orderbook_rpc, orderbook_rpc_v2};
+use price_index::PriceIndex;
 
 cfg_wasm32! {
     use mm2_db::indexed_db::{ConstructibleDb, DbLocked};
@@ -105,21 +112,29 @@ cfg_wasm32! {
 }
 
 mod best_orders;
+mod expiry_index;
 mod lp_bot;
 pub use lp_bot::{start_simple_market_maker_bot, stop_simple_market_maker_bot, StartSimpleMakerBotRequest,
                  TradingBotEvent};
 use primitives::hash::{H256, H264};
 
+pub mod maker_orders_index;
 mod my_orders_storage;
-mod new_protocol;
+pub mod new_protocol;
 pub(crate) mod order_events;
 mod order_requests_tracker;
 mod orderbook_depth;
+pub(crate) mod orderbook_depth_events;
 pub(crate) mod orderbook_events;
+mod orderbook_interner;
+mod orderbook_lock;
+mod orderbook_read_views;
 mod orderbook_rpc;
+#[cfg(not(target_arch = "wasm32"))] mod orderbook_snapshot;
 #[cfg(all(test, not(target_arch = "wasm32")))]
 #[path = "ordermatch_tests.rs"]
 pub mod ordermatch_tests;
+pub mod price_index;
 
 #[cfg(target_arch = "wasm32")] mod ordermatch_wasm_db;
 
@@ -260,11 +275,14 @@ fn process_pubkey_full_trie(
         ));
     }
 
-    let new_root = pubkey_state_mut(&mut orderbook.pubkeys_state, params.pubkey)
-        .trie_roots
-        .get(params.alb_pair)
-        .copied()
-        .unwrap_or_default();
+    let new_root = match CompactPubkey::from_hex(params.pubkey) {
+        Some(pubkey) => pubkey_state_mut(&mut orderbook.pubkeys_state, &mut orderbook.keep_alive_expiry, pubkey)
+            .trie_roots
+            .get(params.alb_pair)
+            .copied()
+            .unwrap_or_default(),
+        None => H64::default(),
+    };
     new_root
 }
 
@@ -286,7 +304,7 @@ fn process_trie_delta(
         }
     }
 
-    let new_root = match orderbook.pubkeys_state.get(params.pubkey) {
+    let new_root = match orderbook.pubkey_state(params.pubkey) {
         Some(pubkey_state) => pubkey_state
             .trie_roots
             .get(params.alb_pair)
@@ -307,7 +325,7 @@ async fn process_orders_keep_alive(
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).expect("from_ctx failed");
     let to_request = ordermatch_ctx
         .orderbook
-        .lock()
+        .write()
         .process_keep_alive(&from_pubkey, keep_alive, i_am_relay);
 
     let req = match to_request {
@@ -329,7 +347,7 @@ async fn process_orders_keep_alive(
         )))
     })?;
 
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
     for (pair, diff) in response.pair_orders_diff {
         let params = ProcessTrieParams {
             pubkey: &from_pubkey,
@@ -358,35 +376,36 @@ fn process_maker_order_updated(
     updated_msg: new_protocol::MakerOrderUpdated,
 ) -> OrderbookP2PHandlerResult {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).expect("from_ctx failed");
-    let uuid = updated_msg.uuid();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
-
-    let mut order = orderbook
-        .find_order_by_uuid_and_pubkey(&uuid, &from_pubkey)
-        .ok_or_else(|| MmError::new(OrderbookP2PHandlerError::OrderNotFound(uuid)))?;
-    order.apply_updated(&updated_msg);
-    drop_mutability!(order);
-    orderbook.insert_or_update_order_update_trie(order);
+    ordermatch_ctx.orderbook.apply_batched(move |orderbook| {
+        let uuid = updated_msg.uuid();
+        let mut order = orderbook
+            .find_order_by_uuid_and_pubkey(&uuid, &from_pubkey)
+            .ok_or_else(|| MmError::new(OrderbookP2PHandlerError::OrderNotFound(uuid)))?;
+        order.apply_updated(&updated_msg);
+        drop_mutability!(order);
+        orderbook.insert_or_update_order_update_trie(order);
 
-    Ok(())
+        Ok(())
+    })
 }
 
 fn process_maker_order_cancelled(ctx: &MmArc, from_pubkey: String, cancelled_msg: new_protocol::MakerOrderCancelled) {
     let uuid = Uuid::from(cancelled_msg.uuid);
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
-    // Add the order to the recently cancelled list to ignore it if a new order with the same uuid
-    // is received within the `RECENTLY_CANCELLED_TIMEOUT` timeframe.
-    // We do this even if the order is in the order_set, because it could have been added through
-    // means other than the order creation message.
-    orderbook
-        .recently_cancelled
-        .insert_expirable(uuid, from_pubkey.clone(), RECENTLY_CANCELLED_TIMEOUT);
-    if let Some(order) = orderbook.order_set.get(&uuid) {
-        if order.pubkey == from_pubkey {
-            orderbook.remove_order_trie_update(uuid);
+    ordermatch_ctx.orderbook.apply_batched(move |orderbook| {
+        // Add the order to the recently cancelled list to ignore it if a new order with the same uuid
+        // is received within the `RECENTLY_CANCELLED_TIMEOUT` timeframe.
+        // We do this even if the order is in the order_set, because it could have been added through
+        // means other than the order creation message.
+        orderbook
+            .recently_cancelled
+            .insert_expirable(uuid, from_pubkey.clone(), RECENTLY_CANCELLED_TIMEOUT);
+        if let Some(order) = orderbook.order_set.get(&uuid) {
+            if order.pubkey == from_pubkey {
+                orderbook.remove_order_trie_update(uuid);
+            }
         }
-    }
+    });
 }
 
 // fn verify_pubkey_orderbook(orderbook: &GetOrderbookPubkeyItem) -> Result<(), String> {
@@ -446,7 +465,7 @@ async fn request_and_fill_orderbook(ctx: &MmArc, base: &str, rel: &str) -> Resul
     };
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).unwrap();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
 
     let my_pubsecp = mm2_internal_pubkey_hex(ctx, String::from).map_err(MmError::into_inner)?;
 
@@ -494,29 +513,31 @@ async fn request_and_fill_orderbook(ctx: &MmArc, base: &str, rel: &str) -> Resul
 }
 
 /// Insert or update an order `req`.
-/// Note this function locks the [`OrdermatchContext::orderbook`] async mutex.
+/// Note this function locks the [`OrdermatchContext::orderbook`] lock,
+/// the update is batched with the concurrent ones by [`OrderbookLock::apply_batched`].
 fn insert_or_update_order(ctx: &MmArc, item: OrderbookItem) {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
-    orderbook.insert_or_update_order_update_trie(item)
+    ordermatch_ctx
+        .orderbook
+        .apply_batched(move |orderbook| orderbook.insert_or_update_order_update_trie(item))
 }
 
 // use this function when notify maker order created
 fn insert_or_update_my_order(ctx: &MmArc, item: OrderbookItem, my_order: &MakerOrder) {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
     orderbook.insert_or_update_order_update_trie(item);
     if let Some(key) = my_order.p2p_privkey {
-        orderbook.my_p2p_pubkeys.insert(hex::encode(key.public_slice()));
+        orderbook.insert_my_p2p_pubkey(hex::encode(key.public_slice()));
     }
 }
 
 fn delete_my_order(ctx: &MmArc, uuid: Uuid, p2p_privkey: Option<SerializableSecp256k1Keypair>) {
     let ordermatch_ctx: Arc<OrdermatchContext> = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
     orderbook.remove_order_trie_update(uuid);
     if let Some(key) = p2p_privkey {
-        orderbook.my_p2p_pubkeys.remove(&hex::encode(key.public_slice()));
+        orderbook.remove_my_p2p_pubkey(&hex::encode(key.public_slice()));
     }
 }
 
@@ -533,7 +554,7 @@ where
 }
 
 fn remove_pubkey_pair_orders(orderbook: &mut Orderbook, pubkey: &str, alb_pair: &str) {
-    let pubkey_state = match orderbook.pubkeys_state.get_mut(pubkey) {
+    let pubkey_state = match orderbook.existing_pubkey_state_mut(pubkey) {
         Some(state) => state,
         None => return,
     };
@@ -558,7 +579,7 @@ fn remove_pubkey_pair_orders(orderbook: &mut Orderbook, pubkey: &str, alb_pair:
         orderbook.remove_order_trie_update(order);
     }
 
-    let pubkey_state = match orderbook.pubkeys_state.get_mut(pubkey) {
+    let pubkey_state = match orderbook.existing_pubkey_state_mut(pubkey) {
         Some(state) => state,
         None => return,
     };
@@ -585,6 +606,7 @@ pub async fn handle_orderbook_msg(
 
 /// Attempts to decode a message and process it returning whether the message is valid and worth rebroadcasting
 pub async fn process_msg(ctx: MmArc, from_peer: String, msg: &[u8], i_am_relay: bool) -> OrderbookP2PHandlerResult {
+    let _span = mm_span!(ctx.metrics, "ordermatch.process_msg.duration");
     match decode_signed::<new_protocol::OrdermatchMessage>(msg) {
         Ok((message, _sig, pubkey)) => {
             if is_pubkey_banned(&ctx, &pubkey.unprefixed().into()) {
@@ -725,8 +747,8 @@ struct GetPubkeysOrdersRes {
 }
 
 fn get_pubkeys_orders(orderbook: &Orderbook, base: String, rel: String) -> GetPubkeysOrdersRes {
-    let asks = orderbook.unordered.get(&(base.clone(), rel.clone()));
-    let bids = orderbook.unordered.get(&(rel, base));
+    let asks = orderbook.unordered_orders(&base, &rel);
+    let bids = orderbook.unordered_orders(&rel, &base);
 
     let asks_num = asks.map(|x| x.len()).unwrap_or(0);
     let bids_num = bids.map(|x| x.len()).unwrap_or(0);
@@ -767,7 +789,7 @@ fn get_pubkeys_orders(orderbook: &Orderbook, base: String, rel: String) -> GetPu
 
 fn process_get_orderbook_request(ctx: MmArc, base: String, rel: String) -> Result<Option<Vec<u8>>, String> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
 
     let pubkeys_orders = get_pubkeys_orders(&orderbook, base, rel);
     if pubkeys_orders.total_number_of_orders > MAX_ORDERS_NUMBER_IN_ORDERBOOK_RESPONSE {
@@ -778,7 +800,7 @@ fn process_get_orderbook_request(ctx: MmArc, base: String, rel: String) -> Resul
         .uuids_by_pubkey
         .into_iter()
         .map(|(pubkey, orders)| {
-            let pubkey_state = orderbook.pubkeys_state.get(&pubkey).ok_or(ERRL!(
+            let pubkey_state = orderbook.pubkey_state(&pubkey).ok_or(ERRL!(
                 "Orderbook::pubkeys_state is expected to contain the {:?} pubkey",
                 pubkey
             ))?;
@@ -914,14 +936,24 @@ struct SyncPubkeyOrderbookStateRes {
     conf_infos: HashMap<Uuid, OrderConfirmationsSettings>,
 }
 
+/// Returns the pair trie roots of the `pubkey` orders known to the local orderbook.
+pub fn pubkey_trie_roots(ctx: &MmArc, pubkey: &str) -> HashMap<AlbOrderedOrderbookPair, H64> {
+    let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
+    let orderbook = ordermatch_ctx.orderbook.read();
+    orderbook
+        .pubkey_state(pubkey)
+        .map(|state| state.trie_roots.clone())
+        .unwrap_or_default()
+}
+
 fn process_sync_pubkey_orderbook_state(
     ctx: MmArc,
     pubkey: String,
     trie_roots: HashMap<AlbOrderedOrderbookPair, H64>,
 ) -> Result<Option<SyncPubkeyOrderbookStateRes>, String> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    let pubkey_state = some_or_return_ok_none!(orderbook.pubkeys_state.get(&pubkey));
+    let orderbook = ordermatch_ctx.orderbook.read();
+    let pubkey_state = some_or_return_ok_none!(orderbook.pubkey_state(&pubkey));
 
     let order_getter = |uuid: &Uuid| orderbook.order_set.get(uuid).cloned();
     let pair_orders_diff: Result<HashMap<_, _>, _> = trie_roots
@@ -1070,7 +1102,7 @@ fn maker_order_created_p2p_notify(
 
 fn process_my_maker_order_updated(ctx: &MmArc, message: &new_protocol::MakerOrderUpdated) {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).expect("from_ctx failed");
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
 
     let uuid = message.uuid();
     if let Some(mut order) = orderbook.find_order_by_uuid(&uuid) {
@@ -1234,6 +1266,19 @@ impl TakerRequest {
         }
     }
 
+    /// Returns the highest price of the maker orders the request matches with,
+    /// or None if the request amounts aren't positive.
+    fn match_price(&self) -> Option<MmNumber> {
+        let zero = MmNumber::from(0);
+        if self.base_amount <= zero || self.rel_amount <= zero {
+            return None;
+        }
+        match self.action {
+            TakerAction::Buy => Some(&self.rel_amount / &self.base_amount),
+            TakerAction::Sell => Some(&self.base_amount / &self.rel_amount),
+        }
+    }
+
     fn can_match_with_uuid(&self, uuid: &Uuid) -> bool {
         match &self.match_by {
             MatchBy::Orders(uuids) => uuids.contains(uuid),
@@ -2086,25 +2131,28 @@ impl MakerOrder {
         false
     }
 
-    fn match_with_request(&self, taker: &TakerRequest) -> OrderMatchResult {
-        let taker_base_amount = taker.get_base_amount();
-        let taker_rel_amount = taker.get_rel_amount();
-
-        let zero = MmNumber::from(0);
-        if taker_base_amount <= &zero || taker_rel_amount <= &zero {
-            return OrderMatchResult::NotMatched;
+    pub fn match_with_request(&self, taker: &TakerRequest) -> OrderMatchResult {
+        match taker.match_price() {
+            Some(taker_price) => self.match_with_request_at_price(taker, &taker_price),
+            None => OrderMatchResult::NotMatched,
         }
+    }
 
+    /// Matches the order with the request whose price is computed by `TakerRequest::match_price`,
+    /// so the price is computed once for all the orders the request is matched against.
+    ///
+    /// The cheap ticker and price checks go first, as the available amount is summed up over the order matches.
+    fn match_with_request_at_price(&self, taker: &TakerRequest, taker_price: &MmNumber) -> OrderMatchResult {
+        let taker_base_amount = taker.get_base_amount();
         match taker.action {
             TakerAction::Buy => {
                 let ticker_match = (self.base == taker.base
                     || self.base_orderbook_ticker.as_ref() == Some(&taker.base))
                     && (self.rel == taker.rel || self.rel_orderbook_ticker.as_ref() == Some(&taker.rel));
-                let taker_price = taker_rel_amount / taker_base_amount;
                 if ticker_match
-                    && taker_base_amount <= &self.available_amount()
+                    && taker_price >= &self.price
                     && taker_base_amount >= &self.min_base_vol
-                    && taker_price >= self.price
+                    && taker_base_amount <= &self.available_amount()
                 {
                     OrderMatchResult::Matched((taker_base_amount.clone(), taker_base_amount * &self.price))
                 } else {
@@ -2114,17 +2162,15 @@ impl MakerOrder {
             TakerAction::Sell => {
                 let ticker_match = (self.base == taker.rel || self.base_orderbook_ticker.as_ref() == Some(&taker.rel))
                     && (self.rel == taker.base || self.rel_orderbook_ticker.as_ref() == Some(&taker.base));
-                let taker_price = taker_base_amount / taker_rel_amount;
+                if !ticker_match || taker_price < &self.price {
+                    return OrderMatchResult::NotMatched;
+                }
 
                 // Calculate the resulting base amount using the Maker's price instead of the Taker's.
                 let matched_base_amount = taker_base_amount / &self.price;
                 let matched_rel_amount = taker_base_amount.clone();
 
-                if ticker_match
-                    && matched_base_amount <= self.available_amount()
-                    && matched_base_amount >= self.min_base_vol
-                    && taker_price >= self.price
-                {
+                if matched_base_amount >= self.min_base_vol && matched_base_amount <= self.available_amount() {
                     OrderMatchResult::Matched((matched_base_amount, matched_rel_amount))
                 } else {
                     OrderMatchResult::NotMatched
@@ -2354,7 +2400,7 @@ impl From<MakerConnected> for new_protocol::OrdermatchMessage {
 }
 
 fn broadcast_keep_alive_for_pub(ctx: &MmArc, pubkey: &str, orderbook: &Orderbook, p2p_privkey: Option<&KeyPair>) {
-    let state = match orderbook.pubkeys_state.get(pubkey) {
+    let state = match orderbook.pubkey_state(pubkey) {
         Some(s) => s,
         None => return,
     };
@@ -2397,12 +2443,12 @@ pub async fn broadcast_maker_orders_keep_alive_loop(ctx: MmArc) {
                 // but it seems to keep holding the guard
                 drop(order);
                 let pubsecp = hex::encode(p2p_privkey.public_slice());
-                let orderbook = ordermatch_ctx.orderbook.lock();
+                let orderbook = ordermatch_ctx.orderbook.read();
                 broadcast_keep_alive_for_pub(&ctx, &pubsecp, &orderbook, Some(p2p_privkey.key_pair()));
             }
         }
 
-        let orderbook = ordermatch_ctx.orderbook.lock();
+        let orderbook = ordermatch_ctx.orderbook.read();
         broadcast_keep_alive_for_pub(&ctx, &persistent_pubsecp, &orderbook, None);
     }
 }
@@ -2424,13 +2470,6 @@ fn broadcast_ordermatch_message(
     broadcast_p2p_msg(ctx, topic, encoded_msg, peer_id);
 }
 
-/// The order is ordered by [`OrderbookItem::price`] and [`OrderbookItem::uuid`].
-#[derive(Clone, Debug, Eq, Ord, PartialEq, PartialOrd)]
-struct OrderedByPriceOrder {
-    price: MmNumber,
-    uuid: Uuid,
-}
-
 #[derive(Clone, Debug, PartialEq)]
 enum OrderbookRequestingState {
     /// The orderbook was requested from relays.
@@ -2524,16 +2563,15 @@ fn get_trie_mut<'a>(
 }
 
 fn pubkey_state_mut<'a>(
-    state: &'a mut HashMap<String, OrderbookPubkeyState>,
-    from_pubkey: &str,
+    state: &'a mut HashMap<CompactPubkey, OrderbookPubkeyState>,
+    keep_alive_expiry: &mut ExpiryIndex<CompactPubkey>,
+    from_pubkey: CompactPubkey,
 ) -> &'a mut OrderbookPubkeyState {
-    match state.raw_entry_mut().from_key(from_pubkey) {
-        RawEntryMut::Occupied(e) => e.into_mut(),
-        RawEntryMut::Vacant(e) => {
-            let state = OrderbookPubkeyState::new();
-            e.insert(from_pubkey.to_string(), state).1
-        },
-    }
+    state.entry(from_pubkey).or_insert_with(|| {
+        let pubkey_state = OrderbookPubkeyState::new();
+        keep_alive_expiry.refresh(from_pubkey, pubkey_state.last_keep_alive);
+        pubkey_state
+    })
 }
 
 fn order_pair_root_mut<'a>(state: &'a mut HashMap<AlbOrderedOrderbookPair, H64>, pair: &str) -> &'a mut H64 {
@@ -2545,29 +2583,39 @@ fn order_pair_root_mut<'a>(state: &'a mut HashMap<AlbOrderedOrderbookPair, H64>,
 
 /// `parity_util_mem::malloc_size` crushes for some reason on wasm32
 #[cfg(target_arch = "wasm32")]
-fn collect_orderbook_metrics(_ctx: &MmArc, _orderbook: &Orderbook) {}
+fn collect_orderbook_metrics(_ctx: &MmArc, _orderbook: &Orderbook, _lock_stats: OrderbookLockStats) {}
 
 #[cfg(not(target_arch = "wasm32"))]
-fn collect_orderbook_metrics(ctx: &MmArc, orderbook: &Orderbook) {
+fn collect_orderbook_metrics(ctx: &MmArc, orderbook: &Orderbook, lock_stats: OrderbookLockStats) {
     use parity_util_mem::malloc_size;
 
     let memory_db_size = malloc_size(&orderbook.memory_db);
     mm_gauge!(ctx.metrics, "orderbook.len", orderbook.order_set.len() as f64);
     mm_gauge!(ctx.metrics, "orderbook.memory_db", memory_db_size as f64);
+    mm_counter!(ctx.metrics, "orderbook.lock.contended", lock_stats.contended_reads, "access" => "read");
+    mm_counter!(ctx.metrics, "orderbook.lock.contended", lock_stats.contended_writes, "access" => "write");
+    mm_counter!(ctx.metrics, "orderbook.lock.writes", lock_stats.writes);
+    mm_counter!(ctx.metrics, "orderbook.lock.wait_us", lock_stats.wait_us);
+    mm_counter!(ctx.metrics, "orderbook.updates.batched", lock_stats.batched_updates);
+    mm_counter!(ctx.metrics, "orderbook.updates.batches", lock_stats.update_batches);
 }
 
 struct Orderbook {
-    /// A map from (base, rel).
-    ordered: HashMap<(String, String), BTreeSet<OrderedByPriceOrder>>,
+    /// The tickers interned to key the pair indexes below.
+    tickers: TickerInterner,
+    /// A map from (base, rel) to the orders ordered by [`OrderbookItem::price`] and [`OrderbookItem::uuid`].
+    ordered: HashMap<PairIds, PriceIndex>,
     /// A map from base ticker to the set of another tickers to track the existing pairs
-    pairs_existing_for_base: HashMap<String, HashSet<String>>,
+    pairs_existing_for_base: HashMap<TickerId, HashSet<TickerId>>,
     /// A map from rel ticker to the set of another tickers to track the existing pairs
-    pairs_existing_for_rel: HashMap<String, HashSet<String>>,
+    pairs_existing_for_rel: HashMap<TickerId, HashSet<TickerId>>,
     /// A map from (base, rel).
-    unordered: HashMap<(String, String), HashSet<Uuid>>,
+    unordered: HashMap<PairIds, HashSet<Uuid>>,
     order_set: HashMap<Uuid, OrderbookItem>,
     /// a map of orderbook states of known maker pubkeys
-    pubkeys_state: HashMap<String, OrderbookPubkeyState>,
+    pubkeys_state: HashMap<CompactPubkey, OrderbookPubkeyState>,
+    /// The known maker pubkeys by [`OrderbookPubkeyState::last_keep_alive`], used to find the timed out pubkeys.
+    keep_alive_expiry: ExpiryIndex<CompactPubkey>,
     /// `TimedMap` of recently canceled orders, mapping `Uuid` to the maker pubkey as `String`,
     /// used to avoid order recreation in case of out-of-order p2p messages,
     /// e.g., when receiving the order cancellation message before the order is created.
@@ -2579,22 +2627,30 @@ struct Orderbook {
     my_p2p_pubkeys: HashSet<String>,
     /// A copy of the streaming manager to stream orderbook events out.
     streaming_manager: StreamingManager,
+    /// The depth books of the (base, rel) pairs streamed by `OrderbookDepthStreamer`s.
+    depth_books: HashMap<PairIds, Weak<PaMutex<OrderbookDepthBook>>>,
+    /// The views of the pairs served to the RPC readers, dropped on every change of their pair.
+    read_views: Arc<OrderbookReadViews>,
 }
 
 impl Default for Orderbook {
     fn default() -> Self {
         Orderbook {
+            tickers: TickerInterner::default(),
             ordered: HashMap::default(),
             pairs_existing_for_base: HashMap::default(),
             pairs_existing_for_rel: HashMap::default(),
             unordered: HashMap::default(),
             order_set: HashMap::default(),
             pubkeys_state: HashMap::default(),
+            keep_alive_expiry: ExpiryIndex::default(),
             recently_cancelled: TimedMap::new_with_map_kind(MapKind::FxHashMap),
             topics_subscribed_to: HashMap::default(),
             memory_db: MemoryDB::default(),
             my_p2p_pubkeys: HashSet::default(),
             streaming_manager: Default::default(),
+            depth_books: HashMap::default(),
+            read_views: Arc::default(),
         }
     }
 }
@@ -2621,6 +2677,66 @@ impl Orderbook {
 
     fn find_order_by_uuid(&self, uuid: &Uuid) -> Option<OrderbookItem> { self.order_set.get(uuid).cloned() }
 
+    fn pubkey_state(&self, pubkey: &str) -> Option<&OrderbookPubkeyState> {
+        let pubkey = CompactPubkey::from_hex(pubkey)?;
+        self.pubkeys_state.get(&pubkey)
+    }
+
+    fn existing_pubkey_state_mut(&mut self, pubkey: &str) -> Option<&mut OrderbookPubkeyState> {
+        let pubkey = CompactPubkey::from_hex(pubkey)?;
+        self.pubkeys_state.get_mut(&pubkey)
+    }
+
+    /// Returns the (base, rel) orders ordered by price.
+    fn ordered_orders(&self, base: &str, rel: &str) -> Option<&PriceIndex> {
+        self.tickers
+            .get_pair(base, rel)
+            .and_then(|pair| self.ordered.get(&pair))
+    }
+
+    /// Returns the read view of the (base, rel) orders, building it if the pair has changed since it was built last time.
+    fn pair_orders_view(&self, base: &str, rel: &str) -> Arc<PairOrdersView> {
+        if let Some(view) = self.read_views.get(base, rel) {
+            return view;
+        }
+
+        let orders = match self.ordered_orders(base, rel) {
+            Some(uuids) => uuids
+                .iter()
+                .filter_map(|uuid| {
+                    let order = self.order_set.get(uuid);
+                    if order.is_none() {
+                        warn!("ordered contains {:?} uuid that is not in order_set", uuid);
+                    }
+                    order.cloned()
+                })
+                .collect(),
+            None => Vec::new(),
+        };
+        let view = Arc::new(PairOrdersView {
+            orders,
+            my_p2p_pubkeys: self.my_p2p_pubkeys.clone(),
+        });
+        self.read_views.insert(base, rel, view.clone());
+        view
+    }
+
+    fn insert_my_p2p_pubkey(&mut self, pubkey: String) {
+        self.my_p2p_pubkeys.insert(pubkey);
+        self.read_views.invalidate_all();
+    }
+
+    fn remove_my_p2p_pubkey(&mut self, pubkey: &str) {
+        self.my_p2p_pubkeys.remove(pubkey);
+        self.read_views.invalidate_all();
+    }
+
+    fn unordered_orders(&self, base: &str, rel: &str) -> Option<&HashSet<Uuid>> {
+        self.tickers
+            .get_pair(base, rel)
+            .and_then(|pair| self.unordered.get(&pair))
+    }
+
     fn insert_or_update_order_update_trie(&mut self, order: OrderbookItem) {
         // Ignore the order if it was recently cancelled
         if self.recently_cancelled.get(&order.uuid) == Some(&order.pubkey) {
@@ -2628,6 +2744,17 @@ impl Orderbook {
             return;
         }
 
+        let pubkey = match CompactPubkey::from_hex(&order.pubkey) {
+            Some(pubkey) => pubkey,
+            None => {
+                warn!(
+                    "Maker order {} has invalid pubkey {}, ignoring",
+                    order.uuid, order.pubkey
+                );
+                return;
+            },
+        };
+
         let zero = BigRational::from_integer(0.into());
         if order.max_volume <= zero || order.price <= zero || order.min_volume < zero {
             self.remove_order_trie_update(order.uuid);
@@ -2636,7 +2763,7 @@ impl Orderbook {
 
         self.insert_or_update_order(order.clone());
 
-        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, &order.pubkey);
+        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, &mut self.keep_alive_expiry, pubkey);
 
         let alb_ordered = alb_ordered_pair(&order.base, &order.rel);
         let pair_root = order_pair_root_mut(&mut pubkey_state.trie_roots, &alb_ordered);
@@ -2703,33 +2830,32 @@ impl Orderbook {
             return;
         } // else insert the order
 
-        let base_rel = (order.base.clone(), order.rel.clone());
+        let base_rel = (self.tickers.intern(&order.base), self.tickers.intern(&order.rel));
 
-        let ordered = self.ordered.entry(base_rel.clone()).or_insert_with(BTreeSet::new);
+        self.read_views.invalidate(&order.base, &order.rel);
+        if let Some(existing) = self.order_set.get(&order.uuid) {
+            self.read_views.invalidate(&existing.base, &existing.rel);
+        }
 
-        // have to clone to drop immutable ordered borrow
-        let existing = ordered
-            .iter()
-            .find(|maybe_existing| maybe_existing.uuid == order.uuid)
-            .cloned();
+        let ordered = self.ordered.entry(base_rel).or_insert_with(PriceIndex::default);
 
-        if let Some(exists) = existing {
-            ordered.remove(&exists);
+        // the existing order can be found in the price index by its previous price only
+        if let Some(existing) = self.order_set.get(&order.uuid) {
+            if existing.base == order.base && existing.rel == order.rel {
+                ordered.remove(&existing.price, &existing.uuid);
+            }
         }
-        ordered.insert(OrderedByPriceOrder {
-            uuid: order.uuid,
-            price: order.price.clone().into(),
-        });
+        ordered.insert(&order.price, order.uuid);
 
         self.pairs_existing_for_base
-            .entry(order.base.clone())
+            .entry(base_rel.0)
             .or_insert_with(HashSet::new)
-            .insert(order.rel.clone());
+            .insert(base_rel.1);
 
         self.pairs_existing_for_rel
-            .entry(order.rel.clone())
+            .entry(base_rel.1)
             .or_insert_with(HashSet::new)
-            .insert(order.base.clone());
+            .insert(base_rel.0);
 
         self.unordered
             .entry(base_rel)
@@ -2741,6 +2867,19 @@ impl Orderbook {
                 OrderbookItemChangeEvent::NewOrUpdatedItem(Box::new(order.clone().into()))
             })
             .ok();
+        match self.order_set.get(&order.uuid) {
+            Some(existing)
+                if existing.base == order.base
+                    && existing.rel == order.rel
+                    && existing.price == order.price
+                    && existing.max_volume == order.max_volume => {},
+            existing => {
+                if let Some(existing) = existing {
+                    update_depth_books(self, existing, true);
+                }
+                update_depth_books(self, &order, false);
+            },
+        }
         self.order_set.insert(order.uuid, order);
     }
 
@@ -2749,31 +2888,39 @@ impl Orderbook {
             Some(order) => order,
             None => return None,
         };
-        let base_rel = (order.base.clone(), order.rel.clone());
-
-        // create an `order_to_delete` that allows to find and remove an element from `self.ordered` by hash
-        let order_to_delete = OrderedByPriceOrder {
-            price: order.price.clone().into(),
-            uuid,
-        };
-
-        if let Some(orders) = self.ordered.get_mut(&base_rel) {
-            orders.remove(&order_to_delete);
-            if orders.is_empty() {
-                self.ordered.remove(&base_rel);
+        self.read_views.invalidate(&order.base, &order.rel);
+        // the order tickers are interned on the order insertion
+        if let Some(base_rel) = self.tickers.get_pair(&order.base, &order.rel) {
+            if let Some(orders) = self.ordered.get_mut(&base_rel) {
+                orders.remove(&order.price, &uuid);
+                if orders.is_empty() {
+                    self.ordered.remove(&base_rel);
+                }
             }
-        }
 
-        if let Some(orders) = self.unordered.get_mut(&base_rel) {
-            // use the same uuid to remove an order
-            orders.remove(&order_to_delete.uuid);
-            if orders.is_empty() {
-                self.unordered.remove(&base_rel);
+            if let Some(orders) = self.unordered.get_mut(&base_rel) {
+                orders.remove(&uuid);
+                if orders.is_empty() {
+                    self.unordered.remove(&base_rel);
+                }
             }
         }
 
+        self.streaming_manager
+            .send_fn(&OrderbookStreamer::derive_streamer_id(&order.base, &order.rel), || {
+                OrderbookItemChangeEvent::RemovedItem(order.uuid)
+            })
+            .ok();
+        update_depth_books(self, &order, true);
+
+        // the orders with invalid pubkeys are not inserted to the tries
+        let pubkey = match CompactPubkey::from_hex(&order.pubkey) {
+            Some(pubkey) => pubkey,
+            None => return Some(order),
+        };
+
         let alb_ordered = alb_ordered_pair(&order.base, &order.rel);
-        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, &order.pubkey);
+        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, &mut self.keep_alive_expiry, pubkey);
         let pair_state = order_pair_root_mut(&mut pubkey_state.trie_roots, &alb_ordered);
         let old_state = *pair_state;
 
@@ -2805,11 +2952,6 @@ impl Orderbook {
             });
         }
 
-        self.streaming_manager
-            .send_fn(&OrderbookStreamer::derive_streamer_id(&order.base, &order.rel), || {
-                OrderbookItemChangeEvent::RemovedItem(order.uuid)
-            })
-            .ok();
         Some(order)
     }
 
@@ -2821,8 +2963,16 @@ impl Orderbook {
         message: new_protocol::PubkeyKeepAlive,
         i_am_relay: bool,
     ) -> Option<OrdermatchRequest> {
-        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, from_pubkey);
+        let pubkey = match CompactPubkey::from_hex(from_pubkey) {
+            Some(pubkey) => pubkey,
+            None => {
+                warn!("Received keep alive from invalid pubkey {}", from_pubkey);
+                return None;
+            },
+        };
+        let pubkey_state = pubkey_state_mut(&mut self.pubkeys_state, &mut self.keep_alive_expiry, pubkey);
         pubkey_state.last_keep_alive = now_sec();
+        self.keep_alive_expiry.refresh(pubkey, pubkey_state.last_keep_alive);
         let mut trie_roots_to_request = HashMap::new();
         for (alb_pair, trie_root) in message.trie_roots {
             let subscribed = self
@@ -2869,7 +3019,9 @@ impl Orderbook {
 struct OrdermatchContext {
     pub maker_orders_ctx: PaMutex<MakerOrdersContext>,
     pub my_taker_orders: AsyncMutex<HashMap<Uuid, TakerOrder>>,
-    pub orderbook: PaMutex<Orderbook>,
+    pub orderbook: OrderbookLock<Orderbook>,
+    /// The shared [`Orderbook::read_views`], read without the `orderbook` lock.
+    orderbook_views: Arc<OrderbookReadViews>,
     /// The map from coin original ticker to the orderbook ticker
     /// It is used to share the same orderbooks for concurrently activated coins with different protocols
     /// E.g. BTC and BTC-Segwit
@@ -2908,10 +3060,12 @@ pub fn init_ordermatch_context(ctx: &MmArc) -> OrdermatchInitResult<()> {
         }
     }
 
+    let orderbook = Orderbook::new(ctx.event_stream_manager.clone());
     let ordermatch_context = OrdermatchContext {
         maker_orders_ctx: PaMutex::new(MakerOrdersContext::new(ctx)?),
         my_taker_orders: Default::default(),
-        orderbook: PaMutex::new(Orderbook::new(ctx.event_stream_manager.clone())),
+        orderbook_views: orderbook.read_views.clone(),
+        orderbook: OrderbookLock::new(orderbook),
         pending_maker_reserved: Default::default(),
         orderbook_tickers,
         original_tickers,
@@ -2938,10 +3092,12 @@ impl OrdermatchContext {
     #[cfg(test)]
     fn from_ctx(ctx: &MmArc) -> Result<Arc<OrdermatchContext>, String> {
         Ok(try_s!(from_ctx(&ctx.ordermatch_ctx, move || {
+            let orderbook = Orderbook::new(ctx.event_stream_manager.clone());
             Ok(OrdermatchContext {
                 maker_orders_ctx: PaMutex::new(try_s!(MakerOrdersContext::new(ctx))),
                 my_taker_orders: Default::default(),
-                orderbook: PaMutex::new(Orderbook::new(ctx.event_stream_manager.clone())),
+                orderbook_views: orderbook.read_views.clone(),
+                orderbook: OrderbookLock::new(orderbook),
                 pending_maker_reserved: Default::default(),
                 orderbook_tickers: Default::default(),
                 original_tickers: Default::default(),
@@ -2953,6 +3109,15 @@ impl OrdermatchContext {
 
     fn orderbook_ticker(&self, ticker: &str) -> Option<String> { self.orderbook_tickers.get(ticker).cloned() }
 
+    /// Returns the read view of the (base, rel) orders.
+    /// The orderbook lock is taken only if the pair has changed since the view was built last time.
+    fn pair_orders_view(&self, base: &str, rel: &str) -> Arc<PairOrdersView> {
+        match self.orderbook_views.get(base, rel) {
+            Some(view) => view,
+            None => self.orderbook.read().pair_orders_view(base, rel),
+        }
+    }
+
     fn orderbook_ticker_bypass(&self, ticker: &str) -> String {
         self.orderbook_ticker(ticker).unwrap_or_else(|| ticker.to_owned())
     }
@@ -2972,6 +3137,8 @@ impl OrdermatchContext {
 
 pub struct MakerOrdersContext {
     orders: HashMap<Uuid, Arc<AsyncMutex<MakerOrder>>>,
+    /// The orders by the pairs the taker requests can match them on.
+    orders_index: MakerOrdersIndex,
     order_tickers: HashMap<Uuid, String>,
     count_by_tickers: HashMap<String, usize>,
     /// The `check_balance_update_loop` future abort handles associated stored by corresponding tickers.
@@ -2986,6 +3153,7 @@ impl MakerOrdersContext {
 
         Ok(MakerOrdersContext {
             orders: HashMap::new(),
+            orders_index: MakerOrdersIndex::default(),
             order_tickers: HashMap::new(),
             count_by_tickers: HashMap::new(),
             balance_loops,
@@ -2995,6 +3163,7 @@ impl MakerOrdersContext {
     fn add_order(&mut self, ctx: MmWeak, order: MakerOrder, balance: Option<BigDecimal>) {
         self.spawn_balance_loop_if_not_spawned(ctx, order.base.clone(), balance);
 
+        self.orders_index.insert(&order);
         self.order_tickers.insert(order.uuid, order.base.clone());
         *self.count_by_tickers.entry(order.base.clone()).or_insert(0) += 1;
         self.orders.insert(order.uuid, Arc::new(AsyncMutex::new(order)));
@@ -3004,6 +3173,7 @@ impl MakerOrdersContext {
 
     fn remove_order(&mut self, uuid: &Uuid) -> Option<Arc<AsyncMutex<MakerOrder>>> {
         let order = self.orders.remove(uuid)?;
+        self.orders_index.remove(uuid);
         let ticker = self.order_tickers.remove(uuid)?;
         if let Some(count) = self.count_by_tickers.get_mut(&ticker) {
             if *count > 0 {
@@ -3018,6 +3188,15 @@ impl MakerOrdersContext {
         Some(order)
     }
 
+    /// Returns the orders on the pair of the `request` that it's allowed to match with.
+    fn request_candidates(&self, request: &TakerRequest) -> Vec<(Uuid, Arc<AsyncMutex<MakerOrder>>)> {
+        self.orders_index
+            .request_candidates(request)
+            .filter(|uuid| request.can_match_with_uuid(uuid))
+            .filter_map(|uuid| Some((*uuid, self.orders.get(uuid)?.clone())))
+            .collect()
+    }
+
     fn coin_has_active_maker_orders(&self, ticker: &str) -> bool {
         self.count_by_tickers.get(ticker).copied() > Some(0)
     }
@@ -3557,12 +3736,27 @@ pub async fn lp_ordermatch_loop(ctx: MmArc) {
         .expect("CryptoCtx not available")
         .mm2_internal_pubkey_hex();
 
+    let my_pubkey = CompactPubkey::from_hex(&my_pubsecp);
+
     let maker_order_timeout = ctx.conf["maker_order_timeout"].as_u64().unwrap_or(MAKER_ORDER_TIMEOUT);
+
+    #[cfg(not(target_arch = "wasm32"))]
+    let mut snapshot_saver = orderbook_snapshot::OrderbookSnapshotSaver::from_ctx(&ctx, &my_pubsecp);
+    #[cfg(not(target_arch = "wasm32"))]
+    if let Some(saver) = &snapshot_saver {
+        saver.load(&OrdermatchContext::from_ctx(&ctx).unwrap().orderbook).await;
+    }
+
     loop {
         if ctx.is_stopping() {
+            #[cfg(not(target_arch = "wasm32"))]
+            if let Some(saver) = &mut snapshot_saver {
+                saver.save(&OrdermatchContext::from_ctx(&ctx).unwrap().orderbook).await;
+            }
             break;
         }
         let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
+        let loop_span = mm_span!(ctx.metrics, "ordermatch.loop.duration");
 
         handle_timed_out_taker_orders(ctx.clone(), &ordermatch_ctx).await;
         handle_timed_out_maker_matches(ctx.clone(), &ordermatch_ctx).await;
@@ -3570,16 +3764,22 @@ pub async fn lp_ordermatch_loop(ctx: MmArc) {
 
         {
             // remove "timed out" pubkeys states with their orders from orderbook
-            let mut orderbook = ordermatch_ctx.orderbook.lock();
+            let mut orderbook = ordermatch_ctx.orderbook.write();
             let mut uuids_to_remove = vec![];
             let mut pubkeys_to_remove = vec![];
-            for (pubkey, state) in orderbook.pubkeys_state.iter() {
-                let to_keep = pubkey == &my_pubsecp || state.last_keep_alive + maker_order_timeout > now_sec();
-                if !to_keep {
-                    for (uuid, _) in &state.orders_uuids {
-                        uuids_to_remove.push(*uuid);
-                    }
-                    pubkeys_to_remove.push(pubkey.clone());
+            // the pubkeys whose last keep alive is at least `maker_order_timeout` seconds old
+            let timed_out = match now_sec().checked_sub(maker_order_timeout) {
+                Some(timed_out_at) => orderbook.keep_alive_expiry.take_until(timed_out_at),
+                None => Vec::new(),
+            };
+            for pubkey in timed_out {
+                // our own pubkey is never timed out, it's tracked again on its next keep alive
+                if Some(pubkey) == my_pubkey {
+                    continue;
+                }
+                if let Some(state) = orderbook.pubkeys_state.get(&pubkey) {
+                    uuids_to_remove.extend(state.orders_uuids.iter().map(|(uuid, _)| *uuid));
+                    pubkeys_to_remove.push(pubkey);
                 }
             }
 
@@ -3590,14 +3790,19 @@ pub async fn lp_ordermatch_loop(ctx: MmArc) {
                 orderbook.pubkeys_state.remove(&pubkey);
             }
 
-            collect_orderbook_metrics(&ctx, &orderbook);
+            collect_orderbook_metrics(&ctx, &orderbook, ordermatch_ctx.orderbook.take_contention_stats());
+        }
+
+        #[cfg(not(target_arch = "wasm32"))]
+        if let Some(saver) = &mut snapshot_saver {
+            saver.save_if_due(&ordermatch_ctx.orderbook).await;
         }
 
         {
             let mut missing_uuids = Vec::new();
             let mut to_cancel = Vec::new();
             {
-                let orderbook = ordermatch_ctx.orderbook.lock();
+                let orderbook = ordermatch_ctx.orderbook.read();
                 for (uuid, _) in ordermatch_ctx.maker_orders_ctx.lock().orders.iter() {
                     if !orderbook.order_set.contains_key(uuid) {
                         missing_uuids.push(*uuid);
@@ -3674,6 +3879,8 @@ pub async fn lp_ordermatch_loop(ctx: MmArc) {
                 }
             }
         }
+        // Don't count the sleep between the iterations.
+        drop(loop_span);
 
         Timer::sleep(0.777).await;
     }
@@ -3691,7 +3898,7 @@ pub async fn clean_memory_loop(ctx_weak: MmWeak) {
             }
 
             let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-            let mut orderbook = ordermatch_ctx.orderbook.lock();
+            let mut orderbook = ordermatch_ctx.orderbook.write();
             orderbook.memory_db.purge();
         }
         Timer::sleep(600.).await;
@@ -3814,6 +4021,7 @@ async fn handle_timed_out_maker_matches(ctx: MmArc, ordermatch_ctx: &OrdermatchC
 }
 
 async fn process_maker_reserved(ctx: MmArc, from_pubkey: H256Json, reserved_msg: MakerReserved) {
+    let _span = mm_span!(ctx.metrics, "ordermatch.maker_reserved.duration");
     log::debug!("Processing MakerReserved {:?}", reserved_msg);
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
     {
@@ -3984,6 +4192,7 @@ async fn process_maker_connected(ctx: MmArc, from_pubkey: PublicKey, connected:
 }
 
 async fn process_taker_request(ctx: MmArc, from_pubkey: H256Json, taker_request: TakerRequest) {
+    let _span = mm_span!(ctx.metrics, "ordermatch.taker_request.duration");
     let our_public_id: H256Json = match CryptoCtx::from_ctx(&ctx) {
         Ok(ctx) => ctx.mm2_internal_public_id().bytes.into(),
         Err(_) => return,
@@ -4001,14 +4210,20 @@ async fn process_taker_request(ctx: MmArc, from_pubkey: H256Json, taker_request:
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
     let storage = MyOrdersStorage::new(ctx.clone());
-    let mut my_orders = ordermatch_ctx.maker_orders_ctx.lock().orders.clone();
-    let filtered = my_orders
-        .iter_mut()
-        .filter(|(uuid, _)| taker_request.can_match_with_uuid(uuid));
+    let taker_price = match taker_request.match_price() {
+        Some(price) => price,
+        None => return,
+    };
+    let candidates = ordermatch_ctx
+        .maker_orders_ctx
+        .lock()
+        .request_candidates(&taker_request);
 
-    for (uuid, order) in filtered {
+    for (uuid, order) in candidates.iter() {
         let mut order = order.lock().await;
-        if let OrderMatchResult::Matched((base_amount, rel_amount)) = order.match_with_request(&taker_request) {
+        if let OrderMatchResult::Matched((base_amount, rel_amount)) =
+            order.match_with_request_at_price(&taker_request, &taker_price)
+        {
             let (base_coin, rel_coin) = match find_pair(&ctx, &order.base, &order.rel).await {
                 Ok(Some(c)) => c,
                 _ => return, // attempt to match with deactivated coin
@@ -5290,7 +5505,7 @@ pub async fn update_maker_order_rpc(ctx: MmArc, req: Json) -> Result<Response<Ve
 
 /// Result of match_order_and_request function
 #[derive(Debug, PartialEq)]
-enum OrderMatchResult {
+pub enum OrderMatchResult {
     /// Order and request matched, contains base and rel resulting amounts
     Matched((MmNumber, MmNumber)),
     /// Orders didn't match
@@ -5737,29 +5952,16 @@ pub async fn my_orders(ctx: MmArc) -> Result<Response<Vec<u8>>, String> {
         .map_err(|e| ERRL!("{}", e))
 }
 
+/// The orders used to be saved to the JSON files of these directories.
+/// They are moved to the SQLite database on migration, see [`crate::database::saved_orders`].
 #[cfg(not(target_arch = "wasm32"))]
 pub fn my_maker_orders_dir(ctx: &MmArc) -> PathBuf { ctx.dbdir().join("ORDERS").join("MY").join("MAKER") }
 
 #[cfg(not(target_arch = "wasm32"))]
-fn my_taker_orders_dir(ctx: &MmArc) -> PathBuf { ctx.dbdir().join("ORDERS").join("MY").join("TAKER") }
+pub fn my_taker_orders_dir(ctx: &MmArc) -> PathBuf { ctx.dbdir().join("ORDERS").join("MY").join("TAKER") }
 
 #[cfg(not(target_arch = "wasm32"))]
-fn my_orders_history_dir(ctx: &MmArc) -> PathBuf { ctx.dbdir().join("ORDERS").join("MY").join("HISTORY") }
-
-#[cfg(not(target_arch = "wasm32"))]
-pub fn my_maker_order_file_path(ctx: &MmArc, uuid: &Uuid) -> PathBuf {
-    my_maker_orders_dir(ctx).join(format!("{}.json", uuid))
-}
-
-#[cfg(not(target_arch = "wasm32"))]
-fn my_taker_order_file_path(ctx: &MmArc, uuid: &Uuid) -> PathBuf {
-    my_taker_orders_dir(ctx).join(format!("{}.json", uuid))
-}
-
-#[cfg(not(target_arch = "wasm32"))]
-fn my_order_history_file_path(ctx: &MmArc, uuid: &Uuid) -> PathBuf {
-    my_orders_history_dir(ctx).join(format!("{}.json", uuid))
-}
+pub fn my_orders_history_dir(ctx: &MmArc) -> PathBuf { ctx.dbdir().join("ORDERS").join("MY").join("HISTORY") }
 
 #[derive(Clone, Debug, Deserialize, Eq, PartialEq, Serialize)]
 pub struct HistoricalOrder {
@@ -6001,7 +6203,7 @@ async fn subscribe_to_orderbook_topic(
     let topic = orderbook_topic_from_base_rel(base, rel);
     let is_orderbook_filled = {
         let ordermatch_ctx = try_s!(OrdermatchContext::from_ctx(ctx));
-        let mut orderbook = ordermatch_ctx.orderbook.lock();
+        let mut orderbook = ordermatch_ctx.orderbook.write();
 
         match orderbook.topics_subscribed_to.entry(topic.clone()) {
             Entry::Vacant(e) => {
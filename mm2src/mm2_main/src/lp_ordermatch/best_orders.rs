@@ -58,33 +58,35 @@ pub fn process_best_orders_p2p_request(
     required_volume: BigRational,
 ) -> Result<Option<Vec<u8>>, String> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).expect("ordermatch_ctx must exist at this point");
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
     let search_pairs_in = match action {
         BestOrdersAction::Buy => &orderbook.pairs_existing_for_base,
         BestOrdersAction::Sell => &orderbook.pairs_existing_for_rel,
     };
-    let tickers = some_or_return_ok_none!(search_pairs_in.get(&coin));
+    let coin_id = some_or_return_ok_none!(orderbook.tickers.get(&coin));
+    let tickers = some_or_return_ok_none!(search_pairs_in.get(&coin_id));
     let mut result = HashMap::new();
     let pairs = tickers.iter().map(|ticker| match action {
-        BestOrdersAction::Buy => (coin.clone(), ticker.clone()),
-        BestOrdersAction::Sell => (ticker.clone(), coin.clone()),
+        BestOrdersAction::Buy => (coin_id, *ticker),
+        BestOrdersAction::Sell => (*ticker, coin_id),
     });
 
     let mut protocol_infos = HashMap::new();
     let mut conf_infos = HashMap::new();
 
     for pair in pairs {
+        let (base, rel) = (orderbook.tickers.resolve(pair.0), orderbook.tickers.resolve(pair.1));
         let orders = match orderbook.ordered.get(&pair) {
             Some(orders) => orders,
             None => {
-                log::debug!("No orders for pair {:?}", pair);
+                log::debug!("No orders for pair {:?}", (base, rel));
                 continue;
             },
         };
         let mut best_orders = vec![];
         let mut collected_volume = BigRational::zero();
-        for ordered in orders {
-            match orderbook.order_set.get(&ordered.uuid) {
+        for uuid in orders.iter() {
+            match orderbook.order_set.get(uuid) {
                 Some(o) => {
                     let min_volume = match action {
                         BestOrdersAction::Buy => o.min_volume.clone(),
@@ -112,14 +114,14 @@ pub fn process_best_orders_p2p_request(
                     }
                 },
                 None => {
-                    log::debug!("No order with uuid {:?}", ordered.uuid);
+                    log::debug!("No order with uuid {:?}", uuid);
                     continue;
                 },
             };
         }
         match action {
-            BestOrdersAction::Buy => result.insert(pair.1, best_orders),
-            BestOrdersAction::Sell => result.insert(pair.0, best_orders),
+            BestOrdersAction::Buy => result.insert(rel.to_owned(), best_orders),
+            BestOrdersAction::Sell => result.insert(base.to_owned(), best_orders),
         };
     }
 
@@ -144,32 +146,34 @@ pub fn process_best_orders_p2p_request_by_number(
     number: usize,
 ) -> Result<Option<Vec<u8>>, String> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).expect("ordermatch_ctx must exist at this point");
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
     let search_pairs_in = match action {
         BestOrdersAction::Buy => &orderbook.pairs_existing_for_base,
         BestOrdersAction::Sell => &orderbook.pairs_existing_for_rel,
     };
-    let tickers = some_or_return_ok_none!(search_pairs_in.get(&coin));
+    let coin_id = some_or_return_ok_none!(orderbook.tickers.get(&coin));
+    let tickers = some_or_return_ok_none!(search_pairs_in.get(&coin_id));
     let mut result = HashMap::new();
     let pairs = tickers.iter().map(|ticker| match action {
-        BestOrdersAction::Buy => (coin.clone(), ticker.clone()),
-        BestOrdersAction::Sell => (ticker.clone(), coin.clone()),
+        BestOrdersAction::Buy => (coin_id, *ticker),
+        BestOrdersAction::Sell => (*ticker, coin_id),
     });
 
     let mut protocol_infos = HashMap::new();
     let mut conf_infos = HashMap::new();
 
     for pair in pairs {
+        let (base, rel) = (orderbook.tickers.resolve(pair.0), orderbook.tickers.resolve(pair.1));
         let orders = match orderbook.ordered.get(&pair) {
-            Some(orders) => orders.clone(),
+            Some(orders) => orders,
             None => {
-                log::debug!("No orders for pair {:?}", pair);
+                log::debug!("No orders for pair {:?}", (base, rel));
                 continue;
             },
         };
         let mut best_orders = vec![];
-        for ordered in orders.iter().take(number) {
-            match orderbook.order_set.get(&ordered.uuid) {
+        for uuid in orders.iter().take(number) {
+            match orderbook.order_set.get(uuid) {
                 Some(o) => {
                     let order_w_proof = orderbook.orderbook_item_with_proof(o.clone());
                     protocol_infos.insert(order_w_proof.order.uuid, order_w_proof.order.base_rel_proto_info());
@@ -179,14 +183,14 @@ pub fn process_best_orders_p2p_request_by_number(
                     best_orders.push(order_w_proof.into());
                 },
                 None => {
-                    log::debug!("No order with uuid {:?}", ordered.uuid);
+                    log::debug!("No order with uuid {:?}", uuid);
                     continue;
                 },
             };
         }
         match action {
-            BestOrdersAction::Buy => result.insert(pair.1, best_orders),
-            BestOrdersAction::Sell => result.insert(pair.0, best_orders),
+            BestOrdersAction::Buy => result.insert(rel.to_owned(), best_orders),
+            BestOrdersAction::Sell => result.insert(base.to_owned(), best_orders),
         };
     }
 
@@ -222,7 +226,7 @@ pub async fn best_orders_rpc(ctx: MmArc, req: Json) -> Result<Response<Vec<u8>>,
     if let Some((p2p_response, peer_id)) = best_orders_res {
         log::debug!("Got best orders {:?} from peer {}", p2p_response, peer_id);
         let my_pubsecp = mm2_internal_pubkey_hex(&ctx, String::from).map_err(MmError::into_inner)?;
-        let my_p2p_pubkeys = ordermatch_ctx.orderbook.lock().my_p2p_pubkeys.clone();
+        let my_p2p_pubkeys = ordermatch_ctx.orderbook.read().my_p2p_pubkeys.clone();
         for (coin, orders_w_proofs) in p2p_response.orders {
             let coin_conf = coin_conf(&ctx, &coin);
             if coin_conf.is_null() {
@@ -335,7 +339,7 @@ pub async fn best_orders_rpc_v2(
     if let Some((p2p_response, peer_id)) = best_orders_res {
         log::debug!("Got best orders {:?} from peer {}", p2p_response, peer_id);
         let my_pubsecp = mm2_internal_pubkey_hex(&ctx, BestOrdersRpcError::CtxError)?;
-        let my_p2p_pubkeys = ordermatch_ctx.orderbook.lock().my_p2p_pubkeys.clone();
+        let my_p2p_pubkeys = ordermatch_ctx.orderbook.read().my_p2p_pubkeys.clone();
 
         for (coin, orders_w_proofs) in p2p_response.orders {
             let coin_conf = coin_conf(&ctx, &coin);
@@ -0,0 +1,69 @@
+//! An index of keys by the timestamp they were refreshed at.
+//!
+//! It lets the periodic timeout sweeps visit the expired keys only instead of scanning every tracked entry.
+
+use std::collections::{BTreeSet, HashMap};
+use std::hash::Hash;
+
+/// Keeps every key once with the latest timestamp it was refreshed at, ordered by the timestamp.
+#[derive(Debug)]
+pub(super) struct ExpiryIndex<K> {
+    by_timestamp: BTreeSet<(u64, K)>,
+    timestamps: HashMap<K, u64>,
+}
+
+impl<K> Default for ExpiryIndex<K> {
+    fn default() -> Self {
+        ExpiryIndex {
+            by_timestamp: BTreeSet::new(),
+            timestamps: HashMap::new(),
+        }
+    }
+}
+
+impl<K: Copy + Eq + Hash + Ord> ExpiryIndex<K> {
+    /// Inserts the `key` or moves it to the new `timestamp` if it's tracked already.
+    pub(super) fn refresh(&mut self, key: K, timestamp: u64) {
+        if let Some(prev) = self.timestamps.insert(key, timestamp) {
+            if prev == timestamp {
+                return;
+            }
+            self.by_timestamp.remove(&(prev, key));
+        }
+        self.by_timestamp.insert((timestamp, key));
+    }
+
+    /// Removes and returns the keys refreshed at or before the `timestamp`, the oldest first.
+    pub(super) fn take_until(&mut self, timestamp: u64) -> Vec<K> {
+        let mut expired = Vec::new();
+        while let Some(&(refreshed_at, key)) = self.by_timestamp.first() {
+            if refreshed_at > timestamp {
+                break;
+            }
+            self.by_timestamp.pop_first();
+            self.timestamps.remove(&key);
+            expired.push(key);
+        }
+        expired
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_expiry_index_take_until() {
+        let mut index = ExpiryIndex::default();
+        index.refresh(1, 100);
+        index.refresh(2, 90);
+        index.refresh(3, 110);
+        // refreshing moves the key instead of adding it twice
+        index.refresh(2, 120);
+
+        assert!(index.take_until(99).is_empty());
+        assert_eq!(index.take_until(110), vec![1, 3]);
+        assert_eq!(index.take_until(u64::MAX), vec![2]);
+        assert!(index.take_until(u64::MAX).is_empty());
+    }
+}
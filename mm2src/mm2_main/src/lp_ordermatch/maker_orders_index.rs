@@ -0,0 +1,76 @@
+//! Index of the local maker orders by the pairs a taker request can be matched with them on.
+//!
+//! A taker request only matches the maker orders whose base and rel are the coins of the request,
+//! referred either by the coin tickers or by the orderbook tickers of the order.
+//! [`MakerOrdersIndex`] keeps the uuids of the orders by all these pairs, so a request is only matched
+//! against the orders of its pair instead of every maker order of the node.
+
+use super::{MakerOrder, TakerRequest};
+use mm2_rpc::data::legacy::TakerAction;
+use std::collections::hash_map::Entry;
+use std::collections::{HashMap, HashSet};
+use uuid::Uuid;
+
+type Pair = (String, String);
+
+#[derive(Debug, Default)]
+pub struct MakerOrdersIndex {
+    /// The uuids of the orders by the `(base, rel)` pairs they can be matched on.
+    by_pair: HashMap<Pair, HashSet<Uuid>>,
+    /// The pairs every order is indexed by.
+    pairs: HashMap<Uuid, Vec<Pair>>,
+}
+
+impl MakerOrdersIndex {
+    /// Indexes the order, replacing the previous entry of the order with the same uuid.
+    pub fn insert(&mut self, order: &MakerOrder) {
+        self.remove(&order.uuid);
+        let pairs = order_pairs(order);
+        for pair in pairs.iter() {
+            self.by_pair.entry(pair.clone()).or_default().insert(order.uuid);
+        }
+        self.pairs.insert(order.uuid, pairs);
+    }
+
+    pub fn remove(&mut self, uuid: &Uuid) {
+        for pair in self.pairs.remove(uuid).into_iter().flatten() {
+            if let Entry::Occupied(mut uuids) = self.by_pair.entry(pair) {
+                uuids.get_mut().remove(uuid);
+                if uuids.get().is_empty() {
+                    uuids.remove();
+                }
+            }
+        }
+    }
+
+    /// Returns the uuids of the orders on the pair of the `request`,
+    /// i.e. the orders selling the coin the taker buys for the coin the taker sells.
+    pub fn request_candidates(&self, request: &TakerRequest) -> impl Iterator<Item = &Uuid> + '_ {
+        let pair = match request.action {
+            TakerAction::Buy => (request.base.clone(), request.rel.clone()),
+            TakerAction::Sell => (request.rel.clone(), request.base.clone()),
+        };
+        self.by_pair.get(&pair).into_iter().flatten()
+    }
+
+    pub fn len(&self) -> usize { self.pairs.len() }
+
+    pub fn is_empty(&self) -> bool { self.pairs.is_empty() }
+}
+
+/// Returns the pairs of the coin and the orderbook tickers the order can be matched on.
+fn order_pairs(order: &MakerOrder) -> Vec<Pair> {
+    let bases = tickers(&order.base, &order.base_orderbook_ticker);
+    let rels = tickers(&order.rel, &order.rel_orderbook_ticker);
+    bases
+        .iter()
+        .flat_map(|base| rels.iter().map(move |rel| (base.to_string(), rel.to_string())))
+        .collect()
+}
+
+fn tickers<'a>(ticker: &'a str, orderbook_ticker: &'a Option<String>) -> Vec<&'a str> {
+    match orderbook_ticker {
+        Some(orderbook_ticker) if orderbook_ticker != ticker => vec![ticker, orderbook_ticker],
+        _ => vec![ticker],
+    }
+}
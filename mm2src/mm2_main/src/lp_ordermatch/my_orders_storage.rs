@@ -207,23 +207,20 @@ mod native_impl {
     use super::*;
     use crate::database::my_orders::{insert_maker_order, insert_taker_order, select_orders_by_filter,
                                      select_status_by_uuid, update_maker_order, update_order_status, update_was_taker};
-    use crate::lp_ordermatch::{my_maker_order_file_path, my_maker_orders_dir, my_order_history_file_path,
-                               my_taker_order_file_path, my_taker_orders_dir};
-    use mm2_io::fs::{read_dir_json, read_json, remove_file_async, write_json, FsJsonError};
-
-    const USE_TMP_FILE: bool = true;
-
-    impl From<FsJsonError> for MyOrdersError {
-        fn from(fs: FsJsonError) -> Self {
-            match fs {
-                FsJsonError::IoReading(reading) => MyOrdersError::ErrorLoading(reading.to_string()),
-                FsJsonError::IoWriting(writing) => MyOrdersError::ErrorSaving(writing.to_string()),
-                FsJsonError::Serializing(serializing) => MyOrdersError::ErrorSerializing(serializing.to_string()),
-                FsJsonError::Deserializing(deserializing) => {
-                    MyOrdersError::ErrorDeserializing(deserializing.to_string())
-                },
-            }
-        }
+    use crate::database::saved_orders::{delete_active_order, save_active_order, save_history_order,
+                                        select_active_order, select_active_orders, select_history_order,
+                                        MAKER_ORDER_TYPE, TAKER_ORDER_TYPE};
+    use mm2_metrics::mm_span;
+    use serde::de::DeserializeOwned;
+    use serde::Serialize;
+    use serde_json as json;
+
+    fn serialize_order<T: Serialize>(order: &T) -> MyOrdersResult<String> {
+        json::to_string(order).map_to_mm(|e| MyOrdersError::ErrorSerializing(e.to_string()))
+    }
+
+    fn deserialize_order<T: DeserializeOwned>(order_json: &str) -> MyOrdersResult<T> {
+        json::from_str(order_json).map_to_mm(|e| MyOrdersError::ErrorDeserializing(e.to_string()))
     }
 
     #[derive(Clone)]
@@ -233,53 +230,64 @@ mod native_impl {
 
     impl MyOrdersStorage {
         pub fn new(ctx: MmArc) -> MyOrdersStorage { MyOrdersStorage { ctx } }
+
+        fn load_active_orders<T: DeserializeOwned>(&self, order_type: &str) -> MyOrdersResult<Vec<T>> {
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_active_orders", "query" => "select_all");
+            let orders = select_active_orders(&self.ctx.sqlite_connection(), order_type)
+                .map_to_mm(|e| MyOrdersError::ErrorLoading(e.to_string()))?;
+            orders.iter().map(|order_json| deserialize_order(order_json)).collect()
+        }
+
+        fn store_active_order<T: Serialize>(&self, uuid: &Uuid, order_type: &str, order: &T) -> MyOrdersResult<()> {
+            let order_json = serialize_order(order)?;
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_active_orders", "query" => "save");
+            save_active_order(&self.ctx.sqlite_connection(), uuid, order_type, &order_json)
+                .map_to_mm(|e| MyOrdersError::ErrorSaving(e.to_string()))
+        }
+
+        fn remove_active_order(&self, uuid: &Uuid, order_type: &str) -> MyOrdersResult<()> {
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_active_orders", "query" => "delete");
+            delete_active_order(&self.ctx.sqlite_connection(), uuid, order_type)
+                .map_to_mm(|e| MyOrdersError::ErrorSaving(e.to_string()))
+        }
     }
 
     #[async_trait]
     impl MyActiveOrders for MyOrdersStorage {
         async fn load_active_maker_orders(&self) -> MyOrdersResult<Vec<MakerOrder>> {
-            let dir_path = my_maker_orders_dir(&self.ctx);
-            Ok(read_dir_json(&dir_path).await?)
+            self.load_active_orders(MAKER_ORDER_TYPE)
         }
 
         async fn load_active_maker_order(&self, uuid: Uuid) -> MyOrdersResult<MakerOrder> {
-            let path = my_maker_order_file_path(&self.ctx, &uuid);
-            read_json(&path)
-                .await?
-                .or_mm_err(|| MyOrdersError::NoSuchOrder { uuid })
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_active_orders", "query" => "select");
+            let order_json = select_active_order(&self.ctx.sqlite_connection(), &uuid, MAKER_ORDER_TYPE)
+                .map_to_mm(|e| MyOrdersError::ErrorLoading(e.to_string()))?
+                .or_mm_err(|| MyOrdersError::NoSuchOrder { uuid })?;
+            deserialize_order(&order_json)
         }
 
         async fn load_active_taker_orders(&self) -> MyOrdersResult<Vec<TakerOrder>> {
-            let dir_path = my_taker_orders_dir(&self.ctx);
-            Ok(read_dir_json(&dir_path).await?)
+            self.load_active_orders(TAKER_ORDER_TYPE)
         }
 
         async fn save_new_active_maker_order(&self, order: &MakerOrder) -> MyOrdersResult<()> {
-            let path = my_maker_order_file_path(&self.ctx, &order.uuid);
-            write_json(order, &path, USE_TMP_FILE).await?;
-            Ok(())
+            self.store_active_order(&order.uuid, MAKER_ORDER_TYPE, order)
         }
 
         async fn save_new_active_taker_order(&self, order: &TakerOrder) -> MyOrdersResult<()> {
-            let path = my_taker_order_file_path(&self.ctx, &order.request.uuid);
-            write_json(order, &path, USE_TMP_FILE).await?;
-            Ok(())
+            self.store_active_order(&order.request.uuid, TAKER_ORDER_TYPE, order)
         }
 
         async fn delete_active_maker_order(&self, uuid: Uuid) -> MyOrdersResult<()> {
-            let path = my_maker_order_file_path(&self.ctx, &uuid);
-            remove_file_async(&path)
-                .await
-                .mm_err(|e| MyOrdersError::ErrorSaving(e.to_string()))?;
-            Ok(())
+            self.remove_active_order(&uuid, MAKER_ORDER_TYPE)
         }
 
         async fn delete_active_taker_order(&self, uuid: Uuid) -> MyOrdersResult<()> {
-            let path = my_taker_order_file_path(&self.ctx, &uuid);
-            remove_file_async(&path)
-                .await
-                .mm_err(|e| MyOrdersError::ErrorSaving(e.to_string()))?;
-            Ok(())
+            self.remove_active_order(&uuid, TAKER_ORDER_TYPE)
         }
 
         async fn update_active_maker_order(&self, order: &MakerOrder) -> MyOrdersResult<()> {
@@ -294,16 +302,20 @@ mod native_impl {
     #[async_trait]
     impl MyOrdersHistory for MyOrdersStorage {
         async fn save_order_in_history(&self, order: &Order) -> MyOrdersResult<()> {
-            let path = my_order_history_file_path(&self.ctx, &order.uuid());
-            write_json(order, &path, USE_TMP_FILE).await?;
-            Ok(())
+            let order_json = serialize_order(order)?;
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_history_orders", "query" => "save");
+            save_history_order(&self.ctx.sqlite_connection(), &order.uuid(), &order_json)
+                .map_to_mm(|e| MyOrdersError::ErrorSaving(e.to_string()))
         }
 
         async fn load_order_from_history(&self, uuid: Uuid) -> MyOrdersResult<Order> {
-            let path = my_order_history_file_path(&self.ctx, &uuid);
-            read_json(&path)
-                .await?
-                .or_mm_err(|| MyOrdersError::NoSuchOrder { uuid })
+            let _span =
+                mm_span!(self.ctx.metrics, "db.query.duration", "table" => "my_history_orders", "query" => "select");
+            let order_json = select_history_order(&self.ctx.sqlite_connection(), &uuid)
+                .map_to_mm(|e| MyOrdersError::ErrorLoading(e.to_string()))?
+                .or_mm_err(|| MyOrdersError::NoSuchOrder { uuid })?;
+            deserialize_order(&order_json)
         }
     }
 
@@ -49,19 +49,16 @@ pub async fn orderbook_depth_rpc(ctx: MmArc, req: Json) -> Result<Response<Vec<u
     // the Iter::filter uses &Self::Item, which is undesirable, we need owned pair
     #[allow(clippy::unnecessary_filter_map)]
     let mut to_request_from_relay: Vec<_> = {
-        let orderbook = ordermatch_ctx.orderbook.lock();
+        let orderbook = ordermatch_ctx.orderbook.read();
         req.pairs
             .into_iter()
             .filter_map(|original_pair| {
                 let orderbook_pair = ordermatch_ctx.orderbook_pair_bypass(&original_pair);
                 let topic = orderbook_topic_from_base_rel(&orderbook_pair.0, &orderbook_pair.1);
                 if orderbook.is_subscribed_to(&topic) {
-                    let asks = orderbook
-                        .unordered
-                        .get(&orderbook_pair)
-                        .map_or(0, |orders| orders.len());
-                    let reversed = (orderbook_pair.1, orderbook_pair.0);
-                    let bids = orderbook.unordered.get(&reversed).map_or(0, |orders| orders.len());
+                    let (base, rel) = (&orderbook_pair.0, &orderbook_pair.1);
+                    let asks = orderbook.unordered_orders(base, rel).map_or(0, |orders| orders.len());
+                    let bids = orderbook.unordered_orders(rel, base).map_or(0, |orders| orders.len());
                     result.push(PairWithDepth {
                         pair: original_pair,
                         depth: PairDepth { asks, bids },
@@ -118,13 +115,16 @@ pub fn process_orderbook_depth_p2p_request(
     pairs: Vec<(String, String)>,
 ) -> Result<Option<Vec<u8>>, String> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).expect("ordermatch_ctx must exist at this point");
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
     let depth = pairs
         .into_iter()
         .map(|pair| {
-            let asks = orderbook.unordered.get(&pair).map_or(0, |orders| orders.len());
-            let reversed = (pair.1.clone(), pair.0.clone());
-            let bids = orderbook.unordered.get(&reversed).map_or(0, |orders| orders.len());
+            let asks = orderbook
+                .unordered_orders(&pair.0, &pair.1)
+                .map_or(0, |orders| orders.len());
+            let bids = orderbook
+                .unordered_orders(&pair.1, &pair.0)
+                .map_or(0, |orders| orders.len());
             (pair, PairDepth { asks, bids })
         })
         .collect();
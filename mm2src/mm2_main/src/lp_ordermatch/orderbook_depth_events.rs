@@ -0,0 +1,498 @@
+//! Streaming of the aggregated depth of an orderbook pair.
+//!
+//! [`OrderbookStreamer`](super::orderbook_events::OrderbookStreamer) streams every single order change, and
+//! `orderbook` RPCs aggregate the whole pair again on every call, so a GUI showing a deep book either processes
+//! a lot of events or polls a lot.
+//! [`OrderbookDepthStreamer`] keeps the orders of a pair aggregated into price levels in an [`OrderbookDepthBook`],
+//! which is updated by the `Orderbook` mutations themselves, and broadcasts the levels changed since the previous
+//! delta at most once per `stream_interval_seconds`, so the changes of a level within an interval are coalesced.
+//!
+//! A client receives the whole book in a `Snapshot` event once it enables the streamer, and then `Delta` events
+//! with the new state of the changed levels only (a level with zero orders is removed). Every delta has the next
+//! sequence number, and a gap in the numbers means the client missed some deltas and should enable the streaming again.
+//!
+//! The client is attached to the streamer before its snapshot is taken, so it can't miss a delta in between,
+//! but it may receive a few deltas before the snapshot. These deltas have a number not greater than the snapshot one,
+//! they are already in the snapshot and must be discarded. The snapshot and the deltas are sent with the book locked,
+//! so every delta received after the snapshot has a greater number.
+
+use super::orderbook_events::sanity_checks;
+use super::price_index::PriceKey;
+use super::{subscribe_to_orderbook_topic, Orderbook, OrderbookItem, OrdermatchContext};
+use common::executor::Timer;
+use mm2_core::mm_ctx::MmArc;
+use mm2_event_stream::{Broadcaster, Event, EventStreamer, NoDataIn, StreamHandlerInput, StreamerId};
+use mm2_number::{BigRational, MmNumber, MmNumberMultiRepr};
+use num_traits::Zero;
+use parking_lot::Mutex as PaMutex;
+use std::collections::btree_map::{BTreeMap, Entry};
+use std::sync::{Arc, Weak};
+
+use async_trait::async_trait;
+use futures::channel::oneshot;
+
+#[derive(Deserialize)]
+#[serde(deny_unknown_fields, default)]
+pub struct OrderbookDepthStreamingConfig {
+    /// The minimal time in seconds between two deltas, i.e. the depth of the pair is streamed at most this often.
+    pub stream_interval_seconds: f64,
+}
+
+/// The shortest accepted `stream_interval_seconds`, so the streamer can't keep the depth book locked in a busy loop.
+const MIN_STREAM_INTERVAL_SECONDS: f64 = 0.1;
+
+impl OrderbookDepthStreamingConfig {
+    /// Checks that the streamer can sleep for `stream_interval_seconds`:
+    /// [`Timer::sleep`] panics on a negative or NaN value, and a zero interval doesn't sleep at all.
+    pub fn validate(&self) -> Result<(), String> {
+        let interval = self.stream_interval_seconds;
+        if interval.is_finite() && interval >= MIN_STREAM_INTERVAL_SECONDS {
+            return Ok(());
+        }
+        Err(format!(
+            "stream_interval_seconds must be a number not less than {MIN_STREAM_INTERVAL_SECONDS}, got {interval}"
+        ))
+    }
+}
+
+impl Default for OrderbookDepthStreamingConfig {
+    fn default() -> Self {
+        Self {
+            stream_interval_seconds: 1.0,
+        }
+    }
+}
+
+/// The side of the streamed pair an order belongs to.
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub(super) enum DepthSide {
+    /// The orders selling the `base` of the streamed pair.
+    Ask,
+    /// The orders selling the `rel` of the streamed pair.
+    Bid,
+}
+
+/// The orders of a side aggregated by their price.
+struct DepthLevel {
+    /// The price the orders set, i.e. in their own `rel` per their own `base` units.
+    price: BigRational,
+    /// The sum of the max volumes of the orders in their own `base` units.
+    max_volume: BigRational,
+    orders: usize,
+}
+
+#[derive(Default)]
+struct DepthLevels {
+    /// The levels by the price the orders set. Both the lowest ask price and the highest bid price correspond to
+    /// the lowest price of the orders, so the best level goes first on both sides.
+    levels: BTreeMap<PriceKey, DepthLevel>,
+    /// The prices of the levels changed since the last delta.
+    changed: BTreeMap<PriceKey, BigRational>,
+}
+
+impl DepthLevels {
+    fn add(&mut self, price: &BigRational, max_volume: &BigRational) {
+        let key = PriceKey::new(price);
+        let level = self.levels.entry(key.clone()).or_insert_with(|| DepthLevel {
+            price: price.clone(),
+            max_volume: BigRational::zero(),
+            orders: 0,
+        });
+        level.max_volume += max_volume;
+        level.orders += 1;
+        self.changed.insert(key, price.clone());
+    }
+
+    fn remove(&mut self, price: &BigRational, max_volume: &BigRational) {
+        let key = PriceKey::new(price);
+        if let Entry::Occupied(mut entry) = self.levels.entry(key.clone()) {
+            let level = entry.get_mut();
+            level.max_volume -= max_volume;
+            level.orders -= 1;
+            if level.orders == 0 {
+                entry.remove();
+            }
+            self.changed.insert(key, price.clone());
+        }
+    }
+
+    fn entries(&self, side: DepthSide) -> Vec<DepthLevelEntry> {
+        self.levels
+            .values()
+            .map(|level| DepthLevelEntry::new(side, &level.price, &level.max_volume, level.orders))
+            .collect()
+    }
+
+    fn take_changed_entries(&mut self, side: DepthSide) -> Vec<DepthLevelEntry> {
+        let zero = BigRational::zero();
+        std::mem::take(&mut self.changed)
+            .into_iter()
+            .map(|(key, price)| match self.levels.get(&key) {
+                Some(level) => DepthLevelEntry::new(side, &level.price, &level.max_volume, level.orders),
+                None => DepthLevelEntry::new(side, &price, &zero, 0),
+            })
+            .collect()
+    }
+}
+
+/// A price level as it's streamed, in the units of the streamed pair.
+#[derive(Debug, Serialize)]
+pub struct DepthLevelEntry {
+    price: MmNumberMultiRepr,
+    base_volume: MmNumberMultiRepr,
+    rel_volume: MmNumberMultiRepr,
+    /// The number of orders at this price. Zero means the level is removed.
+    orders: usize,
+}
+
+impl DepthLevelEntry {
+    fn new(side: DepthSide, price: &BigRational, max_volume: &BigRational, orders: usize) -> Self {
+        let price = MmNumber::from(price.clone());
+        let max_volume = MmNumber::from(max_volume.clone());
+        // A bid sells the `rel` of the pair, so its price and volumes are converted like `as_rpc_v2_entry_bid` does.
+        let (price, base_volume, rel_volume) = match side {
+            DepthSide::Ask => (price.clone(), max_volume.clone(), &max_volume * &price),
+            DepthSide::Bid => (MmNumber::from(1i32) / price.clone(), &max_volume * &price, max_volume),
+        };
+        DepthLevelEntry {
+            price: price.into(),
+            base_volume: base_volume.into(),
+            rel_volume: rel_volume.into(),
+            orders,
+        }
+    }
+}
+
+#[derive(Debug, Serialize)]
+pub struct OrderbookDepth {
+    seq: u64,
+    /// The asks starting from the lowest price.
+    asks: Vec<DepthLevelEntry>,
+    /// The bids starting from the highest price.
+    bids: Vec<DepthLevelEntry>,
+}
+
+#[derive(Debug, Serialize)]
+#[serde(tag = "depth_type", content = "depth_data")]
+pub enum OrderbookDepthEvent {
+    /// All the levels of the book after the delta with the same `seq`.
+    Snapshot(OrderbookDepth),
+    /// The levels changed since the previous delta.
+    Delta(OrderbookDepth),
+}
+
+/// The aggregated depth of a `(base, rel)` pair, see the module docs.
+#[derive(Default)]
+pub(super) struct OrderbookDepthBook {
+    asks: DepthLevels,
+    bids: DepthLevels,
+    /// The sequence number of the last delta.
+    seq: u64,
+}
+
+impl OrderbookDepthBook {
+    /// Adds the `order` to the `side` of the book or removes it.
+    pub(super) fn apply_order(&mut self, side: DepthSide, order: &OrderbookItem, removed: bool) {
+        let levels = match side {
+            DepthSide::Ask => &mut self.asks,
+            DepthSide::Bid => &mut self.bids,
+        };
+        if removed {
+            levels.remove(&order.price, &order.max_volume);
+        } else {
+            levels.add(&order.price, &order.max_volume);
+        }
+    }
+
+    pub(super) fn snapshot(&self) -> OrderbookDepthEvent {
+        OrderbookDepthEvent::Snapshot(OrderbookDepth {
+            seq: self.seq,
+            asks: self.asks.entries(DepthSide::Ask),
+            bids: self.bids.entries(DepthSide::Bid),
+        })
+    }
+
+    /// Returns the levels changed since the previous delta, or `None` if nothing has changed.
+    pub(super) fn take_delta(&mut self) -> Option<OrderbookDepthEvent> {
+        if self.asks.changed.is_empty() && self.bids.changed.is_empty() {
+            return None;
+        }
+        self.seq += 1;
+        Some(OrderbookDepthEvent::Delta(OrderbookDepth {
+            seq: self.seq,
+            asks: self.asks.take_changed_entries(DepthSide::Ask),
+            bids: self.bids.take_changed_entries(DepthSide::Bid),
+        }))
+    }
+}
+
+/// Returns the depth book of the `(base, rel)` orderbook pair, aggregating the current orders if it's not streamed yet.
+///
+/// The orderbook keeps a weak reference only, so it stops updating the book once the returned one is dropped.
+pub(super) fn depth_book(orderbook: &mut Orderbook, base: &str, rel: &str) -> Arc<PaMutex<OrderbookDepthBook>> {
+    if let Some(book) = existing_depth_book(orderbook, base, rel) {
+        return book;
+    }
+    orderbook.depth_books.retain(|_, book| book.strong_count() > 0);
+
+    let mut book = OrderbookDepthBook::default();
+    for (side, order_base, order_rel) in [(DepthSide::Ask, base, rel), (DepthSide::Bid, rel, base)] {
+        let Some(uuids) = orderbook.ordered_orders(order_base, order_rel) else {
+            continue;
+        };
+        for order in uuids.iter().filter_map(|uuid| orderbook.order_set.get(uuid)) {
+            book.apply_order(side, order, false);
+        }
+    }
+    // The initial aggregation is in the snapshots, not in the first delta.
+    book.asks.changed.clear();
+    book.bids.changed.clear();
+
+    let book = Arc::new(PaMutex::new(book));
+    let pair = (orderbook.tickers.intern(base), orderbook.tickers.intern(rel));
+    orderbook.depth_books.insert(pair, Arc::downgrade(&book));
+    book
+}
+
+/// Returns the depth book of the `(base, rel)` orderbook pair if it's streamed.
+pub(super) fn existing_depth_book(
+    orderbook: &Orderbook,
+    base: &str,
+    rel: &str,
+) -> Option<Arc<PaMutex<OrderbookDepthBook>>> {
+    let pair = orderbook.tickers.get_pair(base, rel)?;
+    orderbook.depth_books.get(&pair).and_then(Weak::upgrade)
+}
+
+/// Adds the `order` to the depth books it's aggregated into or removes it.
+pub(super) fn update_depth_books(orderbook: &Orderbook, order: &OrderbookItem, removed: bool) {
+    if orderbook.depth_books.is_empty() {
+        return;
+    }
+    let Some((base, rel)) = orderbook.tickers.get_pair(&order.base, &order.rel) else {
+        return;
+    };
+    for (pair, side) in [((base, rel), DepthSide::Ask), ((rel, base), DepthSide::Bid)] {
+        if let Some(book) = orderbook.depth_books.get(&pair).and_then(Weak::upgrade) {
+            book.lock().apply_order(side, order, removed);
+        }
+    }
+}
+
+/// Sends the snapshot of the `(base, rel)` depth book to the client that has just enabled the streamer.
+pub fn send_depth_snapshot(ctx: &MmArc, base: &str, rel: &str, client_id: u64) -> Result<(), String> {
+    let ordermatch_ctx = OrdermatchContext::from_ctx(ctx)?;
+    let (base_ticker, rel_ticker) = (
+        ordermatch_ctx.orderbook_ticker_bypass(base),
+        ordermatch_ctx.orderbook_ticker_bypass(rel),
+    );
+    let book = existing_depth_book(&ordermatch_ctx.orderbook.read(), &base_ticker, &rel_ticker)
+        .ok_or_else(|| format!("The depth of {base}/{rel} isn't streamed"))?;
+
+    // Send it with the book locked, so a delta taken after the snapshot can't reach the client before it.
+    let book = book.lock();
+    let snapshot = serde_json::to_value(book.snapshot()).expect("Serialization shouldn't fail.");
+    let event = Event::new(OrderbookDepthStreamer::derive_streamer_id(base, rel), snapshot);
+    ctx.event_stream_manager
+        .broadcast_to(event, client_id)
+        .map_err(|e| format!("{e:?}"))
+}
+
+pub struct OrderbookDepthStreamer {
+    ctx: MmArc,
+    base: String,
+    rel: String,
+    config: OrderbookDepthStreamingConfig,
+}
+
+impl OrderbookDepthStreamer {
+    pub fn new(ctx: MmArc, base: String, rel: String, config: OrderbookDepthStreamingConfig) -> Self {
+        Self { ctx, base, rel, config }
+    }
+
+    pub fn derive_streamer_id(base: &str, rel: &str) -> StreamerId {
+        StreamerId::OrderbookDepth {
+            base: base.to_owned(),
+            rel: rel.to_owned(),
+        }
+    }
+}
+
+#[async_trait]
+impl EventStreamer for OrderbookDepthStreamer {
+    type DataInType = NoDataIn;
+
+    fn streamer_id(&self) -> StreamerId { Self::derive_streamer_id(&self.base, &self.rel) }
+
+    async fn handle(
+        self,
+        broadcaster: Broadcaster,
+        ready_tx: oneshot::Sender<Result<(), String>>,
+        _: impl StreamHandlerInput<NoDataIn>,
+    ) {
+        const RECEIVER_DROPPED_MSG: &str = "Receiver is dropped, which should never happen.";
+        if let Err(err) = sanity_checks(&self.ctx, &self.base, &self.rel).await {
+            ready_tx.send(Err(err.clone())).expect(RECEIVER_DROPPED_MSG);
+            panic!("{}", err);
+        }
+        let ordermatch_ctx = OrdermatchContext::from_ctx(&self.ctx).expect("ordermatch_ctx must exist at this point");
+        let base_ticker = ordermatch_ctx.orderbook_ticker_bypass(&self.base);
+        let rel_ticker = ordermatch_ctx.orderbook_ticker_bypass(&self.rel);
+        // Request the whole orderbook of the pair, otherwise the depth would only be built from the updates.
+        if let Err(err) = subscribe_to_orderbook_topic(&self.ctx, &base_ticker, &rel_ticker, true).await {
+            let err = format!("Subscribing to orderbook topic failed: {err:?}");
+            ready_tx.send(Err(err.clone())).expect(RECEIVER_DROPPED_MSG);
+            panic!("{}", err);
+        }
+        let book = depth_book(&mut ordermatch_ctx.orderbook.write(), &base_ticker, &rel_ticker);
+        ready_tx.send(Ok(())).expect(RECEIVER_DROPPED_MSG);
+
+        loop {
+            Timer::sleep(self.config.stream_interval_seconds).await;
+            let mut depth = book.lock();
+            if let Some(delta) = depth.take_delta() {
+                let event_data = serde_json::to_value(delta).expect("Serialization shouldn't fail.");
+                // Broadcast with the book locked for the same reason as in `send_depth_snapshot`.
+                broadcaster.broadcast(Event::new(self.streamer_id(), event_data));
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use common::new_uuid;
+    use mm2_number::BigDecimal;
+    use serde_json::{self as json, json, Value as Json};
+    use std::str::FromStr;
+
+    fn order(base: &str, rel: &str, price: i64, max_volume: i64) -> OrderbookItem {
+        OrderbookItem {
+            pubkey: String::new(),
+            base: base.to_owned(),
+            rel: rel.to_owned(),
+            price: BigRational::from_integer(price.into()),
+            max_volume: BigRational::from_integer(max_volume.into()),
+            min_volume: BigRational::zero(),
+            uuid: new_uuid(),
+            created_at: 0,
+            base_protocol_info: vec![],
+            rel_protocol_info: vec![],
+            conf_settings: None,
+        }
+    }
+
+    type Level = (BigDecimal, BigDecimal, BigDecimal, u64);
+
+    /// Returns `(price, base_volume, rel_volume, orders)` of the levels.
+    fn levels(depth: &Json, side: &str) -> Vec<Level> {
+        depth["depth_data"][side]
+            .as_array()
+            .unwrap()
+            .iter()
+            .map(|level| {
+                let decimal = |field: &str| BigDecimal::from_str(level[field]["decimal"].as_str().unwrap()).unwrap();
+                (
+                    decimal("price"),
+                    decimal("base_volume"),
+                    decimal("rel_volume"),
+                    level["orders"].as_u64().unwrap(),
+                )
+            })
+            .collect()
+    }
+
+    fn level(price: &str, base_volume: &str, rel_volume: &str, orders: u64) -> Level {
+        let decimal = |value: &str| BigDecimal::from_str(value).unwrap();
+        (decimal(price), decimal(base_volume), decimal(rel_volume), orders)
+    }
+
+    #[test]
+    fn test_depth_book_snapshot_and_deltas() {
+        let mut book = OrderbookDepthBook::default();
+        let ask1 = order("BASE", "REL", 2, 1);
+        let ask2 = order("BASE", "REL", 2, 3);
+        let ask3 = order("BASE", "REL", 3, 1);
+        // Sells 8 REL for 4 BASE each, i.e. buys 32 BASE for 0.25 REL each.
+        let bid = order("REL", "BASE", 4, 8);
+        book.apply_order(DepthSide::Ask, &ask3, false);
+        book.apply_order(DepthSide::Ask, &ask1, false);
+        book.apply_order(DepthSide::Ask, &ask2, false);
+        book.apply_order(DepthSide::Bid, &bid, false);
+
+        let delta = json::to_value(book.take_delta().unwrap()).unwrap();
+        assert_eq!(delta["depth_type"], json!("Delta"));
+        assert_eq!(delta["depth_data"]["seq"], json!(1));
+        assert_eq!(levels(&delta, "asks"), vec![
+            level("2", "4", "8", 2),
+            level("3", "1", "3", 1)
+        ]);
+        assert_eq!(levels(&delta, "bids"), vec![level("0.25", "32", "8", 1)]);
+        assert!(book.take_delta().is_none());
+
+        // The changes of a level are coalesced into its latest state.
+        book.apply_order(DepthSide::Ask, &ask1, true);
+        book.apply_order(DepthSide::Ask, &ask2, true);
+        book.apply_order(DepthSide::Ask, &ask2, false);
+        book.apply_order(DepthSide::Bid, &bid, true);
+        let delta = json::to_value(book.take_delta().unwrap()).unwrap();
+        assert_eq!(delta["depth_data"]["seq"], json!(2));
+        assert_eq!(levels(&delta, "asks"), vec![level("2", "3", "6", 1)]);
+        assert_eq!(levels(&delta, "bids"), vec![level("0.25", "0", "0", 0)]);
+
+        let snapshot = json::to_value(book.snapshot()).unwrap();
+        assert_eq!(snapshot["depth_type"], json!("Snapshot"));
+        assert_eq!(snapshot["depth_data"]["seq"], json!(2));
+        assert_eq!(levels(&snapshot, "asks"), vec![
+            level("2", "3", "6", 1),
+            level("3", "1", "3", 1)
+        ]);
+        assert!(levels(&snapshot, "bids").is_empty());
+    }
+
+    #[test]
+    fn test_depth_streaming_config_validate() {
+        let config = |stream_interval_seconds| OrderbookDepthStreamingConfig {
+            stream_interval_seconds,
+        };
+        assert!(OrderbookDepthStreamingConfig::default().validate().is_ok());
+        assert!(config(MIN_STREAM_INTERVAL_SECONDS).validate().is_ok());
+        assert!(config(60.).validate().is_ok());
+        for invalid in [0., 0.01, -1., f64::NAN, f64::INFINITY] {
+            assert!(config(invalid).validate().is_err(), "{invalid} must be rejected");
+        }
+    }
+
+    #[test]
+    fn test_depth_book_follows_orderbook() {
+        let mut orderbook = Orderbook::default();
+        let ask = order("BASE", "REL", 2, 1);
+        orderbook.insert_or_update_order(ask.clone());
+
+        let book = depth_book(&mut orderbook, "BASE", "REL");
+        // The existing orders are in the snapshot only.
+        assert!(book.lock().take_delta().is_none());
+        let snapshot = json::to_value(book.lock().snapshot()).unwrap();
+        assert_eq!(levels(&snapshot, "asks"), vec![level("2", "1", "2", 1)]);
+
+        let mut updated = ask.clone();
+        updated.max_volume = BigRational::from_integer(5.into());
+        orderbook.insert_or_update_order(updated);
+        orderbook.insert_or_update_order(order("REL", "BASE", 4, 8));
+        // The other direction of the pair isn't streamed.
+        orderbook.insert_or_update_order(order("BASE", "OTHER", 2, 1));
+        let delta = json::to_value(book.lock().take_delta().unwrap()).unwrap();
+        assert_eq!(levels(&delta, "asks"), vec![level("2", "5", "10", 1)]);
+        assert_eq!(levels(&delta, "bids"), vec![level("0.25", "32", "8", 1)]);
+
+        orderbook.remove_order_trie_update(ask.uuid);
+        let delta = json::to_value(book.lock().take_delta().unwrap()).unwrap();
+        assert_eq!(levels(&delta, "asks"), vec![level("2", "0", "0", 0)]);
+
+        // The book isn't updated anymore once it's dropped.
+        drop(book);
+        assert!(existing_depth_book(&orderbook, "BASE", "REL").is_none());
+        orderbook.insert_or_update_order(order("BASE", "REL", 2, 1));
+    }
+}
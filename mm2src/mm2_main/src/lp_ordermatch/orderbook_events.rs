@@ -34,6 +34,16 @@ pub enum OrderbookItemChangeEvent {
     RemovedItem(Uuid),
 }
 
+impl OrderbookItemChangeEvent {
+    /// Returns the UUID of the changed orderbook item.
+    fn uuid(&self) -> Uuid {
+        match self {
+            OrderbookItemChangeEvent::NewOrUpdatedItem(item) => item.uuid,
+            OrderbookItemChangeEvent::RemovedItem(uuid) => *uuid,
+        }
+    }
+}
+
 #[async_trait]
 impl EventStreamer for OrderbookStreamer {
     type DataInType = OrderbookItemChangeEvent;
@@ -60,14 +70,16 @@ impl EventStreamer for OrderbookStreamer {
         ready_tx.send(Ok(())).expect(RECEIVER_DROPPED_MSG);
 
         while let Some(orderbook_update) = data_rx.next().await {
+            let uuid = orderbook_update.uuid();
             let event_data = serde_json::to_value(orderbook_update).expect("Serialization shouldn't fail.");
-            let event = Event::new(self.streamer_id(), event_data);
+            // Only the latest change of an order is relevant, so a slow client only receives that.
+            let event = Event::new(self.streamer_id(), event_data).with_coalesce_key(uuid.to_string());
             broadcaster.broadcast(event);
         }
     }
 }
 
-async fn sanity_checks(ctx: &MmArc, base: &str, rel: &str) -> Result<(), String> {
+pub(super) async fn sanity_checks(ctx: &MmArc, base: &str, rel: &str) -> Result<(), String> {
     // TODO: This won't work with no-login mode.
     lp_coinfind(ctx, base)
         .await
@@ -0,0 +1,102 @@
+//! Compact identifiers the `Orderbook` indexes are keyed by.
+//!
+//! Every P2P orderbook message carries the tickers and the maker pubkey as strings.
+//! Keying the orderbook maps by them means allocating and hashing these strings again and again,
+//! so the tickers are interned into [`TickerId`]s and the pubkeys are stored as raw [`CompactPubkey`] bytes instead.
+
+use std::collections::HashMap;
+use std::fmt;
+
+/// The length of a compressed secp256k1 public key.
+const COMPRESSED_PUBKEY_LEN: usize = 33;
+
+/// An interned ticker. Only meaningful for the [`TickerInterner`] that issued it.
+#[derive(Clone, Copy, Debug, Eq, Hash, Ord, PartialEq, PartialOrd)]
+pub(super) struct TickerId(u32);
+
+/// `(base, rel)` pair of interned tickers.
+pub(super) type PairIds = (TickerId, TickerId);
+
+/// Append-only ticker interner.
+///
+/// The tickers are never released since the number of distinct tickers is bounded by the pairs the orderbook has
+/// ever seen, which `Orderbook::pairs_existing_for_base` and `Orderbook::pairs_existing_for_rel` already keep forever.
+#[derive(Debug, Default)]
+pub(super) struct TickerInterner {
+    ids: HashMap<String, TickerId>,
+    tickers: Vec<String>,
+}
+
+impl TickerInterner {
+    /// Returns the existing ID of the `ticker` or interns it.
+    pub(super) fn intern(&mut self, ticker: &str) -> TickerId {
+        if let Some(id) = self.ids.get(ticker) {
+            return *id;
+        }
+
+        let id = TickerId(self.tickers.len() as u32);
+        self.tickers.push(ticker.to_owned());
+        self.ids.insert(ticker.to_owned(), id);
+        id
+    }
+
+    /// Returns the ID of the `ticker` if it has been interned already.
+    #[inline]
+    pub(super) fn get(&self, ticker: &str) -> Option<TickerId> { self.ids.get(ticker).copied() }
+
+    /// Returns both IDs of the `(base, rel)` pair if they have been interned already.
+    pub(super) fn get_pair(&self, base: &str, rel: &str) -> Option<PairIds> { Some((self.get(base)?, self.get(rel)?)) }
+
+    /// # Panic
+    ///
+    /// Panics if the `id` has been issued by another interner.
+    #[inline]
+    pub(super) fn resolve(&self, id: TickerId) -> &str { &self.tickers[id.0 as usize] }
+}
+
+/// A maker pubkey as the orderbook stores it: the raw bytes of the compressed secp256k1 key
+/// instead of its 66 characters long hex representation.
+#[derive(Clone, Copy, Eq, Hash, Ord, PartialEq, PartialOrd)]
+pub(super) struct CompactPubkey([u8; COMPRESSED_PUBKEY_LEN]);
+
+impl CompactPubkey {
+    /// Returns `None` if the `pubkey` isn't a hex-encoded compressed public key.
+    pub(super) fn from_hex(pubkey: &str) -> Option<CompactPubkey> {
+        let mut bytes = [0; COMPRESSED_PUBKEY_LEN];
+        hex::decode_to_slice(pubkey, &mut bytes).ok()?;
+        Some(CompactPubkey(bytes))
+    }
+
+    pub(super) fn to_hex(self) -> String { hex::encode(self.0) }
+}
+
+impl fmt::Debug for CompactPubkey {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result { write!(f, "{}", hex::encode(self.0)) }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_ticker_interner() {
+        let mut interner = TickerInterner::default();
+        let rick = interner.intern("RICK");
+        let morty = interner.intern("MORTY");
+        assert_ne!(rick, morty);
+        assert_eq!(interner.intern("RICK"), rick);
+        assert_eq!(interner.get_pair("RICK", "MORTY"), Some((rick, morty)));
+        assert_eq!(interner.get_pair("RICK", "KMD"), None);
+        assert_eq!(interner.resolve(morty), "MORTY");
+    }
+
+    #[test]
+    fn test_compact_pubkey_from_hex() {
+        let pubkey = "02d8064eece4fa5c0f8dc0267f68cee9bdd527f9e88f3594a323428718c391ecc2";
+        let compact = CompactPubkey::from_hex(pubkey).unwrap();
+        assert_eq!(compact.to_hex(), pubkey);
+
+        assert!(CompactPubkey::from_hex("pubkey").is_none());
+        assert!(CompactPubkey::from_hex(&pubkey[..64]).is_none());
+    }
+}
@@ -0,0 +1,338 @@
+//! The lock guarding `OrdermatchContext::orderbook`.
+//!
+//! The orderbook is written by the P2P message processing and the ordermatch loop only,
+//! while it's read by every `orderbook`, `best_orders` and `orderbook_depth` RPC call and by the P2P orderbook requests.
+//! Guarding it with a mutex serializes these readers, so a burst of RPC calls delays the P2P processing and vice versa.
+//! [`OrderbookLock`] lets the readers share the orderbook and counts how often and how long an access had to wait,
+//! so the remaining contention is visible in the metrics.
+//!
+//! The P2P orderbook updates are applied through [`OrderbookLock::apply_batched`]:
+//! the messages are decoded and verified concurrently by their own tasks, and their updates are queued.
+//! The first caller that finds nobody applying the queue becomes the one that does: it takes the write lock once
+//! per batch of the queued updates, while the other callers wait for their updates to be applied
+//! without touching the lock, so a burst of messages doesn't hand the lock over once per message.
+
+use compatible_time::Instant;
+use futures::channel::oneshot;
+use parking_lot::{Condvar, Mutex as PaMutex, RwLock, RwLockReadGuard, RwLockWriteGuard};
+use std::mem;
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::thread;
+
+type PendingUpdate<T> = Box<dyn FnOnce(&mut T) + Send>;
+
+struct PendingUpdates<T> {
+    /// The updates submitted by [`OrderbookLock::apply_batched`] and not applied yet.
+    updates: Vec<PendingUpdate<T>>,
+    /// Whether a caller of [`OrderbookLock::apply_batched`] is applying the queued updates.
+    draining: bool,
+}
+
+/// The contention counters accumulated since the previous [`OrderbookLock::take_contention_stats`] call.
+#[cfg_attr(target_arch = "wasm32", allow(dead_code))]
+#[derive(Debug, Default, PartialEq)]
+pub(super) struct OrderbookLockStats {
+    /// The number of read accesses that had to wait for a writer.
+    pub(super) contended_reads: u64,
+    /// The number of write accesses that had to wait for readers or another writer.
+    pub(super) contended_writes: u64,
+    /// The number of write accesses.
+    pub(super) writes: u64,
+    /// The total time spent waiting for the lock by the contended accesses.
+    pub(super) wait_us: u64,
+    /// The number of updates applied by [`OrderbookLock::apply_batched`].
+    pub(super) batched_updates: u64,
+    /// The number of batches these updates were applied in.
+    pub(super) update_batches: u64,
+}
+
+pub(super) struct OrderbookLock<T> {
+    inner: RwLock<T>,
+    pending: PaMutex<PendingUpdates<T>>,
+    /// Notified every time a batch of the pending updates has been applied.
+    applied: Condvar,
+    contended_reads: AtomicU64,
+    contended_writes: AtomicU64,
+    writes: AtomicU64,
+    wait_us: AtomicU64,
+    batched_updates: AtomicU64,
+    update_batches: AtomicU64,
+}
+
+impl<T> OrderbookLock<T> {
+    pub(super) fn new(value: T) -> OrderbookLock<T> {
+        OrderbookLock {
+            inner: RwLock::new(value),
+            pending: PaMutex::new(PendingUpdates {
+                updates: Vec::new(),
+                draining: false,
+            }),
+            applied: Condvar::new(),
+            contended_reads: AtomicU64::new(0),
+            contended_writes: AtomicU64::new(0),
+            writes: AtomicU64::new(0),
+            wait_us: AtomicU64::new(0),
+            batched_updates: AtomicU64::new(0),
+            update_batches: AtomicU64::new(0),
+        }
+    }
+
+    /// Locks the orderbook for reading. Any number of readers can hold the lock at the same time.
+    pub(super) fn read(&self) -> RwLockReadGuard<'_, T> {
+        if let Some(guard) = self.inner.try_read() {
+            return guard;
+        }
+
+        let started_at = Instant::now();
+        let guard = self.inner.read();
+        self.contended_reads.fetch_add(1, Ordering::Relaxed);
+        self.add_wait_time(started_at);
+        guard
+    }
+
+    /// Locks the orderbook for writing.
+    pub(super) fn write(&self) -> RwLockWriteGuard<'_, T> {
+        self.writes.fetch_add(1, Ordering::Relaxed);
+        if let Some(guard) = self.inner.try_write() {
+            return guard;
+        }
+
+        let started_at = Instant::now();
+        let guard = self.inner.write();
+        self.contended_writes.fetch_add(1, Ordering::Relaxed);
+        self.add_wait_time(started_at);
+        guard
+    }
+
+    /// Applies the `update` to the orderbook together with the updates queued by the concurrent callers.
+    ///
+    /// If another caller is applying the queued updates already, the `update` is queued for it,
+    /// and this call waits until it's applied without taking the lock.
+    /// Otherwise, this call applies the queue in batches, taking the write lock once per batch,
+    /// until no updates are left, so it may apply the updates queued after its own one as well.
+    ///
+    /// If the `update` panics, the panic is caught by the caller applying it, so the rest of the batch is still applied,
+    /// and is resumed by this call only.
+    pub(super) fn apply_batched<R, F>(&self, update: F) -> R
+    where
+        F: FnOnce(&mut T) -> R + Send + 'static,
+        R: Send + 'static,
+    {
+        let (result_tx, mut result_rx) = oneshot::channel();
+        let mut pending = self.pending.lock();
+        pending.updates.push(Box::new(move |value: &mut T| {
+            result_tx
+                .send(panic::catch_unwind(AssertUnwindSafe(|| update(value))))
+                .ok();
+        }));
+
+        if pending.draining {
+            // The waiters are notified under the `pending` lock, so the notification can't be missed
+            // between the result check and the wait.
+            loop {
+                match result_rx.try_recv() {
+                    Ok(Some(result)) => {
+                        drop(pending);
+                        return unwind_update_result(result);
+                    },
+                    Ok(None) => self.applied.wait(&mut pending),
+                    Err(_) => panic!("The orderbook update must have been applied by the draining caller"),
+                }
+            }
+        }
+
+        pending.draining = true;
+        drop(pending);
+        loop {
+            let mut guard = self.write();
+            // The queue isn't empty: it's checked at the end of the previous iteration,
+            // and the updates are taken by the draining caller only.
+            let batch = mem::take(&mut self.pending.lock().updates);
+            self.batched_updates.fetch_add(batch.len() as u64, Ordering::Relaxed);
+            self.update_batches.fetch_add(1, Ordering::Relaxed);
+            for pending_update in batch {
+                pending_update(&mut *guard);
+            }
+            // let the readers in between the batches
+            drop(guard);
+
+            let mut pending = self.pending.lock();
+            self.applied.notify_all();
+            if pending.updates.is_empty() {
+                pending.draining = false;
+                break;
+            }
+        }
+
+        match result_rx.try_recv() {
+            Ok(Some(result)) => unwind_update_result(result),
+            _ => panic!("The orderbook update must have been applied by the draining caller"),
+        }
+    }
+
+    /// Returns the contention counters and resets them.
+    pub(super) fn take_contention_stats(&self) -> OrderbookLockStats {
+        OrderbookLockStats {
+            contended_reads: self.contended_reads.swap(0, Ordering::Relaxed),
+            contended_writes: self.contended_writes.swap(0, Ordering::Relaxed),
+            writes: self.writes.swap(0, Ordering::Relaxed),
+            wait_us: self.wait_us.swap(0, Ordering::Relaxed),
+            batched_updates: self.batched_updates.swap(0, Ordering::Relaxed),
+            update_batches: self.update_batches.swap(0, Ordering::Relaxed),
+        }
+    }
+
+    fn add_wait_time(&self, started_at: Instant) {
+        let wait_us = started_at.elapsed().as_micros() as u64;
+        self.wait_us.fetch_add(wait_us, Ordering::Relaxed);
+    }
+}
+
+/// Returns the result of a batched update or resumes its panic.
+fn unwind_update_result<R>(result: thread::Result<R>) -> R {
+    match result {
+        Ok(result) => result,
+        Err(update_panic) => panic::resume_unwind(update_panic),
+    }
+}
+
+#[cfg(all(test, not(target_arch = "wasm32")))]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use std::thread;
+    use std::time::Duration;
+
+    #[test]
+    fn test_orderbook_lock_shared_reads() {
+        let lock = OrderbookLock::new(1);
+        let first = lock.read();
+        let second = lock.read();
+        assert_eq!(*first + *second, 2);
+        drop((first, second));
+
+        *lock.write() = 2;
+        assert_eq!(*lock.read(), 2);
+        let expected = OrderbookLockStats {
+            writes: 1,
+            ..OrderbookLockStats::default()
+        };
+        assert_eq!(lock.take_contention_stats(), expected);
+    }
+
+    #[test]
+    fn test_orderbook_lock_contention_stats() {
+        let lock = Arc::new(OrderbookLock::new(0));
+        let guard = lock.write();
+
+        let reader = {
+            let lock = lock.clone();
+            thread::spawn(move || *lock.read())
+        };
+        thread::sleep(Duration::from_millis(50));
+        drop(guard);
+        reader.join().unwrap();
+
+        let stats = lock.take_contention_stats();
+        assert_eq!(stats.contended_reads, 1);
+        assert_eq!(stats.contended_writes, 0);
+        assert!(stats.wait_us > 0);
+        assert_eq!(lock.take_contention_stats(), OrderbookLockStats::default());
+    }
+
+    #[test]
+    fn test_orderbook_lock_apply_batched() {
+        let lock = Arc::new(OrderbookLock::new(Vec::new()));
+        let guard = lock.write();
+
+        let writers: Vec<_> = (0..4)
+            .map(|i| {
+                let lock = lock.clone();
+                thread::spawn(move || {
+                    lock.apply_batched(move |values: &mut Vec<i32>| {
+                        values.push(i);
+                        values.len()
+                    })
+                })
+            })
+            .collect();
+        // let all the writers queue their updates
+        thread::sleep(Duration::from_millis(50));
+        drop(guard);
+
+        let mut results: Vec<_> = writers.into_iter().map(|writer| writer.join().unwrap()).collect();
+        results.sort_unstable();
+        assert_eq!(results, vec![1, 2, 3, 4]);
+        assert_eq!(lock.read().len(), 4);
+
+        let stats = lock.take_contention_stats();
+        assert_eq!(stats.batched_updates, 4);
+        assert!(stats.update_batches < 4);
+    }
+
+    #[test]
+    fn test_orderbook_lock_apply_batched_lock_acquisitions() {
+        const WRITERS: usize = 8;
+
+        let lock = Arc::new(OrderbookLock::new(Vec::new()));
+        let guard = lock.write();
+
+        let writers: Vec<_> = (0..WRITERS)
+            .map(|i| {
+                let lock = lock.clone();
+                thread::spawn(move || lock.apply_batched(move |values: &mut Vec<usize>| values.push(i)))
+            })
+            .collect();
+        // wait for all the writers to queue their updates
+        while lock.pending.lock().updates.len() < WRITERS {
+            thread::sleep(Duration::from_millis(1));
+        }
+        drop(guard);
+
+        for writer in writers {
+            writer.join().unwrap();
+        }
+        let mut values = lock.read().clone();
+        values.sort_unstable();
+        assert_eq!(values, (0..WRITERS).collect::<Vec<_>>());
+
+        let stats = lock.take_contention_stats();
+        // The write lock is taken by this test and then once by the draining writer,
+        // the other writers wait for their updates to be applied without locking.
+        assert_eq!(stats.writes, 2);
+        assert_eq!(stats.update_batches, 1);
+        assert_eq!(stats.batched_updates, WRITERS as u64);
+        assert!(!lock.pending.lock().draining);
+    }
+
+    #[test]
+    fn test_orderbook_lock_apply_batched_panic() {
+        let lock = Arc::new(OrderbookLock::new(Vec::new()));
+        let guard = lock.write();
+
+        let writers: Vec<_> = (0..4)
+            .map(|i| {
+                let lock = lock.clone();
+                thread::spawn(move || {
+                    lock.apply_batched(move |values: &mut Vec<i32>| {
+                        if i == 2 {
+                            panic!("Invalid update");
+                        }
+                        values.push(i);
+                    })
+                })
+            })
+            .collect();
+        // let all the writers queue their updates, so they are applied in one batch
+        thread::sleep(Duration::from_millis(50));
+        drop(guard);
+
+        let results: Vec<_> = writers.into_iter().map(|writer| writer.join().is_ok()).collect();
+        // only the caller of the panicking update panics
+        assert_eq!(results, vec![true, true, false, true]);
+        let mut values = lock.read().clone();
+        values.sort_unstable();
+        assert_eq!(values, vec![0, 1, 3]);
+    }
+}
@@ -0,0 +1,61 @@
+//! The immutable read views of the orderbook served to the `orderbook` RPC calls.
+//!
+//! An `orderbook` RPC call used to hold the orderbook read lock while it derived the address of every order of the pair,
+//! so the P2P writers had to wait for it, and the call itself had to wait for every queued writer.
+//! Instead, the orders of a pair are copied into a [`PairOrdersView`] under the read lock once,
+//! and the view is shared by the following calls until the pair changes:
+//! a writer only drops the views of the pairs it changes, and the next reader builds a fresh one.
+//! The readers of an unchanged pair don't take the orderbook lock at all.
+
+use parking_lot::Mutex as PaMutex;
+use std::collections::{HashMap, HashSet};
+use std::sync::Arc;
+
+use super::OrderbookItem;
+
+/// The (base, rel) orders at the moment the view was built.
+pub(super) struct PairOrdersView {
+    /// The orders sorted by price in ascending order.
+    pub(super) orders: Vec<OrderbookItem>,
+    /// [`Orderbook::my_p2p_pubkeys`](super::Orderbook::my_p2p_pubkeys) at the moment the view was built.
+    pub(super) my_p2p_pubkeys: HashSet<String>,
+}
+
+/// The views shared by `Orderbook` and `OrdermatchContext`, so the readers can get them without the orderbook lock.
+///
+/// The views are inserted and dropped under the orderbook lock only,
+/// so a view built by a reader can't miss a change of a concurrent writer.
+#[derive(Default)]
+pub(super) struct OrderbookReadViews {
+    /// The views by base and rel tickers.
+    pairs: PaMutex<HashMap<String, HashMap<String, Arc<PairOrdersView>>>>,
+}
+
+impl OrderbookReadViews {
+    pub(super) fn get(&self, base: &str, rel: &str) -> Option<Arc<PairOrdersView>> {
+        self.pairs.lock().get(base).and_then(|views| views.get(rel)).cloned()
+    }
+
+    /// Must be called under the orderbook read lock the view was built under.
+    pub(super) fn insert(&self, base: &str, rel: &str, view: Arc<PairOrdersView>) {
+        self.pairs
+            .lock()
+            .entry(base.to_owned())
+            .or_insert_with(HashMap::new)
+            .insert(rel.to_owned(), view);
+    }
+
+    /// Drops the view of the (base, rel) pair. Must be called under the orderbook write lock.
+    pub(super) fn invalidate(&self, base: &str, rel: &str) {
+        let mut pairs = self.pairs.lock();
+        if let Some(views) = pairs.get_mut(base) {
+            views.remove(rel);
+            if views.is_empty() {
+                pairs.remove(base);
+            }
+        }
+    }
+
+    /// Drops the views of all the pairs. Must be called under the orderbook write lock.
+    pub(super) fn invalidate_all(&self) { self.pairs.lock().clear() }
+}
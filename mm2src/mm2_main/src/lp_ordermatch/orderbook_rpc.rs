@@ -90,60 +90,41 @@ pub async fn orderbook_rpc(ctx: MmArc, req: Json) -> Result<Response<Vec<u8>>, S
 
     let my_pubsecp = mm2_internal_pubkey_hex(&ctx, String::from).map_err(MmError::into_inner)?;
 
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    let my_p2p_pubkeys = &orderbook.my_p2p_pubkeys;
+    // The addresses are derived from the read views, without holding the orderbook lock.
+    let asks_view = ordermatch_ctx.pair_orders_view(&base_ticker, &rel_ticker);
+    let bids_view = ordermatch_ctx.pair_orders_view(&rel_ticker, &base_ticker);
 
-    let mut asks = match orderbook.unordered.get(&(base_ticker.clone(), rel_ticker.clone())) {
-        Some(uuids) => {
-            let mut orderbook_entries = Vec::with_capacity(uuids.len());
-            for uuid in uuids {
-                let ask = orderbook.order_set.get(uuid).ok_or(ERRL!(
-                    "Orderbook::unordered contains {:?} uuid that is not in Orderbook::order_set",
-                    uuid
-                ))?;
-                let address_format = addr_format_from_protocol_info(&ask.base_protocol_info);
-                let address = try_s!(address_by_coin_conf_and_pubkey_str(
-                    &ctx,
-                    &req.base,
-                    &base_coin_conf,
-                    &ask.pubkey,
-                    address_format,
-                ));
-                let is_mine = is_my_order(&ask.pubkey, &my_pubsecp, my_p2p_pubkeys);
-                orderbook_entries.push(ask.as_rpc_entry_ask(address, is_mine));
-            }
-            orderbook_entries
-        },
-        None => vec![],
-    };
-    asks.sort_unstable_by(|ask1, ask2| ask1.price_rat.cmp(&ask2.price_rat));
+    // the views have the asks sorted by price in ascending order
+    let mut asks = Vec::with_capacity(asks_view.orders.len());
+    for ask in asks_view.orders.iter() {
+        let address_format = addr_format_from_protocol_info(&ask.base_protocol_info);
+        let address = try_s!(address_by_coin_conf_and_pubkey_str(
+            &ctx,
+            &req.base,
+            &base_coin_conf,
+            &ask.pubkey,
+            address_format,
+        ));
+        let is_mine = is_my_order(&ask.pubkey, &my_pubsecp, &asks_view.my_p2p_pubkeys);
+        asks.push(ask.as_rpc_entry_ask(address, is_mine));
+    }
     let (mut asks, total_asks_base_vol, total_asks_rel_vol) = build_aggregated_entries(asks);
     asks.reverse();
 
-    let mut bids = match orderbook.unordered.get(&(rel_ticker, base_ticker)) {
-        Some(uuids) => {
-            let mut orderbook_entries = Vec::with_capacity(uuids.len());
-            for uuid in uuids {
-                let bid = orderbook.order_set.get(uuid).ok_or(ERRL!(
-                    "Orderbook::unordered contains {:?} uuid that is not in Orderbook::order_set",
-                    uuid
-                ))?;
-                let address_format = addr_format_from_protocol_info(&bid.base_protocol_info);
-                let address = try_s!(address_by_coin_conf_and_pubkey_str(
-                    &ctx,
-                    &req.rel,
-                    &rel_coin_conf,
-                    &bid.pubkey,
-                    address_format,
-                ));
-                let is_mine = is_my_order(&bid.pubkey, &my_pubsecp, my_p2p_pubkeys);
-                orderbook_entries.push(bid.as_rpc_entry_bid(address, is_mine));
-            }
-            orderbook_entries
-        },
-        None => vec![],
-    };
-    bids.sort_unstable_by(|bid1, bid2| bid2.price_rat.cmp(&bid1.price_rat));
+    // bids are the (rel, base) orders, so ascending order price means descending bid price
+    let mut bids = Vec::with_capacity(bids_view.orders.len());
+    for bid in bids_view.orders.iter() {
+        let address_format = addr_format_from_protocol_info(&bid.base_protocol_info);
+        let address = try_s!(address_by_coin_conf_and_pubkey_str(
+            &ctx,
+            &req.rel,
+            &rel_coin_conf,
+            &bid.pubkey,
+            address_format,
+        ));
+        let is_mine = is_my_order(&bid.pubkey, &my_pubsecp, &bids_view.my_p2p_pubkeys);
+        bids.push(bid.as_rpc_entry_bid(address, is_mine));
+    }
     let (bids, total_bids_base_vol, total_bids_rel_vol) = build_aggregated_entries(bids);
 
     let response = OrderbookResponse {
@@ -256,66 +237,41 @@ pub async fn orderbook_rpc_v2(
         .map_to_mm(OrderbookRpcError::P2PSubscribeError)?;
 
     let my_pubsecp = mm2_internal_pubkey_hex(&ctx, OrderbookRpcError::Internal)?;
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    let my_p2p_pubkeys = &orderbook.my_p2p_pubkeys;
+    // The addresses are derived from the read views, without holding the orderbook lock.
+    let asks_view = ordermatch_ctx.pair_orders_view(&base_ticker, &rel_ticker);
+    let bids_view = ordermatch_ctx.pair_orders_view(&rel_ticker, &base_ticker);
 
-    let mut asks = match orderbook.unordered.get(&(base_ticker.clone(), rel_ticker.clone())) {
-        Some(uuids) => {
-            let mut orderbook_entries = Vec::new();
-            for uuid in uuids {
-                let ask = match orderbook.order_set.get(uuid) {
-                    Some(a) => a,
-                    None => {
-                        warn!("unordered contains {:?} uuid that is not in order_set", uuid);
-                        continue;
-                    },
-                };
-                let address_format = addr_format_from_protocol_info(&ask.base_protocol_info);
-                let address = match orderbook_address(&ctx, &req.base, &base_coin_conf, &ask.pubkey, address_format) {
-                    Ok(a) => a,
-                    Err(e) => {
-                        warn!("Error {} on getting address for order {}", e, ask.uuid);
-                        continue;
-                    },
-                };
-                let is_mine = is_my_order(&ask.pubkey, &my_pubsecp, my_p2p_pubkeys);
-                orderbook_entries.push(ask.as_rpc_v2_entry_ask(address, is_mine));
-            }
-            orderbook_entries
-        },
-        None => Vec::new(),
-    };
-    asks.sort_unstable_by(|ask1, ask2| ask1.price.rational.cmp(&ask2.price.rational));
+    // the views have the asks sorted by price in ascending order
+    let mut asks = Vec::with_capacity(asks_view.orders.len());
+    for ask in asks_view.orders.iter() {
+        let address_format = addr_format_from_protocol_info(&ask.base_protocol_info);
+        let address = match orderbook_address(&ctx, &req.base, &base_coin_conf, &ask.pubkey, address_format) {
+            Ok(a) => a,
+            Err(e) => {
+                warn!("Error {} on getting address for order {}", e, ask.uuid);
+                continue;
+            },
+        };
+        let is_mine = is_my_order(&ask.pubkey, &my_pubsecp, &asks_view.my_p2p_pubkeys);
+        asks.push(ask.as_rpc_v2_entry_ask(address, is_mine));
+    }
     let (mut asks, total_asks_base_vol, total_asks_rel_vol) = build_aggregated_entries_v2(asks);
     asks.reverse();
 
-    let mut bids = match orderbook.unordered.get(&(rel_ticker, base_ticker)) {
-        Some(uuids) => {
-            let mut orderbook_entries = vec![];
-            for uuid in uuids {
-                let bid = match orderbook.order_set.get(uuid) {
-                    Some(b) => b,
-                    None => {
-                        warn!("unordered contains {:?} uuid that is not in order_set", uuid);
-                        continue;
-                    },
-                };
-                let address_format = addr_format_from_protocol_info(&bid.base_protocol_info);
-                let address = match orderbook_address(&ctx, &req.rel, &rel_coin_conf, &bid.pubkey, address_format) {
-                    Ok(a) => a,
-                    Err(e) => {
-                        warn!("Error {} on getting address for order {}", e, bid.uuid);
-                        continue;
-                    },
-                };
-                let is_mine = is_my_order(&bid.pubkey, &my_pubsecp, my_p2p_pubkeys);
-                orderbook_entries.push(bid.as_rpc_v2_entry_bid(address, is_mine));
-            }
-            orderbook_entries
-        },
-        None => vec![],
-    };
-    bids.sort_unstable_by(|bid1, bid2| bid2.price.rational.cmp(&bid1.price.rational));
+    // bids are the (rel, base) orders, so ascending order price means descending bid price
+    let mut bids = Vec::with_capacity(bids_view.orders.len());
+    for bid in bids_view.orders.iter() {
+        let address_format = addr_format_from_protocol_info(&bid.base_protocol_info);
+        let address = match orderbook_address(&ctx, &req.rel, &rel_coin_conf, &bid.pubkey, address_format) {
+            Ok(a) => a,
+            Err(e) => {
+                warn!("Error {} on getting address for order {}", e, bid.uuid);
+                continue;
+            },
+        };
+        let is_mine = is_my_order(&bid.pubkey, &my_pubsecp, &bids_view.my_p2p_pubkeys);
+        bids.push(bid.as_rpc_v2_entry_bid(address, is_mine));
+    }
     let (bids, total_bids_base_vol, total_bids_rel_vol) = build_aggregated_entries_v2(bids);
 
     Ok(OrderbookV2Response {
@@ -0,0 +1,188 @@
+//! An optional on-disk snapshot of the orderbook tries.
+//!
+//! After a restart the orderbook is empty, so a relay would have to request every pair and every pubkey state
+//! from the peers again before it can serve a complete orderbook.
+//! If `orderbook_snapshot` is enabled in the config, the orders of the known maker pubkeys are saved periodically
+//! and on stop, and are put back into the tries at startup.
+//! The restored tries have the roots they had when the snapshot was saved, so the next keep alive of each maker
+//! requests only the changes since then through the usual `DeltaOrFullTrie` sync,
+//! and the makers that went offline meanwhile are timed out by their saved `last_keep_alive`.
+
+use super::{pubkey_state_mut, BaseRelProtocolInfo, CompactPubkey, Orderbook, OrderbookItem, OrderbookLock,
+            OrderbookP2PItem};
+use common::log::{info, warn};
+use common::{async_blocking, now_sec};
+use mm2_core::mm_ctx::MmArc;
+use mm2_libp2p::{decode_message, encode_message};
+use mm2_rpc::data::legacy::OrderConfirmationsSettings;
+use std::path::PathBuf;
+
+/// Bump it on any change of the snapshot structures below.
+const ORDERBOOK_SNAPSHOT_VERSION: u8 = 1;
+/// How often the snapshot is saved while running, in seconds.
+const ORDERBOOK_SNAPSHOT_INTERVAL: u64 = 60;
+
+/// The snapshot is encoded with MessagePack as the P2P orderbook messages are.
+#[derive(Deserialize, Serialize)]
+struct OrderbookSnapshot {
+    version: u8,
+    pubkeys: Vec<PubkeySnapshot>,
+}
+
+#[derive(Deserialize, Serialize)]
+struct PubkeySnapshot {
+    pubkey: String,
+    last_keep_alive: u64,
+    orders: Vec<OrderSnapshot>,
+}
+
+#[derive(Deserialize, Serialize)]
+struct OrderSnapshot {
+    order: OrderbookP2PItem,
+    protocol_info: BaseRelProtocolInfo,
+    conf_settings: Option<OrderConfirmationsSettings>,
+}
+
+/// Encodes the orders of every known maker pubkey except for ours,
+/// since our own orders are loaded from the `my_orders` storage at startup.
+pub(super) fn encode_orderbook_snapshot(orderbook: &Orderbook, my_pubsecp: &str) -> Result<Vec<u8>, String> {
+    let pubkeys = orderbook
+        .pubkeys_state
+        .iter()
+        .filter_map(|(pubkey, state)| {
+            let pubkey = pubkey.to_hex();
+            if pubkey == my_pubsecp || orderbook.my_p2p_pubkeys.contains(&pubkey) {
+                return None;
+            }
+
+            let orders = state
+                .orders_uuids
+                .iter()
+                .filter_map(|(uuid, _)| orderbook.order_set.get(uuid))
+                .map(|order| OrderSnapshot {
+                    protocol_info: order.base_rel_proto_info(),
+                    conf_settings: order.conf_settings.clone(),
+                    order: order.clone().into(),
+                })
+                .collect();
+            Some(PubkeySnapshot {
+                pubkey,
+                last_keep_alive: state.last_keep_alive,
+                orders,
+            })
+        })
+        .collect();
+
+    let snapshot = OrderbookSnapshot {
+        version: ORDERBOOK_SNAPSHOT_VERSION,
+        pubkeys,
+    };
+    encode_message(&snapshot).map_err(|e| ERRL!("{}", e))
+}
+
+/// Puts the snapshot orders into the orderbook. Returns the number of the restored orders.
+///
+/// The pubkeys the orderbook has received a message from already are skipped as their state is more recent.
+pub(super) fn restore_orderbook_snapshot(orderbook: &mut Orderbook, snapshot: &[u8]) -> Result<usize, String> {
+    let snapshot: OrderbookSnapshot = try_s!(decode_message(snapshot));
+    if snapshot.version != ORDERBOOK_SNAPSHOT_VERSION {
+        return ERR!("Unsupported orderbook snapshot version {}", snapshot.version);
+    }
+
+    let mut restored = 0;
+    for pubkey_snapshot in snapshot.pubkeys {
+        let pubkey = match CompactPubkey::from_hex(&pubkey_snapshot.pubkey) {
+            Some(pubkey) => pubkey,
+            None => continue,
+        };
+        if orderbook.pubkeys_state.contains_key(&pubkey) {
+            continue;
+        }
+
+        for order in pubkey_snapshot.orders {
+            if order.order.pubkey != pubkey_snapshot.pubkey {
+                continue;
+            }
+            orderbook.insert_or_update_order_update_trie(OrderbookItem::from_p2p_and_info(
+                order.order,
+                order.protocol_info,
+                order.conf_settings,
+            ));
+            restored += 1;
+        }
+
+        let pubkey_state = pubkey_state_mut(&mut orderbook.pubkeys_state, &mut orderbook.keep_alive_expiry, pubkey);
+        pubkey_state.last_keep_alive = pubkey_snapshot.last_keep_alive;
+        orderbook
+            .keep_alive_expiry
+            .refresh(pubkey, pubkey_state.last_keep_alive);
+    }
+    Ok(restored)
+}
+
+/// Loads the orderbook snapshot at startup and keeps saving it while `lp_ordermatch_loop` runs.
+pub(super) struct OrderbookSnapshotSaver {
+    path: PathBuf,
+    my_pubsecp: String,
+    saved_at: u64,
+}
+
+impl OrderbookSnapshotSaver {
+    /// Returns `None` if the snapshot isn't enabled in the config.
+    pub(super) fn from_ctx(ctx: &MmArc, my_pubsecp: &str) -> Option<OrderbookSnapshotSaver> {
+        if !ctx.conf["orderbook_snapshot"].as_bool().unwrap_or(false) {
+            return None;
+        }
+
+        Some(OrderbookSnapshotSaver {
+            path: ctx.dbdir().join("ORDERS").join("ORDERBOOK_SNAPSHOT"),
+            my_pubsecp: my_pubsecp.to_owned(),
+            saved_at: now_sec(),
+        })
+    }
+
+    pub(super) async fn load(&self, orderbook: &OrderbookLock<Orderbook>) {
+        let path = self.path.clone();
+        let snapshot = match async_blocking(move || std::fs::read(path)).await {
+            Ok(snapshot) => snapshot,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return,
+            Err(e) => {
+                warn!("Error {} on reading the orderbook snapshot {}", e, self.path.display());
+                return;
+            },
+        };
+
+        match restore_orderbook_snapshot(&mut orderbook.write(), &snapshot) {
+            Ok(restored) => info!("Restored {} orders from the orderbook snapshot", restored),
+            Err(e) => warn!(
+                "Error {} on restoring the orderbook snapshot {}",
+                e,
+                self.path.display()
+            ),
+        }
+    }
+
+    /// Saves the snapshot if `ORDERBOOK_SNAPSHOT_INTERVAL` has passed since it was saved last time.
+    pub(super) async fn save_if_due(&mut self, orderbook: &OrderbookLock<Orderbook>) {
+        if self.saved_at + ORDERBOOK_SNAPSHOT_INTERVAL <= now_sec() {
+            self.save(orderbook).await;
+        }
+    }
+
+    /// Writes the snapshot on a blocking thread not to stall the ordermatch loop on the disk IO.
+    pub(super) async fn save(&mut self, orderbook: &OrderbookLock<Orderbook>) {
+        self.saved_at = now_sec();
+        // release the orderbook lock before writing to the disk
+        let snapshot = match encode_orderbook_snapshot(&orderbook.read(), &self.my_pubsecp) {
+            Ok(snapshot) => snapshot,
+            Err(e) => {
+                warn!("Error {} on encoding the orderbook snapshot", e);
+                return;
+            },
+        };
+        let path = self.path.clone();
+        if let Err(e) = async_blocking(move || mm2_io::fs::write(&path, &snapshot, true)).await {
+            warn!("Error {} on saving the orderbook snapshot {}", e, self.path.display());
+        }
+    }
+}
@@ -0,0 +1,219 @@
+//! Price-ordered index of the orderbook orders of a single `(base, rel)` pair.
+//!
+//! `OrderbookItem::price` is a `BigRational`, so keeping the orders sorted by it directly means
+//! heap-allocated bignum comparisons on every insert, removal and best price walk.
+//! [`PriceKey`] represents a price as a 64.64 fixed-point `u128` and keeps the exact rational only
+//! for the prices that can't be represented in this format, so comparing two keys is an integer comparison
+//! in the vast majority of cases.
+//! [`PriceIndex`] keeps the keys in a flat sorted vector, which makes top-N walks a sequential scan.
+
+use mm2_number::{BigInt, BigRational};
+use num_traits::{One, Signed, ToPrimitive, Zero};
+use std::cmp::Ordering;
+use std::iter::FromIterator;
+use uuid::Uuid;
+
+/// The number of fractional bits of the [`PriceKey::scaled`] fixed-point representation.
+const PRICE_KEY_FRACTIONAL_BITS: usize = 64;
+
+/// A fixed-width price ordering key.
+///
+/// `scaled` is a monotonic function of the price, so two keys with distinct `scaled` values are ordered by it.
+/// The exact rational is only consulted if both keys have the same `scaled` value and at least one of them is inexact.
+#[derive(Clone, Debug, Eq, PartialEq)]
+pub struct PriceKey {
+    /// `floor(price * 2^64)` clamped to the `[0, u128::MAX]` range.
+    scaled: u128,
+    /// The exact price if it's not equal to `scaled / 2^64`.
+    inexact: Option<Box<BigRational>>,
+}
+
+impl PriceKey {
+    pub fn new(price: &BigRational) -> PriceKey {
+        // Order prices are always positive, but keep the key total for any rational anyway.
+        if price.is_negative() {
+            return PriceKey {
+                scaled: 0,
+                inexact: Some(Box::new(price.clone())),
+            };
+        }
+
+        let shifted: BigInt = price.numer() << PRICE_KEY_FRACTIONAL_BITS;
+        let denom = price.denom();
+        match (&shifted / denom).to_u128() {
+            Some(scaled) if (&shifted % denom).is_zero() => PriceKey { scaled, inexact: None },
+            Some(scaled) => PriceKey {
+                scaled,
+                inexact: Some(Box::new(price.clone())),
+            },
+            None => PriceKey {
+                scaled: u128::MAX,
+                inexact: Some(Box::new(price.clone())),
+            },
+        }
+    }
+
+    /// Returns `true` if the price is represented by the fixed-point value only.
+    #[inline]
+    pub fn is_exact(&self) -> bool { self.inexact.is_none() }
+
+    fn to_ratio(&self) -> BigRational {
+        match self.inexact {
+            Some(ref price) => price.as_ref().clone(),
+            None => BigRational::new(BigInt::from(self.scaled), BigInt::one() << PRICE_KEY_FRACTIONAL_BITS),
+        }
+    }
+}
+
+impl Ord for PriceKey {
+    fn cmp(&self, other: &Self) -> Ordering {
+        match self.scaled.cmp(&other.scaled) {
+            Ordering::Equal => (),
+            ordering => return ordering,
+        }
+        match (&self.inexact, &other.inexact) {
+            (None, None) => Ordering::Equal,
+            (Some(left), Some(right)) => left.cmp(right),
+            // The keys share the same fixed-point part, so this path is rare enough to afford an allocation.
+            _ => self.to_ratio().cmp(&other.to_ratio()),
+        }
+    }
+}
+
+impl PartialOrd for PriceKey {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> { Some(self.cmp(other)) }
+}
+
+/// The set of orders of a pair ordered by [`PriceKey`] and by `Uuid` within the same price.
+///
+/// The entries are stored in a flat sorted vector: lookups are binary searches and iteration is a sequential scan,
+/// while insertions and removals shift the tail of the vector, which is cheap for the depths seen in practice.
+#[derive(Clone, Debug, Default, Eq, PartialEq)]
+pub struct PriceIndex {
+    entries: Vec<(PriceKey, Uuid)>,
+}
+
+impl PriceIndex {
+    /// Inserts the order into the index. Returns `false` if the index already contained it.
+    pub fn insert(&mut self, price: &BigRational, uuid: Uuid) -> bool {
+        let key = PriceKey::new(price);
+        match self.search(&key, &uuid) {
+            Ok(_) => false,
+            Err(pos) => {
+                self.entries.insert(pos, (key, uuid));
+                true
+            },
+        }
+    }
+
+    /// Removes the order inserted with the given `price`. Returns `false` if the index didn't contain it.
+    pub fn remove(&mut self, price: &BigRational, uuid: &Uuid) -> bool {
+        let key = PriceKey::new(price);
+        match self.search(&key, uuid) {
+            Ok(pos) => {
+                self.entries.remove(pos);
+                true
+            },
+            Err(_) => false,
+        }
+    }
+
+    #[inline]
+    pub fn len(&self) -> usize { self.entries.len() }
+
+    #[inline]
+    pub fn is_empty(&self) -> bool { self.entries.is_empty() }
+
+    /// Iterates over the order UUIDs starting from the lowest price.
+    pub fn iter(&self) -> impl DoubleEndedIterator<Item = &Uuid> + ExactSizeIterator {
+        self.entries.iter().map(|(_, uuid)| uuid)
+    }
+
+    fn search(&self, key: &PriceKey, uuid: &Uuid) -> Result<usize, usize> {
+        self.entries
+            .binary_search_by(|(entry_key, entry_uuid)| entry_key.cmp(key).then_with(|| entry_uuid.cmp(uuid)))
+    }
+}
+
+impl<'a> FromIterator<(&'a BigRational, Uuid)> for PriceIndex {
+    fn from_iter<I: IntoIterator<Item = (&'a BigRational, Uuid)>>(iter: I) -> Self {
+        let mut entries: Vec<_> = iter
+            .into_iter()
+            .map(|(price, uuid)| (PriceKey::new(price), uuid))
+            .collect();
+        entries.sort_unstable();
+        entries.dedup();
+        PriceIndex { entries }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use mm2_number::MmNumber;
+
+    fn ratio(s: &'static str) -> BigRational { MmNumber::from(s).to_ratio() }
+
+    #[test]
+    fn test_price_key_order_matches_rational_order() {
+        let prices = [
+            "0.00000000000000000001",
+            "0.00000000000000000002",
+            "0.1",
+            "0.3333333333333333333333333",
+            "0.5",
+            "1",
+            "1.00000000000000000000000001",
+            "3",
+            "18446744073709551615.5",
+            "18446744073709551616",
+            "100000000000000000000000",
+        ];
+        let mut expected: Vec<BigRational> = prices.iter().copied().map(ratio).collect();
+        expected.push(BigRational::new(1.into(), 3.into()));
+        expected.push(BigRational::new(2.into(), 3.into()));
+
+        for left in expected.iter() {
+            for right in expected.iter() {
+                assert_eq!(
+                    PriceKey::new(left).cmp(&PriceKey::new(right)),
+                    left.cmp(right),
+                    "{} vs {}",
+                    left,
+                    right
+                );
+            }
+        }
+
+        assert!(PriceKey::new(&ratio("0.5")).is_exact());
+        assert!(PriceKey::new(&ratio("3")).is_exact());
+        assert!(!PriceKey::new(&ratio("0.1")).is_exact());
+        assert!(!PriceKey::new(&ratio("100000000000000000000000")).is_exact());
+    }
+
+    #[test]
+    fn test_price_index_insert_remove() {
+        let uuids: Vec<Uuid> = (1..=4).map(Uuid::from_u128).collect();
+        let mut index = PriceIndex::default();
+        assert!(index.insert(&ratio("2"), uuids[0]));
+        assert!(index.insert(&ratio("0.1"), uuids[1]));
+        assert!(index.insert(&ratio("2"), uuids[2]));
+        assert!(index.insert(&ratio("1"), uuids[3]));
+        assert!(!index.insert(&ratio("1"), uuids[3]));
+
+        let actual: Vec<_> = index.iter().copied().collect();
+        assert_eq!(actual, vec![uuids[1], uuids[3], uuids[0], uuids[2]]);
+
+        // the order can be removed by the price it was inserted with only
+        assert!(!index.remove(&ratio("0.2"), &uuids[1]));
+        assert!(index.remove(&ratio("0.1"), &uuids[1]));
+        assert!(index.remove(&ratio("2"), &uuids[0]));
+        let actual: Vec<_> = index.iter().copied().collect();
+        assert_eq!(actual, vec![uuids[3], uuids[2]]);
+
+        let expected: PriceIndex = vec![(&ratio("2"), uuids[2]), (&ratio("1"), uuids[3])]
+            .into_iter()
+            .collect();
+        assert_eq!(index, expected);
+    }
+}
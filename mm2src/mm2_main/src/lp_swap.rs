@@ -964,11 +964,6 @@ pub struct TransactionIdentifier {
 #[cfg(not(target_arch = "wasm32"))]
 pub fn my_swaps_dir(ctx: &MmArc, address: &str) -> PathBuf { ctx.address_dir(address).join("SWAPS").join("MY") }
 
-#[cfg(not(target_arch = "wasm32"))]
-pub fn my_swap_file_path(ctx: &MmArc, address: &str, uuid: &Uuid) -> PathBuf {
-    my_swaps_dir(ctx, address).join(format!("{}.json", uuid))
-}
-
 pub async fn insert_new_swap_to_db(
     ctx: MmArc,
     my_coin: &str,
@@ -2165,6 +2160,7 @@ mod lp_swap_tests {
         fix_directories(&maker_ctx).unwrap();
         block_on(init_p2p(maker_ctx.clone())).unwrap();
         maker_ctx.init_sqlite_connection().unwrap();
+        block_on(crate::database::init_and_migrate_sql_db(&maker_ctx)).unwrap();
 
         let rick_activation_params = utxo_activation_params(RICK_ELECTRUM_ADDRS);
         let morty_activation_params = utxo_activation_params(MORTY_ELECTRUM_ADDRS);
@@ -2203,6 +2199,7 @@ mod lp_swap_tests {
         fix_directories(&taker_ctx).unwrap();
         block_on(init_p2p(taker_ctx.clone())).unwrap();
         taker_ctx.init_sqlite_connection().unwrap();
+        block_on(crate::database::init_and_migrate_sql_db(&taker_ctx)).unwrap();
 
         let rick_taker = block_on(utxo_standard_coin_with_priv_key(
             &taker_ctx,
@@ -2277,21 +2274,14 @@ mod lp_swap_tests {
             run_taker_swap(RunTakerSwapInput::StartNew(taker_swap), taker_ctx.clone()),
         ));
 
-        let makers_maker_coin_address = rick_maker.my_address().unwrap();
-        let takers_maker_coin_address = rick_taker.my_address().unwrap();
-
-        println!(
-            "Maker swap path {}",
-            std::fs::canonicalize(my_swap_file_path(&maker_ctx, &makers_maker_coin_address, &uuid))
-                .unwrap()
-                .display()
-        );
-        println!(
-            "Taker swap path {}",
-            std::fs::canonicalize(my_swap_file_path(&taker_ctx, &takers_maker_coin_address, &uuid))
-                .unwrap()
-                .display()
-        );
+        let maker_swap = block_on(SavedSwap::load_my_swap_from_db(&maker_ctx, None, uuid))
+            .unwrap()
+            .unwrap();
+        println!("Maker swap {}", json::to_string(&maker_swap).unwrap());
+        let taker_swap = block_on(SavedSwap::load_my_swap_from_db(&taker_ctx, None, uuid))
+            .unwrap()
+            .unwrap();
+        println!("Taker swap {}", json::to_string(&taker_swap).unwrap());
     }
 
     #[test]
@@ -31,6 +31,7 @@ use futures::{compat::Future01CompatExt, select, FutureExt};
 use keys::KeyPair;
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
+use mm2_metrics::mm_span;
 use mm2_number::{BigDecimal, MmNumber};
 use mm2_rpc::data::legacy::OrderConfirmationsSettings;
 use parking_lot::Mutex as PaMutex;
@@ -2174,7 +2175,11 @@ pub async fn run_maker_swap(swap: RunMakerSwapInput, ctx: MmArc) {
     let mut swap_fut = Box::pin(
         async move {
             loop {
-                let res = running_swap.handle_command(command).await.expect("!handle_command");
+                let res = {
+                    let _span = mm_span!(ctx.metrics, "swap.command.duration",
+                        "swap" => "maker", "command" => format!("{:?}", command));
+                    running_swap.handle_command(command).await.expect("!handle_command")
+                };
                 for event in res.1 {
                     let to_save = MakerSavedEvent {
                         timestamp: now_ms(),
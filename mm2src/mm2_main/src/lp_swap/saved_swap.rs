@@ -198,10 +198,13 @@ pub trait SavedSwapIo {
 #[cfg(not(target_arch = "wasm32"))]
 mod native_impl {
     use super::*;
+    use crate::database::saved_swaps::{load_all_saved_swaps, load_saved_swap, save_saved_swap, split_swap_events};
     use crate::lp_swap::maker_swap::{stats_maker_swap_dir, stats_maker_swap_file_path};
+    use crate::lp_swap::my_swaps_dir;
     use crate::lp_swap::taker_swap::{stats_taker_swap_dir, stats_taker_swap_file_path};
-    use crate::lp_swap::{my_swap_file_path, my_swaps_dir};
     use mm2_io::fs::{read_dir_json, read_json, write_json, FsJsonError};
+    use mm2_metrics::mm_span;
+    use serde_json as json;
 
     const USE_TMP_FILE: bool = true;
 
@@ -218,24 +221,11 @@ mod native_impl {
         }
     }
 
-    #[async_trait]
-    impl SavedSwapIo for SavedSwap {
-        async fn load_my_swap_from_db(
-            ctx: &MmArc,
-            address_dir: Option<&str>,
-            uuid: Uuid,
-        ) -> SavedSwapResult<Option<SavedSwap>> {
-            // TODO(new-db-arch): Set the correct address directory for the new db arch branch (via a query to the global DB).
-            #[cfg(feature = "new-db-arch")]
-            let address_dir = address_dir.unwrap_or("Fetch the address directory from the global DB given the UUID.");
-            #[cfg(not(feature = "new-db-arch"))]
-            let address_dir = address_dir.unwrap_or("no address directory for old DB architecture (has no effect)");
-            let path = my_swap_file_path(ctx, address_dir, &uuid);
-            Ok(read_json(&path).await?)
-        }
-
+    impl SavedSwap {
+        /// Loads the swaps saved to the JSON files before they were moved to the SQLite database.
+        /// Use this only in migration code! The swaps are saved to the `saved_swaps` table since then.
         #[cfg_attr(feature = "new-db-arch", allow(unreachable_code, unused_variables))]
-        async fn load_all_my_swaps_from_db(ctx: &MmArc) -> SavedSwapResult<Vec<SavedSwap>> {
+        pub(crate) async fn load_all_my_swaps_from_json_files(ctx: &MmArc) -> SavedSwapResult<Vec<SavedSwap>> {
             #[cfg(feature = "new-db-arch")]
             {
                 // This method is solely used for migrations. Which we should ditch or refactor with the new DB architecture.
@@ -246,6 +236,39 @@ mod native_impl {
             let path = my_swaps_dir(ctx, "has no effect in not(feature = 'new-db-arch')");
             Ok(read_dir_json(&path).await?)
         }
+    }
+
+    /// The swaps are stored in the `saved_swaps` and `saved_swap_events` tables of the `MmCtx::sqlite_connection`
+    /// database, next to the `my_swaps` table indexing them, with the `new-db-arch` feature too.
+    /// With that feature, they used to be saved to the JSON files in their `maker_address()` directories:
+    /// moving them to the address databases is left to the rest of the `new-db-arch` migration.
+    #[async_trait]
+    impl SavedSwapIo for SavedSwap {
+        /// The swaps are looked up by their uuid, so the `address_dir` has no effect.
+        async fn load_my_swap_from_db(
+            ctx: &MmArc,
+            _address_dir: Option<&str>,
+            uuid: Uuid,
+        ) -> SavedSwapResult<Option<SavedSwap>> {
+            let _span = mm_span!(ctx.metrics, "db.query.duration", "table" => "saved_swaps", "query" => "load");
+            let swap_json = load_saved_swap(&ctx.sqlite_connection(), &uuid)
+                .map_to_mm(|e| SavedSwapError::ErrorLoading(e.to_string()))?;
+            swap_json
+                .map(|swap_json| json::from_str(&swap_json))
+                .transpose()
+                .map_to_mm(|e| SavedSwapError::ErrorDeserializing(e.to_string()))
+        }
+
+        async fn load_all_my_swaps_from_db(ctx: &MmArc) -> SavedSwapResult<Vec<SavedSwap>> {
+            let _span = mm_span!(ctx.metrics, "db.query.duration", "table" => "saved_swaps", "query" => "load_all");
+            let swaps = load_all_saved_swaps(&ctx.sqlite_connection())
+                .map_to_mm(|e| SavedSwapError::ErrorLoading(e.to_string()))?;
+            swaps
+                .iter()
+                .map(|swap_json| json::from_str(swap_json))
+                .map(|res: Result<SavedSwap, _>| res.map_to_mm(|e| SavedSwapError::ErrorDeserializing(e.to_string())))
+                .collect()
+        }
 
         async fn load_from_maker_stats_db(ctx: &MmArc, uuid: Uuid) -> SavedSwapResult<Option<MakerSavedSwap>> {
             let path = stats_maker_swap_file_path(ctx, &uuid);
@@ -268,13 +291,11 @@ mod native_impl {
         }
 
         async fn save_to_db(&self, ctx: &MmArc) -> SavedSwapResult<()> {
-            #[cfg(feature = "new-db-arch")]
-            let address_dir = self.maker_address();
-            #[cfg(not(feature = "new-db-arch"))]
-            let address_dir = "no address directory for old DB architecture (has no effect)";
-            let path = my_swap_file_path(ctx, address_dir, self.uuid());
-            write_json(self, &path, USE_TMP_FILE).await?;
-            Ok(())
+            let swap = json::to_value(self).map_to_mm(|e| SavedSwapError::ErrorSerializing(e.to_string()))?;
+            let (swap_json, events) = split_swap_events(swap);
+            let _span = mm_span!(ctx.metrics, "db.query.duration", "table" => "saved_swaps", "query" => "save");
+            save_saved_swap(&ctx.sqlite_connection(), self.uuid(), &swap_json, &events)
+                .map_to_mm(|e| SavedSwapError::ErrorSaving(e.to_string()))
         }
 
         /// Save the inner maker/taker swap to the corresponding stats db.
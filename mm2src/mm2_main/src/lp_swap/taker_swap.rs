@@ -31,6 +31,7 @@ use http::Response;
 use keys::KeyPair;
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
+use mm2_metrics::mm_span;
 use mm2_number::{BigDecimal, MmNumber};
 use mm2_rpc::data::legacy::{MatchBy, OrderConfirmationsSettings, TakerAction};
 use parking_lot::Mutex as PaMutex;
@@ -481,7 +482,11 @@ pub async fn run_taker_swap(swap: RunTakerSwapInput, ctx: MmArc) {
         async move {
             let mut events;
             loop {
-                let res = running_swap.handle_command(command).await.expect("!handle_command");
+                let res = {
+                    let _span = mm_span!(ctx.metrics, "swap.command.duration",
+                        "swap" => "taker", "command" => format!("{:?}", command));
+                    running_swap.handle_command(command).await.expect("!handle_command")
+                };
                 events = res.1;
                 for event in events {
                     let to_save = TakerSavedEvent {
@@ -514,6 +514,106 @@ fn test_maker_order_available_amount() {
     assert_eq!(MmNumber::from(expected), actual);
 }
 
+#[test]
+fn test_maker_orders_index_request_candidates() {
+    let maker_order = |base: &str, rel: &str, base_orderbook_ticker: Option<&str>| MakerOrder {
+        base: base.into(),
+        rel: rel.into(),
+        created_at: now_ms(),
+        updated_at: Some(now_ms()),
+        max_base_vol: 10.into(),
+        min_base_vol: 0.into(),
+        price: 1.into(),
+        matches: HashMap::new(),
+        started_swaps: Vec::new(),
+        uuid: new_uuid(),
+        conf_settings: None,
+        changes_history: None,
+        save_in_history: false,
+        base_orderbook_ticker: base_orderbook_ticker.map(String::from),
+        rel_orderbook_ticker: None,
+        p2p_privkey: None,
+        swap_version: SwapVersion::default(),
+        #[cfg(feature = "ibc-routing-for-swaps")]
+        order_metadata: OrderMetadata::default(),
+    };
+    let taker_request = |base: &str, rel: &str, action: TakerAction| TakerRequest {
+        base: base.into(),
+        rel: rel.into(),
+        uuid: new_uuid(),
+        dest_pub_key: H256Json::default(),
+        sender_pubkey: H256Json::default(),
+        base_amount: 1.into(),
+        rel_amount: 1.into(),
+        action,
+        match_by: MatchBy::Any,
+        conf_settings: None,
+        base_protocol_info: None,
+        rel_protocol_info: None,
+        swap_version: SwapVersion::default(),
+        #[cfg(feature = "ibc-routing-for-swaps")]
+        order_metadata: OrderMetadata::default(),
+    };
+    let candidates = |index: &MakerOrdersIndex, request: &TakerRequest| -> HashSet<Uuid> {
+        index.request_candidates(request).copied().collect()
+    };
+
+    let rick_morty = maker_order("RICK", "MORTY", None);
+    let rick_segwit_morty = maker_order("RICK-segwit", "MORTY", Some("RICK"));
+    let morty_rick = maker_order("MORTY", "RICK", None);
+    let mut index = MakerOrdersIndex::default();
+    for order in [&rick_morty, &rick_segwit_morty, &morty_rick] {
+        index.insert(order);
+    }
+    assert_eq!(index.len(), 3);
+
+    // the orders are found by the coin and the orderbook tickers
+    let expected = HashSet::from_iter([rick_morty.uuid, rick_segwit_morty.uuid]);
+    assert_eq!(
+        candidates(&index, &taker_request("RICK", "MORTY", TakerAction::Buy)),
+        expected
+    );
+    assert_eq!(
+        candidates(&index, &taker_request("MORTY", "RICK", TakerAction::Sell)),
+        expected
+    );
+    let expected = HashSet::from_iter([rick_segwit_morty.uuid]);
+    assert_eq!(
+        candidates(&index, &taker_request("RICK-segwit", "MORTY", TakerAction::Buy)),
+        expected
+    );
+    let expected = HashSet::from_iter([morty_rick.uuid]);
+    assert_eq!(
+        candidates(&index, &taker_request("MORTY", "RICK", TakerAction::Buy)),
+        expected
+    );
+    assert!(candidates(&index, &taker_request("RICK", "KMD", TakerAction::Buy)).is_empty());
+
+    // every order is matched with the requests on its pair only
+    for request in [
+        taker_request("RICK", "MORTY", TakerAction::Buy),
+        taker_request("MORTY", "RICK", TakerAction::Buy),
+        taker_request("RICK-segwit", "MORTY", TakerAction::Buy),
+        taker_request("MORTY", "RICK-segwit", TakerAction::Sell),
+    ] {
+        let found = candidates(&index, &request);
+        for order in [&rick_morty, &rick_segwit_morty, &morty_rick] {
+            let matched = matches!(order.match_with_request(&request), OrderMatchResult::Matched(_));
+            assert_eq!(found.contains(&order.uuid), matched);
+        }
+    }
+
+    index.remove(&rick_segwit_morty.uuid);
+    index.remove(&morty_rick.uuid);
+    let expected = HashSet::from_iter([rick_morty.uuid]);
+    assert_eq!(
+        candidates(&index, &taker_request("MORTY", "RICK", TakerAction::Sell)),
+        expected
+    );
+    assert!(candidates(&index, &taker_request("MORTY", "RICK", TakerAction::Buy)).is_empty());
+    assert_eq!(index.len(), 1);
+}
+
 #[test]
 fn test_taker_match_reserved() {
     let uuid = new_uuid();
@@ -1882,7 +1982,7 @@ fn test_process_get_orderbook_request() {
     orders_by_pubkeys.insert(pubkey3, pubkey3_orders);
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
 
     for order in orders_by_pubkeys.values().flatten() {
         orderbook.insert_or_update_order_update_trie(order.clone());
@@ -1922,7 +2022,7 @@ fn test_process_get_orderbook_request() {
 fn test_process_get_orderbook_request_limit() {
     let (ctx, pubkey, secret) = make_ctx_for_tests();
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
 
     let orders = make_random_orders(
         pubkey,
@@ -2033,37 +2133,31 @@ fn test_request_and_fill_orderbook() {
 
     // check if the best asks and bids are in the orderbook
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
 
     let expected = expected_orders.values().flatten().cloned().collect();
     assert_eq!(orderbook.order_set, expected);
 
     let expected = expected_orders.values().flatten().map(|(uuid, _order)| *uuid).collect();
     let unordered = orderbook
-        .unordered
-        .get(&("RICK".to_owned(), "MORTY".to_owned()))
+        .unordered_orders("RICK", "MORTY")
         .expect("No (RICK, MORTY) in unordered container");
     assert_eq!(*unordered, expected);
 
     let expected = expected_orders
         .values()
         .flatten()
-        .map(|(uuid, order)| OrderedByPriceOrder {
-            uuid: *uuid,
-            price: order.price.clone().into(),
-        })
+        .map(|(uuid, order)| (&order.price, *uuid))
         .collect();
     let ordered = orderbook
-        .ordered
-        .get(&("RICK".to_owned(), "MORTY".to_owned()))
+        .ordered_orders("RICK", "MORTY")
         .expect("No (RICK, MORTY) in unordered container");
     assert_eq!(*ordered, expected);
 
     let rick_morty_pair = alb_ordered_pair("RICK", "MORTY");
     for (pubkey, orders) in expected_orders {
         let pubkey_state = orderbook
-            .pubkeys_state
-            .get(&pubkey)
+            .pubkey_state(&pubkey)
             .unwrap_or_else(|| panic!("!pubkey_state.get() {} pubkey", pubkey));
 
         let expected = orders
@@ -2171,7 +2265,7 @@ fn test_process_order_keep_alive_requested_from_peer() {
         keep_alive
     )));
 
-    let mut orderbook = block_on(ordermatch_ctx.orderbook.lock());
+    let mut orderbook = block_on(ordermatch_ctx.orderbook.write());
     // try to find the order within OrdermatchContext::orderbook and check if this order equals to the expected
     let actual = orderbook.find_order_by_uuid_and_pubkey(&uuid, &pubkey).unwrap();
     let expected: OrderbookItem = (order, pubkey).into();
@@ -2186,7 +2280,7 @@ fn test_process_get_order_request() {
     let ordermatch_ctx_clone = ordermatch_ctx.clone();
     OrdermatchContext::from_ctx.mock_safe(move |_| MockResult::Return(Ok(ordermatch_ctx_clone.clone())));
 
-    let mut orderbook = block_on(ordermatch_ctx.orderbook.lock());
+    let mut orderbook = block_on(ordermatch_ctx.orderbook.write());
 
     let order = new_protocol::MakerOrderCreated {
         uuid: new_uuid().into(),
@@ -2256,7 +2350,7 @@ fn test_subscribe_to_ordermatch_topic_not_subscribed() {
     block_on(subscribe_to_orderbook_topic(&ctx, "RICK", "MORTY", true)).unwrap();
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = block_on(ordermatch_ctx.orderbook.lock());
+    let orderbook = block_on(ordermatch_ctx.orderbook.read());
 
     let actual = orderbook
         .topics_subscribed_to
@@ -2273,7 +2367,7 @@ fn test_subscribe_to_ordermatch_topic_subscribed_not_filled() {
 
     {
         let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-        let mut orderbook = block_on(ordermatch_ctx.orderbook.lock());
+        let mut orderbook = block_on(ordermatch_ctx.orderbook.write());
         // not enough time has passed for the orderbook to be filled
         let subscribed_at = now_ms() / 1000 - ORDERBOOK_REQUESTING_TIMEOUT + 1;
         orderbook.topics_subscribed_to.insert(
@@ -2306,7 +2400,7 @@ fn test_subscribe_to_ordermatch_topic_subscribed_not_filled() {
     block_on(subscribe_to_orderbook_topic(&ctx, "RICK", "MORTY", true)).unwrap();
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = block_on(ordermatch_ctx.orderbook.lock());
+    let orderbook = block_on(ordermatch_ctx.orderbook.read());
 
     let actual = orderbook
         .topics_subscribed_to
@@ -2327,7 +2421,7 @@ fn test_subscribe_to_ordermatch_topic_subscribed_filled() {
     let subscribed_at = now_ms() / 1000 - ORDERBOOK_REQUESTING_TIMEOUT - 1;
     {
         let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-        let mut orderbook = block_on(ordermatch_ctx.orderbook.lock());
+        let mut orderbook = block_on(ordermatch_ctx.orderbook.write());
         orderbook.topics_subscribed_to.insert(
             orderbook_topic("RICK", "MORTY"),
             OrderbookRequestingState::NotRequested { subscribed_at },
@@ -2341,7 +2435,7 @@ fn test_subscribe_to_ordermatch_topic_subscribed_filled() {
     block_on(subscribe_to_orderbook_topic(&ctx, "RICK", "MORTY", true)).unwrap();
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = block_on(ordermatch_ctx.orderbook.lock());
+    let orderbook = block_on(ordermatch_ctx.orderbook.read());
 
     let actual = orderbook
         .topics_subscribed_to
@@ -2405,27 +2499,58 @@ fn test_orderbook_insert_or_update_order() {
     orderbook.insert_or_update_order_update_trie(order);
 }
 
+#[test]
+fn test_orderbook_pair_orders_view() {
+    let (pubkey, secret) = pubkey_and_secret_for_test("pubkey");
+    let mut orderbook = Orderbook::default();
+    let mut orders = make_random_orders(pubkey, &secret, "C1".into(), "C2".into(), 3);
+    let new_order = orders.pop().unwrap();
+    for order in orders {
+        orderbook.insert_or_update_order_update_trie(order);
+    }
+
+    let view = orderbook.pair_orders_view("C1", "C2");
+    assert_eq!(view.orders.len(), 2);
+    assert!(view.orders[0].price <= view.orders[1].price);
+    // the view is shared by the readers until the pair changes
+    assert!(Arc::ptr_eq(&view, &orderbook.read_views.get("C1", "C2").unwrap()));
+    assert!(orderbook.pair_orders_view("C2", "C1").orders.is_empty());
+
+    orderbook.insert_or_update_order_update_trie(new_order.clone());
+    assert!(orderbook.read_views.get("C1", "C2").is_none());
+    assert!(orderbook.read_views.get("C2", "C1").is_some());
+    assert_eq!(orderbook.pair_orders_view("C1", "C2").orders.len(), 3);
+    // the views taken by the readers are immutable
+    assert_eq!(view.orders.len(), 2);
+
+    orderbook.remove_order_trie_update(new_order.uuid);
+    let view = orderbook.pair_orders_view("C1", "C2");
+    assert_eq!(view.orders.len(), 2);
+    assert!(view.orders.iter().all(|order| order.uuid != new_order.uuid));
+
+    orderbook.insert_my_p2p_pubkey("my_p2p_pubkey".to_owned());
+    assert!(orderbook.read_views.get("C2", "C1").is_none());
+    assert!(orderbook
+        .pair_orders_view("C1", "C2")
+        .my_p2p_pubkeys
+        .contains("my_p2p_pubkey"));
+}
+
 fn pair_trie_root_by_pub(ctx: &MmArc, pubkey: &str, pair: &str) -> H64 {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    *orderbook
-        .pubkeys_state
-        .get(pubkey)
-        .unwrap()
-        .trie_roots
-        .get(pair)
-        .unwrap()
+    let orderbook = ordermatch_ctx.orderbook.read();
+    *orderbook.pubkey_state(pubkey).unwrap().trie_roots.get(pair).unwrap()
 }
 
 fn clone_orderbook_memory_db(ctx: &MmArc) -> MemoryDB<Blake2Hasher64> {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
+    let orderbook = ordermatch_ctx.orderbook.read();
     orderbook.memory_db.clone()
 }
 
 fn remove_order(ctx: &MmArc, uuid: Uuid) {
     let ordermatch_ctx = OrdermatchContext::from_ctx(ctx).unwrap();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
     orderbook.remove_order_trie_update(uuid);
 }
 
@@ -2495,8 +2620,8 @@ fn test_diff_should_not_be_written_if_hash_not_changed_on_insert() {
     }
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    let pubkey_state = orderbook.pubkeys_state.get(&pubkey).unwrap();
+    let orderbook = ordermatch_ctx.orderbook.read();
+    let pubkey_state = orderbook.pubkey_state(&pubkey).unwrap();
     assert!(!pubkey_state
         .order_pairs_trie_state_history
         .get(&alb_ordered_pair)
@@ -2574,8 +2699,8 @@ fn test_diff_should_not_be_written_if_hash_not_changed_on_remove() {
     let pair_trie_root = pair_trie_root_by_pub(&ctx, &pubkey, &alb_ordered_pair);
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let orderbook = ordermatch_ctx.orderbook.lock();
-    let pubkey_state = orderbook.pubkeys_state.get(&pubkey).unwrap();
+    let orderbook = ordermatch_ctx.orderbook.read();
+    let pubkey_state = orderbook.pubkey_state(&pubkey).unwrap();
     assert!(!pubkey_state
         .order_pairs_trie_state_history
         .get(&alb_ordered_pair)
@@ -2590,7 +2715,8 @@ fn test_orderbook_pubkey_sync_request() {
         orderbook_topic_from_base_rel("C1", "C2"),
         OrderbookRequestingState::Requested,
     );
-    let pubkey = "pubkey";
+    let (pubkey, _) = pubkey_and_secret_for_test("pubkey");
+    let pubkey = pubkey.as_str();
 
     let mut trie_roots = HashMap::new();
     trie_roots.insert("C1:C2".to_owned(), [1; 8]);
@@ -2621,7 +2747,8 @@ fn test_orderbook_pubkey_sync_request_relay() {
         orderbook_topic_from_base_rel("C1", "C2"),
         OrderbookRequestingState::Requested,
     );
-    let pubkey = "pubkey";
+    let (pubkey, _) = pubkey_and_secret_for_test("pubkey");
+    let pubkey = pubkey.as_str();
 
     let mut trie_roots = HashMap::new();
     trie_roots.insert("C1:C2".to_owned(), [1; 8]);
@@ -2645,6 +2772,47 @@ fn test_orderbook_pubkey_sync_request_relay() {
     }
 }
 
+#[test]
+fn test_orderbook_snapshot_restores_tries() {
+    use super::orderbook_snapshot::{encode_orderbook_snapshot, restore_orderbook_snapshot};
+
+    let (my_pubkey, my_secret) = pubkey_and_secret_for_test("my_pubkey");
+    let (pubkey, secret) = pubkey_and_secret_for_test("pubkey");
+    let mut orderbook = Orderbook::default();
+    let mut orders = make_random_orders(pubkey.clone(), &secret, "RICK".into(), "MORTY".into(), 10);
+    orders.extend(make_random_orders(
+        pubkey.clone(),
+        &secret,
+        "MORTY".into(),
+        "KMD".into(),
+        5,
+    ));
+    orders.extend(make_random_orders(
+        my_pubkey.clone(),
+        &my_secret,
+        "RICK".into(),
+        "MORTY".into(),
+        5,
+    ));
+    for order in orders {
+        orderbook.insert_or_update_order_update_trie(order);
+    }
+
+    let snapshot = encode_orderbook_snapshot(&orderbook, &my_pubkey).unwrap();
+    let mut restored = Orderbook::default();
+    assert_eq!(restore_orderbook_snapshot(&mut restored, &snapshot), Ok(15));
+
+    // our own orders are not saved to the snapshot
+    assert!(restored.pubkey_state(&my_pubkey).is_none());
+    assert_eq!(restored.order_set.len(), 15);
+
+    let expected = orderbook.pubkey_state(&pubkey).unwrap();
+    let actual = restored.pubkey_state(&pubkey).unwrap();
+    assert_eq!(actual.trie_roots, expected.trie_roots);
+    assert_eq!(actual.orders_uuids, expected.orders_uuids);
+    assert_eq!(actual.last_keep_alive, expected.last_keep_alive);
+}
+
 #[test]
 fn test_trie_diff_avoid_cycle_on_insertion() {
     let mut history = TrieDiffHistory::<String, String> { inner: TimedMap::new() };
@@ -2694,12 +2862,11 @@ fn test_process_sync_pubkey_orderbook_state_points_to_not_uptodate_trie_root() {
     // update trie root by adding a new order and do not update history
     let (old_root, _new_root) = {
         let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-        let mut orderbook = ordermatch_ctx.orderbook.lock();
+        let mut orderbook = ordermatch_ctx.orderbook.write();
 
         log!("{:?}, found {:?}", pubkey, orderbook.pubkeys_state.keys());
         let old_root = *orderbook
-            .pubkeys_state
-            .get_mut(&pubkey)
+            .existing_pubkey_state_mut(&pubkey)
             .expect("!pubkeys_state")
             .trie_roots
             .get(&alb_pair)
@@ -2714,8 +2881,7 @@ fn test_process_sync_pubkey_orderbook_state_points_to_not_uptodate_trie_root() {
 
         // update root in orderbook trie_roots
         orderbook
-            .pubkeys_state
-            .get_mut(&pubkey)
+            .existing_pubkey_state_mut(&pubkey)
             .expect("!pubkeys_state")
             .trie_roots
             .insert(alb_pair.clone(), new_root);
@@ -2748,7 +2914,7 @@ fn test_process_sync_pubkey_orderbook_state_points_to_not_uptodate_trie_root() {
 }
 
 fn check_if_orderbook_contains_only(orderbook: &Orderbook, pubkey: &str, orders: &[OrderbookItem]) {
-    let pubkey_state = orderbook.pubkeys_state.get(pubkey).expect("!pubkeys_state");
+    let pubkey_state = orderbook.pubkey_state(pubkey).expect("!pubkeys_state");
 
     // order_set
     let expected_set: HashMap<_, _> = orders.iter().map(|order| (order.uuid, order.clone())).collect();
@@ -2757,16 +2923,20 @@ fn check_if_orderbook_contains_only(orderbook: &Orderbook, pubkey: &str, orders:
     // ordered
     let mut expected_ordered = HashMap::new();
     for order in orders.iter() {
-        let item = OrderedByPriceOrder {
-            uuid: order.uuid,
-            price: order.price.clone().into(),
-        };
-        let set = expected_ordered
+        let index = expected_ordered
             .entry((order.base.clone(), order.rel.clone()))
-            .or_insert_with(BTreeSet::default);
-        set.insert(item);
+            .or_insert_with(PriceIndex::default);
+        index.insert(&order.price, order.uuid);
     }
-    assert_eq!(orderbook.ordered, expected_ordered);
+    let actual_ordered: HashMap<_, _> = orderbook
+        .ordered
+        .iter()
+        .map(|((base, rel), index)| {
+            let pair = (orderbook.tickers.resolve(*base), orderbook.tickers.resolve(*rel));
+            ((pair.0.to_owned(), pair.1.to_owned()), index.clone())
+        })
+        .collect();
+    assert_eq!(actual_ordered, expected_ordered);
 
     // unordered
     let mut expected_unordered = HashMap::new();
@@ -2776,7 +2946,15 @@ fn check_if_orderbook_contains_only(orderbook: &Orderbook, pubkey: &str, orders:
             .or_insert_with(HashSet::default);
         set.insert(order.uuid);
     }
-    assert_eq!(orderbook.unordered, expected_unordered);
+    let actual_unordered: HashMap<_, _> = orderbook
+        .unordered
+        .iter()
+        .map(|((base, rel), uuids)| {
+            let pair = (orderbook.tickers.resolve(*base), orderbook.tickers.resolve(*rel));
+            ((pair.0.to_owned(), pair.1.to_owned()), uuids.clone())
+        })
+        .collect();
+    assert_eq!(actual_unordered, expected_unordered);
 
     // history
     let actual_keys: HashSet<_> = pubkey_state
@@ -2844,7 +3022,7 @@ fn test_remove_and_purge_pubkey_pair_orders() {
     let rick_morty_pair = alb_ordered_pair("RICK", "MORTY");
 
     let ordermatch_ctx = OrdermatchContext::from_ctx(&ctx).unwrap();
-    let mut orderbook = ordermatch_ctx.orderbook.lock();
+    let mut orderbook = ordermatch_ctx.orderbook.write();
 
     remove_pubkey_pair_orders(&mut orderbook, &pubkey, &rick_morty_pair);
     check_if_orderbook_contains_only(&orderbook, &pubkey, &rick_kmd_orders);
@@ -2868,8 +3046,8 @@ fn test_orderbook_sync_trie_diff_time_cache() {
     }
 
     let ordermatch_ctx_bob = OrdermatchContext::from_ctx(&ctx_bob).unwrap();
-    let orderbook_bob = ordermatch_ctx_bob.orderbook.lock();
-    let bob_state = orderbook_bob.pubkeys_state.get(&pubkey_bob).unwrap();
+    let orderbook_bob = ordermatch_ctx_bob.orderbook.read();
+    let bob_state = orderbook_bob.pubkey_state(&pubkey_bob).unwrap();
     let rick_morty_history_bob = bob_state.order_pairs_trie_state_history.get(&rick_morty_pair).unwrap();
     assert_eq!(rick_morty_history_bob.len(), 5);
 
@@ -2881,8 +3059,8 @@ fn test_orderbook_sync_trie_diff_time_cache() {
     }
 
     let ordermatch_ctx_alice = OrdermatchContext::from_ctx(&ctx_alice).unwrap();
-    let mut orderbook_alice = ordermatch_ctx_alice.orderbook.lock();
-    let bob_state_on_alice_side = orderbook_alice.pubkeys_state.get(&pubkey_bob).unwrap();
+    let mut orderbook_alice = ordermatch_ctx_alice.orderbook.write();
+    let bob_state_on_alice_side = orderbook_alice.pubkey_state(&pubkey_bob).unwrap();
 
     let alice_root = bob_state_on_alice_side.trie_roots.get(&rick_morty_pair).unwrap();
     let bob_root = bob_state.trie_roots.get(&rick_morty_pair).unwrap();
@@ -2925,15 +3103,15 @@ fn test_orderbook_sync_trie_diff_time_cache() {
         insert_or_update_order(&ctx_bob, order.clone());
     }
 
-    let mut orderbook_bob = ordermatch_ctx_bob.orderbook.lock();
+    let mut orderbook_bob = ordermatch_ctx_bob.orderbook.write();
 
     orderbook_bob.remove_order_trie_update(rick_morty_orders[12].uuid);
 
-    let bob_state = orderbook_bob.pubkeys_state.get(&pubkey_bob).unwrap();
+    let bob_state = orderbook_bob.pubkey_state(&pubkey_bob).unwrap();
     let rick_morty_history_bob = bob_state.order_pairs_trie_state_history.get(&rick_morty_pair).unwrap();
 
-    let mut orderbook_alice = ordermatch_ctx_alice.orderbook.lock();
-    let bob_state_on_alice_side = orderbook_alice.pubkeys_state.get(&pubkey_bob).unwrap();
+    let mut orderbook_alice = ordermatch_ctx_alice.orderbook.write();
+    let bob_state_on_alice_side = orderbook_alice.pubkey_state(&pubkey_bob).unwrap();
 
     let alice_root = bob_state_on_alice_side.trie_roots.get(&rick_morty_pair).unwrap();
     let bob_root = bob_state.trie_roots.get(&rick_morty_pair).unwrap();
@@ -2990,8 +3168,8 @@ fn test_orderbook_order_pairs_trie_state_history_updates_expiration_on_insert()
     }
 
     let ordermatch_ctx_bob = OrdermatchContext::from_ctx(&ctx_bob).unwrap();
-    let orderbook_bob = ordermatch_ctx_bob.orderbook.lock();
-    let bob_state = orderbook_bob.pubkeys_state.get(&pubkey_bob).unwrap();
+    let orderbook_bob = ordermatch_ctx_bob.orderbook.read();
+    let bob_state = orderbook_bob.pubkey_state(&pubkey_bob).unwrap();
 
     // Only the last inserted 5 orders are found
     assert_eq!(
@@ -3013,8 +3191,8 @@ fn test_orderbook_order_pairs_trie_state_history_updates_expiration_on_insert()
     }
 
     let ordermatch_ctx_bob = OrdermatchContext::from_ctx(&ctx_bob).unwrap();
-    let orderbook_bob = ordermatch_ctx_bob.orderbook.lock();
-    let bob_state = orderbook_bob.pubkeys_state.get(&pubkey_bob).unwrap();
+    let orderbook_bob = ordermatch_ctx_bob.orderbook.read();
+    let bob_state = orderbook_bob.pubkey_state(&pubkey_bob).unwrap();
 
     assert_eq!(
         bob_state
@@ -3030,8 +3208,8 @@ fn test_orderbook_order_pairs_trie_state_history_updates_expiration_on_insert()
     std::thread::sleep(Duration::from_secs(1));
 
     let ordermatch_ctx_bob = OrdermatchContext::from_ctx(&ctx_bob).unwrap();
-    let orderbook_bob = ordermatch_ctx_bob.orderbook.lock();
-    let bob_state = orderbook_bob.pubkeys_state.get(&pubkey_bob).unwrap();
+    let orderbook_bob = ordermatch_ctx_bob.orderbook.read();
+    let bob_state = orderbook_bob.pubkey_state(&pubkey_bob).unwrap();
 
     // After 3 seconds from inserting orders number 6-10 these orders have not expired due to updated expiration on inserting orders 11-15
     assert_eq!(
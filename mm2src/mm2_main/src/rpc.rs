@@ -32,13 +32,17 @@ use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
 use mm2_rpc::mm_protocol::{MmRpcBuilder, MmRpcResponse, MmRpcVersion};
 use serde::Serialize;
+use serde_json::value::RawValue;
 use serde_json::{self as json, Value as Json};
 use std::net::SocketAddr;
 
 cfg_native! {
     use hyper::{self, Body, Server};
+    use common::executor::SpawnFuture;
     use futures::channel::oneshot;
     use mm2_net::event_streaming::sse_handler::{handle_sse, SSE_ENDPOINT};
+    use serde::de::IgnoredAny;
+    use request_body::RpcRequestBody;
 }
 
 #[path = "rpc/dispatcher/dispatcher.rs"] mod dispatcher;
@@ -46,6 +50,7 @@ cfg_native! {
 mod dispatcher_legacy;
 pub mod lp_commands;
 mod rate_limiter;
+#[cfg(not(target_arch = "wasm32"))] mod request_body;
 mod streaming_activations;
 pub mod wc_commands;
 
@@ -121,12 +126,45 @@ macro_rules! unwrap_or_err_response {
     };
 }
 
-async fn process_json_batch_requests(ctx: MmArc, requests: &[Json], client: SocketAddr) -> Result<Json, String> {
-    let mut futures = Vec::with_capacity(requests.len());
-    for request in requests {
-        futures.push(process_single_request(ctx.clone(), request.clone(), client));
-    }
-    let results = join_all(futures).await;
+/// Processes the independent items of a batch request concurrently,
+/// every item being spawned on its own task to be processed in parallel by the executor threads.
+#[cfg(not(target_arch = "wasm32"))]
+async fn process_batch_items(
+    ctx: MmArc,
+    requests: Vec<Json>,
+    client: SocketAddr,
+) -> Vec<Result<Response<Vec<u8>>, String>> {
+    let spawner = ctx.spawner();
+    let responses: Vec<_> = requests
+        .into_iter()
+        .map(|request| {
+            let (tx, rx) = oneshot::channel();
+            let ctx = ctx.clone();
+            spawner.spawn(async move {
+                tx.send(process_single_request(ctx, request, None, client).await).ok();
+            });
+            rx.map(|response| response.unwrap_or_else(|_| ERR!("The request was aborted")))
+        })
+        .collect();
+    join_all(responses).await
+}
+
+/// Processes the independent items of a batch request concurrently on the single threaded executor.
+#[cfg(target_arch = "wasm32")]
+async fn process_batch_items(
+    ctx: MmArc,
+    requests: Vec<Json>,
+    client: SocketAddr,
+) -> Vec<Result<Response<Vec<u8>>, String>> {
+    let responses = requests
+        .into_iter()
+        .map(|request| process_single_request(ctx.clone(), request, None, client));
+    join_all(responses).await
+}
+
+#[cfg(target_arch = "wasm32")]
+async fn process_json_batch_requests(ctx: MmArc, requests: Vec<Json>, client: SocketAddr) -> Result<Json, String> {
+    let results = process_batch_items(ctx, requests, client).await;
     let responses: Vec<_> = results
         .into_iter()
         .map(|resp| match resp {
@@ -143,27 +181,56 @@ async fn process_json_batch_requests(ctx: MmArc, requests: &[Json], client: Sock
     Ok(Json::Array(responses))
 }
 
+#[cfg(not(target_arch = "wasm32"))]
+async fn process_json_batch_requests(ctx: MmArc, requests: Vec<Json>, client: SocketAddr) -> Result<Vec<u8>, String> {
+    let results = process_batch_items(ctx, requests, client).await;
+    batch_response_body(results)
+}
+
+/// Writes the response bodies of the batch items as is into the JSON array of the batch response,
+/// only checking that they are valid JSON instead of deserializing and serializing them again.
+#[cfg(not(target_arch = "wasm32"))]
+fn batch_response_body(results: Vec<Result<Response<Vec<u8>>, String>>) -> Result<Vec<u8>, String> {
+    let mut body = vec![b'['];
+    for (i, resp) in results.into_iter().enumerate() {
+        if i > 0 {
+            body.push(b',');
+        }
+        match resp {
+            Ok(r) => match json::from_slice::<IgnoredAny>(r.body()) {
+                Ok(_) => body.extend_from_slice(r.body()),
+                Err(e) => {
+                    error!("Response {:?} is not a valid JSON, error: {}", r, e);
+                    body.extend_from_slice(b"null");
+                },
+            },
+            Err(e) => try_s!(json::to_writer(&mut body, &err_tp_rpc_json(e))),
+        }
+    }
+    body.push(b']');
+    Ok(body)
+}
+
 #[cfg(target_arch = "wasm32")]
-async fn process_json_request(ctx: MmArc, req_json: Json, client: SocketAddr) -> Result<Json, String> {
-    if let Some(requests) = req_json.as_array() {
+pub async fn process_json_request(ctx: MmArc, req_json: Json, client: SocketAddr) -> Result<Json, String> {
+    if let Json::Array(requests) = req_json {
         return process_json_batch_requests(ctx, requests, client)
             .await
             .map_err(|e| ERRL!("{}", e));
     }
 
-    let r = try_s!(process_single_request(ctx, req_json, client).await);
+    let r = try_s!(process_single_request(ctx, req_json, None, client).await);
     json::from_slice(r.body()).map_err(|e| ERRL!("Response {:?} is not a valid JSON, error: {}", r, e))
 }
 
 #[cfg(not(target_arch = "wasm32"))]
-async fn process_json_request(ctx: MmArc, req_json: Json, client: SocketAddr) -> Result<Response<Vec<u8>>, String> {
-    if let Some(requests) = req_json.as_array() {
-        let response = try_s!(process_json_batch_requests(ctx, requests, client).await);
-        let res = try_s!(json::to_vec(&response));
+pub async fn process_json_request(ctx: MmArc, req_json: Json, client: SocketAddr) -> Result<Response<Vec<u8>>, String> {
+    if let Json::Array(requests) = req_json {
+        let res = try_s!(process_json_batch_requests(ctx, requests, client).await);
         return Ok(try_s!(Response::builder().body(res)));
     }
 
-    process_single_request(ctx, req_json, client).await
+    process_single_request(ctx, req_json, None, client).await
 }
 
 fn response_from_dispatcher_error(
@@ -176,14 +243,22 @@ fn response_from_dispatcher_error(
     response.serialize_http_response()
 }
 
-async fn process_single_request(ctx: MmArc, mut req: Json, client: SocketAddr) -> Result<Response<Vec<u8>>, String> {
+/// `raw_params` are the undecoded params of a v2 request, see `RpcRequestBody`.
+/// The legacy requests (without `mmrpc`) are expected to have their params in `req`.
+async fn process_single_request(
+    ctx: MmArc,
+    mut req: Json,
+    raw_params: Option<Box<RawValue>>,
+    client: SocketAddr,
+) -> Result<Response<Vec<u8>>, String> {
     let local_only = ctx.conf["rpc_local_only"].as_bool().unwrap_or(true);
     if req["mmrpc"].is_null() {
-        match dispatcher_legacy::process_single_request(ctx.clone(), req.clone(), client, local_only).await {
+        match dispatcher_legacy::process_single_request(ctx.clone(), req, client, local_only).await {
             Ok(t) => return Ok(t),
 
-            Err(dispatcher_legacy::LegacyRequestProcessError::NoMatch) => {
+            Err(dispatcher_legacy::LegacyRequestProcessError::NoMatch(legacy_req)) => {
                 // Try the v2 implementation
+                req = legacy_req;
                 req["mmrpc"] = json!("2.0");
                 info!(
                     "Couldn't resolve '{}' RPC using the legacy API, trying v2 (mmrpc: 2.0) instead.",
@@ -207,7 +282,7 @@ async fn process_single_request(ctx: MmArc, mut req: Json, client: SocketAddr) -
         },
     };
 
-    match dispatcher::process_single_request(ctx, req, client, local_only).await {
+    match dispatcher::process_single_request(ctx, req, raw_params, client, local_only).await {
         Ok(response) => Ok(response),
         Err(e) => {
             // return always serialized response
@@ -237,14 +312,20 @@ async fn rpc_service(req: Request<Body>, ctx_h: u32, client: SocketAddr) -> Resp
     async fn process_rpc_request(
         ctx: MmArc,
         req: Parts,
-        req_json: Json,
+        req_body: RpcRequestBody,
         client: SocketAddr,
     ) -> Result<Response<Vec<u8>>, String> {
         if req.method != Method::POST {
             return ERR!("Only POST requests are supported!");
         }
 
-        process_json_request(ctx, req_json, client).await
+        match req_body {
+            RpcRequestBody::Batch(requests) => {
+                let res = try_s!(process_json_batch_requests(ctx, requests, client).await);
+                Ok(try_s!(Response::builder().body(res)))
+            },
+            RpcRequestBody::Single { req, params } => process_single_request(ctx, req, params, client).await,
+        }
     }
 
     let ctx = try_sf!(MmArc::from_ffi_handle(ctx_h));
@@ -274,12 +355,12 @@ async fn rpc_service(req: Request<Body>, ctx_h: u32, client: SocketAddr) -> Resp
             .unwrap();
     }
 
-    let req_json = {
+    let req_body: RpcRequestBody = {
         let req_bytes = try_sf!(hyper::body::to_bytes(req_body).await, ACCESS_CONTROL_ALLOW_ORIGIN => rpc_cors);
         try_sf!(json::from_slice(&req_bytes), ACCESS_CONTROL_ALLOW_ORIGIN => rpc_cors)
     };
 
-    let res = try_sf!(process_rpc_request(ctx, req, req_json, client).await, ACCESS_CONTROL_ALLOW_ORIGIN => rpc_cors);
+    let res = try_sf!(process_rpc_request(ctx, req, req_body, client).await, ACCESS_CONTROL_ALLOW_ORIGIN => rpc_cors);
     let (mut parts, body) = res.into_parts();
     parts.headers.insert(ACCESS_CONTROL_ALLOW_ORIGIN, rpc_cors);
 
@@ -542,3 +623,36 @@ pub fn spawn_rpc(ctx_h: u32) {
         common::now_ms() / 1000
     );
 }
+
+#[cfg(all(test, not(target_arch = "wasm32")))]
+mod tests {
+    use super::*;
+
+    fn response(body: &str) -> Result<Response<Vec<u8>>, String> {
+        Ok(Response::builder().body(body.as_bytes().to_vec()).unwrap())
+    }
+
+    #[test]
+    fn test_batch_response_body() {
+        let results = vec![
+            response(r#"{"result":"first"}"#),
+            response("not a JSON"),
+            Err("The request was aborted".to_owned()),
+            response(r#"{"mmrpc":"2.0","result":[1,2]}"#),
+        ];
+        let body = batch_response_body(results).unwrap();
+
+        // The valid bodies are written as is and in the order of the requests.
+        let expected =
+            br#"[{"result":"first"},null,{"error":"The request was aborted"},{"mmrpc":"2.0","result":[1,2]}]"#;
+        assert_eq!(body, expected.to_vec());
+
+        let actual: Json = json::from_slice(&body).unwrap();
+        assert_eq!(actual[2], err_tp_rpc_json("The request was aborted".to_owned()));
+    }
+
+    #[test]
+    fn test_empty_batch_response_body() {
+        assert_eq!(batch_response_body(Vec::new()).unwrap(), b"[]".to_vec());
+    }
+}
@@ -59,8 +59,10 @@ use coins_activation::{cancel_init_l2, cancel_init_platform_coin_with_tokens, ca
                        init_standalone_coin_user_action, init_token, init_token_status, init_token_user_action};
 use common::log::{error, warn};
 use common::HttpStatusCode;
+use futures::future::BoxFuture;
 use futures::Future as Future03;
 use http::Response;
+use lazy_static::lazy_static;
 use mm2_core::data_asker::send_asked_data_rpc;
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
@@ -68,16 +70,40 @@ use mm2_rpc::mm_protocol::{MmRpcBuilder, MmRpcRequest, MmRpcVersion};
 use nft::{clear_nft_db, get_nft_list, get_nft_metadata, get_nft_transfers, refresh_nft_metadata, update_nft,
           withdraw_nft};
 use serde::de::DeserializeOwned;
+use serde_json::value::RawValue;
 use serde_json::{self as json, Value as Json};
+use std::collections::HashMap;
 use std::net::SocketAddr;
 
 cfg_native! {
     use coins::lightning::LightningCoin;
 }
 
+type MmRpcFuture = BoxFuture<'static, DispatcherResult<Response<Vec<u8>>>>;
+type MmRpcHandler = fn(MmArc, MmRpcRequest, Option<Box<RawValue>>) -> MmRpcFuture;
+
+/// Wraps `handle_mmrpc_params` over the given RPC handler into an `MmRpcHandler`.
+macro_rules! mmrpc_handler {
+    ($handler: expr) => {{
+        fn handler(ctx: MmArc, request: MmRpcRequest, raw_params: Option<Box<RawValue>>) -> MmRpcFuture {
+            Box::pin(handle_mmrpc_params(ctx, request, raw_params, $handler))
+        }
+        handler as MmRpcHandler
+    }};
+}
+
+lazy_static! {
+    static ref MMRPC_METHODS: HashMap<&'static str, MmRpcHandler> = mmrpc_methods();
+}
+
+/// Processes a v2 request.
+///
+/// `raw_params` are the params left undecoded in the request body, see `RpcRequestBody`.
+/// They are deserialized straight into the params of the resolved method, the `params` of `req` being ignored then.
 pub async fn process_single_request(
     ctx: MmArc,
     req: Json,
+    raw_params: Option<Box<RawValue>>,
     client: SocketAddr,
     local_only: bool,
 ) -> DispatcherResult<Response<Vec<u8>>> {
@@ -90,13 +116,13 @@ pub async fn process_single_request(
     }
 
     let rate_limit_ctx = RateLimitContext::from_ctx(&ctx).unwrap();
-    if rate_limit_ctx.is_banned(client.ip()).await {
+    if rate_limit_ctx.is_banned(client.ip()) {
         return MmError::err(DispatcherError::Banned);
     }
 
     auth(&request, &ctx, &client).await?;
     match request.mmrpc {
-        MmRpcVersion::V2 => dispatcher_v2(request, ctx).await,
+        MmRpcVersion::V2 => dispatcher_v2(request, raw_params, ctx).await,
     }
 }
 
@@ -122,7 +148,27 @@ where
     T: serde::Serialize + 'static,
     E: SerMmErrorType + HttpStatusCode + 'static,
 {
-    let params = json::from_value(request.params)?;
+    handle_mmrpc_params(ctx, request, None, handler).await
+}
+
+/// Same as `handle_mmrpc`, but deserializes the `Request` from `raw_params` if they are given.
+async fn handle_mmrpc_params<Handler, Fut, Request, T, E>(
+    ctx: MmArc,
+    request: MmRpcRequest,
+    raw_params: Option<Box<RawValue>>,
+    handler: Handler,
+) -> DispatcherResult<Response<Vec<u8>>>
+where
+    Handler: FnOnce(MmArc, Request) -> Fut,
+    Fut: Future03<Output = Result<T, MmError<E>>>,
+    Request: DeserializeOwned,
+    T: serde::Serialize + 'static,
+    E: SerMmErrorType + HttpStatusCode + 'static,
+{
+    let params = match raw_params {
+        Some(raw_params) => json::from_str(raw_params.get())?,
+        None => json::from_value(request.params)?,
+    };
     let result = handler(ctx, params).await;
     if let Err(ref e) = result {
         error!("RPC error response: {}", e);
@@ -146,7 +192,7 @@ async fn auth(request: &MmRpcRequest, ctx: &MmArc, client: &SocketAddr) -> Dispa
     });
     match request.userpass {
         Some(ref userpass) if userpass == rpc_password => Ok(()),
-        Some(_) => Err(process_rate_limit(ctx, client).await),
+        Some(_) => Err(process_rate_limit(ctx, client)),
         None => MmError::err(DispatcherError::UserpassIsNotSet),
     }
 }
@@ -167,17 +213,25 @@ async fn experimental_rpcs_dispatcher(
     MmError::err(DispatcherError::NoSuchMethod)
 }
 
-async fn dispatcher_v2(request: MmRpcRequest, ctx: MmArc) -> DispatcherResult<Response<Vec<u8>>> {
+async fn dispatcher_v2(
+    mut request: MmRpcRequest,
+    raw_params: Option<Box<RawValue>>,
+    ctx: MmArc,
+) -> DispatcherResult<Response<Vec<u8>>> {
+    if let Some(handler) = MMRPC_METHODS.get(request.method.as_str()) {
+        return handler(ctx, request, raw_params).await;
+    }
+
+    // The namespaced dispatchers below decode the params from the `Value`.
+    if let Some(raw_params) = raw_params {
+        request.params = json::from_str(raw_params.get())?;
+    }
+
     if let Some(streaming_request) = request.method.strip_prefix("stream::") {
         let streaming_request = streaming_request.to_string();
         return rpc_streaming_dispatcher(request, ctx, streaming_request).await;
     }
 
-    if let Some(task_method) = request.method.strip_prefix("task::") {
-        let task_method = task_method.to_string();
-        return rpc_task_dispatcher(request, ctx, task_method).await;
-    }
-
     if let Some(gui_storage_method) = request.method.strip_prefix("gui_storage::") {
         let gui_storage_method = gui_storage_method.to_owned();
         return gui_storage_dispatcher(request, ctx, &gui_storage_method).await;
@@ -194,191 +248,358 @@ async fn dispatcher_v2(request: MmRpcRequest, ctx: MmArc) -> DispatcherResult<Re
         return lightning_dispatcher(request, ctx, &lightning_method).await;
     }
 
-    match request.method.as_str() {
-        "account_balance" => handle_mmrpc(ctx, request, account_balance).await,
-        "active_swaps" => handle_mmrpc(ctx, request, active_swaps_rpc).await,
-        "add_node_to_version_stat" => handle_mmrpc(ctx, request, add_node_to_version_stat).await,
-        "approve_token" => handle_mmrpc(ctx, request, approve_token_rpc).await,
-        "get_token_allowance" => handle_mmrpc(ctx, request, get_token_allowance_rpc).await,
-        "best_orders" => handle_mmrpc(ctx, request, best_orders_rpc_v2).await,
-        "clear_nft_db" => handle_mmrpc(ctx, request, clear_nft_db).await,
-        "delete_wallet" => handle_mmrpc(ctx, request, delete_wallet_rpc).await,
-        "enable_bch_with_tokens" => handle_mmrpc(ctx, request, enable_platform_coin_with_tokens::<BchCoin>).await,
-        "enable_slp" => handle_mmrpc(ctx, request, enable_token::<SlpToken>).await,
-        "enable_eth_with_tokens" => handle_mmrpc(ctx, request, enable_platform_coin_with_tokens::<EthCoin>).await,
-        "enable_erc20" => handle_mmrpc(ctx, request, enable_token::<EthCoin>).await,
-        "enable_nft" => handle_mmrpc(ctx, request, enable_token::<EthCoin>).await,
-        "enable_tendermint_with_assets" => {
-            handle_mmrpc(ctx, request, enable_platform_coin_with_tokens::<TendermintCoin>).await
-        },
-        "enable_tendermint_token" => handle_mmrpc(ctx, request, enable_token::<TendermintToken>).await,
-        "get_current_mtp" => handle_mmrpc(ctx, request, get_current_mtp_rpc).await,
-        "get_enabled_coins" => handle_mmrpc(ctx, request, get_enabled_coins_rpc).await,
-        "get_locked_amount" => handle_mmrpc(ctx, request, get_locked_amount_rpc).await,
-        "get_mnemonic" => handle_mmrpc(ctx, request, get_mnemonic_rpc).await,
-        "get_my_address" => handle_mmrpc(ctx, request, get_my_address).await,
-        "get_new_address" => handle_mmrpc(ctx, request, get_new_address).await,
-        "get_private_keys" => handle_mmrpc(ctx, request, get_private_keys).await,
-        "get_nft_list" => handle_mmrpc(ctx, request, get_nft_list).await,
-        "get_nft_metadata" => handle_mmrpc(ctx, request, get_nft_metadata).await,
-        "get_nft_transfers" => handle_mmrpc(ctx, request, get_nft_transfers).await,
-        "get_public_key" => handle_mmrpc(ctx, request, get_public_key).await,
-        "get_public_key_hash" => handle_mmrpc(ctx, request, get_public_key_hash).await,
-        "get_raw_transaction" => handle_mmrpc(ctx, request, get_raw_transaction).await,
-        "get_shared_db_id" => handle_mmrpc(ctx, request, get_shared_db_id).await,
-        "get_token_info" => handle_mmrpc(ctx, request, get_token_info).await,
-        "get_wallet_names" => handle_mmrpc(ctx, request, get_wallet_names_rpc).await,
-        "max_maker_vol" => handle_mmrpc(ctx, request, max_maker_vol).await,
-        "my_recent_swaps" => handle_mmrpc(ctx, request, my_recent_swaps_rpc).await,
-        "my_swap_status" => handle_mmrpc(ctx, request, my_swap_status_rpc).await,
-        "my_tx_history" => handle_mmrpc(ctx, request, my_tx_history_v2_rpc).await,
-        "orderbook" => handle_mmrpc(ctx, request, orderbook_rpc_v2).await,
-        "recreate_swap_data" => handle_mmrpc(ctx, request, recreate_swap_data).await,
-        "refresh_nft_metadata" => handle_mmrpc(ctx, request, refresh_nft_metadata).await,
-        "remove_node_from_version_stat" => handle_mmrpc(ctx, request, remove_node_from_version_stat).await,
-        "sign_message" => handle_mmrpc(ctx, request, sign_message).await,
-        "sign_raw_transaction" => handle_mmrpc(ctx, request, sign_raw_transaction).await,
-        "start_simple_market_maker_bot" => handle_mmrpc(ctx, request, start_simple_market_maker_bot).await,
-        "start_version_stat_collection" => handle_mmrpc(ctx, request, start_version_stat_collection).await,
-        "stop_simple_market_maker_bot" => handle_mmrpc(ctx, request, stop_simple_market_maker_bot).await,
-        "stop_version_stat_collection" => handle_mmrpc(ctx, request, stop_version_stat_collection).await,
-        "trade_preimage" => handle_mmrpc(ctx, request, trade_preimage_rpc).await,
-        "trezor_connection_status" => handle_mmrpc(ctx, request, trezor_connection_status).await,
-        "update_nft" => handle_mmrpc(ctx, request, update_nft).await,
-        "change_mnemonic_password" => handle_mmrpc(ctx, request, change_mnemonic_password).await,
-        "update_version_stat_collection" => handle_mmrpc(ctx, request, update_version_stat_collection).await,
-        "verify_message" => handle_mmrpc(ctx, request, verify_message).await,
-        "withdraw" => handle_mmrpc(ctx, request, withdraw).await,
-        "peer_connection_healthcheck" => handle_mmrpc(ctx, request, peer_connection_healthcheck_rpc).await,
-        "withdraw_nft" => handle_mmrpc(ctx, request, withdraw_nft).await,
-        "get_eth_estimated_fee_per_gas" => handle_mmrpc(ctx, request, get_eth_estimated_fee_per_gas).await,
-        "get_swap_transaction_fee_policy" => handle_mmrpc(ctx, request, get_swap_transaction_fee_policy).await,
-        "set_swap_transaction_fee_policy" => handle_mmrpc(ctx, request, set_swap_transaction_fee_policy).await,
-        "send_asked_data" => handle_mmrpc(ctx, request, send_asked_data_rpc).await,
-        "z_coin_tx_history" => handle_mmrpc(ctx, request, coins::my_tx_history_v2::z_coin_tx_history_rpc).await,
-        "1inch_v6_0_classic_swap_contract" => handle_mmrpc(ctx, request, one_inch_v6_0_classic_swap_contract_rpc).await,
-        "1inch_v6_0_classic_swap_quote" => handle_mmrpc(ctx, request, one_inch_v6_0_classic_swap_quote_rpc).await,
-        "1inch_v6_0_classic_swap_create" => handle_mmrpc(ctx, request, one_inch_v6_0_classic_swap_create_rpc).await,
-        "1inch_v6_0_classic_swap_liquidity_sources" => {
-            handle_mmrpc(ctx, request, one_inch_v6_0_classic_swap_liquidity_sources_rpc).await
-        },
-        "1inch_v6_0_classic_swap_tokens" => handle_mmrpc(ctx, request, one_inch_v6_0_classic_swap_tokens_rpc).await,
-        "wc_new_connection" => handle_mmrpc(ctx, request, new_connection).await,
-        "wc_get_session" => handle_mmrpc(ctx, request, get_session).await,
-        "wc_get_sessions" => handle_mmrpc(ctx, request, get_all_sessions).await,
-        "wc_delete_session" => handle_mmrpc(ctx, request, disconnect_session).await,
-        "wc_ping_session" => handle_mmrpc(ctx, request, ping_session).await,
-        _ => MmError::err(DispatcherError::NoSuchMethod),
-    }
+    MmError::err(DispatcherError::NoSuchMethod)
 }
 
-/// `task` dispatcher.
-/// The full path is expected to be `task::method::action`.
-/// For example, `task::withdraw::init`, `task::create_new_account::init` etc.
+/// The methods resolved by `dispatcher_v2` with a single lookup.
 ///
-/// # Note
-///
-/// `task_method` is a method name with the `task::` prefix removed.
-async fn rpc_task_dispatcher(
-    request: MmRpcRequest,
-    ctx: MmArc,
-    task_method: String,
-) -> DispatcherResult<Response<Vec<u8>>> {
-    match task_method.as_str() {
-        "account_balance::cancel" => handle_mmrpc(ctx, request, cancel_account_balance).await,
-        "account_balance::init" => handle_mmrpc(ctx, request, init_account_balance).await,
-        "account_balance::status" => handle_mmrpc(ctx, request, init_account_balance_status).await,
-        "create_new_account::cancel" => handle_mmrpc(ctx, request, cancel_create_new_account).await,
-        "create_new_account::init" => handle_mmrpc(ctx, request, init_create_new_account).await,
-        "create_new_account::status" => handle_mmrpc(ctx, request, init_create_new_account_status).await,
-        "create_new_account::user_action" => handle_mmrpc(ctx, request, init_create_new_account_user_action).await,
-        "enable_bch::cancel" => handle_mmrpc(ctx, request, cancel_init_standalone_coin::<BchCoin>).await,
-        "enable_bch::init" => handle_mmrpc(ctx, request, init_standalone_coin::<BchCoin>).await,
-        "enable_bch::status" => handle_mmrpc(ctx, request, init_standalone_coin_status::<BchCoin>).await,
-        "enable_bch::user_action" => handle_mmrpc(ctx, request, init_standalone_coin_user_action::<BchCoin>).await,
-        "enable_qtum::cancel" => handle_mmrpc(ctx, request, cancel_init_standalone_coin::<QtumCoin>).await,
-        "enable_qtum::init" => handle_mmrpc(ctx, request, init_standalone_coin::<QtumCoin>).await,
-        "enable_qtum::status" => handle_mmrpc(ctx, request, init_standalone_coin_status::<QtumCoin>).await,
-        "enable_qtum::user_action" => handle_mmrpc(ctx, request, init_standalone_coin_user_action::<QtumCoin>).await,
-        "enable_utxo::cancel" => handle_mmrpc(ctx, request, cancel_init_standalone_coin::<UtxoStandardCoin>).await,
-        "enable_utxo::init" => handle_mmrpc(ctx, request, init_standalone_coin::<UtxoStandardCoin>).await,
-        "enable_utxo::status" => handle_mmrpc(ctx, request, init_standalone_coin_status::<UtxoStandardCoin>).await,
-        "enable_utxo::user_action" => {
-            handle_mmrpc(ctx, request, init_standalone_coin_user_action::<UtxoStandardCoin>).await
-        },
-        "enable_eth::cancel" => handle_mmrpc(ctx, request, cancel_init_platform_coin_with_tokens::<EthCoin>).await,
-        "enable_eth::init" => handle_mmrpc(ctx, request, init_platform_coin_with_tokens::<EthCoin>).await,
-        "enable_eth::status" => handle_mmrpc(ctx, request, init_platform_coin_with_tokens_status::<EthCoin>).await,
-        "enable_eth::user_action" => {
-            handle_mmrpc(ctx, request, init_platform_coin_with_tokens_user_action::<EthCoin>).await
-        },
-        "enable_erc20::cancel" => handle_mmrpc(ctx, request, cancel_init_token::<EthCoin>).await,
-        "enable_erc20::init" => handle_mmrpc(ctx, request, init_token::<EthCoin>).await,
-        "enable_erc20::status" => handle_mmrpc(ctx, request, init_token_status::<EthCoin>).await,
-        "enable_erc20::user_action" => handle_mmrpc(ctx, request, init_token_user_action::<EthCoin>).await,
-        "enable_tendermint::cancel" => {
-            handle_mmrpc(ctx, request, cancel_init_platform_coin_with_tokens::<TendermintCoin>).await
-        },
-        "enable_tendermint::init" => handle_mmrpc(ctx, request, init_platform_coin_with_tokens::<TendermintCoin>).await,
-        "enable_tendermint::status" => {
-            handle_mmrpc(ctx, request, init_platform_coin_with_tokens_status::<TendermintCoin>).await
-        },
-        "enable_tendermint::user_action" => {
-            handle_mmrpc(
-                ctx,
-                request,
-                init_platform_coin_with_tokens_user_action::<TendermintCoin>,
-            )
-            .await
-        },
-        // // TODO: tendermint tokens
-        // "enable_tendermint_token::cancel" => handle_mmrpc(ctx, request, cancel_init_token::<TendermintToken>).await,
-        // "enable_tendermint_token::init" => handle_mmrpc(ctx, request, init_token::<TendermintToken>).await,
-        // "enable_tendermint_token::status" => handle_mmrpc(ctx, request, init_token_status::<TendermintToken>).await,
-        // "enable_tendermint_token::user_action" => {
-        //     handle_mmrpc(ctx, request, init_token_user_action::<TendermintToken>).await
-        // },
-        "get_new_address::cancel" => handle_mmrpc(ctx, request, cancel_get_new_address).await,
-        "get_new_address::init" => handle_mmrpc(ctx, request, init_get_new_address).await,
-        "get_new_address::status" => handle_mmrpc(ctx, request, init_get_new_address_status).await,
-        "get_new_address::user_action" => handle_mmrpc(ctx, request, init_get_new_address_user_action).await,
-        "scan_for_new_addresses::cancel" => handle_mmrpc(ctx, request, cancel_scan_for_new_addresses).await,
-        "scan_for_new_addresses::init" => handle_mmrpc(ctx, request, init_scan_for_new_addresses).await,
-        "scan_for_new_addresses::status" => handle_mmrpc(ctx, request, init_scan_for_new_addresses_status).await,
-        "init_trezor::cancel" => handle_mmrpc(ctx, request, cancel_init_trezor).await,
-        "init_trezor::init" => handle_mmrpc(ctx, request, init_trezor).await,
-        "init_trezor::status" => handle_mmrpc(ctx, request, init_trezor_status).await,
-        "init_trezor::user_action" => handle_mmrpc(ctx, request, init_trezor_user_action).await,
-        "withdraw::cancel" => handle_mmrpc(ctx, request, cancel_withdraw).await,
-        "withdraw::init" => handle_mmrpc(ctx, request, init_withdraw).await,
-        "withdraw::status" => handle_mmrpc(ctx, request, withdraw_status).await,
-        "withdraw::user_action" => handle_mmrpc(ctx, request, withdraw_user_action).await,
-        //"enable_sia::cancel" => handle_mmrpc(ctx, request, cancel_init_standalone_coin::<SiaCoin>).await,
-        #[cfg(feature = "enable-sia")]
-        "enable_sia::init" => handle_mmrpc(ctx, request, init_standalone_coin::<SiaCoin>).await,
-        #[cfg(feature = "enable-sia")]
-        "enable_sia::status" => handle_mmrpc(ctx, request, init_standalone_coin_status::<SiaCoin>).await,
-        //"enable_sia::user_action" => handle_mmrpc(ctx, request, init_standalone_coin_user_action::<SiaCoin>).await,
-        "enable_z_coin::init" => handle_mmrpc(ctx, request, init_standalone_coin::<ZCoin>).await,
-        "enable_z_coin::cancel" => handle_mmrpc(ctx, request, cancel_init_standalone_coin::<ZCoin>).await,
-        "enable_z_coin::status" => handle_mmrpc(ctx, request, init_standalone_coin_status::<ZCoin>).await,
-        "enable_z_coin::user_action" => handle_mmrpc(ctx, request, init_standalone_coin_user_action::<ZCoin>).await,
-        #[cfg(not(target_arch = "wasm32"))]
-        native_only_methods => match native_only_methods {
-            "enable_lightning::cancel" => handle_mmrpc(ctx, request, cancel_init_l2::<LightningCoin>).await,
-            "enable_lightning::init" => handle_mmrpc(ctx, request, init_l2::<LightningCoin>).await,
-            "enable_lightning::status" => handle_mmrpc(ctx, request, init_l2_status::<LightningCoin>).await,
-            "enable_lightning::user_action" => handle_mmrpc(ctx, request, init_l2_user_action::<LightningCoin>).await,
-            _ => MmError::err(DispatcherError::NoSuchMethod),
-        },
-        #[cfg(target_arch = "wasm32")]
-        wasm_only_methods => match wasm_only_methods {
-            "connect_metamask::cancel" => handle_mmrpc(ctx, request, cancel_connect_metamask).await,
-            "connect_metamask::init" => handle_mmrpc(ctx, request, connect_metamask).await,
-            "connect_metamask::status" => handle_mmrpc(ctx, request, connect_metamask_status).await,
-            _ => MmError::err(DispatcherError::NoSuchMethod),
-        },
-    }
+/// The `task` methods are listed with their full path, which is expected to be `task::method::action`.
+/// For example, `task::withdraw::init`, `task::create_new_account::init` etc.
+fn mmrpc_methods() -> HashMap<&'static str, MmRpcHandler> {
+    let mut methods: HashMap<&'static str, MmRpcHandler> = HashMap::new();
+    methods.insert("account_balance", mmrpc_handler!(account_balance));
+    methods.insert("active_swaps", mmrpc_handler!(active_swaps_rpc));
+    methods.insert("add_node_to_version_stat", mmrpc_handler!(add_node_to_version_stat));
+    methods.insert("approve_token", mmrpc_handler!(approve_token_rpc));
+    methods.insert("get_token_allowance", mmrpc_handler!(get_token_allowance_rpc));
+    methods.insert("best_orders", mmrpc_handler!(best_orders_rpc_v2));
+    methods.insert("clear_nft_db", mmrpc_handler!(clear_nft_db));
+    methods.insert("delete_wallet", mmrpc_handler!(delete_wallet_rpc));
+    methods.insert(
+        "enable_bch_with_tokens",
+        mmrpc_handler!(enable_platform_coin_with_tokens::<BchCoin>),
+    );
+    methods.insert("enable_slp", mmrpc_handler!(enable_token::<SlpToken>));
+    methods.insert(
+        "enable_eth_with_tokens",
+        mmrpc_handler!(enable_platform_coin_with_tokens::<EthCoin>),
+    );
+    methods.insert("enable_erc20", mmrpc_handler!(enable_token::<EthCoin>));
+    methods.insert("enable_nft", mmrpc_handler!(enable_token::<EthCoin>));
+    methods.insert(
+        "enable_tendermint_with_assets",
+        mmrpc_handler!(enable_platform_coin_with_tokens::<TendermintCoin>),
+    );
+    methods.insert(
+        "enable_tendermint_token",
+        mmrpc_handler!(enable_token::<TendermintToken>),
+    );
+    methods.insert("get_current_mtp", mmrpc_handler!(get_current_mtp_rpc));
+    methods.insert("get_enabled_coins", mmrpc_handler!(get_enabled_coins_rpc));
+    methods.insert("get_locked_amount", mmrpc_handler!(get_locked_amount_rpc));
+    methods.insert("get_mnemonic", mmrpc_handler!(get_mnemonic_rpc));
+    methods.insert("get_my_address", mmrpc_handler!(get_my_address));
+    methods.insert("get_new_address", mmrpc_handler!(get_new_address));
+    methods.insert("get_private_keys", mmrpc_handler!(get_private_keys));
+    methods.insert("get_nft_list", mmrpc_handler!(get_nft_list));
+    methods.insert("get_nft_metadata", mmrpc_handler!(get_nft_metadata));
+    methods.insert("get_nft_transfers", mmrpc_handler!(get_nft_transfers));
+    methods.insert("get_public_key", mmrpc_handler!(get_public_key));
+    methods.insert("get_public_key_hash", mmrpc_handler!(get_public_key_hash));
+    methods.insert("get_raw_transaction", mmrpc_handler!(get_raw_transaction));
+    methods.insert("get_shared_db_id", mmrpc_handler!(get_shared_db_id));
+    methods.insert("get_token_info", mmrpc_handler!(get_token_info));
+    methods.insert("get_wallet_names", mmrpc_handler!(get_wallet_names_rpc));
+    methods.insert("max_maker_vol", mmrpc_handler!(max_maker_vol));
+    methods.insert("my_recent_swaps", mmrpc_handler!(my_recent_swaps_rpc));
+    methods.insert("my_swap_status", mmrpc_handler!(my_swap_status_rpc));
+    methods.insert("my_tx_history", mmrpc_handler!(my_tx_history_v2_rpc));
+    methods.insert("orderbook", mmrpc_handler!(orderbook_rpc_v2));
+    methods.insert("recreate_swap_data", mmrpc_handler!(recreate_swap_data));
+    methods.insert("refresh_nft_metadata", mmrpc_handler!(refresh_nft_metadata));
+    methods.insert(
+        "remove_node_from_version_stat",
+        mmrpc_handler!(remove_node_from_version_stat),
+    );
+    methods.insert("sign_message", mmrpc_handler!(sign_message));
+    methods.insert("sign_raw_transaction", mmrpc_handler!(sign_raw_transaction));
+    methods.insert(
+        "start_simple_market_maker_bot",
+        mmrpc_handler!(start_simple_market_maker_bot),
+    );
+    methods.insert(
+        "start_version_stat_collection",
+        mmrpc_handler!(start_version_stat_collection),
+    );
+    methods.insert(
+        "stop_simple_market_maker_bot",
+        mmrpc_handler!(stop_simple_market_maker_bot),
+    );
+    methods.insert(
+        "stop_version_stat_collection",
+        mmrpc_handler!(stop_version_stat_collection),
+    );
+    methods.insert("trade_preimage", mmrpc_handler!(trade_preimage_rpc));
+    methods.insert("trezor_connection_status", mmrpc_handler!(trezor_connection_status));
+    methods.insert("update_nft", mmrpc_handler!(update_nft));
+    methods.insert("change_mnemonic_password", mmrpc_handler!(change_mnemonic_password));
+    methods.insert(
+        "update_version_stat_collection",
+        mmrpc_handler!(update_version_stat_collection),
+    );
+    methods.insert("verify_message", mmrpc_handler!(verify_message));
+    methods.insert("withdraw", mmrpc_handler!(withdraw));
+    methods.insert(
+        "peer_connection_healthcheck",
+        mmrpc_handler!(peer_connection_healthcheck_rpc),
+    );
+    methods.insert("withdraw_nft", mmrpc_handler!(withdraw_nft));
+    methods.insert(
+        "get_eth_estimated_fee_per_gas",
+        mmrpc_handler!(get_eth_estimated_fee_per_gas),
+    );
+    methods.insert(
+        "get_swap_transaction_fee_policy",
+        mmrpc_handler!(get_swap_transaction_fee_policy),
+    );
+    methods.insert(
+        "set_swap_transaction_fee_policy",
+        mmrpc_handler!(set_swap_transaction_fee_policy),
+    );
+    methods.insert("send_asked_data", mmrpc_handler!(send_asked_data_rpc));
+    methods.insert(
+        "z_coin_tx_history",
+        mmrpc_handler!(coins::my_tx_history_v2::z_coin_tx_history_rpc),
+    );
+    methods.insert(
+        "1inch_v6_0_classic_swap_contract",
+        mmrpc_handler!(one_inch_v6_0_classic_swap_contract_rpc),
+    );
+    methods.insert(
+        "1inch_v6_0_classic_swap_quote",
+        mmrpc_handler!(one_inch_v6_0_classic_swap_quote_rpc),
+    );
+    methods.insert(
+        "1inch_v6_0_classic_swap_create",
+        mmrpc_handler!(one_inch_v6_0_classic_swap_create_rpc),
+    );
+    methods.insert(
+        "1inch_v6_0_classic_swap_liquidity_sources",
+        mmrpc_handler!(one_inch_v6_0_classic_swap_liquidity_sources_rpc),
+    );
+    methods.insert(
+        "1inch_v6_0_classic_swap_tokens",
+        mmrpc_handler!(one_inch_v6_0_classic_swap_tokens_rpc),
+    );
+    methods.insert("wc_new_connection", mmrpc_handler!(new_connection));
+    methods.insert("wc_get_session", mmrpc_handler!(get_session));
+    methods.insert("wc_get_sessions", mmrpc_handler!(get_all_sessions));
+    methods.insert("wc_delete_session", mmrpc_handler!(disconnect_session));
+    methods.insert("wc_ping_session", mmrpc_handler!(ping_session));
+    methods.insert("task::account_balance::cancel", mmrpc_handler!(cancel_account_balance));
+    methods.insert("task::account_balance::init", mmrpc_handler!(init_account_balance));
+    methods.insert(
+        "task::account_balance::status",
+        mmrpc_handler!(init_account_balance_status),
+    );
+    methods.insert(
+        "task::create_new_account::cancel",
+        mmrpc_handler!(cancel_create_new_account),
+    );
+    methods.insert(
+        "task::create_new_account::init",
+        mmrpc_handler!(init_create_new_account),
+    );
+    methods.insert(
+        "task::create_new_account::status",
+        mmrpc_handler!(init_create_new_account_status),
+    );
+    methods.insert(
+        "task::create_new_account::user_action",
+        mmrpc_handler!(init_create_new_account_user_action),
+    );
+    methods.insert(
+        "task::enable_bch::cancel",
+        mmrpc_handler!(cancel_init_standalone_coin::<BchCoin>),
+    );
+    methods.insert(
+        "task::enable_bch::init",
+        mmrpc_handler!(init_standalone_coin::<BchCoin>),
+    );
+    methods.insert(
+        "task::enable_bch::status",
+        mmrpc_handler!(init_standalone_coin_status::<BchCoin>),
+    );
+    methods.insert(
+        "task::enable_bch::user_action",
+        mmrpc_handler!(init_standalone_coin_user_action::<BchCoin>),
+    );
+    methods.insert(
+        "task::enable_qtum::cancel",
+        mmrpc_handler!(cancel_init_standalone_coin::<QtumCoin>),
+    );
+    methods.insert(
+        "task::enable_qtum::init",
+        mmrpc_handler!(init_standalone_coin::<QtumCoin>),
+    );
+    methods.insert(
+        "task::enable_qtum::status",
+        mmrpc_handler!(init_standalone_coin_status::<QtumCoin>),
+    );
+    methods.insert(
+        "task::enable_qtum::user_action",
+        mmrpc_handler!(init_standalone_coin_user_action::<QtumCoin>),
+    );
+    methods.insert(
+        "task::enable_utxo::cancel",
+        mmrpc_handler!(cancel_init_standalone_coin::<UtxoStandardCoin>),
+    );
+    methods.insert(
+        "task::enable_utxo::init",
+        mmrpc_handler!(init_standalone_coin::<UtxoStandardCoin>),
+    );
+    methods.insert(
+        "task::enable_utxo::status",
+        mmrpc_handler!(init_standalone_coin_status::<UtxoStandardCoin>),
+    );
+    methods.insert(
+        "task::enable_utxo::user_action",
+        mmrpc_handler!(init_standalone_coin_user_action::<UtxoStandardCoin>),
+    );
+    methods.insert(
+        "task::enable_eth::cancel",
+        mmrpc_handler!(cancel_init_platform_coin_with_tokens::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_eth::init",
+        mmrpc_handler!(init_platform_coin_with_tokens::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_eth::status",
+        mmrpc_handler!(init_platform_coin_with_tokens_status::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_eth::user_action",
+        mmrpc_handler!(init_platform_coin_with_tokens_user_action::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_erc20::cancel",
+        mmrpc_handler!(cancel_init_token::<EthCoin>),
+    );
+    methods.insert("task::enable_erc20::init", mmrpc_handler!(init_token::<EthCoin>));
+    methods.insert(
+        "task::enable_erc20::status",
+        mmrpc_handler!(init_token_status::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_erc20::user_action",
+        mmrpc_handler!(init_token_user_action::<EthCoin>),
+    );
+    methods.insert(
+        "task::enable_tendermint::cancel",
+        mmrpc_handler!(cancel_init_platform_coin_with_tokens::<TendermintCoin>),
+    );
+    methods.insert(
+        "task::enable_tendermint::init",
+        mmrpc_handler!(init_platform_coin_with_tokens::<TendermintCoin>),
+    );
+    methods.insert(
+        "task::enable_tendermint::status",
+        mmrpc_handler!(init_platform_coin_with_tokens_status::<TendermintCoin>),
+    );
+    methods.insert(
+        "task::enable_tendermint::user_action",
+        mmrpc_handler!(init_platform_coin_with_tokens_user_action::<TendermintCoin>),
+    );
+    // // TODO: tendermint tokens
+    // methods.insert("task::enable_tendermint_token::cancel", mmrpc_handler!(cancel_init_token::<TendermintToken>));
+    // methods.insert("task::enable_tendermint_token::init", mmrpc_handler!(init_token::<TendermintToken>));
+    // methods.insert("task::enable_tendermint_token::status", mmrpc_handler!(init_token_status::<TendermintToken>));
+    // methods.insert(
+    //     "task::enable_tendermint_token::user_action",
+    //     mmrpc_handler!(init_token_user_action::<TendermintToken>),
+    // );
+    methods.insert("task::get_new_address::cancel", mmrpc_handler!(cancel_get_new_address));
+    methods.insert("task::get_new_address::init", mmrpc_handler!(init_get_new_address));
+    methods.insert(
+        "task::get_new_address::status",
+        mmrpc_handler!(init_get_new_address_status),
+    );
+    methods.insert(
+        "task::get_new_address::user_action",
+        mmrpc_handler!(init_get_new_address_user_action),
+    );
+    methods.insert(
+        "task::scan_for_new_addresses::cancel",
+        mmrpc_handler!(cancel_scan_for_new_addresses),
+    );
+    methods.insert(
+        "task::scan_for_new_addresses::init",
+        mmrpc_handler!(init_scan_for_new_addresses),
+    );
+    methods.insert(
+        "task::scan_for_new_addresses::status",
+        mmrpc_handler!(init_scan_for_new_addresses_status),
+    );
+    methods.insert("task::init_trezor::cancel", mmrpc_handler!(cancel_init_trezor));
+    methods.insert("task::init_trezor::init", mmrpc_handler!(init_trezor));
+    methods.insert("task::init_trezor::status", mmrpc_handler!(init_trezor_status));
+    methods.insert(
+        "task::init_trezor::user_action",
+        mmrpc_handler!(init_trezor_user_action),
+    );
+    methods.insert("task::withdraw::cancel", mmrpc_handler!(cancel_withdraw));
+    methods.insert("task::withdraw::init", mmrpc_handler!(init_withdraw));
+    methods.insert("task::withdraw::status", mmrpc_handler!(withdraw_status));
+    methods.insert("task::withdraw::user_action", mmrpc_handler!(withdraw_user_action));
+    // methods.insert("task::enable_sia::cancel", mmrpc_handler!(cancel_init_standalone_coin::<SiaCoin>));
+    #[cfg(feature = "enable-sia")]
+    methods.insert(
+        "task::enable_sia::init",
+        mmrpc_handler!(init_standalone_coin::<SiaCoin>),
+    );
+    #[cfg(feature = "enable-sia")]
+    methods.insert(
+        "task::enable_sia::status",
+        mmrpc_handler!(init_standalone_coin_status::<SiaCoin>),
+    );
+    // methods.insert("task::enable_sia::user_action", mmrpc_handler!(init_standalone_coin_user_action::<SiaCoin>));
+    methods.insert(
+        "task::enable_z_coin::init",
+        mmrpc_handler!(init_standalone_coin::<ZCoin>),
+    );
+    methods.insert(
+        "task::enable_z_coin::cancel",
+        mmrpc_handler!(cancel_init_standalone_coin::<ZCoin>),
+    );
+    methods.insert(
+        "task::enable_z_coin::status",
+        mmrpc_handler!(init_standalone_coin_status::<ZCoin>),
+    );
+    methods.insert(
+        "task::enable_z_coin::user_action",
+        mmrpc_handler!(init_standalone_coin_user_action::<ZCoin>),
+    );
+    #[cfg(not(target_arch = "wasm32"))]
+    methods.insert(
+        "task::enable_lightning::cancel",
+        mmrpc_handler!(cancel_init_l2::<LightningCoin>),
+    );
+    #[cfg(not(target_arch = "wasm32"))]
+    methods.insert("task::enable_lightning::init", mmrpc_handler!(init_l2::<LightningCoin>));
+    #[cfg(not(target_arch = "wasm32"))]
+    methods.insert(
+        "task::enable_lightning::status",
+        mmrpc_handler!(init_l2_status::<LightningCoin>),
+    );
+    #[cfg(not(target_arch = "wasm32"))]
+    methods.insert(
+        "task::enable_lightning::user_action",
+        mmrpc_handler!(init_l2_user_action::<LightningCoin>),
+    );
+    #[cfg(target_arch = "wasm32")]
+    methods.insert(
+        "task::connect_metamask::cancel",
+        mmrpc_handler!(cancel_connect_metamask),
+    );
+    #[cfg(target_arch = "wasm32")]
+    methods.insert("task::connect_metamask::init", mmrpc_handler!(connect_metamask));
+    #[cfg(target_arch = "wasm32")]
+    methods.insert(
+        "task::connect_metamask::status",
+        mmrpc_handler!(connect_metamask_status),
+    );
+    methods
 }
 
 async fn rpc_streaming_dispatcher(
@@ -395,6 +616,7 @@ async fn rpc_streaming_dispatcher(
         "order_status::enable" => handle_mmrpc(ctx, request, streaming_activations::enable_order_status).await,
         "tx_history::enable" => handle_mmrpc(ctx, request, streaming_activations::enable_tx_history).await,
         "orderbook::enable" => handle_mmrpc(ctx, request, streaming_activations::enable_orderbook).await,
+        "orderbook_depth::enable" => handle_mmrpc(ctx, request, streaming_activations::enable_orderbook_depth).await,
         "disable" => handle_mmrpc(ctx, request, streaming_activations::disable_streamer).await,
         _ => MmError::err(DispatcherError::NoSuchMethod),
     }
@@ -3,8 +3,10 @@ use common::HyRes;
 use futures::compat::Future01CompatExt;
 use futures::{Future as Future03, FutureExt, TryFutureExt};
 use http::Response;
+use lazy_static::lazy_static;
 use mm2_core::mm_ctx::MmArc;
 use serde_json::{self as json, Value as Json};
+use std::collections::HashMap;
 use std::net::SocketAddr;
 
 use super::lp_commands::legacy::*;
@@ -34,12 +36,18 @@ async fn auth(json: &Json, ctx: &MmArc, client: &SocketAddr) -> Result<(), Strin
         }
 
         if json["userpass"] != ctx.conf["rpc_password"] {
-            return Err(format!("{}", process_rate_limit(ctx, client).await));
+            return Err(format!("{}", process_rate_limit(ctx, client)));
         }
     }
     Ok(())
 }
 
+type LegacyHandler = fn(MmArc, Json) -> HyRes;
+
+lazy_static! {
+    static ref LEGACY_METHODS: HashMap<&'static str, LegacyHandler> = legacy_methods();
+}
+
 /// Using async/await (futures 0.3) in `dispatcher`
 /// will pave the way for porting the remaining system threading code to async/await green threads.
 fn hyres(handler: impl Future03<Output = Result<Response<Vec<u8>>, String>> + Send + 'static) -> HyRes {
@@ -52,77 +60,98 @@ fn hyres(handler: impl Future03<Output = Result<Response<Vec<u8>>, String>> + Se
 ///
 /// Returns `None` if the requested "method" wasn't found among the ported RPC methods and has to be handled elsewhere.
 pub fn dispatcher(req: Json, ctx: MmArc) -> DispatcherRes {
-    let method = match req["method"].clone() {
-        Json::String(method) => method,
-        _ => return DispatcherRes::NoMatch(req),
+    let handler = match req["method"].as_str().and_then(|method| LEGACY_METHODS.get(method)) {
+        Some(handler) => *handler,
+        None => return DispatcherRes::NoMatch(req),
     };
-    DispatcherRes::Match(match &method[..] {
-        // Sorted alphanumerically (on the first latter) for readability.
-        // "autoprice" => lp_autoprice (ctx, req),
-        "active_swaps" => hyres(active_swaps_rpc(ctx, req)),
-        "all_swaps_uuids_by_filter" => hyres(all_swaps_uuids_by_filter(ctx, req)),
-        "ban_pubkey" => hyres(ban_pubkey_rpc(ctx, req)),
-        "best_orders" => hyres(best_orders_rpc(ctx, req)),
-        "buy" => hyres(buy(ctx, req)),
-        "cancel_all_orders" => hyres(cancel_all_orders_rpc(ctx, req)),
-        "cancel_order" => hyres(cancel_order_rpc(ctx, req)),
-        "coins_needed_for_kick_start" => hyres(coins_needed_for_kick_start(ctx)),
-        "convertaddress" => hyres(convert_address(ctx, req)),
-        "convert_utxo_address" => hyres(convert_utxo_address(ctx, req)),
-        "disable_coin" => hyres(disable_coin(ctx, req)),
-        "electrum" => hyres(electrum(ctx, req)),
-        "enable" => hyres(enable(ctx, req)),
-        "get_enabled_coins" => hyres(get_enabled_coins(ctx)),
-        "get_directly_connected_peers" => hyres(get_directly_connected_peers(ctx)),
-        "get_gossip_mesh" => hyres(get_gossip_mesh(ctx)),
-        "get_gossip_peer_topics" => hyres(get_gossip_peer_topics(ctx)),
-        "get_gossip_topic_peers" => hyres(get_gossip_topic_peers(ctx)),
-        "get_my_peer_id" => hyres(get_my_peer_id(ctx)),
-        "get_relay_mesh" => hyres(get_relay_mesh(ctx)),
-        "get_trade_fee" => hyres(get_trade_fee(ctx, req)),
-        // "fundvalue" => lp_fundvalue (ctx, req, false),
-        "help" => help(),
-        "import_swaps" => hyres(import_swaps(ctx, req)),
-        "kmd_rewards_info" => hyres(kmd_rewards_info(ctx)),
-        // "inventory" => inventory (ctx, req),
-        "list_banned_pubkeys" => hyres(list_banned_pubkeys_rpc(ctx)),
-        "max_taker_vol" => hyres(max_taker_vol(ctx, req)),
-        "metrics" => metrics(ctx),
-        "min_trading_vol" => hyres(min_trading_vol(ctx, req)),
-        "my_balance" => hyres(my_balance(ctx, req)),
-        "my_orders" => hyres(my_orders(ctx)),
-        "my_recent_swaps" => hyres(my_recent_swaps_rpc(ctx, req)),
-        "my_swap_status" => hyres(my_swap_status(ctx, req)),
-        "my_tx_history" => hyres(my_tx_history(ctx, req)),
-        "orders_history_by_filter" => hyres(orders_history_by_filter(ctx, req)),
-        "order_status" => hyres(order_status(ctx, req)),
-        "orderbook" => hyres(orderbook_rpc(ctx, req)),
-        "orderbook_depth" => hyres(orderbook_depth_rpc(ctx, req)),
-        "recover_funds_of_swap" => hyres(recover_funds_of_swap(ctx, req)),
-        "sell" => hyres(sell(ctx, req)),
-        "show_priv_key" => hyres(show_priv_key(ctx, req)),
-        "send_raw_transaction" => hyres(send_raw_transaction(ctx, req)),
-        "set_required_confirmations" => hyres(set_required_confirmations(ctx, req)),
-        "set_requires_notarization" => hyres(set_requires_notarization(ctx, req)),
-        "setprice" => hyres(set_price(ctx, req)),
-        "stats_swap_status" => hyres(stats_swap_status(ctx, req)),
-        "stop" => hyres(stop(ctx)),
-        "trade_preimage" => hyres(into_legacy::trade_preimage(ctx, req)),
-        "unban_pubkeys" => hyres(unban_pubkeys_rpc(ctx, req)),
-        "update_maker_order" => hyres(update_maker_order_rpc(ctx, req)),
-        "validateaddress" => hyres(validate_address(ctx, req)),
-        "version" => version(ctx),
-        "withdraw" => hyres(into_legacy::withdraw(ctx, req)),
-        _ => return DispatcherRes::NoMatch(req),
-    })
+    DispatcherRes::Match(handler(ctx, req))
+}
+
+/// The methods resolved by `dispatcher` with a single lookup.
+fn legacy_methods() -> HashMap<&'static str, LegacyHandler> {
+    let mut methods: HashMap<&'static str, LegacyHandler> = HashMap::new();
+    // Sorted alphanumerically (on the first latter) for readability.
+    // methods.insert("autoprice", |ctx, req| lp_autoprice(ctx, req));
+    methods.insert("active_swaps", |ctx, req| hyres(active_swaps_rpc(ctx, req)));
+    methods.insert("all_swaps_uuids_by_filter", |ctx, req| {
+        hyres(all_swaps_uuids_by_filter(ctx, req))
+    });
+    methods.insert("ban_pubkey", |ctx, req| hyres(ban_pubkey_rpc(ctx, req)));
+    methods.insert("best_orders", |ctx, req| hyres(best_orders_rpc(ctx, req)));
+    methods.insert("buy", |ctx, req| hyres(buy(ctx, req)));
+    methods.insert("cancel_all_orders", |ctx, req| hyres(cancel_all_orders_rpc(ctx, req)));
+    methods.insert("cancel_order", |ctx, req| hyres(cancel_order_rpc(ctx, req)));
+    methods.insert("coins_needed_for_kick_start", |ctx, _req| {
+        hyres(coins_needed_for_kick_start(ctx))
+    });
+    methods.insert("convertaddress", |ctx, req| hyres(convert_address(ctx, req)));
+    methods.insert("convert_utxo_address", |ctx, req| hyres(convert_utxo_address(ctx, req)));
+    methods.insert("disable_coin", |ctx, req| hyres(disable_coin(ctx, req)));
+    methods.insert("electrum", |ctx, req| hyres(electrum(ctx, req)));
+    methods.insert("enable", |ctx, req| hyres(enable(ctx, req)));
+    methods.insert("get_enabled_coins", |ctx, _req| hyres(get_enabled_coins(ctx)));
+    methods.insert("get_directly_connected_peers", |ctx, _req| {
+        hyres(get_directly_connected_peers(ctx))
+    });
+    methods.insert("get_gossip_mesh", |ctx, _req| hyres(get_gossip_mesh(ctx)));
+    methods.insert("get_gossip_peer_topics", |ctx, _req| hyres(get_gossip_peer_topics(ctx)));
+    methods.insert("get_gossip_topic_peers", |ctx, _req| hyres(get_gossip_topic_peers(ctx)));
+    methods.insert("get_my_peer_id", |ctx, _req| hyres(get_my_peer_id(ctx)));
+    methods.insert("get_relay_mesh", |ctx, _req| hyres(get_relay_mesh(ctx)));
+    methods.insert("get_trade_fee", |ctx, req| hyres(get_trade_fee(ctx, req)));
+    // methods.insert("fundvalue", |ctx, req| lp_fundvalue(ctx, req, false));
+    methods.insert("help", |_ctx, _req| help());
+    methods.insert("import_swaps", |ctx, req| hyres(import_swaps(ctx, req)));
+    methods.insert("kmd_rewards_info", |ctx, _req| hyres(kmd_rewards_info(ctx)));
+    // methods.insert("inventory", |ctx, req| inventory(ctx, req));
+    methods.insert("list_banned_pubkeys", |ctx, _req| hyres(list_banned_pubkeys_rpc(ctx)));
+    methods.insert("max_taker_vol", |ctx, req| hyres(max_taker_vol(ctx, req)));
+    methods.insert("metrics", |ctx, _req| metrics(ctx));
+    methods.insert("min_trading_vol", |ctx, req| hyres(min_trading_vol(ctx, req)));
+    methods.insert("my_balance", |ctx, req| hyres(my_balance(ctx, req)));
+    methods.insert("my_orders", |ctx, _req| hyres(my_orders(ctx)));
+    methods.insert("my_recent_swaps", |ctx, req| hyres(my_recent_swaps_rpc(ctx, req)));
+    methods.insert("my_swap_status", |ctx, req| hyres(my_swap_status(ctx, req)));
+    methods.insert("my_tx_history", |ctx, req| hyres(my_tx_history(ctx, req)));
+    methods.insert("orders_history_by_filter", |ctx, req| {
+        hyres(orders_history_by_filter(ctx, req))
+    });
+    methods.insert("order_status", |ctx, req| hyres(order_status(ctx, req)));
+    methods.insert("orderbook", |ctx, req| hyres(orderbook_rpc(ctx, req)));
+    methods.insert("orderbook_depth", |ctx, req| hyres(orderbook_depth_rpc(ctx, req)));
+    methods.insert("recover_funds_of_swap", |ctx, req| {
+        hyres(recover_funds_of_swap(ctx, req))
+    });
+    methods.insert("sell", |ctx, req| hyres(sell(ctx, req)));
+    methods.insert("show_priv_key", |ctx, req| hyres(show_priv_key(ctx, req)));
+    methods.insert("send_raw_transaction", |ctx, req| hyres(send_raw_transaction(ctx, req)));
+    methods.insert("set_required_confirmations", |ctx, req| {
+        hyres(set_required_confirmations(ctx, req))
+    });
+    methods.insert("set_requires_notarization", |ctx, req| {
+        hyres(set_requires_notarization(ctx, req))
+    });
+    methods.insert("setprice", |ctx, req| hyres(set_price(ctx, req)));
+    methods.insert("stats_swap_status", |ctx, req| hyres(stats_swap_status(ctx, req)));
+    methods.insert("stop", |ctx, _req| hyres(stop(ctx)));
+    methods.insert("trade_preimage", |ctx, req| {
+        hyres(into_legacy::trade_preimage(ctx, req))
+    });
+    methods.insert("unban_pubkeys", |ctx, req| hyres(unban_pubkeys_rpc(ctx, req)));
+    methods.insert("update_maker_order", |ctx, req| hyres(update_maker_order_rpc(ctx, req)));
+    methods.insert("validateaddress", |ctx, req| hyres(validate_address(ctx, req)));
+    methods.insert("version", |ctx, _req| version(ctx));
+    methods.insert("withdraw", |ctx, req| hyres(into_legacy::withdraw(ctx, req)));
+    methods
 }
 
 #[derive(Debug, Display)]
 pub enum LegacyRequestProcessError {
     #[display(fmt = "Selected method is not allowed: {reason}")]
     NotAllowed { reason: String },
+    /// The method isn't a legacy one. Returning the `Json` request in order for it to be handled by the v2 dispatcher.
     #[display(fmt = "No such method")]
-    NoMatch,
+    NoMatch(Json),
     #[display(fmt = "RPC call failed: {reason}")]
     Failed { reason: String },
 }
@@ -140,7 +169,7 @@ pub async fn process_single_request(
         });
     }
     let rate_limit_ctx = RateLimitContext::from_ctx(&ctx).unwrap();
-    if rate_limit_ctx.is_banned(client.ip()).await {
+    if rate_limit_ctx.is_banned(client.ip()) {
         return Err(LegacyRequestProcessError::NotAllowed {
             reason: "Your IP is banned.".to_owned(),
         });
@@ -151,8 +180,8 @@ pub async fn process_single_request(
 
     let handler = match dispatcher(req, ctx.clone()) {
         DispatcherRes::Match(handler) => handler,
-        DispatcherRes::NoMatch(_) => {
-            return Err(LegacyRequestProcessError::NoMatch);
+        DispatcherRes::NoMatch(req) => {
+            return Err(LegacyRequestProcessError::NoMatch(req));
         },
     };
 
@@ -1,11 +1,12 @@
 use crate::rpc::DispatcherError;
 use derive_more::Display;
-use futures::lock::Mutex as AsyncMutex;
 use mm2_core::mm_ctx::from_ctx;
 use mm2_core::mm_ctx::MmArc;
 use mm2_err_handle::prelude::*;
+use parking_lot::Mutex as PaMutex;
 use std::collections::HashMap;
 use std::net::{IpAddr, SocketAddr};
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
 
 pub const LIMIT_FAILED_REQUEST: usize = 10;
@@ -18,8 +19,16 @@ pub enum RateLimitError {
     NbAttemptsLeft(usize),
 }
 
+/// The failed attempts of the clients.
+///
+/// Every request checks whether its client is banned, but the registry is only updated on the failed attempts,
+/// so the check is a single atomic load until some client is banned.
 #[derive(Default)]
-pub struct RateLimitContext(AsyncMutex<RateInfosRegistry>);
+pub struct RateLimitContext {
+    registry: PaMutex<RateInfosRegistry>,
+    /// The number of the banned clients. The clients are never unbanned, so it only grows.
+    banned: AtomicUsize,
+}
 
 impl RateLimitContext {
     pub fn from_ctx(ctx: &MmArc) -> Result<Arc<RateLimitContext>, String> {
@@ -28,34 +37,93 @@ impl RateLimitContext {
         })))
     }
 
-    pub async fn is_banned(&self, client_ip: IpAddr) -> bool {
-        let rate_infos = self.0.lock().await;
-        if let Some(limit) = rate_infos.get(&client_ip) {
-            return *limit >= LIMIT_FAILED_REQUEST;
+    pub fn is_banned(&self, client_ip: IpAddr) -> bool {
+        if self.banned.load(Ordering::Relaxed) == 0 {
+            return false;
+        }
+        match self.registry.lock().get(&client_ip) {
+            Some(limit) => *limit >= LIMIT_FAILED_REQUEST,
+            None => false,
         }
-        false
+    }
+
+    /// Registers a failed attempt of the client and returns the number of the attempts left.
+    fn register_failed_attempt(&self, client_ip: IpAddr) -> Option<usize> {
+        let mut registry = self.registry.lock();
+        let limit = registry.entry(client_ip).or_insert(0);
+        if *limit >= LIMIT_FAILED_REQUEST {
+            return None;
+        }
+        *limit += 1;
+        if *limit == LIMIT_FAILED_REQUEST {
+            self.banned.fetch_add(1, Ordering::Relaxed);
+        }
+        Some(LIMIT_FAILED_REQUEST - *limit)
     }
 }
 
-pub async fn process_rate_limit(ctx: &MmArc, client: &SocketAddr) -> MmError<DispatcherError> {
+pub fn process_rate_limit(ctx: &MmArc, client: &SocketAddr) -> MmError<DispatcherError> {
     let rate_limit_ctx = RateLimitContext::from_ctx(ctx).unwrap();
-    let mut rate_limit_registry = rate_limit_ctx.0.lock().await;
+    match rate_limit_ctx.register_failed_attempt(client.ip()) {
+        Some(attempts_left) => MmError::new(DispatcherError::UserpassIsInvalid(RateLimitError::NbAttemptsLeft(
+            attempts_left,
+        ))),
+        None => MmError::new(DispatcherError::Banned),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use mm2_core::mm_ctx::MmCtxBuilder;
 
-    match rate_limit_registry.get_mut(&client.ip()) {
-        Some(limit) => {
-            if *limit >= LIMIT_FAILED_REQUEST {
-                return MmError::new(DispatcherError::Banned);
+    #[test]
+    fn test_ban_at_limit_failed_request() {
+        let rate_limit_ctx = RateLimitContext::default();
+        let client_ip: IpAddr = "192.168.0.1".parse().unwrap();
+        let other_ip: IpAddr = "192.168.0.2".parse().unwrap();
+        assert!(!rate_limit_ctx.is_banned(client_ip));
+
+        for attempt in 1..LIMIT_FAILED_REQUEST {
+            let attempts_left = rate_limit_ctx.register_failed_attempt(client_ip);
+            assert_eq!(attempts_left, Some(LIMIT_FAILED_REQUEST - attempt));
+            assert!(!rate_limit_ctx.is_banned(client_ip));
+        }
+
+        // The client is banned at exactly `LIMIT_FAILED_REQUEST` failed attempts.
+        assert_eq!(rate_limit_ctx.register_failed_attempt(client_ip), Some(0));
+        assert!(rate_limit_ctx.is_banned(client_ip));
+        assert_eq!(rate_limit_ctx.register_failed_attempt(client_ip), None);
+        assert!(rate_limit_ctx.is_banned(client_ip));
+        assert_eq!(rate_limit_ctx.banned.load(Ordering::Relaxed), 1);
+
+        // The other clients still pass once some client is banned.
+        assert!(!rate_limit_ctx.is_banned(other_ip));
+        let attempts_left = rate_limit_ctx.register_failed_attempt(other_ip);
+        assert_eq!(attempts_left, Some(LIMIT_FAILED_REQUEST - 1));
+        assert!(!rate_limit_ctx.is_banned(other_ip));
+    }
+
+    #[test]
+    fn test_process_rate_limit() {
+        let ctx = MmCtxBuilder::default().into_mm_arc();
+        let client: SocketAddr = "192.168.0.1:7783".parse().unwrap();
+
+        for attempt in 1..=LIMIT_FAILED_REQUEST {
+            let attempts_left = LIMIT_FAILED_REQUEST - attempt;
+            match process_rate_limit(&ctx, &client).into_inner() {
+                DispatcherError::UserpassIsInvalid(RateLimitError::NbAttemptsLeft(left)) => {
+                    assert_eq!(left, attempts_left)
+                },
+                e => panic!("Unexpected error: {}", e),
             }
-            *limit += 1;
-            MmError::new(DispatcherError::UserpassIsInvalid(RateLimitError::NbAttemptsLeft(
-                LIMIT_FAILED_REQUEST - *limit,
-            )))
-        },
-        None => {
-            rate_limit_registry.insert(client.ip(), 1);
-            MmError::new(DispatcherError::UserpassIsInvalid(RateLimitError::NbAttemptsLeft(
-                LIMIT_FAILED_REQUEST - 1,
-            )))
-        },
+        }
+
+        let rate_limit_ctx = RateLimitContext::from_ctx(&ctx).unwrap();
+        assert!(rate_limit_ctx.is_banned(client.ip()));
+        assert!(matches!(
+            process_rate_limit(&ctx, &client).into_inner(),
+            DispatcherError::Banned
+        ));
     }
 }
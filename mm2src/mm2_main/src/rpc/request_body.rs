@@ -0,0 +1,146 @@
+use serde::de::{self, Deserialize, Deserializer, MapAccess, SeqAccess, Visitor};
+use serde_json::value::RawValue;
+use serde_json::{self as json, Map, Value as Json};
+use std::fmt;
+
+/// The body of an RPC request decoded in a single pass.
+///
+/// The `params` of a v2 (`mmrpc`) request are kept as the raw JSON text of the body,
+/// so that they are deserialized straight into the params type of the resolved method
+/// instead of going through an intermediate `Value`.
+/// The legacy requests are handled as `Value`, so their `params` are decoded along with the rest of the request.
+pub enum RpcRequestBody {
+    Batch(Vec<Json>),
+    Single {
+        /// The request, without its `params` if they are kept raw in `params`.
+        req: Json,
+        params: Option<Box<RawValue>>,
+    },
+}
+
+impl<'de> Deserialize<'de> for RpcRequestBody {
+    fn deserialize<D>(deserializer: D) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>,
+    {
+        struct RpcRequestBodyVisitor;
+
+        impl<'de> Visitor<'de> for RpcRequestBodyVisitor {
+            type Value = RpcRequestBody;
+
+            fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+                formatter.write_str("a request object or an array of requests")
+            }
+
+            fn visit_seq<A>(self, mut seq: A) -> Result<Self::Value, A::Error>
+            where
+                A: SeqAccess<'de>,
+            {
+                let mut requests = Vec::with_capacity(seq.size_hint().unwrap_or_default());
+                while let Some(request) = seq.next_element()? {
+                    requests.push(request);
+                }
+                Ok(RpcRequestBody::Batch(requests))
+            }
+
+            fn visit_map<A>(self, mut map: A) -> Result<Self::Value, A::Error>
+            where
+                A: MapAccess<'de>,
+            {
+                let mut fields = Map::new();
+                let mut params = None;
+                while let Some(key) = map.next_key::<String>()? {
+                    if key == "params" {
+                        params = Some(map.next_value::<Box<RawValue>>()?);
+                    } else {
+                        fields.insert(key, map.next_value()?);
+                    }
+                }
+
+                // The legacy dispatcher and the v2 fallback of the legacy requests take the whole `Value`.
+                if fields.get("mmrpc").map_or(true, Json::is_null) {
+                    if let Some(params) = params.take() {
+                        let params = json::from_str(params.get()).map_err(de::Error::custom)?;
+                        fields.insert("params".to_owned(), params);
+                    }
+                }
+
+                Ok(RpcRequestBody::Single {
+                    req: Json::Object(fields),
+                    params,
+                })
+            }
+        }
+
+        deserializer.deserialize_any(RpcRequestBodyVisitor)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[derive(Debug, Deserialize, PartialEq)]
+    struct WithdrawParams {
+        coin: String,
+        amount: Option<String>,
+    }
+
+    #[test]
+    fn test_v2_request_params_are_left_raw() {
+        let body =
+            br#"{"userpass":"pass","method":"withdraw","params":{"coin":"RICK","amount":"1"},"mmrpc":"2.0","id":1}"#;
+        let (req, params) = match json::from_slice(body).unwrap() {
+            RpcRequestBody::Single { req, params } => (req, params.expect("!params")),
+            RpcRequestBody::Batch(_) => panic!("Expected a single request"),
+        };
+        assert_eq!(
+            req,
+            json!({"userpass": "pass", "method": "withdraw", "mmrpc": "2.0", "id": 1})
+        );
+
+        let params: WithdrawParams = json::from_str(params.get()).unwrap();
+        let expected = WithdrawParams {
+            coin: "RICK".to_owned(),
+            amount: Some("1".to_owned()),
+        };
+        assert_eq!(params, expected);
+    }
+
+    #[test]
+    fn test_legacy_request_params_are_decoded() {
+        let body = br#"{"method":"my_balance","coin":"RICK","params":[1,2]}"#;
+        match json::from_slice(body).unwrap() {
+            RpcRequestBody::Single { req, params: None } => {
+                assert_eq!(req, json!({"method": "my_balance", "coin": "RICK", "params": [1, 2]}))
+            },
+            _ => panic!("Expected a single request without the raw params"),
+        }
+
+        let body = br#"{"method":"my_balance","mmrpc":null,"params":{}}"#;
+        match json::from_slice(body).unwrap() {
+            RpcRequestBody::Single { req, params: None } => assert_eq!(req["params"], json!({})),
+            _ => panic!("Expected a single request without the raw params"),
+        }
+    }
+
+    #[test]
+    fn test_batch_request() {
+        let body = br#"[{"method":"version"},{"method":"get_enabled_coins","mmrpc":"2.0","params":{}}]"#;
+        match json::from_slice(body).unwrap() {
+            RpcRequestBody::Batch(requests) => assert_eq!(requests, vec![
+                json!({"method": "version"}),
+                json!({"method": "get_enabled_coins", "mmrpc": "2.0", "params": {}}),
+            ]),
+            RpcRequestBody::Single { .. } => panic!("Expected a batch request"),
+        }
+    }
+
+    #[test]
+    fn test_invalid_request_body() {
+        assert!(json::from_slice::<RpcRequestBody>(br#""version""#).is_err());
+        assert!(json::from_slice::<RpcRequestBody>(b"null").is_err());
+        assert!(json::from_slice::<RpcRequestBody>(br#"{"method":"version"} {}"#).is_err());
+        assert!(json::from_slice::<RpcRequestBody>(br#"{"method":"version","mmrpc":"2.0","params":"#).is_err());
+    }
+}
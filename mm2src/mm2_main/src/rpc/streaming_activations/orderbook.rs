@@ -1,8 +1,11 @@
-//! RPC activation and deactivation of the orderbook streamer.
-use super::EnableStreamingResponse;
+//! RPC activation and deactivation of the orderbook streamers.
+use super::{EnableStreamingRequest, EnableStreamingResponse};
+use crate::lp_ordermatch::orderbook_depth_events::{send_depth_snapshot, OrderbookDepthStreamer,
+                                                   OrderbookDepthStreamingConfig};
 use crate::lp_ordermatch::orderbook_events::OrderbookStreamer;
 use mm2_core::mm_ctx::MmArc;
-use mm2_err_handle::{map_to_mm::MapToMmResult, mm_error::MmResult};
+use mm2_err_handle::{map_to_mm::MapToMmResult,
+                     mm_error::{MmError, MmResult}};
 
 use common::HttpStatusCode;
 use http::StatusCode;
@@ -14,10 +17,19 @@ pub struct EnableOrderbookStreamingRequest {
     pub rel: String,
 }
 
+#[derive(Deserialize)]
+pub struct EnableOrderbookDepthStreamingRequest {
+    pub base: String,
+    pub rel: String,
+    #[serde(default)]
+    pub config: OrderbookDepthStreamingConfig,
+}
+
 #[derive(Display, Serialize, SerializeErrorType)]
 #[serde(tag = "error_type", content = "error_data")]
 pub enum OrderbookStreamingRequestError {
     EnableError(String),
+    InvalidConfig(String),
 }
 
 impl HttpStatusCode for OrderbookStreamingRequestError {
@@ -35,3 +47,28 @@ pub async fn enable_orderbook(
         .map(EnableStreamingResponse::new)
         .map_to_mm(|e| OrderbookStreamingRequestError::EnableError(format!("{e:?}")))
 }
+
+pub async fn enable_orderbook_depth(
+    ctx: MmArc,
+    req: EnableStreamingRequest<EnableOrderbookDepthStreamingRequest>,
+) -> MmResult<EnableStreamingResponse, OrderbookStreamingRequestError> {
+    let (client_id, req) = (req.client_id, req.inner);
+    req.config
+        .validate()
+        .map_to_mm(OrderbookStreamingRequestError::InvalidConfig)?;
+    let depth_streamer = OrderbookDepthStreamer::new(ctx.clone(), req.base.clone(), req.rel.clone(), req.config);
+    let streamer_id = ctx
+        .event_stream_manager
+        .add(client_id, depth_streamer, ctx.spawner())
+        .await
+        .map_to_mm(|e| OrderbookStreamingRequestError::EnableError(format!("{e:?}")))?;
+    // The deltas are only meaningful on top of the current depth, so send it to the new client.
+    // The client is attached already, so the deltas it receives before the snapshot are in the snapshot,
+    // see the `orderbook_depth_events` module docs.
+    if let Err(e) = send_depth_snapshot(&ctx, &req.base, &req.rel, client_id) {
+        // The client would only receive the deltas it can't apply.
+        ctx.event_stream_manager.stop(client_id, &streamer_id).ok();
+        return MmError::err(OrderbookStreamingRequestError::EnableError(e));
+    }
+    Ok(EnableStreamingResponse::new(streamer_id))
+}
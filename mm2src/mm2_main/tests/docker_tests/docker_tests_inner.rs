@@ -21,9 +21,9 @@ use mm2_libp2p::behaviours::atomicdex::MAX_TIME_GAP_FOR_CONNECTED_PEER;
 use mm2_number::{BigDecimal, BigRational, MmNumber};
 use mm2_test_helpers::for_tests::{check_my_swap_status_amounts, disable_coin, disable_coin_err, enable_eth_coin,
                                   enable_eth_with_tokens_v2, erc20_dev_conf, eth_dev_conf, get_locked_amount,
-                                  kmd_conf, max_maker_vol, mm_dump, mycoin1_conf, mycoin_conf, set_price, start_swaps,
-                                  wait_for_swap_contract_negotiation, wait_for_swap_negotiation_failure,
-                                  MarketMakerIt, Mm2TestConf, DEFAULT_RPC_PASSWORD};
+                                  is_active_maker_order_saved, kmd_conf, max_maker_vol, mm_dump, mycoin1_conf,
+                                  mycoin_conf, set_price, start_swaps, wait_for_swap_contract_negotiation,
+                                  wait_for_swap_negotiation_failure, MarketMakerIt, Mm2TestConf, DEFAULT_RPC_PASSWORD};
 use mm2_test_helpers::{get_passphrase, structs::*};
 use serde_json::Value as Json;
 use std::collections::{HashMap, HashSet};
@@ -495,13 +495,8 @@ fn order_should_be_cancelled_when_entire_balance_is_withdrawn() {
     );
 
     let rmd160 = rmd160_from_priv(priv_key);
-    let order_path = mm_bob.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160.take()),
-        bob_uuid,
-    ));
-    log!("Order path {}", order_path.display());
-    assert!(!order_path.exists());
+    let db_dir = hex::encode(rmd160.take());
+    assert!(!is_active_maker_order_saved(&mm_bob, &db_dir, &bob_uuid.to_string()));
     block_on(mm_bob.stop()).unwrap();
 }
 
@@ -984,13 +979,8 @@ fn test_match_and_trade_setprice_max() {
     thread::sleep(Duration::from_secs(3));
 
     let rmd160 = rmd160_from_priv(bob_priv_key);
-    let order_path = mm_bob.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160.take()),
-        bob_uuid,
-    ));
-    log!("Order path {}", order_path.display());
-    assert!(!order_path.exists());
+    let db_dir = hex::encode(rmd160.take());
+    assert!(!is_active_maker_order_saved(&mm_bob, &db_dir, &bob_uuid.to_string()));
     block_on(mm_bob.stop()).unwrap();
     block_on(mm_alice.stop()).unwrap();
 }
@@ -2545,14 +2535,8 @@ fn test_maker_order_should_not_kick_start_and_appear_in_orderbook_if_balance_is_
     let res: MyOrdersRpcResult = serde_json::from_str(&rc.1).unwrap();
     assert!(res.result.maker_orders.is_empty(), "Bob maker orders must be empty");
 
-    let order_path = mm_bob.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160_from_priv(bob_priv_key).take()),
-        uuid
-    ));
-
-    log!("Order path {}", order_path.display());
-    assert!(!order_path.exists());
+    let db_dir = hex::encode(rmd160_from_priv(bob_priv_key).take());
+    assert!(!is_active_maker_order_saved(&mm_bob, &db_dir, &uuid.to_string()));
 }
 
 #[test]
@@ -4402,13 +4386,8 @@ fn test_gtc_taker_order_should_transform_to_maker() {
         serde_json::from_value(my_orders["result"]["taker_orders"].clone()).unwrap();
     assert_eq!(1, my_maker_orders.len(), "maker_orders must have exactly 1 order");
     assert!(my_taker_orders.is_empty(), "taker_orders must be empty");
-    let order_path = mm.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160_from_passphrase(&format!("0x{}", hex::encode(privkey)))),
-        uuid
-    ));
-    log!("Order path {}", order_path.display());
-    assert!(order_path.exists());
+    let db_dir = hex::encode(rmd160_from_passphrase(&format!("0x{}", hex::encode(privkey))));
+    assert!(is_active_maker_order_saved(&mm, &db_dir, &uuid.to_string()));
 }
 
 #[test]
@@ -4456,12 +4435,8 @@ fn test_set_price_must_save_order_to_db() {
     assert!(rc.0.is_success(), "!setprice: {}", rc.1);
     let rc_json: Json = serde_json::from_str(&rc.1).unwrap();
     let uuid: String = serde_json::from_value(rc_json["result"]["uuid"].clone()).unwrap();
-    let order_path = mm.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160_from_passphrase(&private_key_str)),
-        uuid
-    ));
-    assert!(order_path.exists());
+    let db_dir = hex::encode(rmd160_from_passphrase(&private_key_str));
+    assert!(is_active_maker_order_saved(&mm, &db_dir, &uuid.to_string()));
 }
 
 #[test]
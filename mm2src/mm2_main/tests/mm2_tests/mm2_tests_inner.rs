@@ -15,14 +15,15 @@ use mm2_test_helpers::for_tests::wait_check_stats_swap_status;
 use mm2_test_helpers::for_tests::{account_balance, btc_segwit_conf, btc_with_spv_conf, btc_with_sync_starting_header,
                                   check_recent_swaps, delete_wallet, enable_qrc20, enable_utxo_v2_electrum,
                                   eth_dev_conf, find_metrics_in_json, from_env_file, get_new_address,
-                                  get_shared_db_id, get_wallet_names, mm_spat, morty_conf, my_balance, rick_conf,
-                                  sign_message, start_swaps, tbtc_conf, tbtc_segwit_conf, tbtc_with_spv_conf,
-                                  test_qrc20_history_impl, tqrc20_conf, verify_message,
-                                  wait_for_swaps_finish_and_check_status, wait_till_history_has_records,
-                                  MarketMakerIt, Mm2InitPrivKeyPolicy, Mm2TestConf, Mm2TestConfForSwap, RaiiDump,
-                                  DOC_ELECTRUM_ADDRS, ETH_MAINNET_NODES, ETH_MAINNET_SWAP_CONTRACT, ETH_SEPOLIA_NODES,
-                                  ETH_SEPOLIA_SWAP_CONTRACT, MARTY_ELECTRUM_ADDRS, MORTY, QRC20_ELECTRUMS, RICK,
-                                  RICK_ELECTRUM_ADDRS, TBTC_ELECTRUMS, T_BCH_ELECTRUMS};
+                                  get_shared_db_id, get_wallet_names, is_active_maker_order_saved, mm_spat,
+                                  morty_conf, my_balance, rick_conf, sign_message, start_swaps, tbtc_conf,
+                                  tbtc_segwit_conf, tbtc_with_spv_conf, test_qrc20_history_impl, tqrc20_conf,
+                                  verify_message, wait_for_swaps_finish_and_check_status,
+                                  wait_till_history_has_records, MarketMakerIt, Mm2InitPrivKeyPolicy, Mm2TestConf,
+                                  Mm2TestConfForSwap, RaiiDump, DOC_ELECTRUM_ADDRS, ETH_MAINNET_NODES,
+                                  ETH_MAINNET_SWAP_CONTRACT, ETH_SEPOLIA_NODES, ETH_SEPOLIA_SWAP_CONTRACT,
+                                  MARTY_ELECTRUM_ADDRS, MORTY, QRC20_ELECTRUMS, RICK, RICK_ELECTRUM_ADDRS,
+                                  TBTC_ELECTRUMS, T_BCH_ELECTRUMS};
 use mm2_test_helpers::get_passphrase;
 use mm2_test_helpers::structs::*;
 use serde_json::{self as json, json, Value as Json};
@@ -1524,12 +1525,8 @@ fn test_cancel_order() {
     .unwrap();
     assert!(cancel_rc.0.is_success(), "!cancel_order: {}", rc.1);
     let uuid: Uuid = json::from_value(setprice_json["result"]["uuid"].clone()).unwrap();
-    let order_path = mm_bob.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160_from_passphrase(bob_passphrase)),
-        uuid
-    ));
-    assert!(!order_path.exists());
+    let db_dir = hex::encode(rmd160_from_passphrase(bob_passphrase));
+    assert!(!is_active_maker_order_saved(&mm_bob, &db_dir, &uuid.to_string()));
 
     let pause = 3;
     log!("Waiting ({} seconds) for Bob to cancel the order…", pause);
@@ -1670,12 +1667,8 @@ fn test_cancel_all_orders() {
     .unwrap();
     assert!(cancel_rc.0.is_success(), "!cancel_all_orders: {}", rc.1);
     let uuid: Uuid = json::from_value(setprice_json["result"]["uuid"].clone()).unwrap();
-    let order_path = mm_bob.folder.join(format!(
-        "DB/{}/ORDERS/MY/MAKER/{}.json",
-        hex::encode(rmd160_from_passphrase(bob_passphrase)),
-        uuid
-    ));
-    assert!(!order_path.exists());
+    let db_dir = hex::encode(rmd160_from_passphrase(bob_passphrase));
+    assert!(!is_active_maker_order_saved(&mm_bob, &db_dir, &uuid.to_string()));
 
     let pause = 3;
     log!("Waiting ({} seconds) for Bob to cancel the order…", pause);
@@ -66,6 +66,9 @@ impl MetricsArc {
 
     /// Create a weak pointer from `MetricsWeak`.
     pub fn weak(&self) -> MetricsWeak { MetricsWeak(Arc::downgrade(&self.0)) }
+
+    /// Enable or disable measuring the spans started with `mm_span!`.
+    pub fn set_spans_enabled(&self, enabled: bool) { self.0.recorder.set_spans_enabled(enabled) }
 }
 
 impl TryRecorder for MetricsArc {
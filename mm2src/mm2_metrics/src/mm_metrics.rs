@@ -8,6 +8,7 @@ use serde_json::Value;
 use std::sync::{atomic::Ordering, Arc};
 use std::{collections::HashMap, slice::Iter};
 
+use crate::recorder::HistogramSnapshot;
 use crate::{common::log::Tag, MetricsOps, MmMetricsError, MmMetricsResult, MmRecorder, SpawnFuture};
 
 type MetricLabels = Vec<Label>;
@@ -90,6 +91,30 @@ macro_rules! mm_timing {
     }};
 }
 
+/// Start a span if an MmArc is not dropped yet and the spans are enabled.
+///
+/// Returns a guard recording the seconds elapsed until it's dropped to the histogram, so it has to be bound to a variable:
+/// `let _span = mm_span!(ctx.metrics, "swap.command.duration", "command" => "Start");`.
+/// Neither the key nor the labels are evaluated if the spans are disabled.
+#[macro_export]
+macro_rules! mm_span {
+    ($metrics:expr, $name:expr) => {{
+        $crate::recorder::TryRecorder::try_recorder(&$metrics)
+            .filter(|recorder| recorder.spans_enabled())
+            .map(|recorder| recorder.span(&$crate::metrics::Key::from_static_name($name)))
+    }};
+
+    // Start a span with label.
+    ($metrics:expr, $name:expr, $($label_key:expr => $label_val:expr),+) => {{
+        $crate::recorder::TryRecorder::try_recorder(&$metrics)
+            .filter(|recorder| recorder.spans_enabled())
+            .map(|recorder| {
+                let key = $crate::metrics::Key::from_parts($name, $crate::mm_label!($($label_key => $label_val),+).as_slice());
+                recorder.span(&key)
+            })
+    }};
+}
+
 /// Market Maker Metrics, used as inner to get metrics data and exporting.
 #[derive(Default, Clone)]
 pub struct Metrics {
@@ -174,8 +199,8 @@ impl TagObserver {
             map_metrics_to_prepare_tag_metric_output(key, PreparedMetric::Float(value), &mut output);
         }
 
-        for (key, histo) in recorder.registry.get_histogram_handles() {
-            if let Some(values) = MmHistogram::new(&histo.get_inner().data()) {
+        for (key, histogram) in recorder.histogram_snapshots() {
+            if let Some(values) = MmHistogram::new(&histogram) {
                 map_metrics_to_prepare_tag_metric_output(key, PreparedMetric::Histogram(values), &mut output);
             }
         }
@@ -226,15 +251,17 @@ pub(crate) struct MmHistogram {
 }
 
 impl MmHistogram {
-    /// Create new MmHistogram from `&[f64]`.
+    /// Create new MmHistogram from `&HistogramSnapshot`.
     ///
-    /// Return None if data.len() <= 0.
-    pub(crate) fn new(data: &[f64]) -> Option<MmHistogram> {
-        let (min, max) = data.iter().minmax().into_option()?;
+    /// Return None if the histogram is empty.
+    pub(crate) fn new(histogram: &HistogramSnapshot) -> Option<MmHistogram> {
+        if histogram.count == 0 {
+            return None;
+        }
         Some(MmHistogram {
-            count: data.len(),
-            min: *min,
-            max: *max,
+            count: histogram.count as usize,
+            min: histogram.min,
+            max: histogram.max,
         })
     }
 
@@ -561,6 +588,42 @@ mod test {
                          "coin"=> "KMD",
                          "method"=>"blockchain.transaction.get");
 
-        println!("{}", mm_metrics.0.collect_prometheus_format());
+        let output = mm_metrics.0.collect_prometheus_format();
+        println!("{}", output);
+        assert!(output.contains("# TYPE rpc_query_spent_time histogram"));
+        assert!(output.contains("le=\"+Inf\"} 1"));
+        assert!(output.contains("rpc_query_spent_time_count{coin=\"KMD\",method=\"blockchain.transaction.get\"} 1"));
+    }
+
+    #[test]
+    fn test_span() {
+        let mm_metrics = MetricsArc::new();
+
+        mm_metrics.init();
+
+        {
+            let _span = mm_span!(mm_metrics, "test.span", "command" => "Start");
+        }
+        {
+            let _span = mm_span!(mm_metrics, "test.span", "command" => "Start");
+        }
+
+        mm_metrics.set_spans_enabled(false);
+        {
+            let _span = mm_span!(mm_metrics, "test.span", "command" => "Start");
+            assert!(_span.is_none());
+            let _span = mm_span!(mm_metrics, "test.disabled_span");
+        }
+
+        let actual = mm_metrics.collect_json().unwrap();
+        let histograms: Vec<_> = actual["metrics"]
+            .as_array()
+            .unwrap()
+            .iter()
+            .filter(|metric| metric["type"] == "histogram")
+            .collect();
+        assert_eq!(histograms.len(), 1);
+        assert_eq!(histograms[0]["key"], "test.span");
+        assert_eq!(histograms[0]["count"], 2.0);
     }
 }
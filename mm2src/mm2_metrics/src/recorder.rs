@@ -1,16 +1,251 @@
 use crate::{mm_metrics::MmHistogram, MetricType, MetricsJson};
 
-use metrics::{Counter, Gauge, Histogram, Key, KeyName, Label, Recorder, Unit};
+use compatible_time::Instant;
+use metrics::{Counter, Gauge, Histogram, HistogramFn, Key, KeyName, Label, Recorder, Unit};
 #[cfg(not(target_arch = "wasm32"))]
 use metrics_exporter_prometheus::formatting::{key_to_parts, write_metric_line, write_type_line};
 use metrics_util::registry::{GenerationalAtomicStorage, GenerationalStorage, Registry};
-use std::sync::{atomic::Ordering, Arc};
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, RwLock};
 use std::{collections::HashMap, slice::Iter};
 
+/// The number of the power of 2 ranges covered by a histogram, the values from 2^-24 to 2^24.
+///
+/// With the values recorded in seconds, that's from 60 nanoseconds to half a year.
+/// The smaller values are counted in the first bucket and the larger ones in [`OVERFLOW_BUCKET`],
+/// but they still count to the exact min and max.
+const HISTOGRAM_OCTAVES: usize = 48;
+/// The power of 2 of the smallest value tracked by a histogram.
+const HISTOGRAM_MIN_POWER: i32 = -24;
+/// Every power of 2 range is split into `2^OCTAVE_SUB_BUCKETS_BITS` linear buckets,
+/// so the quantiles are known with the relative error of 12.5% at most.
+const OCTAVE_SUB_BUCKETS_BITS: u32 = 3;
+const OCTAVE_SUB_BUCKETS: usize = 1 << OCTAVE_SUB_BUCKETS_BITS;
+/// The bucket of the values not less than 2^24, it's only counted in the `+Inf` bucket of the Prometheus histogram.
+const OVERFLOW_BUCKET: usize = HISTOGRAM_OCTAVES * OCTAVE_SUB_BUCKETS;
+const HISTOGRAM_BUCKETS: usize = OVERFLOW_BUCKET + 1;
+/// The number of the shards of a histogram, every thread records to one of them.
+const HISTOGRAM_SHARDS: usize = 4;
+
+const F64_MANTISSA_BITS: u32 = 52;
+const F64_EXPONENT_BIAS: i32 = 1023;
+
+static NEXT_HISTOGRAM_SHARD: AtomicUsize = AtomicUsize::new(0);
+
+thread_local! {
+    /// The histogram shard the current thread records to, the threads are spread over the shards round-robin.
+    static HISTOGRAM_SHARD: usize = NEXT_HISTOGRAM_SHARD.fetch_add(1, Ordering::Relaxed) % HISTOGRAM_SHARDS;
+}
+
+/// Returns the index of the bucket counting the non-negative `value`.
+///
+/// The bucket is taken from the bits of the float: the exponent gives the power of 2 range,
+/// and the highest bits of the mantissa give the linear bucket within the range.
+fn bucket_index(value: f64) -> usize {
+    let bits = value.to_bits();
+    let power = (bits >> F64_MANTISSA_BITS) as i32 - F64_EXPONENT_BIAS;
+    if power < HISTOGRAM_MIN_POWER {
+        return 0;
+    }
+    let octave = (power - HISTOGRAM_MIN_POWER) as usize;
+    if octave >= HISTOGRAM_OCTAVES {
+        return OVERFLOW_BUCKET;
+    }
+    let sub_bucket = (bits >> (F64_MANTISSA_BITS - OCTAVE_SUB_BUCKETS_BITS)) as usize & (OCTAVE_SUB_BUCKETS - 1);
+    octave * OCTAVE_SUB_BUCKETS + sub_bucket
+}
+
+/// Returns the upper bound of the values counted in the bucket.
+fn bucket_upper_bound(index: usize) -> f64 {
+    if index == OVERFLOW_BUCKET {
+        return f64::INFINITY;
+    }
+    let octave = index / OCTAVE_SUB_BUCKETS;
+    let sub_bucket = index % OCTAVE_SUB_BUCKETS;
+    let octave_start = 2f64.powi(octave as i32 + HISTOGRAM_MIN_POWER);
+    octave_start * (1. + (sub_bucket + 1) as f64 / OCTAVE_SUB_BUCKETS as f64)
+}
+
+/// A part of `ShardedHistogram` updated by a subset of threads.
+///
+/// Aligned to a cache line so the threads recording to different shards don't contend over it.
+#[repr(align(64))]
+struct HistogramShard {
+    buckets: Box<[AtomicU64]>,
+    /// The bits of the f64 sum of the recorded values.
+    sum: AtomicU64,
+    /// The bits of the smallest recorded value, the bits of the non-negative floats are ordered as the floats.
+    min: AtomicU64,
+    /// The bits of the largest recorded value.
+    max: AtomicU64,
+}
+
+impl Default for HistogramShard {
+    fn default() -> Self {
+        HistogramShard {
+            buckets: (0..HISTOGRAM_BUCKETS).map(|_| AtomicU64::new(0)).collect(),
+            sum: AtomicU64::new(0f64.to_bits()),
+            min: AtomicU64::new(u64::MAX),
+            max: AtomicU64::new(0),
+        }
+    }
+}
+
+impl HistogramShard {
+    fn record(&self, value: f64) {
+        self.buckets[bucket_index(value)].fetch_add(1, Ordering::Relaxed);
+
+        let mut sum = self.sum.load(Ordering::Relaxed);
+        loop {
+            let new_sum = (f64::from_bits(sum) + value).to_bits();
+            match self
+                .sum
+                .compare_exchange_weak(sum, new_sum, Ordering::Relaxed, Ordering::Relaxed)
+            {
+                Ok(_) => break,
+                Err(actual) => sum = actual,
+            }
+        }
+
+        // Skip the writes in the common case of the value being within the known range.
+        let bits = value.to_bits();
+        if bits < self.min.load(Ordering::Relaxed) {
+            self.min.fetch_min(bits, Ordering::Relaxed);
+        }
+        if bits > self.max.load(Ordering::Relaxed) {
+            self.max.fetch_max(bits, Ordering::Relaxed);
+        }
+    }
+}
+
+/// A lock-free histogram of the log-linear buckets, HDR histogram style.
+///
+/// Unlike a histogram keeping every recorded value, it takes a fixed amount of memory
+/// and recording to it is a few relaxed atomic operations on the shard of the current thread.
+/// The shards are only merged when the metrics are collected.
+pub struct ShardedHistogram {
+    shards: [HistogramShard; HISTOGRAM_SHARDS],
+}
+
+impl Default for ShardedHistogram {
+    fn default() -> Self {
+        ShardedHistogram {
+            shards: Default::default(),
+        }
+    }
+}
+
+impl ShardedHistogram {
+    /// Merges the shards into a snapshot of the histogram.
+    pub fn snapshot(&self) -> HistogramSnapshot {
+        let mut snapshot = HistogramSnapshot {
+            count: 0,
+            sum: 0.,
+            min: f64::INFINITY,
+            max: 0.,
+            buckets: vec![0; HISTOGRAM_BUCKETS],
+        };
+        for shard in self.shards.iter() {
+            for (total, bucket) in snapshot.buckets.iter_mut().zip(shard.buckets.iter()) {
+                *total += bucket.load(Ordering::Relaxed);
+            }
+            snapshot.sum += f64::from_bits(shard.sum.load(Ordering::Relaxed));
+            let min = shard.min.load(Ordering::Relaxed);
+            if min != u64::MAX {
+                snapshot.min = snapshot.min.min(f64::from_bits(min));
+            }
+            snapshot.max = snapshot.max.max(f64::from_bits(shard.max.load(Ordering::Relaxed)));
+        }
+        snapshot.count = snapshot.buckets.iter().sum();
+        snapshot
+    }
+}
+
+impl HistogramFn for ShardedHistogram {
+    /// Records the `value`, the negative values are recorded as 0 and NaN is ignored.
+    fn record(&self, value: f64) {
+        if value.is_nan() {
+            return;
+        }
+        let shard = HISTOGRAM_SHARD.with(|shard| *shard);
+        self.shards[shard].record(value.max(0.));
+    }
+}
+
+/// The merged state of `ShardedHistogram` at the moment of collecting.
+#[derive(Clone, Debug)]
+pub struct HistogramSnapshot {
+    pub count: u64,
+    pub sum: f64,
+    pub min: f64,
+    pub max: f64,
+    buckets: Vec<u64>,
+}
+
+impl HistogramSnapshot {
+    /// Returns the estimated value at the quantile `q` in the range `[0, 1]`, or None if the histogram is empty.
+    ///
+    /// The estimation is the upper bound of the bucket the value is counted in, clamped to the exact min and max.
+    pub fn quantile(&self, q: f64) -> Option<f64> {
+        if self.count == 0 {
+            return None;
+        }
+        let rank = ((q.clamp(0., 1.) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        let index = self
+            .buckets
+            .iter()
+            .position(|count| {
+                seen += count;
+                seen >= rank
+            })
+            .unwrap_or(OVERFLOW_BUCKET);
+        Some(bucket_upper_bound(index).clamp(self.min, self.max))
+    }
+
+    /// Returns the cumulative counts of the values less than the powers of 2
+    /// from the lowest to the highest power of 2 range having any value.
+    ///
+    /// The values counted in [`OVERFLOW_BUCKET`] are left out, they only count to the total `count`.
+    /// The recorded values are never removed, so the returned bounds only extend over time.
+    pub fn cumulative_octaves(&self) -> Vec<(f64, u64)> {
+        let octave_counts: Vec<u64> = self.buckets[..OVERFLOW_BUCKET]
+            .chunks(OCTAVE_SUB_BUCKETS)
+            .map(|octave| octave.iter().sum())
+            .collect();
+        let first = match octave_counts.iter().position(|count| *count != 0) {
+            Some(first) => first,
+            None => return Vec::new(),
+        };
+        let last = octave_counts.iter().rposition(|count| *count != 0).unwrap_or(first);
+
+        let mut cumulative = 0;
+        (first..=last)
+            .map(|octave| {
+                cumulative += octave_counts[octave];
+                let bound = bucket_upper_bound((octave + 1) * OCTAVE_SUB_BUCKETS - 1);
+                (bound, cumulative)
+            })
+            .collect()
+    }
+}
+
+/// Records the seconds elapsed since it was started to the histogram when dropped.
+///
+/// Created with the `mm_span!` macro.
+pub struct SpanGuard {
+    histogram: Arc<ShardedHistogram>,
+    started_at: Instant,
+}
+
+impl Drop for SpanGuard {
+    fn drop(&mut self) { self.histogram.record(self.started_at.elapsed().as_secs_f64()) }
+}
+
 pub struct Snapshot {
     pub counters: HashMap<String, HashMap<Vec<String>, u64>>,
     pub gauges: HashMap<String, HashMap<Vec<String>, f64>>,
-    pub histograms: HashMap<String, HashMap<Vec<String>, Vec<f64>>>,
+    pub histograms: HashMap<String, HashMap<Vec<String>, HistogramSnapshot>>,
 }
 
 /// `MmRecorder` the core of mm metrics.
@@ -18,17 +253,64 @@ pub struct Snapshot {
 ///  Registering, Recording, Updating and Collecting metrics is all done from within MmRecorder.
 pub struct MmRecorder {
     pub(crate) registry: Registry<Key, GenerationalAtomicStorage>,
+    /// The histograms are kept apart from the `registry` as they aren't supported by its storage.
+    histograms: RwLock<HashMap<Key, Arc<ShardedHistogram>>>,
+    /// Whether `mm_span!` measures the spans.
+    spans_enabled: AtomicBool,
 }
 
 impl Default for MmRecorder {
     fn default() -> Self {
         Self {
             registry: Registry::new(GenerationalStorage::atomic()),
+            histograms: RwLock::new(HashMap::new()),
+            spans_enabled: AtomicBool::new(true),
         }
     }
 }
 
 impl MmRecorder {
+    /// Returns the histogram by the `key`, registers it if it doesn't exist yet.
+    pub fn histogram(&self, key: &Key) -> Arc<ShardedHistogram> {
+        if let Some(histogram) = self.histograms.read().unwrap().get(key) {
+            return histogram.clone();
+        }
+        self.histograms
+            .write()
+            .unwrap()
+            .entry(key.clone())
+            .or_insert_with(Default::default)
+            .clone()
+    }
+
+    /// Returns the snapshots of all the registered histograms.
+    pub(crate) fn histogram_snapshots(&self) -> Vec<(Key, HistogramSnapshot)> {
+        let histograms: Vec<_> = self
+            .histograms
+            .read()
+            .unwrap()
+            .iter()
+            .map(|(key, histogram)| (key.clone(), histogram.clone()))
+            .collect();
+        // Merge the shards without holding the lock not to block the registration of the new histograms.
+        histograms
+            .into_iter()
+            .map(|(key, histogram)| (key, histogram.snapshot()))
+            .collect()
+    }
+
+    pub fn spans_enabled(&self) -> bool { self.spans_enabled.load(Ordering::Relaxed) }
+
+    pub fn set_spans_enabled(&self, enabled: bool) { self.spans_enabled.store(enabled, Ordering::Relaxed) }
+
+    /// Starts a span recorded to the histogram by the `key`.
+    pub fn span(&self, key: &Key) -> SpanGuard {
+        SpanGuard {
+            histogram: self.histogram(key),
+            started_at: Instant::now(),
+        }
+    }
+
     #[cfg(not(target_arch = "wasm32"))]
     fn get_metrics(&self) -> Snapshot {
         let mut counters = HashMap::new();
@@ -46,8 +328,8 @@ impl MmRecorder {
         }
 
         let mut histograms = HashMap::new();
-        for (key, histogram) in self.registry.get_histogram_handles() {
-            key_value_to_snapshot_entry(&mut histograms, key, histogram.get_inner().data());
+        for (key, histogram) in self.histogram_snapshots() {
+            key_value_to_snapshot_entry(&mut histograms, key, histogram);
         }
 
         Snapshot {
@@ -83,30 +365,24 @@ impl MmRecorder {
             output.push('\n');
         }
 
-        for (key, histogram) in histograms.drain() {
-            let key = Key::from_name(key.to_owned());
-            let (name, labels) = key_to_parts(&key, None);
+        for (name, mut by_labels) in histograms.drain() {
             write_type_line(&mut output, &name, "histogram");
-            for (_, values) in histogram {
-                let mut count = 0;
-                let mut sum = 0.0;
-
-                count += values.len();
-                values.iter().for_each(|value| {
-                    sum += value;
-                });
-
-                write_metric_line::<&str, f64>(&mut output, &name, Some("sum"), &labels, None, sum);
-                write_metric_line::<&str, usize>(
+            for (labels, histogram) in by_labels.drain() {
+                for (bound, count) in histogram.cumulative_octaves() {
+                    write_metric_line(&mut output, &name, Some("bucket"), &labels, Some(("le", bound)), count);
+                }
+                write_metric_line(
                     &mut output,
                     &name,
-                    Some("count"),
-                    key_to_parts(&key, None).1.as_slice(),
-                    None,
-                    count,
+                    Some("bucket"),
+                    &labels,
+                    Some(("le", "+Inf")),
+                    histogram.count,
                 );
-                output.push('\n');
+                write_metric_line::<&str, f64>(&mut output, &name, Some("sum"), &labels, None, histogram.sum);
+                write_metric_line::<&str, u64>(&mut output, &name, Some("count"), &labels, None, histogram.count);
             }
+            output.push('\n');
         }
 
         output
@@ -135,10 +411,9 @@ impl MmRecorder {
             });
         }
 
-        for (key, histogram) in self.registry.get_histogram_handles() {
-            let value = histogram.get_inner().data();
+        for (key, histogram) in self.histogram_snapshots() {
             let (key, labels) = key.into_parts();
-            let mm_histogram = MmHistogram::new(&value);
+            let mm_histogram = MmHistogram::new(&histogram);
 
             if let Some(qauntiles_value) = mm_histogram {
                 output.push(MetricType::Histogram {
@@ -177,9 +452,7 @@ impl Recorder for MmRecorder {
 
     fn register_gauge(&self, key: &Key) -> Gauge { self.registry.get_or_create_gauge(key, |e| e.clone().into()) }
 
-    fn register_histogram(&self, key: &Key) -> Histogram {
-        self.registry.get_or_create_histogram(key, |e| e.clone().into())
-    }
+    fn register_histogram(&self, key: &Key) -> Histogram { Histogram::from_arc(self.histogram(key)) }
 }
 
 pub trait TryRecorder {
@@ -193,3 +466,64 @@ fn labels_into_parts(labels: Iter<Label>) -> HashMap<String, String> {
         .map(|label| (label.key().to_string(), label.value().to_string()))
         .collect()
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bucket_bounds() {
+        for value in [0., 1e-9, 0.001, 0.3, 1., 1.5, 7.99, 1000., 1e9] {
+            let index = bucket_index(value);
+            assert!(value <= bucket_upper_bound(index));
+            assert!(index == 0 || value >= bucket_upper_bound(index - 1));
+        }
+        assert_eq!(bucket_index(0.), 0);
+        assert_eq!(bucket_index(2f64.powi(24) - 1.), OVERFLOW_BUCKET - 1);
+        assert_eq!(bucket_index(2f64.powi(24)), OVERFLOW_BUCKET);
+        assert_eq!(bucket_index(f64::INFINITY), OVERFLOW_BUCKET);
+    }
+
+    #[test]
+    fn test_histogram_snapshot() {
+        let histogram = ShardedHistogram::default();
+        assert_eq!(histogram.snapshot().quantile(0.5), None);
+        assert!(histogram.snapshot().cumulative_octaves().is_empty());
+
+        for value in 1..=100 {
+            histogram.record(value as f64);
+        }
+        histogram.record(f64::NAN);
+        histogram.record(-1.);
+
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.count, 101);
+        assert_eq!(snapshot.sum, 5050.);
+        assert_eq!(snapshot.min, 0.);
+        assert_eq!(snapshot.max, 100.);
+
+        let median = snapshot.quantile(0.5).unwrap();
+        assert!((median - 50.).abs() / 50. <= 0.125, "median {}", median);
+        assert_eq!(snapshot.quantile(1.).unwrap(), 100.);
+
+        let octaves = snapshot.cumulative_octaves();
+        assert_eq!(octaves.last(), Some(&(128., 101)));
+        // 0 and 1 are counted in the lowest buckets, 2 and 3 are in the [2, 4) range.
+        assert!(octaves.contains(&(2., 2)));
+        assert!(octaves.contains(&(4., 4)));
+    }
+
+    #[test]
+    fn test_histogram_overflow() {
+        let histogram = ShardedHistogram::default();
+        histogram.record(1.);
+        histogram.record(1e9);
+
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.count, 2);
+        // the value out of the range is only in the total count, so it's only reported under `le="+Inf"`
+        assert_eq!(snapshot.cumulative_octaves(), vec![(2., 1)]);
+        assert_eq!(snapshot.quantile(0.5), Some(1.125));
+        assert_eq!(snapshot.quantile(1.), Some(1e9));
+    }
+}
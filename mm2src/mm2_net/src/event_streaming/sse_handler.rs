@@ -1,7 +1,6 @@
 use http::header::{ACCESS_CONTROL_ALLOW_ORIGIN, CACHE_CONTROL, CONTENT_TYPE};
 use hyper::{body::Bytes, Body, Request, Response};
 use mm2_core::mm_ctx::MmArc;
-use serde_json::json;
 
 pub const SSE_ENDPOINT: &str = "/event-stream";
 
@@ -33,15 +32,8 @@ pub async fn handle_sse(request: Request<Body>, ctx_h: u32) -> Response<Body> {
     };
     let body = Body::wrap_stream(async_stream::stream! {
         while let Some(event) = rx.recv().await {
-            // The event's filter will decide whether to expose the event data to this client or not.
-            // This happens based on the events that this client has subscribed to.
-            let (event_type, message) = event.get();
-            let data = json!({
-                "_type": event_type,
-                "message": message,
-            });
-
-            yield Ok::<_, hyper::Error>(Bytes::from(format!("data: {data} \n\n")));
+            // The event is serialized once and shared by all the clients it's broadcast to.
+            yield Ok::<_, hyper::Error>(Bytes::from(format!("data: {} \n\n", event.payload())));
         }
     });
 
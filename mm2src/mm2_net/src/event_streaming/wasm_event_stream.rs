@@ -1,5 +1,4 @@
 use mm2_core::mm_ctx::MmArc;
-use serde_json::json;
 use web_sys::SharedWorker;
 
 struct SendableSharedWorker(SharedWorker);
@@ -32,12 +31,7 @@ pub async fn handle_worker_stream(ctx: MmArc, worker_path: String) {
         .expect("A different wasm client is already listening. Only one client is allowed at a time.");
 
     while let Some(event) = rx.recv().await {
-        let (event_type, message) = event.get();
-        let data = json!({
-            "_type": event_type,
-            "message": message,
-        });
-        let message_js = wasm_bindgen::JsValue::from_str(&data.to_string());
+        let message_js = wasm_bindgen::JsValue::from_str(event.payload());
         port.0.post_message(&message_js)
             .expect("Failed to post a message to the SharedWorker.\n\
             This could be due to the browser being incompatible.\n\
@@ -1195,6 +1195,23 @@ pub fn mm_ctx_with_custom_db_with_conf(conf: Option<Json>) -> MmArc {
     ctx
 }
 
+/// Checks whether the active maker order is saved to the SQLite database in the `db_dir` of the node.
+#[cfg(not(target_arch = "wasm32"))]
+pub fn is_active_maker_order_saved(mm: &MarketMakerIt, db_dir: &str, uuid: &str) -> bool {
+    use db_common::sqlite::rusqlite::{Connection, OpenFlags};
+
+    let db_path = mm.folder.join("DB").join(db_dir).join("MM2.db");
+    let conn = Connection::open_with_flags(db_path, OpenFlags::SQLITE_OPEN_READ_ONLY).unwrap();
+    let count: i64 = conn
+        .query_row(
+            "SELECT COUNT(*) FROM my_active_orders WHERE uuid = ?1 AND type = 'Maker';",
+            [uuid],
+            |row| row.get(0),
+        )
+        .unwrap();
+    count > 0
+}
+
 #[cfg(not(target_arch = "wasm32"))]
 pub async fn mm_ctx_with_custom_async_db() -> MmArc {
     use db_common::async_sql_conn::AsyncConnection;
@@ -1204,6 +1221,7 @@ pub async fn mm_ctx_with_custom_async_db() -> MmArc {
     let ctx = MmCtxBuilder::new().into_mm_arc();
 
     let connection = AsyncConnection::open_in_memory().await.unwrap();
+    let _ = ctx.async_sqlite_reader.set(connection.clone());
     let _ = ctx
         .async_sqlite_connection
         .set(Arc::new(AsyncMutex::new(connection)))